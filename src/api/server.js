@@ -20,6 +20,77 @@ const app = express();
 const PORT = process.env.PORT || 3000;
 const SERVICE_ID = process.env.SERVICE_ID || "default";
 
+/**
+ * Native decision cache in front of EvaluateHash, chosen by env:
+ * - SHARED_DECISION_CACHE=true: host-wide shared-memory segment
+ *   (SHARED_CACHE_ENTRIES sizes a new segment)
+ * - NATIVE_DECISION_CACHE=true: this process only; a timing wheel evicts
+ *   each entry when the user's timeofRetention ends (DECISION_CACHE_ENTRIES)
+ * When one is attached it replaces the EvaluateHash lookup on the hot path;
+ * decisions are still written to MongoDB, off the request path.
+ * Resolves to { kind, get, set, clear, stats }, or null if disabled or
+ * unavailable. get returns { result, inputDigest } or null; the shared
+ * segment's 32-byte entries have no room for the digest, so it is null there.
+ */
+let decisionCachePromise = null;
+function getDecisionCache() {
+  const useShared = process.env.SHARED_DECISION_CACHE === "true";
+  if (!useShared && process.env.NATIVE_DECISION_CACHE !== "true") {
+    return Promise.resolve(null);
+  }
+  if (!decisionCachePromise) {
+    decisionCachePromise = import("../sgx/index.js")
+      .then((sgxModule) => {
+        const evaluator = sgxModule.default;
+        if (useShared) {
+          const options = {};
+          if (process.env.SHARED_CACHE_ENTRIES) {
+            options.capacity = Number(process.env.SHARED_CACHE_ENTRIES);
+          }
+          const info = evaluator.openSharedCache(options);
+          if (!info) {
+            return null;
+          }
+          console.log(
+            `[${SERVICE_ID}] Shared decision cache: ${info.capacity} entries (${info.created ? "created" : "attached"})`
+          );
+          return {
+            kind: "shared",
+            get: (key, version) => {
+              const result = evaluator.sharedCacheGet(key, version);
+              return result && { result, inputDigest: null };
+            },
+            set: (key, version, result, ttlSeconds) => evaluator.sharedCacheSet(key, version, result, ttlSeconds),
+            clear: () => evaluator.clearSharedCache(),
+            stats: () => evaluator.getSharedCacheStats(),
+          };
+        }
+
+        const options = {};
+        if (process.env.DECISION_CACHE_ENTRIES) {
+          options.capacity = Number(process.env.DECISION_CACHE_ENTRIES);
+        }
+        if (!evaluator.enableDecisionCache(options)) {
+          return null;
+        }
+        console.log(`[${SERVICE_ID}] Native decision cache enabled (timing-wheel expiry)`);
+        return {
+          kind: "native",
+          get: (key, version) => evaluator.decisionCacheGet(key, version, { digest: true }),
+          set: (key, version, result, ttlSeconds, inputDigest) =>
+            evaluator.decisionCacheSet(key, version, result, ttlSeconds, inputDigest),
+          clear: () => evaluator.clearDecisionCache(),
+          stats: () => evaluator.getDecisionCacheStats(),
+        };
+      })
+      .catch((error) => {
+        console.warn(`[${SERVICE_ID}] Native decision cache unavailable, using MongoDB:`, error.message);
+        return null;
+      });
+  }
+  return decisionCachePromise;
+}
+
 // Middleware
 app.use(cors());
 app.use(express.json());
@@ -53,6 +124,8 @@ app.get("/", (req, res) => {
     endpoints: {
       health: "GET /health",
       evaluate: "POST /api/evaluate",
+      openChannel: "POST /api/channel",
+      evaluateSealed: "POST /api/evaluate/sealed",
       users: "GET /api/users",
       createUser: "POST /api/users",
       updatePreferences: "PUT /api/users/:userId/preferences",
@@ -61,6 +134,7 @@ app.get("/", (req, res) => {
       getPolicy: "GET /api/policy",
       updatePolicy: "PUT /api/policy",
       cacheStats: "GET /api/cache/stats",
+      sgxStats: "GET /api/sgx/stats",
       clearCache: "DELETE /api/cache",
     },
   });
@@ -72,7 +146,7 @@ app.get("/", (req, res) => {
  */
 app.post("/api/evaluate", async (req, res) => {
   try {
-    const { appId, userId } = req.body;
+    const { appId, userId, deadlineMs, priority } = req.body;
 
     if (!appId || !userId) {
       return res.status(400).json({
@@ -110,22 +184,31 @@ app.post("/api/evaluate", async (req, res) => {
         md5(policy.version)
     );
 
-    const cachedResult = await Models.EvaluateHash.findOne({
-      userId: user.id.toString(),
-      hash: hashValue,
-      createdAt: {
-        $gte: moment()
-          .utc()
-          .subtract(Number(user.privacyPreference.timeofRetention), "second"),
-      },
-    });
+    const decisionCache = await getDecisionCache();
+    const cacheKey = `${user.id}:${hashValue}`;
+    let cachedResult = null;
+    if (decisionCache) {
+      cachedResult = decisionCache.get(cacheKey, policy.version);
+    } else {
+      cachedResult = await Models.EvaluateHash.findOne({
+        userId: user.id.toString(),
+        hash: hashValue,
+        createdAt: {
+          $gte: moment()
+            .utc()
+            .subtract(Number(user.privacyPreference.timeofRetention), "second"),
+        },
+      });
+    }
 
     let result;
+    let inputDigest = null;
     let cacheHit = false;
     let usingSGX = false;
 
     if (cachedResult) {
       result = cachedResult.result;
+      inputDigest = cachedResult.inputDigest || null;
       cacheHit = true;
     } else {
       // Use SGX enclave if enabled, otherwise fall back to JavaScript
@@ -136,14 +219,39 @@ app.post("/api/evaluate", async (req, res) => {
           const isSGXAvailable = sgxModule.isSGXAvailable();
 
           if (isSGXAvailable) {
-            const isAccepted = await sgxEvaluator.evaluate(app, user, policy);
-            result = isAccepted ? "grant" : "deny";
+            // With digest, evaluate() checks the enclave's digest against
+            // the JSON it sent and throws SGX_INPUT_MISMATCH otherwise, so
+            // only a decision over the inputs hashed into hashValue is cached
+            const evaluation = await sgxEvaluator.evaluate(app, user, policy, {
+              deadlineMs: Number(deadlineMs) || 0,
+              priority: priority === "bulk" ? "bulk" : "realtime",
+              digest: true,
+            });
+            result = evaluation.granted ? "grant" : "deny";
+            inputDigest = evaluation.inputDigest;
             usingSGX = true;
             console.log(`[${SERVICE_ID}] Evaluation performed in SGX enclave`);
           } else {
             throw new Error("SGX not initialized");
           }
         } catch (sgxError) {
+          // The enclave queue shed this request: an answer after the
+          // device's deadline is useless, so do not fall back either
+          if (sgxError.code === "SGX_OVERLOAD" || sgxError.code === "SGX_DEADLINE_EXPIRED") {
+            return res.status(503).json({
+              error: "Evaluator overloaded",
+              code: sgxError.code,
+              service: SERVICE_ID,
+            });
+          }
+          if (sgxError.code === "SGX_INPUT_MISMATCH") {
+            return res.status(500).json({
+              error: "Evaluation failed",
+              code: sgxError.code,
+              message: sgxError.message,
+              service: SERVICE_ID,
+            });
+          }
           console.warn(`[${SERVICE_ID}] SGX evaluation failed, falling back to JS:`, sgxError.message);
           const isAccepted = await Helpers.PrivacyPreference.evaluate(app, user);
           result = isAccepted ? "grant" : "deny";
@@ -154,11 +262,20 @@ app.post("/api/evaluate", async (req, res) => {
       }
 
       // Store in cache
-      await Models.EvaluateHash.create({
+      const retentionSeconds = Number(user.privacyPreference.timeofRetention);
+      const stored = Models.EvaluateHash.create({
         userId: user.id.toString(),
         hash: hashValue,
         result,
+        ...(inputDigest && { inputDigest }),
+        expiresAt: new Date(Date.now() + retentionSeconds * 1000),
       });
+      if (decisionCache) {
+        decisionCache.set(cacheKey, policy.version, result, retentionSeconds, inputDigest);
+        stored.catch((error) => console.warn(`[${SERVICE_ID}] Failed to persist decision:`, error.message));
+      } else {
+        await stored;
+      }
     }
 
     const endTime = process.hrtime.bigint();
@@ -166,6 +283,7 @@ app.post("/api/evaluate", async (req, res) => {
 
     res.json({
       result,
+      inputDigest,
       latencyMs: latencyMs.toFixed(3),
       cacheHit,
       usingSGX,
@@ -181,6 +299,107 @@ app.post("/api/evaluate", async (req, res) => {
   }
 });
 
+/**
+ * Loaded SGX evaluator, or null when the enclave is not in use
+ */
+async function getEnclave() {
+  if (process.env.SGX_ENABLED !== "true") {
+    return null;
+  }
+  const sgxModule = await import("../sgx/index.js");
+  return sgxModule.isSGXAvailable() ? sgxModule.default : null;
+}
+
+/**
+ * POST /api/channel
+ * Open an encrypted request channel with the enclave
+ * Body: { publicKey } - base64 uncompressed P-256 point
+ */
+app.post("/api/channel", async (req, res) => {
+  try {
+    const sgxEvaluator = await getEnclave();
+    if (!sgxEvaluator) {
+      return res.status(503).json({ error: "Encrypted requests need the SGX enclave" });
+    }
+    if (!req.body.publicKey) {
+      return res.status(400).json({ error: "Missing required field: publicKey" });
+    }
+
+    const { sessionId, enclavePublicKey } = sgxEvaluator.openSecureChannel(
+      Buffer.from(req.body.publicKey, "base64")
+    );
+    res.json({ sessionId, enclavePublicKey: enclavePublicKey.toString("base64") });
+  } catch (error) {
+    res.status(400).json({
+      error: "Failed to open channel",
+      message: error.message,
+    });
+  }
+});
+
+/**
+ * POST /api/evaluate/sealed
+ * Evaluate an app request and preference sealed by SecureChannelClient
+ * Body: { sessionId, sealed (base64), deadlineMs, priority }
+ * The server cannot read the inputs, so these decisions are not cached;
+ * inputDigest lets the client, who holds the plaintext, check what was
+ * evaluated (sgx/index.js inputDigest).
+ */
+app.post("/api/evaluate/sealed", async (req, res) => {
+  try {
+    const { sessionId, sealed, deadlineMs, priority } = req.body;
+    if (!sessionId || !sealed) {
+      return res.status(400).json({ error: "Missing required fields: sessionId, sealed" });
+    }
+
+    const sgxEvaluator = await getEnclave();
+    if (!sgxEvaluator) {
+      return res.status(503).json({ error: "Encrypted requests need the SGX enclave" });
+    }
+    const policy = await Models.PrivacyPolicy.findOne();
+    if (!policy) {
+      return res.status(404).json({
+        error: "Privacy policy not found. Initialize database first.",
+      });
+    }
+
+    const startTime = process.hrtime.bigint();
+    const { granted, inputDigest } = await sgxEvaluator.evaluateEncrypted(
+      Number(sessionId),
+      Buffer.from(sealed, "base64"),
+      policy,
+      {
+        deadlineMs: Number(deadlineMs) || 0,
+        priority: priority === "bulk" ? "bulk" : "realtime",
+        digest: true,
+      }
+    );
+    const latencyMs = Number(process.hrtime.bigint() - startTime) / 1_000_000;
+
+    res.json({
+      result: granted ? "grant" : "deny",
+      inputDigest,
+      latencyMs: latencyMs.toFixed(3),
+      usingSGX: true,
+      service: SERVICE_ID,
+      timestamp: new Date().toISOString(),
+    });
+  } catch (error) {
+    let status = 500;
+    if (error.code === "SGX_UNAUTHENTICATED") {
+      status = 401;
+    } else if (error.code === "SGX_OVERLOAD" || error.code === "SGX_DEADLINE_EXPIRED") {
+      status = 503;
+    }
+    res.status(status).json({
+      error: "Evaluation failed",
+      code: error.code,
+      message: error.message,
+      service: SERVICE_ID,
+    });
+  }
+});
+
 /**
  * GET /api/users
  * List all users
@@ -461,6 +680,8 @@ app.get("/api/cache/stats", async (req, res) => {
       createdAt: { $gte: now.clone().subtract(24, "hours") },
     });
 
+    const decisionCache = await getDecisionCache();
+
     res.json({
       totalEntries,
       grantCount,
@@ -469,6 +690,7 @@ app.get("/api/cache/stats", async (req, res) => {
         last1Hour,
         last24Hours,
       },
+      native: decisionCache ? { kind: decisionCache.kind, ...decisionCache.stats() } : null,
       service: SERVICE_ID,
     });
   } catch (error) {
@@ -479,6 +701,30 @@ app.get("/api/cache/stats", async (req, res) => {
   }
 });
 
+/**
+ * GET /api/sgx/stats
+ * SGX batch dispatcher metrics (batch sizes, queueing delay, latency)
+ */
+app.get("/api/sgx/stats", async (req, res) => {
+  try {
+    if (process.env.SGX_ENABLED !== "true") {
+      return res.status(404).json({ error: "SGX not enabled" });
+    }
+
+    const sgxModule = await import("../sgx/index.js");
+    res.json({
+      available: sgxModule.isSGXAvailable(),
+      batching: sgxModule.default.getBatchingStats(req.query.reset === "true"),
+      service: SERVICE_ID,
+    });
+  } catch (error) {
+    res.status(500).json({
+      error: "Failed to fetch SGX stats",
+      message: error.message,
+    });
+  }
+});
+
 /**
  * DELETE /api/cache
  * Clear cache (for testing/benchmarking)
@@ -486,6 +732,10 @@ app.get("/api/cache/stats", async (req, res) => {
 app.delete("/api/cache", async (req, res) => {
   try {
     const result = await Models.EvaluateHash.deleteMany({});
+    const decisionCache = await getDecisionCache();
+    if (decisionCache) {
+      decisionCache.clear();
+    }
 
     res.json({
       message: "Cache cleared successfully",
@@ -0,0 +1,133 @@
+/**
+ * App Normalization Benchmark
+ *
+ * Times minimizeAppRequest() (sgx/enclave/Enclave.h), which drops every
+ * requested node that has another requested node under it, on apps that
+ * list each node after some of its ancestors ("Contact", "Email", "Phone"):
+ * 1. Nodes per app before and after, and the cost of minimizing one app
+ * 2. evaluate() and evaluateLayout() on the listed and the minimized apps
+ * 3. A check that evaluate(), evaluateLayout() and evaluateConstantTime()
+ *    decide every minimized app as evaluate() decides the listed one
+ *
+ * The enclave cache and the eval daemon minimize each app once and keep
+ * it. Only the benchmark addon is needed (npm run build-addon), not SGX
+ * hardware or MongoDB.
+ *
+ * Usage:
+ *   npm run app-normalization-benchmark
+ *   APP_NODES=16 ANCESTORS=5 npm run app-normalization-benchmark
+ */
+
+import { createCollector } from "../metrics/collector.js";
+import { createRequire } from "module";
+import { fileURLToPath } from "url";
+import path from "path";
+import os from "os";
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+const require = createRequire(import.meta.url);
+
+// Benchmark configuration
+const ATTRIBUTES = Number(process.env.ATTRIBUTES) || 1023;
+const PURPOSES = Number(process.env.PURPOSES) || 255;
+const ALLOW_IDS = Number(process.env.ALLOW_IDS) || 4;
+const APP_NODES = Number(process.env.APP_NODES) || 8;
+const ANCESTORS = (process.env.ANCESTORS || "0,1,3").split(",").map(Number);
+const MIN_US = Number(process.env.MIN_US) || 200000;
+
+function printResults(runs) {
+  console.log("\n" + "=".repeat(80));
+  console.log("APP REQUEST MINIMIZATION (ns per request)");
+  console.log("=".repeat(80));
+  console.log(
+    "Ancestors".padEnd(11) +
+      "nodes".padStart(8) +
+      "minimal".padStart(9) +
+      "minimize".padStart(10) +
+      "evaluate".padStart(10) +
+      "minimal".padStart(9) +
+      "layout".padStart(9) +
+      "minimal".padStart(9)
+  );
+  for (const run of runs) {
+    console.log(
+      String(run.ancestors).padEnd(11) +
+        run.rawNodes.toFixed(1).padStart(8) +
+        run.minimizedNodes.toFixed(1).padStart(9) +
+        run.minimizeNs.toFixed(0).padStart(10) +
+        run.evaluateNs.toFixed(0).padStart(10) +
+        run.evaluateMinimizedNs.toFixed(0).padStart(9) +
+        run.layoutNs.toFixed(0).padStart(9) +
+        run.layoutMinimizedNs.toFixed(0).padStart(9)
+    );
+  }
+  console.log(
+    `${ATTRIBUTES} attributes, ${PURPOSES} purposes, ${APP_NODES} requested nodes per tree, ` +
+      `${ALLOW_IDS} allowed IDs. Mismatches: ${runs.reduce((sum, run) => sum + run.mismatches, 0)}`
+  );
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("App Normalization Benchmark");
+  console.log("=".repeat(80));
+
+  let addon;
+  try {
+    addon = require(path.join(__dirname, "../sgx/build/Release/bench-addon.node"));
+  } catch (error) {
+    console.error("\n[ERROR] Benchmark addon not available. Run: npm run build-addon");
+    process.exit(1);
+  }
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "app-normalization");
+
+  const runs = [];
+  for (const ancestors of ANCESTORS) {
+    console.log(`Running: ${APP_NODES} nodes per tree, ${ancestors} ancestors listed with each`);
+    runs.push(
+      await addon.benchmarkAppNormalization({
+        attributes: ATTRIBUTES,
+        purposes: PURPOSES,
+        allowIds: ALLOW_IDS,
+        appNodes: APP_NODES,
+        ancestors,
+        minUs: MIN_US,
+      })
+    );
+  }
+
+  printResults(runs);
+
+  collector.addCustomData("attributes", ATTRIBUTES);
+  collector.addCustomData("purposes", PURPOSES);
+  collector.addCustomData("allowIds", ALLOW_IDS);
+  collector.addCustomData("appNodes", APP_NODES);
+  collector.addCustomData("ancestors", ANCESTORS);
+  collector.addCustomData("minUs", MIN_US);
+  collector.addCustomData("results", runs);
+  collector.export("app-normalization");
+
+  const mismatches = runs.reduce((sum, run) => sum + run.mismatches, 0);
+  if (mismatches > 0) {
+    throw new Error(`Minimized apps are decided differently on ${mismatches} requests`);
+  }
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
@@ -0,0 +1,112 @@
+/**
+ * Batch Prefetch Benchmark
+ *
+ * Times evaluateLayoutBatch() (sgx/enclave/PolicyLayout.h), which runs a
+ * batch of requests as a software pipeline that prefetches each request's
+ * objects, index slots and intervals some requests ahead, against the plain
+ * loop over evaluateLayout() (distance 0):
+ * 1. Nanoseconds per request at each prefetch distance, and the speedup
+ *    over the plain loop
+ * 2. A check that every distance returns the plain loop's decisions
+ *
+ * The policy should be larger than the host's last-level cache (the layout
+ * size is printed); on trees that fit, prefetching has nothing to hide.
+ * The eval daemon's native engine uses the same pipeline (--prefetch-distance).
+ * Only the benchmark addon is needed (npm run build-addon), not SGX hardware
+ * or MongoDB.
+ *
+ * Usage:
+ *   npm run batch-prefetch-benchmark
+ *   NODES=4000000 DISTANCES=1,2,4,8 npm run batch-prefetch-benchmark
+ */
+
+import { createCollector } from "../metrics/collector.js";
+import { createRequire } from "module";
+import { fileURLToPath } from "url";
+import path from "path";
+import os from "os";
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+const require = createRequire(import.meta.url);
+
+// Benchmark configuration
+const NODES = Number(process.env.NODES) || 1000000;
+const REQUESTS = Number(process.env.REQUESTS) || 262144;
+const ALLOW_IDS = Number(process.env.ALLOW_IDS) || 4;
+const MIN_US = Number(process.env.MIN_US) || 200000;
+const DISTANCES = (process.env.DISTANCES || "1,2,4,8,16,32").split(",").map(Number);
+
+function printResults(run) {
+  console.log("\n" + "=".repeat(80));
+  console.log("BATCH EVALUATION WITH SOFTWARE PREFETCH");
+  console.log("=".repeat(80));
+  console.log("Distance".padEnd(10) + "ns/request".padStart(12) + "speedup".padStart(10));
+  for (const entry of run.distances) {
+    console.log(
+      (entry.distance === 0 ? "0 (plain)" : String(entry.distance)).padEnd(10) +
+        entry.ns.toFixed(1).padStart(12) +
+        `${entry.speedup.toFixed(2)}x`.padStart(10)
+    );
+  }
+  console.log(
+    `${run.nodes} attribute nodes, ${run.requests} requests, ${run.allowIds} allowed IDs each; ` +
+      `layout ${(run.layoutBytes / 1048576).toFixed(0)} MiB, compiled in ${(run.compileUs / 1000).toFixed(0)} ms. ` +
+      `Mismatches: ${run.mismatches}`
+  );
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Batch Prefetch Benchmark");
+  console.log("=".repeat(80));
+
+  let addon;
+  try {
+    addon = require(path.join(__dirname, "../sgx/build/Release/bench-addon.node"));
+  } catch (error) {
+    console.error("\n[ERROR] Benchmark addon not available. Run: npm run build-addon");
+    process.exit(1);
+  }
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "batch-prefetch");
+
+  console.log(`Running: ${NODES} nodes, ${REQUESTS} requests, distances 0,${DISTANCES.join(",")}`);
+  const run = await addon.benchmarkBatchPrefetch({
+    nodes: NODES,
+    requests: REQUESTS,
+    allowIds: ALLOW_IDS,
+    minUs: MIN_US,
+    distances: DISTANCES,
+  });
+
+  printResults(run);
+
+  collector.addCustomData("nodes", NODES);
+  collector.addCustomData("requests", REQUESTS);
+  collector.addCustomData("allowIds", ALLOW_IDS);
+  collector.addCustomData("minUs", MIN_US);
+  collector.addCustomData("results", run);
+  collector.export("batch-prefetch");
+
+  if (run.mismatches > 0) {
+    throw new Error(`Batch evaluation disagrees with the plain loop on ${run.mismatches} requests`);
+  }
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
@@ -0,0 +1,130 @@
+/**
+ * Constant-Time Evaluation Benchmark
+ *
+ * Compares the early-exit evaluate() core with the branch-free
+ * evaluateConstantTime() kernel (sgx/enclave/ConstantTime.h):
+ * 1. Throughput over the synthetic 63-attribute / 15-purpose workload, and
+ *    a check that both kernels reach the same decisions
+ * 2. Timing-variance test: batches of evaluations on two inputs that differ
+ *    only in which preference entry matches, randomly interleaved, compared
+ *    with Welch's t-test. |t| above 4.5 means the timing depends on the
+ *    input. The early-exit core is expected to fail; the constant-time
+ *    kernel must pass, or the benchmark exits non-zero.
+ *
+ * The kernels run outside the enclave, so only the benchmark addon is needed
+ * (npm run build-addon), not SGX hardware or MongoDB.
+ *
+ * Usage:
+ *   npm run constant-time-benchmark
+ *   EVALUATIONS=5000000 SAMPLES=50000 BATCH=32 npm run constant-time-benchmark
+ */
+
+import { createCollector } from "../metrics/collector.js";
+import { createRequire } from "module";
+import { fileURLToPath } from "url";
+import path from "path";
+import os from "os";
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+const require = createRequire(import.meta.url);
+
+// Benchmark configuration
+const EVALUATIONS = Number(process.env.EVALUATIONS) || 2000000;
+const SAMPLES = Number(process.env.SAMPLES) || 20000;
+const BATCH = Number(process.env.BATCH) || 16;
+const T_THRESHOLD = 4.5;
+
+function printResults(run) {
+  const { timing } = run;
+  console.log("\n" + "=".repeat(80));
+  console.log("CONSTANT-TIME EVALUATION");
+  console.log("=".repeat(80));
+  console.log(
+    "Kernel".padEnd(16) +
+      "ns/eval".padStart(10) +
+      "match (ns)".padStart(13) +
+      "no match (ns)".padStart(15) +
+      "Welch t".padStart(11) +
+      "timing".padStart(10)
+  );
+  const row = (name, ns, matchNs, noMatchNs, t) =>
+    console.log(
+      name.padEnd(16) +
+        ns.toFixed(1).padStart(10) +
+        matchNs.toFixed(1).padStart(13) +
+        noMatchNs.toFixed(1).padStart(15) +
+        t.toFixed(2).padStart(11) +
+        (Math.abs(t) > T_THRESHOLD ? "leaks" : "flat").padStart(10)
+    );
+  row("early exit", run.earlyExitNs, timing.earlyExitMatchNs, timing.earlyExitNoMatchNs, timing.earlyExitT);
+  row(
+    "constant time",
+    run.constantTimeNs,
+    timing.constantTimeMatchNs,
+    timing.constantTimeNoMatchNs,
+    timing.constantTimeT
+  );
+  console.log(
+    `${run.evaluations} evaluations, ${run.mismatches} decision mismatches; ` +
+      `${timing.samples} samples per class of ${timing.batch} evaluations, |t| > ${T_THRESHOLD} leaks`
+  );
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Constant-Time Evaluation Benchmark");
+  console.log("=".repeat(80));
+
+  let addon;
+  try {
+    addon = require(path.join(__dirname, "../sgx/build/Release/bench-addon.node"));
+  } catch (error) {
+    console.error("\n[ERROR] Benchmark addon not available. Run: npm run build-addon");
+    process.exit(1);
+  }
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "constant-time");
+
+  // Warm-up: page in the code and the synthetic workload
+  await addon.benchmarkConstantTime({ evaluations: 100000, samples: 1000 });
+
+  console.log(`Running: ${EVALUATIONS} evaluations per kernel, ${SAMPLES} samples per class`);
+  const run = await addon.benchmarkConstantTime({
+    evaluations: EVALUATIONS,
+    samples: SAMPLES,
+    batch: BATCH,
+  });
+
+  printResults(run);
+
+  collector.addCustomData("evaluations", EVALUATIONS);
+  collector.addCustomData("samples", SAMPLES);
+  collector.addCustomData("batch", BATCH);
+  collector.addCustomData("results", run);
+  collector.export("constant-time");
+
+  if (run.mismatches > 0) {
+    throw new Error(`Constant-time kernel disagrees with evaluate() on ${run.mismatches} inputs`);
+  }
+  if (Math.abs(run.timing.constantTimeT) > T_THRESHOLD) {
+    throw new Error(`Constant-time kernel timing depends on the input (t = ${run.timing.constantTimeT.toFixed(2)})`);
+  }
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
@@ -0,0 +1,231 @@
+/**
+ * Evaluation Daemon Overhead Benchmark
+ *
+ * Compares per-request cost of evaluating in-process (addon + dispatcher)
+ * with going through the host-local evaluation daemon over its Unix socket:
+ * 1. Serial latency: one request at a time (p50 / p99 / mean)
+ * 2. Pipelined throughput with 1..512 requests in flight on one connection
+ * Daemon runs are made with the decision cache off (pure transport and
+ * batching overhead) and with a warm cache (every request a hit).
+ *
+ * Needs the addon and the eval-daemon binary (npm run build-addon); the
+ * in-process rows also need the enclave (SGX_ENABLED=true, SIM mode is fine).
+ * ENGINE=native runs the daemon without an enclave.
+ *
+ * Usage:
+ *   SGX_ENABLED=true npx babel-watch src/benchmarks/daemon-overhead-benchmark.js
+ *   ENGINE=native REQUESTS=50000 npm run daemon-benchmark
+ */
+
+import sgxEvaluator, { isSGXAvailable } from "../sgx/index.js";
+import { createCollector } from "../metrics/collector.js";
+import { spawn } from "child_process";
+import fs from "fs";
+import os from "os";
+import path from "path";
+import { fileURLToPath } from "url";
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+const SGX_DIR = path.join(__dirname, "..", "sgx");
+
+// Benchmark configuration
+const ENGINE = process.env.ENGINE || "enclave";
+const REQUESTS = Number(process.env.REQUESTS) || 20000;
+const SERIAL_REQUESTS = Number(process.env.SERIAL_REQUESTS) || 5000;
+const IN_FLIGHT = [1, 8, 64, 512];
+const DAEMON_BINARY = path.join(SGX_DIR, "build", "Release", "eval-daemon");
+const ENCLAVE_FILE = process.env.ENCLAVE_FILE || path.join(SGX_DIR, "build", "enclave.signed.so");
+const SOCKET_PATH = path.join(os.tmpdir(), `privacy-evald-bench-${process.pid}.sock`);
+
+/**
+ * Synthetic nested-set policy, one app and REQUESTS distinct users so that
+ * the cache-off runs never repeat a key
+ */
+function buildTestData() {
+  const attributes = [
+    { _id: "a0", name: "Personal", left: 1, right: 10 },
+    { _id: "a1", name: "Contact", left: 2, right: 7 },
+    { _id: "a2", name: "Email", left: 3, right: 4 },
+    { _id: "a3", name: "Phone", left: 5, right: 6 },
+    { _id: "a4", name: "Location", left: 8, right: 9 },
+  ];
+  const purposes = [
+    { _id: "p0", name: "Any", left: 1, right: 6 },
+    { _id: "p1", name: "Service", left: 2, right: 3 },
+    { _id: "p2", name: "Marketing", left: 4, right: 5 },
+  ];
+
+  const users = [];
+  for (let i = 0; i < REQUESTS; i++) {
+    users.push({
+      privacyPreference: {
+        attributes: ["a1"],
+        exceptions: i % 3 === 0 ? ["a2"] : ["a4"],
+        allowedPurposes: ["p1"],
+        prohibitedPurposes: ["p2"],
+        timeofRetention: 3600 + i,
+      },
+    });
+  }
+
+  return {
+    policy: { attributes, purposes },
+    app: { attributes: ["a2"], purposes: ["p1"], timeofRetention: 3600 },
+    users,
+  };
+}
+
+/**
+ * Start a daemon and wait until its socket accepts connections
+ */
+async function startDaemon(cacheEntries) {
+  const args = ["--socket", SOCKET_PATH, "--engine", ENGINE, "--cache-entries", String(cacheEntries)];
+  if (ENGINE === "enclave") {
+    args.push("--enclave", ENCLAVE_FILE);
+  }
+  const daemon = spawn(DAEMON_BINARY, args, { stdio: ["ignore", "ignore", "inherit"] });
+  const exited = new Promise((resolve) => daemon.once("exit", resolve));
+
+  for (let waitedMs = 0; waitedMs < 5000; waitedMs += 20) {
+    if (daemon.exitCode !== null) break;
+    if (fs.existsSync(SOCKET_PATH) && sgxEvaluator.connectDaemon(SOCKET_PATH)) {
+      return { daemon, exited };
+    }
+    await new Promise((resolve) => setTimeout(resolve, 20));
+  }
+  daemon.kill("SIGKILL");
+  throw new Error(`eval-daemon did not start (${DAEMON_BINARY})`);
+}
+
+async function stopDaemon({ daemon, exited }) {
+  sgxEvaluator.disconnectDaemon();
+  daemon.kill("SIGTERM");
+  await exited;
+}
+
+/**
+ * One request at a time
+ */
+async function measureSerial(evaluate, testData) {
+  const latencies = [];
+  for (let i = 0; i < SERIAL_REQUESTS; i++) {
+    const startTime = process.hrtime.bigint();
+    await evaluate(testData.app, testData.users[i % testData.users.length], testData.policy);
+    latencies.push(Number(process.hrtime.bigint() - startTime) / 1000);
+  }
+  latencies.sort((a, b) => a - b);
+  return {
+    p50Us: latencies[Math.floor(latencies.length * 0.5)],
+    p99Us: latencies[Math.floor(latencies.length * 0.99)],
+    meanUs: latencies.reduce((sum, v) => sum + v, 0) / latencies.length,
+  };
+}
+
+/**
+ * inFlight closed-loop callers sharing REQUESTS requests
+ */
+async function measurePipelined(evaluate, testData, inFlight) {
+  let next = 0;
+  let grants = 0;
+  const caller = async () => {
+    while (next < REQUESTS) {
+      const i = next++;
+      if (await evaluate(testData.app, testData.users[i], testData.policy)) grants++;
+    }
+  };
+
+  const startTime = process.hrtime.bigint();
+  await Promise.all(Array.from({ length: inFlight }, caller));
+  const elapsedSec = Number(process.hrtime.bigint() - startTime) / 1e9;
+  return { inFlight, requestsPerSec: REQUESTS / elapsedSec, usPerRequest: (elapsedSec * 1e6) / REQUESTS, grants };
+}
+
+async function runScenario(label, evaluate, testData) {
+  console.log(`Running: ${label}`);
+  const serial = await measureSerial(evaluate, testData);
+  const pipelined = [];
+  for (const inFlight of IN_FLIGHT) {
+    pipelined.push(await measurePipelined(evaluate, testData, inFlight));
+  }
+  return { label, serial, pipelined };
+}
+
+function printResults(scenarios) {
+  console.log("\n" + "=".repeat(80));
+  console.log("EVALUATION DAEMON OVERHEAD");
+  console.log("=".repeat(80));
+  console.log("Serial latency".padEnd(32) + "p50 (us)".padStart(12) + "p99 (us)".padStart(12) + "mean (us)".padStart(12));
+  scenarios.forEach(({ label, serial }) => {
+    console.log(
+      label.padEnd(32) +
+        serial.p50Us.toFixed(1).padStart(12) +
+        serial.p99Us.toFixed(1).padStart(12) +
+        serial.meanUs.toFixed(1).padStart(12)
+    );
+  });
+
+  console.log("-".repeat(80));
+  console.log("Pipelined (req/s)".padEnd(32) + IN_FLIGHT.map((n) => `${n} in flight`.padStart(14)).join(""));
+  scenarios.forEach(({ label, pipelined }) => {
+    console.log(label.padEnd(32) + pipelined.map((run) => run.requestsPerSec.toFixed(0).padStart(14)).join(""));
+  });
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Evaluation Daemon Overhead Benchmark");
+  console.log("=".repeat(80));
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "daemon-overhead");
+  collector.addCustomData("engine", ENGINE);
+
+  const testData = buildTestData();
+  const scenarios = [];
+
+  // In-process baseline first: once connected, evaluate() uses the daemon
+  if (process.env.SGX_ENABLED === "true" && (await sgxEvaluator.initialize()) && isSGXAvailable()) {
+    scenarios.push(await runScenario("In-process addon", (a, u, p) => sgxEvaluator.evaluate(a, u, p), testData));
+  } else {
+    console.log("Enclave not available: skipping the in-process baseline");
+  }
+
+  const viaDaemon = (a, u, p) => sgxEvaluator.evaluateViaDaemon(a, u, p);
+
+  let daemon = await startDaemon(0);
+  scenarios.push(await runScenario(`Daemon (${ENGINE}, no cache)`, viaDaemon, testData));
+  let stats = await sgxEvaluator.getDaemonStats();
+  collector.addCustomData("daemonStatsNoCache", stats);
+  console.log(`  records per engine batch: ${(stats.engineRecords / Math.max(stats.batches, 1)).toFixed(1)}`);
+  await stopDaemon(daemon);
+
+  daemon = await startDaemon(REQUESTS * 4);
+  await measurePipelined(viaDaemon, testData, 64);
+  scenarios.push(await runScenario(`Daemon (${ENGINE}, warm cache)`, viaDaemon, testData));
+  stats = await sgxEvaluator.getDaemonStats();
+  collector.addCustomData("daemonStatsWarmCache", stats);
+  await stopDaemon(daemon);
+
+  printResults(scenarios);
+
+  collector.addCustomData("requests", REQUESTS);
+  collector.addCustomData("scenarios", scenarios);
+  collector.export("daemon-overhead");
+  sgxEvaluator.destroy();
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
@@ -0,0 +1,207 @@
+/**
+ * Decision Export Benchmark (Columnar vs JSON Lines)
+ *
+ * Audits a synthetic NDJSON file with the native pipeline, writing the
+ * decisions both as JSON Lines and as a columnar file, then compares:
+ * 1. File size
+ * 2. Time to count grants: JSON.parse per line in JS, a native substring
+ *    scan over the JSON Lines, and a SIMD popcount over the decision column
+ * 3. Scan time of every other boolean column in the columnar file
+ *
+ * Only the native addon is needed (npm run build-addon), not SGX or MongoDB.
+ *
+ * Usage:
+ *   npx babel-watch src/benchmarks/decision-columns-benchmark.js
+ *   ROWS=5000000 APPS=50 USERS=1000000 npm run columns-benchmark
+ */
+
+import sgxEvaluator from "../sgx/index.js";
+import { createCollector } from "../metrics/collector.js";
+import fs from "fs";
+import os from "os";
+import path from "path";
+import readline from "readline";
+
+// Benchmark configuration
+const ROWS = Number(process.env.ROWS) || 1000000;
+const APPS = Number(process.env.APPS) || 20;
+const USERS = Number(process.env.USERS) || 200000;
+const REPETITIONS = 5;
+const COLUMNS = [
+  "valid",
+  "retention",
+  "attr_allowed",
+  "attr_excepted",
+  "purpose_allowed",
+  "purpose_prohibited",
+];
+
+const workDir = fs.mkdtempSync(path.join(os.tmpdir(), "decision-columns-"));
+const files = {
+  policy: path.join(workDir, "policy.json"),
+  input: path.join(workDir, "records.ndjson"),
+  jsonl: path.join(workDir, "decisions.ndjson"),
+  columnar: path.join(workDir, "decisions.pdc"),
+};
+
+/**
+ * Small nested-set policy and ROWS random (app, user) records
+ */
+async function writeTestData() {
+  const attributes = [
+    { _id: "a0", name: "Personal", left: 1, right: 10 },
+    { _id: "a1", name: "Contact", left: 2, right: 7 },
+    { _id: "a2", name: "Email", left: 3, right: 4 },
+    { _id: "a3", name: "Phone", left: 5, right: 6 },
+    { _id: "a4", name: "Location", left: 8, right: 9 },
+  ];
+  const purposes = [
+    { _id: "p0", name: "Any", left: 1, right: 6 },
+    { _id: "p1", name: "Service", left: 2, right: 3 },
+    { _id: "p2", name: "Marketing", left: 4, right: 5 },
+  ];
+  fs.writeFileSync(files.policy, JSON.stringify({ attributes, purposes }));
+
+  const pick = (list) => list[Math.floor(Math.random() * list.length)];
+  const out = fs.createWriteStream(files.input);
+  for (let i = 0; i < ROWS; i++) {
+    const record = {
+      id: i,
+      app: {
+        _id: `app-${i % APPS}`,
+        attributes: [pick(["a2", "a3", "a4"])],
+        purposes: [pick(["p1", "p2"])],
+        timeofRetention: pick([3600, 604800]),
+      },
+      user: {
+        _id: `user-${Math.floor(Math.random() * USERS)}`,
+        privacyPreference: {
+          attributes: [pick(["a0", "a1"])],
+          exceptions: Math.random() < 0.3 ? ["a4"] : [],
+          allowedPurposes: ["p1"],
+          prohibitedPurposes: Math.random() < 0.5 ? ["p2"] : [],
+          timeofRetention: 86400,
+        },
+      },
+    };
+    if (!out.write(JSON.stringify(record) + "\n")) {
+      await new Promise((resolve) => out.once("drain", resolve));
+    }
+  }
+  await new Promise((resolve) => out.end(resolve));
+}
+
+/**
+ * Baseline: what an analyst does with JSON Lines today
+ */
+async function countGrantsWithJsonParse() {
+  const startTime = process.hrtime.bigint();
+  const lines = readline.createInterface({ input: fs.createReadStream(files.jsonl) });
+  let rows = 0;
+  let matches = 0;
+  for await (const line of lines) {
+    rows++;
+    if (JSON.parse(line).decision === "grant") matches++;
+  }
+  return { rows, matches, scanMs: Number(process.hrtime.bigint() - startTime) / 1e6 };
+}
+
+/**
+ * Fastest of REPETITIONS native scans
+ */
+function bestScan(options) {
+  let best = null;
+  for (let i = 0; i < REPETITIONS; i++) {
+    const scan = sgxEvaluator.scanDecisions(options);
+    if (!best || scan.scanMs < best.scanMs) best = scan;
+  }
+  return best;
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Decision Export Benchmark");
+  console.log("=".repeat(80));
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "decision-columns");
+
+  console.log(`\nWriting ${ROWS} records (${APPS} apps, ${USERS} users)...`);
+  await writeTestData();
+
+  console.log("Auditing...");
+  const audit = await sgxEvaluator.auditNdjson({
+    policy: files.policy,
+    input: files.input,
+    output: files.jsonl,
+    columnar: files.columnar,
+  });
+
+  const sizes = {
+    jsonlBytes: fs.statSync(files.jsonl).size,
+    columnarBytes: fs.statSync(files.columnar).size,
+  };
+  sizes.ratio = sizes.jsonlBytes / sizes.columnarBytes;
+
+  console.log("Scanning...");
+  const jsParse = await countGrantsWithJsonParse();
+  const jsonlScan = bestScan({ path: files.jsonl, format: "jsonl", column: "decision" });
+  const columnarScan = bestScan({ path: files.columnar, format: "columnar", column: "decision" });
+  const columnScans = {};
+  COLUMNS.forEach((column) => {
+    columnScans[column] = bestScan({ path: files.columnar, format: "columnar", column });
+  });
+
+  console.log("\n" + "=".repeat(80));
+  console.log("DECISION EXPORT: COLUMNAR VS JSON LINES");
+  console.log("=".repeat(80));
+  console.log(`Rows: ${audit.records}, grants: ${audit.grants}`);
+  console.log(
+    `JSON Lines: ${(sizes.jsonlBytes / 1048576).toFixed(1)} MB, ` +
+      `columnar: ${(sizes.columnarBytes / 1048576).toFixed(1)} MB (${sizes.ratio.toFixed(1)}x smaller)`
+  );
+  console.log("-".repeat(80));
+  console.log("Count grants".padEnd(40) + "Time (ms)".padStart(12) + "Rows/s".padStart(16) + "Matches".padStart(12));
+  [
+    ["JSON Lines, JSON.parse (JS)", jsParse],
+    ["JSON Lines, substring scan (native)", jsonlScan],
+    ["Columnar, SIMD popcount", columnarScan],
+  ].forEach(([label, scan]) => {
+    console.log(
+      label.padEnd(40) +
+        scan.scanMs.toFixed(3).padStart(12) +
+        (scan.rows / (scan.scanMs / 1000)).toExponential(2).padStart(16) +
+        String(scan.matches).padStart(12)
+    );
+  });
+  console.log("-".repeat(80));
+  COLUMNS.forEach((column) => {
+    const scan = columnScans[column];
+    console.log(`Column ${column}`.padEnd(40) + scan.scanMs.toFixed(3).padStart(12) + String(scan.matches).padStart(28));
+  });
+
+  collector.addCustomData("rows", audit.records);
+  collector.addCustomData("sizes", sizes);
+  collector.addCustomData("grantScans", { jsParse, jsonlScan, columnarScan });
+  collector.addCustomData("columnScans", columnScans);
+  collector.export("decision-columns");
+
+  fs.rmSync(workDir, { recursive: true, force: true });
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  fs.rmSync(workDir, { recursive: true, force: true });
+  process.exit(1);
+});
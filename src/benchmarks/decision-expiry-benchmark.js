@@ -0,0 +1,244 @@
+/**
+ * Decision Cache Expiry Benchmark
+ *
+ * Compares two ways of honouring timeofRetention under heavy churn (a
+ * steady stream of new decisions with short retention windows):
+ * 1. Query-time filtering (current EvaluateHash path): entries are kept
+ *    forever and each lookup checks createdAt >= now - retention. Run
+ *    against an in-process Map and, with MONGO=true, against MongoDB.
+ * 2. Timing-wheel expiry (native decision cache): each entry is freed the
+ *    moment its window ends.
+ * Reports lookup latency, stored vs live entries, memory, and any lookup
+ * that returned an expired decision.
+ *
+ * Needs the addon (npm run build-addon); MONGO=true also needs MONGODB_URL.
+ *
+ * Usage:
+ *   npm run expiry-benchmark
+ *   DURATION_MS=30000 INSERTS_PER_ROUND=2000 TTL_MAX_MS=5000 npm run expiry-benchmark
+ */
+
+import sgxEvaluator from "../sgx/index.js";
+import { createCollector } from "../metrics/collector.js";
+import os from "os";
+
+// Benchmark configuration
+const DURATION_MS = Number(process.env.DURATION_MS) || 10000;
+const INSERTS_PER_ROUND = Number(process.env.INSERTS_PER_ROUND) || 1000;
+const LOOKUPS_PER_ROUND = Number(process.env.LOOKUPS_PER_ROUND) || 2000;
+const TTL_MIN_MS = Number(process.env.TTL_MIN_MS) || 50;
+const TTL_MAX_MS = Number(process.env.TTL_MAX_MS) || 2000;
+const MONGO_DURATION_MS = Number(process.env.MONGO_DURATION_MS) || 5000;
+// Lookups pick from this many most recent keys: a mix of live and expired
+const LOOKUP_WINDOW = INSERTS_PER_ROUND * 20;
+// Clock granularity between the JS and native timers
+const STALE_TOLERANCE_MS = 2;
+
+/**
+ * Query-time filter over a Map, as the EvaluateHash query does
+ */
+function createFilteredMap() {
+  const entries = new Map();
+  return {
+    name: "Query-time filter (Map)",
+    get: async (key) => {
+      const entry = entries.get(key);
+      return entry && entry.createdAt >= Date.now() - entry.ttlMs ? entry.result : null;
+    },
+    set: async (key, result, ttlMs) => {
+      entries.set(key, { result, createdAt: Date.now(), ttlMs });
+    },
+    stored: async () => entries.size,
+    // The entries are the only thing this run adds to the JS heap
+    bytes: () => null,
+    measureHeap: true,
+  };
+}
+
+function createWheelCache() {
+  sgxEvaluator.clearDecisionCache();
+  return {
+    name: "Timing wheel (native)",
+    get: async (key) => sgxEvaluator.decisionCacheGet(key, 1),
+    set: async (key, result, ttlMs) => sgxEvaluator.decisionCacheSet(key, 1, result, ttlMs / 1000),
+    stored: async () => sgxEvaluator.getDecisionCacheStats().entries,
+    bytes: () => sgxEvaluator.getDecisionCacheStats().bytes,
+  };
+}
+
+async function createMongoFilter() {
+  await import("../services/mongoose.js");
+  const { default: Models } = await import("../models/index.js");
+  const userId = "000000000000000000000001";
+  await Models.EvaluateHash.deleteMany({ userId });
+  return {
+    name: "Query-time filter (MongoDB)",
+    get: async (key, ttlMs) => {
+      const doc = await Models.EvaluateHash.findOne({
+        userId,
+        hash: key,
+        createdAt: { $gte: new Date(Date.now() - ttlMs) },
+      });
+      return doc ? doc.result : null;
+    },
+    set: async (key, result) => {
+      await Models.EvaluateHash.create({ userId, hash: key, result });
+    },
+    stored: async () => Models.EvaluateHash.countDocuments({ userId }),
+    bytes: () => null,
+    cleanup: async () => {
+      await Models.EvaluateHash.deleteMany({ userId });
+      const { default: mongoose } = await import("mongoose");
+      await mongoose.disconnect();
+    },
+  };
+}
+
+/**
+ * Insert/lookup rounds for durationMs; every lookup is timed and checked
+ * against the expiry the benchmark itself recorded
+ */
+async function runChurn(cache, durationMs) {
+  console.log(`Running: ${cache.name}`);
+  if (global.gc) global.gc();
+  const heapBefore = process.memoryUsage().heapUsed;
+
+  const keys = [];
+  const expiresAt = [];
+  const ttls = [];
+  const latencies = [];
+  let hits = 0;
+  let stale = 0;
+  let rounds = 0;
+  const samples = [];
+
+  const endTime = Date.now() + durationMs;
+  while (Date.now() < endTime) {
+    for (let i = 0; i < INSERTS_PER_ROUND; i++) {
+      const key = `u${keys.length}:${(keys.length * 2654435761) >>> 0}`;
+      const ttlMs = TTL_MIN_MS + Math.floor(Math.random() * (TTL_MAX_MS - TTL_MIN_MS));
+      await cache.set(key, keys.length % 3 ? "grant" : "deny", ttlMs);
+      keys.push(key);
+      ttls.push(ttlMs);
+      expiresAt.push(Date.now() + ttlMs);
+    }
+
+    const windowStart = Math.max(0, keys.length - LOOKUP_WINDOW);
+    for (let i = 0; i < LOOKUPS_PER_ROUND; i++) {
+      const index = windowStart + Math.floor(Math.random() * (keys.length - windowStart));
+      const askedAt = Date.now();
+      const startTime = process.hrtime.bigint();
+      const result = await cache.get(keys[index], ttls[index]);
+      latencies.push(Number(process.hrtime.bigint() - startTime) / 1000);
+      if (result) {
+        hits++;
+        if (askedAt > expiresAt[index] + STALE_TOLERANCE_MS) stale++;
+      }
+    }
+
+    if (rounds++ % 10 === 0) {
+      samples.push({ elapsedMs: durationMs - (endTime - Date.now()), stored: await cache.stored() });
+    }
+  }
+
+  const now = Date.now();
+  const live = expiresAt.filter((t) => t > now).length;
+  const stored = await cache.stored();
+  const heapGrowth = process.memoryUsage().heapUsed - heapBefore;
+  const memoryBytes = cache.measureHeap ? heapGrowth : cache.bytes();
+  latencies.sort((a, b) => a - b);
+  return {
+    name: cache.name,
+    inserted: keys.length,
+    lookups: latencies.length,
+    hitRate: hits / latencies.length,
+    staleHits: stale,
+    live,
+    stored,
+    memoryBytes,
+    p50Us: latencies[Math.floor(latencies.length * 0.5)],
+    p99Us: latencies[Math.floor(latencies.length * 0.99)],
+    samples,
+  };
+}
+
+function printResults(runs) {
+  console.log("\n" + "=".repeat(100));
+  console.log("DECISION CACHE EXPIRY UNDER CHURN");
+  console.log("=".repeat(100));
+  console.log(
+    "Approach".padEnd(30) +
+      "inserted".padStart(10) +
+      "live".padStart(9) +
+      "stored".padStart(10) +
+      "memory (MB)".padStart(13) +
+      "p50 (us)".padStart(10) +
+      "p99 (us)".padStart(10) +
+      "stale hits".padStart(12)
+  );
+  runs.forEach((run) => {
+    console.log(
+      run.name.padEnd(30) +
+        String(run.inserted).padStart(10) +
+        String(run.live).padStart(9) +
+        String(run.stored).padStart(10) +
+        (run.memoryBytes !== null ? (run.memoryBytes / 1048576).toFixed(1) : "n/a").padStart(13) +
+        run.p50Us.toFixed(2).padStart(10) +
+        run.p99Us.toFixed(2).padStart(10) +
+        String(run.staleHits).padStart(12)
+    );
+  });
+  console.log("Memory: native estimate for the timing wheel, JS heap growth for the Map, n/a for MongoDB");
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Decision Cache Expiry Benchmark");
+  console.log("=".repeat(100));
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "decision-cache-expiry");
+
+  if (!sgxEvaluator.enableDecisionCache({ capacity: 1 << 24 })) {
+    throw new Error("Native decision cache unavailable (build the addon first)");
+  }
+
+  const runs = [];
+  runs.push(await runChurn(createFilteredMap(), DURATION_MS));
+  runs.push(await runChurn(createWheelCache(), DURATION_MS));
+  collector.addCustomData("wheelStats", sgxEvaluator.getDecisionCacheStats());
+
+  if (process.env.MONGO === "true") {
+    const mongo = await createMongoFilter();
+    runs.push(await runChurn(mongo, MONGO_DURATION_MS));
+    await mongo.cleanup();
+  }
+
+  printResults(runs);
+
+  collector.addCustomData("config", {
+    durationMs: DURATION_MS,
+    insertsPerRound: INSERTS_PER_ROUND,
+    lookupsPerRound: LOOKUPS_PER_ROUND,
+    ttlMinMs: TTL_MIN_MS,
+    ttlMaxMs: TTL_MAX_MS,
+  });
+  collector.addCustomData("runs", runs);
+  collector.export("decision-cache-expiry");
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
@@ -0,0 +1,157 @@
+/**
+ * Decision Cache Bloom Filter Benchmark
+ *
+ * Measures the Bloom filter in front of the native decision cache:
+ * 1. Miss-path cost (first-time keys) with the filter on and off
+ * 2. Hit-path cost with the filter on and off (the filter is pure overhead)
+ * 3. False-positive rate over the misses
+ * 4. Background rebuild after a policy version change: lookups keep running
+ *    while the filter for the new version is built
+ * Each measurement is repeated at several cache sizes, since a table probe
+ * gets more expensive once the table outgrows the CPU caches.
+ *
+ * Needs the addon (npm run build-addon); no enclave or MongoDB.
+ *
+ * Usage:
+ *   npm run filter-benchmark
+ *   SIZES=100000,1000000,4000000 LOOKUPS=2000000 npm run filter-benchmark
+ */
+
+import sgxEvaluator from "../sgx/index.js";
+import { createCollector } from "../metrics/collector.js";
+import os from "os";
+
+// Benchmark configuration
+const SIZES = (process.env.SIZES || "10000,100000,1000000").split(",").map(Number);
+const LOOKUPS = Number(process.env.LOOKUPS) || 1000000;
+const TTL_SECONDS = 3600;
+
+const liveKey = (i) => `u${i}:${(i * 2654435761) >>> 0}`;
+const missKey = (i) => `new${i}:${(i * 40503) >>> 0}`;
+
+/**
+ * Average ns per lookup over LOOKUPS keys
+ */
+function timeLookups(keyFor, count, version) {
+  const keys = Array.from({ length: Math.min(count, LOOKUPS) }, (_, i) => keyFor(i));
+  let hits = 0;
+  const startTime = process.hrtime.bigint();
+  for (let i = 0; i < LOOKUPS; i++) {
+    if (sgxEvaluator.decisionCacheGet(keys[i % keys.length], version)) hits++;
+  }
+  return { nsPerLookup: Number(process.hrtime.bigint() - startTime) / LOOKUPS, hits };
+}
+
+function fill(size, version) {
+  sgxEvaluator.clearDecisionCache();
+  for (let i = 0; i < size; i++) {
+    sgxEvaluator.decisionCacheSet(liveKey(i), version, i % 3 ? "grant" : "deny", TTL_SECONDS);
+  }
+}
+
+async function measureSize(size) {
+  console.log(`Running: ${size} live entries`);
+  fill(size, "1.0");
+  // Let the rebuilds triggered while filling finish
+  await new Promise((resolve) => setTimeout(resolve, 100));
+
+  const result = { size };
+  for (const bloomFilter of [false, true]) {
+    sgxEvaluator.enableDecisionCache({ bloomFilter });
+    const before = sgxEvaluator.getDecisionCacheStats().filter;
+    const miss = timeLookups(missKey, LOOKUPS, "1.0");
+    const after = sgxEvaluator.getDecisionCacheStats().filter;
+    const hit = timeLookups(liveKey, size, "1.0");
+    const label = bloomFilter ? "withFilter" : "withoutFilter";
+    result[label] = { missNs: miss.nsPerLookup, hitNs: hit.nsPerLookup };
+    if (bloomFilter) {
+      const skipped = after.skippedLookups - before.skippedLookups;
+      const falsePositives = after.falsePositives - before.falsePositives;
+      result.falsePositiveRate = falsePositives / (skipped + falsePositives);
+      result.filterBytes = after.bytes;
+    }
+  }
+  result.missSavedNs = result.withoutFilter.missNs - result.withFilter.missNs;
+
+  // Policy update: the first insert under the new version starts a rebuild;
+  // lookups bypass the filter until it lands
+  const rebuildsBefore = sgxEvaluator.getDecisionCacheStats().filter.rebuilds;
+  const switchTime = process.hrtime.bigint();
+  sgxEvaluator.decisionCacheSet(liveKey(0), "2.0", "grant", TTL_SECONDS);
+  let lookupsDuringRebuild = 0;
+  while (sgxEvaluator.getDecisionCacheStats().filter.rebuilds === rebuildsBefore) {
+    sgxEvaluator.decisionCacheGet(missKey(lookupsDuringRebuild++), "2.0");
+  }
+  result.rebuildMs = Number(process.hrtime.bigint() - switchTime) / 1e6;
+  result.lookupsDuringRebuild = lookupsDuringRebuild;
+  return result;
+}
+
+function printResults(results) {
+  console.log("\n" + "=".repeat(100));
+  console.log("DECISION CACHE BLOOM FILTER");
+  console.log("=".repeat(100));
+  console.log(
+    "Live entries".padEnd(14) +
+      "miss, no filter".padStart(17) +
+      "miss, filter".padStart(14) +
+      "saved".padStart(9) +
+      "hit, no filter".padStart(16) +
+      "hit, filter".padStart(13) +
+      "FP rate".padStart(10) +
+      "rebuild (ms)".padStart(14)
+  );
+  results.forEach((r) => {
+    console.log(
+      String(r.size).padEnd(14) +
+        `${r.withoutFilter.missNs.toFixed(0)} ns`.padStart(17) +
+        `${r.withFilter.missNs.toFixed(0)} ns`.padStart(14) +
+        `${r.missSavedNs.toFixed(0)} ns`.padStart(9) +
+        `${r.withoutFilter.hitNs.toFixed(0)} ns`.padStart(16) +
+        `${r.withFilter.hitNs.toFixed(0)} ns`.padStart(13) +
+        `${(r.falsePositiveRate * 100).toFixed(3)}%`.padStart(10) +
+        r.rebuildMs.toFixed(1).padStart(14)
+    );
+  });
+  console.log("Times are per call from JS, N-API crossing and key hashing included");
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Decision Cache Bloom Filter Benchmark");
+  console.log("=".repeat(100));
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "decision-cache-filter");
+
+  if (!sgxEvaluator.enableDecisionCache({ capacity: Math.max(...SIZES) * 2 })) {
+    throw new Error("Native decision cache unavailable (build the addon first)");
+  }
+
+  const results = [];
+  for (const size of SIZES) {
+    results.push(await measureSize(size));
+  }
+
+  printResults(results);
+
+  collector.addCustomData("lookups", LOOKUPS);
+  collector.addCustomData("results", results);
+  collector.export("decision-cache-filter");
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
@@ -0,0 +1,232 @@
+/**
+ * Sealed Enclave Snapshot Benchmark
+ *
+ * Measures how long a restarted validator takes to get back to warm
+ * latency, with and without a sealed snapshot of the enclave's compiled
+ * policies and decision cache:
+ * 1. Seed: a process evaluates the working set once and seals its caches
+ *    (snapshot size and seal time)
+ * 2. Cold restart: a fresh process evaluates the working set twice
+ * 3. Restored restart: a fresh process unseals the snapshot, then evaluates
+ *    the working set twice
+ * Each phase runs in its own process, so no state survives between them
+ * except the sealed file. Time-to-warm is enclave creation + restore + the
+ * first pass over the working set; the second pass is the warm reference.
+ *
+ * Needs the addon and the enclave (SGX_ENABLED=true; SGX_MODE=SIM builds
+ * work, since simulation mode seals with a software-derived key).
+ *
+ * Usage:
+ *   SGX_ENABLED=true npm run snapshot-benchmark
+ *   USERS=50000 POLICIES=16 npm run snapshot-benchmark
+ */
+
+import sgxEvaluator from "../sgx/index.js";
+import { createCollector } from "../metrics/collector.js";
+import { fork } from "child_process";
+import fs from "fs";
+import os from "os";
+import path from "path";
+import { fileURLToPath } from "url";
+
+// Benchmark configuration
+const USERS = Number(process.env.USERS) || 20000;
+const POLICIES = Number(process.env.POLICIES) || 8;
+const IN_FLIGHT = Number(process.env.IN_FLIGHT) || 256;
+const SNAPSHOT_FILE = path.join(os.tmpdir(), `privacy-snapshot-bench-${process.pid}.sealed`);
+
+/**
+ * POLICIES variants of a nested-set policy and USERS distinct preferences;
+ * request i pairs user i with policy i % POLICIES
+ */
+function buildWorkingSet() {
+  const policies = Array.from({ length: POLICIES }, (_, p) => ({
+    version: `1.${p}`,
+    attributes: [
+      { _id: "a0", name: "Personal", left: 1, right: 10 },
+      { _id: "a1", name: "Contact", left: 2, right: 7 },
+      { _id: "a2", name: "Email", left: 3, right: 4 },
+      { _id: "a3", name: "Phone", left: 5, right: 6 },
+      { _id: "a4", name: "Location", left: 8, right: 9 },
+    ],
+    purposes: [
+      { _id: "p0", name: "Any", left: 1, right: 6 },
+      { _id: "p1", name: "Service", left: 2, right: 3 },
+      { _id: "p2", name: "Marketing", left: 4, right: 5 },
+    ],
+  }));
+  const app = { attributes: ["a2"], purposes: ["p1"], timeofRetention: 3600 };
+
+  return Array.from({ length: USERS }, (_, i) => ({
+    app,
+    policy: policies[i % POLICIES],
+    user: {
+      privacyPreference: {
+        attributes: ["a1"],
+        exceptions: i % 3 === 0 ? ["a2"] : ["a4"],
+        allowedPurposes: ["p1"],
+        prohibitedPurposes: ["p2"],
+        timeofRetention: 3600 + i,
+      },
+    },
+  }));
+}
+
+/**
+ * One pass over the working set, IN_FLIGHT requests at a time
+ * @returns {number} elapsed ms
+ */
+async function runPass(requests) {
+  const startTime = process.hrtime.bigint();
+  for (let i = 0; i < requests.length; i += IN_FLIGHT) {
+    await Promise.all(
+      requests.slice(i, i + IN_FLIGHT).map((r) => sgxEvaluator.evaluate(r.app, r.user, r.policy))
+    );
+  }
+  return Number(process.hrtime.bigint() - startTime) / 1e6;
+}
+
+/**
+ * Worker side: one validator lifetime for the given phase
+ */
+async function runWorker() {
+  const { phase, snapshotFile } = JSON.parse(process.env.SNAPSHOT_BENCH_WORKER);
+  const requests = buildWorkingSet();
+  const result = { phase };
+
+  const initStart = process.hrtime.bigint();
+  if (!(await sgxEvaluator.initialize())) {
+    throw new Error("SGX enclave not initialized");
+  }
+  result.initMs = Number(process.hrtime.bigint() - initStart) / 1e6;
+  result.restoreMs = 0;
+
+  if (phase === "restored") {
+    const restored = sgxEvaluator.loadSnapshot(snapshotFile);
+    if (!restored) {
+      throw new Error(`No snapshot at ${snapshotFile}`);
+    }
+    result.restoreMs = restored.unsealMs;
+    result.restoredPolicies = restored.policies;
+    result.restoredDecisions = restored.decisions;
+  }
+
+  result.firstPassMs = await runPass(requests);
+  if (phase === "seed") {
+    const saved = sgxEvaluator.saveSnapshot(snapshotFile);
+    Object.assign(result, saved);
+  } else {
+    result.warmPassMs = await runPass(requests);
+  }
+  result.timeToWarmMs = result.initMs + result.restoreMs + result.firstPassMs;
+
+  process.send(result);
+  sgxEvaluator.destroy();
+}
+
+function runPhase(phase) {
+  const worker = JSON.stringify({ phase, snapshotFile: SNAPSHOT_FILE });
+  const env = { ...process.env, SNAPSHOT_BENCH_WORKER: worker };
+  // The workers manage the snapshot themselves
+  delete env.SGX_SNAPSHOT_PATH;
+  delete env.SGX_ENABLED;
+  const child = fork(fileURLToPath(import.meta.url), [], { env });
+  return new Promise((resolve, reject) => {
+    let result = null;
+    child.once("message", (message) => (result = message));
+    child.once("error", reject);
+    child.once("exit", (code) =>
+      result ? resolve(result) : reject(new Error(`${phase} worker exited with code ${code}`))
+    );
+  });
+}
+
+function printResults(seed, runs) {
+  const perRequestUs = (ms) => ((ms * 1000) / USERS).toFixed(1);
+
+  console.log("\n" + "=".repeat(100));
+  console.log("SEALED ENCLAVE SNAPSHOT");
+  console.log("=".repeat(100));
+  console.log(
+    `Snapshot: ${seed.policies} policies, ${seed.decisions} decisions, ` +
+      `${(seed.bytes / 1024).toFixed(1)} KB sealed in ${seed.sealMs.toFixed(2)} ms`
+  );
+  console.log(
+    "Restart".padEnd(12) +
+      "init (ms)".padStart(11) +
+      "restore (ms)".padStart(14) +
+      "1st pass (ms)".padStart(15) +
+      "1st (µs/req)".padStart(14) +
+      "warm (µs/req)".padStart(15) +
+      "time-to-warm (ms)".padStart(19)
+  );
+  runs.forEach((r) => {
+    console.log(
+      r.phase.padEnd(12) +
+        r.initMs.toFixed(1).padStart(11) +
+        r.restoreMs.toFixed(2).padStart(14) +
+        r.firstPassMs.toFixed(1).padStart(15) +
+        perRequestUs(r.firstPassMs).padStart(14) +
+        perRequestUs(r.warmPassMs).padStart(15) +
+        r.timeToWarmMs.toFixed(1).padStart(19)
+    );
+  });
+  const [cold, restored] = runs;
+  console.log(
+    `Restored restart reaches warm latency ${(cold.timeToWarmMs - restored.timeToWarmMs).toFixed(1)} ms sooner ` +
+      `(${USERS} requests, ${POLICIES} policies, ${IN_FLIGHT} in flight)`
+  );
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Sealed Enclave Snapshot Benchmark");
+  console.log("=".repeat(100));
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+    sgxMode: process.env.SGX_MODE || "HW",
+  });
+  collector.addCustomData("benchmarkType", "enclave-snapshot");
+
+  try {
+    console.log("Running: seed");
+    const seed = await runPhase("seed");
+    const runs = [];
+    for (const phase of ["cold", "restored"]) {
+      console.log(`Running: ${phase} restart`);
+      runs.push(await runPhase(phase));
+    }
+
+    printResults(seed, runs);
+
+    collector.addCustomData("users", USERS);
+    collector.addCustomData("policies", POLICIES);
+    collector.addCustomData("seed", seed);
+    collector.addCustomData("results", runs);
+    collector.export("enclave-snapshot");
+  } finally {
+    fs.rmSync(SNAPSHOT_FILE, { force: true });
+  }
+}
+
+if (process.env.SNAPSHOT_BENCH_WORKER) {
+  runWorker().catch((error) => {
+    console.error("[ERROR] Worker failed:", error.message);
+    process.exit(1);
+  });
+} else {
+  main().catch((error) => {
+    console.error("\n[ERROR] Benchmark failed:", error.message);
+    console.error(error.stack);
+    process.exit(1);
+  });
+}
@@ -0,0 +1,199 @@
+/**
+ * Enclave Input Digest Benchmark
+ *
+ * Measures what it costs the enclave to return the SHA-256 of the inputs it
+ * evaluated alongside each decision (evaluate(..., { digest: true })):
+ * 1. Per-request time through the dispatcher with and without digests, on a
+ *    first pass (every request evaluated) and on repeat passes (enclave
+ *    decision cache hits, where the hash is the largest share of the work).
+ *    Repeat passes alternate between the modes ROUNDS times, swapping which
+ *    goes first; the median is reported.
+ * 2. Caller cost: the check evaluate() makes on every digest it returns,
+ *    recomputing it in JS from the JSON sent (inputDigest). It is included
+ *    in the "with digest" times too.
+ * The policy digest is computed once per compiled policy in the enclave, and
+ * once per policy version in JS, so a request only hashes its own app and
+ * preference JSON.
+ *
+ * Needs the addon and the enclave (SGX_ENABLED=true; SGX_MODE=SIM is fine).
+ *
+ * Usage:
+ *   SGX_ENABLED=true npm run digest-benchmark
+ *   REQUESTS=100000 IN_FLIGHT=512 npm run digest-benchmark
+ */
+
+import sgxEvaluator, { inputDigest } from "../sgx/index.js";
+import { createCollector } from "../metrics/collector.js";
+import os from "os";
+
+// Benchmark configuration
+const REQUESTS = Number(process.env.REQUESTS) || 20000;
+const IN_FLIGHT = Number(process.env.IN_FLIGHT) || 256;
+const ROUNDS = Number(process.env.ROUNDS) || 7;
+
+const median = (values) => [...values].sort((a, b) => a - b)[Math.floor(values.length / 2)];
+
+/**
+ * Synthetic nested-set policy and REQUESTS distinct preferences
+ */
+function buildTestData() {
+  const policy = {
+    attributes: [
+      { _id: "a0", name: "Personal", left: 1, right: 10 },
+      { _id: "a1", name: "Contact", left: 2, right: 7 },
+      { _id: "a2", name: "Email", left: 3, right: 4 },
+      { _id: "a3", name: "Phone", left: 5, right: 6 },
+      { _id: "a4", name: "Location", left: 8, right: 9 },
+    ],
+    purposes: [
+      { _id: "p0", name: "Any", left: 1, right: 6 },
+      { _id: "p1", name: "Service", left: 2, right: 3 },
+      { _id: "p2", name: "Marketing", left: 4, right: 5 },
+    ],
+  };
+  const app = { attributes: ["a2"], purposes: ["p1"], timeofRetention: 3600 };
+  const users = Array.from({ length: REQUESTS }, (_, i) => ({
+    privacyPreference: {
+      attributes: ["a1"],
+      exceptions: i % 3 === 0 ? ["a2"] : ["a4"],
+      allowedPurposes: ["p1"],
+      prohibitedPurposes: ["p2"],
+      timeofRetention: 3600 + i,
+    },
+  }));
+  return { policy, app, users };
+}
+
+/**
+ * Run count calls of fn(i), IN_FLIGHT at a time
+ * @returns {Object} - { usPerRequest, results }
+ */
+async function timeRequests(count, fn) {
+  const results = [];
+  const startTime = process.hrtime.bigint();
+  for (let i = 0; i < count; i += IN_FLIGHT) {
+    const chunk = [];
+    for (let j = i; j < Math.min(i + IN_FLIGHT, count); j++) {
+      chunk.push(fn(j));
+    }
+    results.push(...(await Promise.all(chunk)));
+  }
+  return { usPerRequest: Number(process.hrtime.bigint() - startTime) / 1000 / count, results };
+}
+
+function printResults(verifyUs, rows) {
+  console.log("\n" + "=".repeat(80));
+  console.log("ENCLAVE INPUT DIGEST");
+  console.log("=".repeat(80));
+  console.log(
+    "Pass".padEnd(10) +
+      "plain (µs/req)".padStart(18) +
+      "with digest (µs/req)".padStart(23) +
+      "overhead (µs/req)".padStart(19)
+  );
+  rows.forEach((r) => {
+    console.log(
+      r.pass.padEnd(10) +
+        r.plainUs.toFixed(2).padStart(18) +
+        r.digestUs.toFixed(2).padStart(23) +
+        r.overheadUs.toFixed(2).padStart(19)
+    );
+  });
+  console.log(`Caller verification (inputDigest in JS): ${verifyUs.toFixed(2)} µs per request`);
+  console.log(
+    `${REQUESTS} requests, ${IN_FLIGHT} in flight; repeat = enclave decision cache hits, ` +
+      `median of ${ROUNDS}`
+  );
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Enclave Input Digest Benchmark");
+  console.log("=".repeat(80));
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+    sgxMode: process.env.SGX_MODE || "HW",
+  });
+  collector.addCustomData("benchmarkType", "input-digest");
+
+  if (!(await sgxEvaluator.initialize())) {
+    throw new Error("SGX enclave not initialized");
+  }
+  const { policy, app, users } = buildTestData();
+  // A distinct policy text keeps the digest first pass from hitting the
+  // decisions the plain pass left in the enclave cache
+  const digestPolicy = { ...policy, version: "digest" };
+  const runPlain = () =>
+    timeRequests(REQUESTS, (i) => sgxEvaluator.evaluate(app, users[i], policy));
+  const runDigest = () =>
+    timeRequests(REQUESTS, (i) =>
+      sgxEvaluator.evaluate(app, users[i], digestPolicy, { digest: true })
+    );
+
+  console.log("Running: first pass");
+  const firstPlain = await runPlain();
+  const firstDigest = await runDigest();
+
+  const appJson = JSON.stringify(app);
+  const policyJson = JSON.stringify(digestPolicy);
+  const verifyStart = process.hrtime.bigint();
+  let verified = 0;
+  firstDigest.results.forEach(({ inputDigest: digest }, i) => {
+    const userJson = JSON.stringify(users[i].privacyPreference);
+    if (digest === inputDigest(appJson, userJson, policyJson, digestPolicy.version)) {
+      verified++;
+    }
+  });
+  const verifyUs = Number(process.hrtime.bigint() - verifyStart) / 1000 / REQUESTS;
+  if (verified !== REQUESTS) {
+    throw new Error(`Only ${verified} of ${REQUESTS} digests verified`);
+  }
+
+  const repeats = { plain: [], digest: [] };
+  for (let round = 0; round < ROUNDS; round++) {
+    console.log(`Running: repeat pass ${round + 1}/${ROUNDS}`);
+    // Alternate which mode goes first so neither always inherits the
+    // other's garbage
+    const order = round % 2 === 0 ? ["plain", "digest"] : ["digest", "plain"];
+    for (const mode of order) {
+      const run = mode === "plain" ? runPlain : runDigest;
+      repeats[mode].push((await run()).usPerRequest);
+    }
+  }
+
+  const row = (pass, plainUs, digestUs) => ({
+    pass,
+    plainUs,
+    digestUs,
+    overheadUs: digestUs - plainUs,
+  });
+  const rows = [
+    row("first", firstPlain.usPerRequest, firstDigest.usPerRequest),
+    row("repeat", median(repeats.plain), median(repeats.digest)),
+  ];
+
+  printResults(verifyUs, rows);
+
+  collector.addCustomData("requests", REQUESTS);
+  collector.addCustomData("inFlight", IN_FLIGHT);
+  collector.addCustomData("rounds", ROUNDS);
+  collector.addCustomData("verifyUs", verifyUs);
+  collector.addCustomData("results", rows);
+  collector.export("input-digest");
+  sgxEvaluator.destroy();
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
@@ -0,0 +1,118 @@
+/**
+ * Large Request Benchmark
+ *
+ * Times evaluate() (sgx/enclave/Enclave.h) on apps that request many
+ * attributes and purposes:
+ * 1. The per-node loops, which resolve the preference against the policy
+ *    for every requested node, against the interval path, which resolves it
+ *    once and binary-searches each node, at each app size
+ * 2. evaluate() itself, which takes the interval path from
+ *    INTERVAL_MIN_APP_NODES requested nodes
+ * 3. A check that all three return the same decisions
+ *
+ * Only the benchmark addon is needed (npm run build-addon), not SGX hardware
+ * or MongoDB.
+ *
+ * Usage:
+ *   npm run large-request-benchmark
+ *   APP_NODES=10,100,1000 ATTRIBUTES=1023 PURPOSES=255 npm run large-request-benchmark
+ */
+
+import { createCollector } from "../metrics/collector.js";
+import { createRequire } from "module";
+import { fileURLToPath } from "url";
+import path from "path";
+import os from "os";
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+const require = createRequire(import.meta.url);
+
+// Benchmark configuration
+const APP_NODES = (process.env.APP_NODES || "1,4,10,100,1000").split(",").map(Number);
+const ATTRIBUTES = Number(process.env.ATTRIBUTES) || 255;
+const PURPOSES = Number(process.env.PURPOSES) || 63;
+const ALLOW_IDS = Number(process.env.ALLOW_IDS) || 4;
+const MIN_US = Number(process.env.MIN_US) || 100000;
+
+function printResults(run) {
+  console.log("\n" + "=".repeat(80));
+  console.log("LARGE APP REQUESTS (ns per request)");
+  console.log("=".repeat(80));
+  console.log(
+    "App nodes".padEnd(11) +
+      "per-node".padStart(12) +
+      "intervals".padStart(12) +
+      "speedup".padStart(9) +
+      "evaluate()".padStart(12)
+  );
+  for (const size of run.sizes) {
+    console.log(
+      String(size.appNodes).padEnd(11) +
+        size.linearNs.toFixed(0).padStart(12) +
+        size.intervalNs.toFixed(0).padStart(12) +
+        `${(size.linearNs / size.intervalNs).toFixed(1)}x`.padStart(9) +
+        size.evaluateNs.toFixed(0).padStart(12)
+    );
+  }
+  console.log(
+    `${run.attributes} attributes, ${run.purposes} purposes, ${run.allowIds} allowed IDs; ` +
+      `evaluate() switches at ${run.threshold} app nodes. Mismatches: ${run.mismatches}`
+  );
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Large Request Benchmark");
+  console.log("=".repeat(80));
+
+  let addon;
+  try {
+    addon = require(path.join(__dirname, "../sgx/build/Release/bench-addon.node"));
+  } catch (error) {
+    console.error("\n[ERROR] Benchmark addon not available. Run: npm run build-addon");
+    process.exit(1);
+  }
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "large-request");
+
+  console.log(`Running: ${ATTRIBUTES} attributes, ${PURPOSES} purposes, app sizes ${APP_NODES.join(",")}`);
+  const run = await addon.benchmarkLargeRequest({
+    appNodes: APP_NODES,
+    attributes: ATTRIBUTES,
+    purposes: PURPOSES,
+    allowIds: ALLOW_IDS,
+    minUs: MIN_US,
+  });
+
+  printResults(run);
+
+  collector.addCustomData("appNodes", APP_NODES);
+  collector.addCustomData("attributes", ATTRIBUTES);
+  collector.addCustomData("purposes", PURPOSES);
+  collector.addCustomData("allowIds", ALLOW_IDS);
+  collector.addCustomData("minUs", MIN_US);
+  collector.addCustomData("results", run);
+  collector.export("large-request");
+
+  if (run.mismatches > 0) {
+    throw new Error(`Interval evaluation disagrees with the per-node loops on ${run.mismatches} requests`);
+  }
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
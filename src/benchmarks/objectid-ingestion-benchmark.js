@@ -0,0 +1,125 @@
+/**
+ * ObjectId Ingestion Benchmark
+ *
+ * Times turning the 24-hex ObjectId strings of incoming app requests into
+ * policy node references (sgx/core/ObjectId.h), on batches of about a
+ * million IDs of which 1 in 16 is unknown:
+ * 1. The string map PolicyIndex used before, against hex decoding (scalar
+ *    and SSSE3) plus a minimal perfect hash over the decoded keys
+ * 2. Build time and size of both indexes
+ * 3. A check that both accept exactly the same IDs
+ *
+ * Only the benchmark addon is needed (npm run build-addon), not SGX hardware
+ * or MongoDB.
+ *
+ * Usage:
+ *   npm run objectid-ingestion-benchmark
+ *   POLICY_SIZES=1000,1000000 IDS=4194304 npm run objectid-ingestion-benchmark
+ */
+
+import { createCollector } from "../metrics/collector.js";
+import { createRequire } from "module";
+import { fileURLToPath } from "url";
+import path from "path";
+import os from "os";
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+const require = createRequire(import.meta.url);
+
+// Benchmark configuration
+const POLICY_SIZES = (process.env.POLICY_SIZES || "1000,100000,1000000").split(",").map(Number);
+const IDS = Number(process.env.IDS) || 1048576;
+const MIN_US = Number(process.env.MIN_US) || 200000;
+
+function printResults(runs) {
+  console.log("\n" + "=".repeat(80));
+  console.log("OBJECTID INGESTION (ns per ID)");
+  console.log("=".repeat(80));
+  console.log(
+    "Policy IDs".padEnd(12) +
+      "map".padStart(8) +
+      "decode".padStart(9) +
+      "simd".padStart(8) +
+      "decode+mph".padStart(12) +
+      "simd+mph".padStart(10) +
+      "speedup".padStart(9) +
+      "mismatches".padStart(12)
+  );
+  for (const run of runs) {
+    console.log(
+      String(run.nodes).padEnd(12) +
+        run.mapNs.toFixed(1).padStart(8) +
+        run.scalarDecodeNs.toFixed(1).padStart(9) +
+        run.simdDecodeNs.toFixed(1).padStart(8) +
+        run.scalarNs.toFixed(1).padStart(12) +
+        run.simdNs.toFixed(1).padStart(10) +
+        `${(run.mapNs / run.simdNs).toFixed(1)}x`.padStart(9) +
+        String(run.mismatches).padStart(12)
+    );
+  }
+  console.log(
+    "\n" + "Policy IDs".padEnd(12) + "map build (ms)".padStart(16) + "mph build (ms)".padStart(16) + "mph bytes/ID".padStart(14)
+  );
+  for (const run of runs) {
+    console.log(
+      String(run.nodes).padEnd(12) +
+        (run.mapBuildUs / 1000).toFixed(1).padStart(16) +
+        (run.hashBuildUs / 1000).toFixed(1).padStart(16) +
+        (run.hashBytes / run.nodes).toFixed(1).padStart(14)
+    );
+  }
+  console.log(`${runs[0].ids} incoming IDs per run, ${runs[0].unknown} unknown (rejected: ${runs[0].rejected}).`);
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("ObjectId Ingestion Benchmark");
+  console.log("=".repeat(80));
+
+  let addon;
+  try {
+    addon = require(path.join(__dirname, "../sgx/build/Release/bench-addon.node"));
+  } catch (error) {
+    console.error("\n[ERROR] Benchmark addon not available. Run: npm run build-addon");
+    process.exit(1);
+  }
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "objectid-ingestion");
+
+  const runs = [];
+  for (const nodes of POLICY_SIZES) {
+    console.log(`Running: ${nodes} policy IDs, ${IDS} incoming IDs`);
+    runs.push(await addon.benchmarkObjectIdIngestion({ nodes, ids: IDS, minUs: MIN_US }));
+  }
+
+  printResults(runs);
+
+  collector.addCustomData("policySizes", POLICY_SIZES);
+  collector.addCustomData("ids", IDS);
+  collector.addCustomData("minUs", MIN_US);
+  collector.addCustomData("results", runs);
+  collector.export("objectid-ingestion");
+
+  const mismatches = runs.reduce((sum, run) => sum + run.mismatches, 0);
+  if (mismatches > 0) {
+    throw new Error(`Perfect hash lookups disagree with the string map on ${mismatches} IDs`);
+  }
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
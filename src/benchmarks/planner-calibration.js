@@ -0,0 +1,133 @@
+/**
+ * Evaluation Planner Calibration
+ *
+ * Fits the cost constants of the evaluation strategy planner
+ * (sgx/enclave/EvaluationPlanner.h) on this host:
+ * 1. Times evaluate(), sorted-interval evaluation, and building and
+ *    probing a compiled preference table over a grid of policy sizes
+ *    (15-255 attributes), preference sizes (1-64 allowed IDs) and app
+ *    request sizes (1-16 nodes), and checks that all three agree
+ * 2. Fits fixedNs + perOpNs * ops per strategy
+ * 3. Reports how often the planner, with the fitted and with the
+ *    compiled-in constants, picks the measured fastest strategy, and the
+ *    mean cost of its picks relative to the fastest (regret)
+ *
+ * The fitted constants are printed as #define lines for EvaluationPlanner.h.
+ * Only the benchmark addon is needed (npm run build-addon), not SGX hardware
+ * or MongoDB.
+ *
+ * Usage:
+ *   npm run planner-calibration
+ *   MIN_US=50000 EXPECTED_USES=4 npm run planner-calibration
+ */
+
+import { createCollector } from "../metrics/collector.js";
+import { createRequire } from "module";
+import { fileURLToPath } from "url";
+import path from "path";
+import os from "os";
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+const require = createRequire(import.meta.url);
+
+// Benchmark configuration
+const MIN_US = Number(process.env.MIN_US) || 20000;
+const EXPECTED_USES = Number(process.env.EXPECTED_USES) || 1;
+
+function printResults(run) {
+  console.log("\n" + "=".repeat(80));
+  console.log(`PLANNER CALIBRATION (tables amortized over ${run.expectedUses} use(s))`);
+  console.log("=".repeat(80));
+  console.log(
+    "Attrs".padEnd(7) +
+      "Allow".padStart(6) +
+      "App".padStart(5) +
+      "linear".padStart(10) +
+      "sorted".padStart(10) +
+      "build".padStart(10) +
+      "probe".padStart(9) +
+      "best".padStart(8) +
+      "planned".padStart(9) +
+      "default".padStart(9)
+  );
+  for (const shape of run.shapes) {
+    console.log(
+      String(shape.attributes).padEnd(7) +
+        String(shape.allowIds).padStart(6) +
+        String(shape.appNodes).padStart(5) +
+        shape.linearNs.toFixed(0).padStart(10) +
+        shape.sortedNs.toFixed(0).padStart(10) +
+        shape.buildNs.toFixed(0).padStart(10) +
+        shape.probeNs.toFixed(0).padStart(9) +
+        shape.best.padStart(8) +
+        shape.planned.padStart(9) +
+        shape.plannedDefault.padStart(9)
+    );
+  }
+  console.log("(ns per call)");
+  console.log(
+    `\nFitted constants: ${(run.accuracy * 100).toFixed(0)}% best picks, regret ${run.regret.toFixed(2)}x; ` +
+      `compiled-in: ${(run.defaultAccuracy * 100).toFixed(0)}% best picks, regret ${run.defaultRegret.toFixed(2)}x`
+  );
+
+  const { fitted } = run;
+  console.log("\n// Fitted on " + os.cpus()[0].model);
+  const define = (name, value) =>
+    console.log(`#define ${name} ${value < 1 ? value.toPrecision(2) : value.toFixed(2)}`);
+  define("PLANNER_LINEAR_FIXED_NS", fitted.linear.fixedNs);
+  define("PLANNER_LINEAR_OP_NS", fitted.linear.perOpNs);
+  define("PLANNER_SORTED_FIXED_NS", fitted.sorted.fixedNs);
+  define("PLANNER_SORTED_OP_NS", fitted.sorted.perOpNs);
+  define("PLANNER_BUILD_FIXED_NS", fitted.tableBuild.fixedNs);
+  define("PLANNER_BUILD_OP_NS", fitted.tableBuild.perOpNs);
+  define("PLANNER_PROBE_FIXED_NS", fitted.tableProbe.fixedNs);
+  define("PLANNER_PROBE_OP_NS", fitted.tableProbe.perOpNs);
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Evaluation Planner Calibration");
+  console.log("=".repeat(80));
+
+  let addon;
+  try {
+    addon = require(path.join(__dirname, "../sgx/build/Release/bench-addon.node"));
+  } catch (error) {
+    console.error("\n[ERROR] Benchmark addon not available. Run: npm run build-addon");
+    process.exit(1);
+  }
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "planner-calibration");
+
+  console.log(`Running: 36 shapes x 4 kernels, at least ${MIN_US} µs each`);
+  const run = await addon.calibratePlanner({ minUs: MIN_US, expectedUses: EXPECTED_USES });
+
+  printResults(run);
+
+  collector.addCustomData("minUs", MIN_US);
+  collector.addCustomData("expectedUses", EXPECTED_USES);
+  collector.addCustomData("results", run);
+  collector.export("planner-calibration");
+
+  if (run.mismatches > 0) {
+    throw new Error(`Evaluation strategies disagree with evaluate() on ${run.mismatches} inputs`);
+  }
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
@@ -0,0 +1,145 @@
+/**
+ * Policy DAG Benchmark
+ *
+ * Compares PolicyDag (sgx/core/PolicyDag.h), which labels attributes with
+ * several parents by a few intervals each, with copying every shared
+ * subtree under each parent so that nested-set numbering still applies. On
+ * a complete binary tree where a fraction of the nodes also sits under a
+ * second parent on the same level:
+ * 1. Nodes, intervals and bytes of each
+ * 2. ns per ancestor/descendant check on random pairs and on pairs where
+ *    one node lies a few levels under the other, PolicyDag vectorized and
+ *    one interval at a time
+ * 3. A check that both answer every query the same way
+ *
+ * Only the benchmark addon is needed (npm run build-addon), not SGX hardware
+ * or MongoDB.
+ *
+ * Usage:
+ *   npm run policy-dag-benchmark
+ *   NODES=100000 SHARED=0,0.1,0.2 npm run policy-dag-benchmark
+ */
+
+import { createCollector } from "../metrics/collector.js";
+import { createRequire } from "module";
+import { fileURLToPath } from "url";
+import path from "path";
+import os from "os";
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+const require = createRequire(import.meta.url);
+
+// Benchmark configuration
+const NODES = Number(process.env.NODES) || 1000000;
+const SHARED = (process.env.SHARED || "0,0.01,0.05").split(",").map(Number);
+const QUERIES = Number(process.env.QUERIES) || 1048576;
+const MIN_US = Number(process.env.MIN_US) || 200000;
+
+function printResults(result) {
+  console.log("\n" + "=".repeat(80));
+  console.log("POLICY DAG vs DUPLICATED SUBTREES");
+  console.log("=".repeat(80));
+  console.log(
+    "Shared".padEnd(8) +
+      "edges".padStart(10) +
+      "intervals".padStart(11) +
+      "max".padStart(7) +
+      "MiB".padStart(7) +
+      "copies".padStart(10) +
+      "MiB".padStart(7) +
+      "build (ms)".padStart(12)
+  );
+  for (const run of result.runs) {
+    console.log(
+      `${(run.shared * 100).toFixed(1)}%`.padEnd(8) +
+        String(run.edges).padStart(10) +
+        String(run.intervals).padStart(11) +
+        String(run.maxIntervals).padStart(7) +
+        (run.dagBytes / 1048576).toFixed(1).padStart(7) +
+        String(run.duplicatedNodes).padStart(10) +
+        (run.duplicatedBytes / 1048576).toFixed(1).padStart(7) +
+        run.buildMs.toFixed(1).padStart(12)
+    );
+  }
+  console.log("Intervals and MiB of the DAG, then nodes and MiB of the duplicated tree.");
+  console.log(
+    "\n" +
+      "Shared".padEnd(8) +
+      "random".padStart(9) +
+      "scalar".padStart(9) +
+      "copies".padStart(9) +
+      "ancestor".padStart(10) +
+      "scalar".padStart(9) +
+      "copies".padStart(9) +
+      "mismatches".padStart(12)
+  );
+  for (const run of result.runs) {
+    console.log(
+      `${(run.shared * 100).toFixed(1)}%`.padEnd(8) +
+        run.dagRandomNs.toFixed(1).padStart(9) +
+        run.scalarRandomNs.toFixed(1).padStart(9) +
+        run.duplicatedRandomNs.toFixed(1).padStart(9) +
+        run.dagAncestorNs.toFixed(1).padStart(10) +
+        run.scalarAncestorNs.toFixed(1).padStart(9) +
+        run.duplicatedAncestorNs.toFixed(1).padStart(9) +
+        String(run.mismatches).padStart(12)
+    );
+  }
+  console.log(`${result.nodes} nodes; ns per query over ${result.queries} queries.`);
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Policy DAG Benchmark");
+  console.log("=".repeat(80));
+
+  let addon;
+  try {
+    addon = require(path.join(__dirname, "../sgx/build/Release/bench-addon.node"));
+  } catch (error) {
+    console.error("\n[ERROR] Benchmark addon not available. Run: npm run build-addon");
+    process.exit(1);
+  }
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "policy-dag");
+
+  console.log(`Running: ${NODES} nodes, ${SHARED.join(", ")} of them shared, ${QUERIES} queries each`);
+  const result = await addon.benchmarkPolicyDag({
+    nodes: NODES,
+    shared: SHARED,
+    queries: QUERIES,
+    minUs: MIN_US,
+  });
+
+  printResults(result);
+
+  collector.addCustomData("nodes", NODES);
+  collector.addCustomData("shared", SHARED);
+  collector.addCustomData("queries", QUERIES);
+  collector.addCustomData("minUs", MIN_US);
+  collector.addCustomData("results", result.runs);
+  collector.export("policy-dag");
+
+  const mismatches = result.runs.reduce((sum, run) => sum + run.mismatches, 0);
+  if (mismatches > 0) {
+    throw new Error(`The DAG labeling disagrees with the duplicated tree on ${mismatches} queries`);
+  }
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
@@ -0,0 +1,144 @@
+/**
+ * Hot/Cold Policy Layout Benchmark
+ *
+ * Compares evaluate() over PolicyNode vectors with evaluateLayout() over
+ * the cache-line aligned hot columns of a compiled policy layout
+ * (sgx/enclave/PolicyLayout.h), on large generated trees:
+ * 1. Bytes per node of both layouts, split into hot columns, ID index and
+ *    cold string pool, and the time to compile the layout
+ * 2. Per-evaluation time and last-level cache misses per evaluation (from
+ *    perf events; reported as n/a where the kernel or VM hides them, see
+ *    /proc/sys/kernel/perf_event_paranoid), and a check that both agree
+ *
+ * Only the benchmark addon is needed (npm run build-addon), not SGX hardware
+ * or MongoDB.
+ *
+ * Usage:
+ *   npm run policy-layout-benchmark
+ *   TREE_SIZES=1000,100000,1000000 GENERIC_EVALUATIONS=50 npm run policy-layout-benchmark
+ */
+
+import { createCollector } from "../metrics/collector.js";
+import { createRequire } from "module";
+import { fileURLToPath } from "url";
+import path from "path";
+import os from "os";
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+const require = createRequire(import.meta.url);
+
+// Benchmark configuration
+const TREE_SIZES = (process.env.TREE_SIZES || "1000,10000,100000").split(",").map(Number);
+const GENERIC_EVALUATIONS = Number(process.env.GENERIC_EVALUATIONS) || 200;
+const LAYOUT_EVALUATIONS = Number(process.env.LAYOUT_EVALUATIONS) || 200000;
+const ALLOW_IDS = Number(process.env.ALLOW_IDS) || 4;
+
+function printResults(runs) {
+  console.log("\n" + "=".repeat(80));
+  console.log("HOT/COLD POLICY LAYOUT");
+  console.log("=".repeat(80));
+  const perNode = (run, bytes) => (bytes / (run.nodes * 1.25)).toFixed(1);
+  console.log(
+    "Nodes".padEnd(9) +
+      "node B/n".padStart(10) +
+      "hot B/n".padStart(9) +
+      "index B/n".padStart(11) +
+      "cold B/n".padStart(10) +
+      "compile (ms)".padStart(14)
+  );
+  for (const run of runs) {
+    console.log(
+      String(run.nodes).padEnd(9) +
+        perNode(run, run.nodeBytes).padStart(10) +
+        perNode(run, run.hotBytes).padStart(9) +
+        perNode(run, run.indexBytes).padStart(11) +
+        perNode(run, run.coldBytes).padStart(10) +
+        (run.compileUs / 1000).toFixed(1).padStart(14)
+    );
+  }
+
+  const misses = (value) => (value === null ? "n/a" : value.toFixed(1));
+  console.log(
+    "\n" +
+      "Nodes".padEnd(9) +
+      "generic (ns)".padStart(14) +
+      "layout (ns)".padStart(13) +
+      "speedup".padStart(10) +
+      "LLC/eval gen".padStart(14) +
+      "LLC/eval lay".padStart(14) +
+      "mismatches".padStart(12)
+  );
+  for (const run of runs) {
+    console.log(
+      String(run.nodes).padEnd(9) +
+        run.genericNs.toFixed(0).padStart(14) +
+        run.layoutNs.toFixed(1).padStart(13) +
+        `${(run.genericNs / run.layoutNs).toFixed(0)}x`.padStart(10) +
+        misses(run.genericLlcMisses).padStart(14) +
+        misses(run.layoutLlcMisses).padStart(14) +
+        String(run.mismatches).padStart(12)
+    );
+  }
+  console.log(`Attribute trees of the given size plus purpose trees a quarter as large; B/n is bytes per node.`);
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Hot/Cold Policy Layout Benchmark");
+  console.log("=".repeat(80));
+
+  let addon;
+  try {
+    addon = require(path.join(__dirname, "../sgx/build/Release/bench-addon.node"));
+  } catch (error) {
+    console.error("\n[ERROR] Benchmark addon not available. Run: npm run build-addon");
+    process.exit(1);
+  }
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "policy-layout");
+
+  const runs = [];
+  for (const nodes of TREE_SIZES) {
+    console.log(
+      `Running: ${nodes} nodes, ${GENERIC_EVALUATIONS} generic and ${LAYOUT_EVALUATIONS} layout evaluations`
+    );
+    runs.push(
+      await addon.benchmarkPolicyLayout({
+        nodes,
+        allowIds: ALLOW_IDS,
+        genericEvaluations: GENERIC_EVALUATIONS,
+        layoutEvaluations: LAYOUT_EVALUATIONS,
+      })
+    );
+  }
+
+  printResults(runs);
+
+  collector.addCustomData("treeSizes", TREE_SIZES);
+  collector.addCustomData("allowIds", ALLOW_IDS);
+  collector.addCustomData("results", runs);
+  collector.export("policy-layout");
+
+  const mismatches = runs.reduce((sum, run) => sum + run.mismatches, 0);
+  if (mismatches > 0) {
+    throw new Error(`Policy layout evaluation disagrees with evaluate() on ${mismatches} inputs`);
+  }
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
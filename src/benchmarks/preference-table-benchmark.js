@@ -0,0 +1,117 @@
+/**
+ * Compiled Preference Table Benchmark
+ *
+ * Compares evaluate() with preferences compiled into verdict tables over
+ * the policy's node ordinals (sgx/enclave/PreferenceTable.h), for growing
+ * preference sizes on a 255-attribute / 63-purpose policy:
+ * 1. Cost of building one table, and of indexing the policy once
+ * 2. Per-evaluation cost of both paths, and a check that they agree
+ * 3. Break-even: evaluations of one profile after which its table has paid
+ *    for itself
+ *
+ * Both paths run outside the enclave, so only the benchmark addon is needed
+ * (npm run build-addon), not SGX hardware or MongoDB.
+ *
+ * Usage:
+ *   npm run preference-table-benchmark
+ *   PREFERENCE_SIZES=4,16,64 EVALUATIONS=500000 npm run preference-table-benchmark
+ */
+
+import { createCollector } from "../metrics/collector.js";
+import { createRequire } from "module";
+import { fileURLToPath } from "url";
+import path from "path";
+import os from "os";
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+const require = createRequire(import.meta.url);
+
+// Benchmark configuration
+const EVALUATIONS = Number(process.env.EVALUATIONS) || 200000;
+const PREFERENCE_SIZES = (process.env.PREFERENCE_SIZES || "2,8,32").split(",").map(Number);
+
+function printResults(runs) {
+  console.log("\n" + "=".repeat(80));
+  console.log("COMPILED PREFERENCE TABLES");
+  console.log("=".repeat(80));
+  console.log(
+    "Allow IDs".padEnd(11) +
+      "build (ns)".padStart(12) +
+      "generic (ns)".padStart(14) +
+      "table (ns)".padStart(12) +
+      "speedup".padStart(10) +
+      "break-even".padStart(12) +
+      "mismatches".padStart(12)
+  );
+  for (const run of runs) {
+    console.log(
+      String(run.allowIds).padEnd(11) +
+        run.buildNs.toFixed(0).padStart(12) +
+        run.genericNs.toFixed(1).padStart(14) +
+        run.tableNs.toFixed(1).padStart(12) +
+        `${(run.genericNs / run.tableNs).toFixed(1)}x`.padStart(10) +
+        (run.breakEven < 0 ? "never" : run.breakEven.toFixed(2)).padStart(12) +
+        String(run.mismatches).padStart(12)
+    );
+  }
+  const { attributes, purposes, ordinalsUs } = runs[0];
+  console.log(
+    `${attributes} attributes, ${purposes} purposes; policy index built once in ${ordinalsUs.toFixed(0)} µs. ` +
+      "Break-even in evaluations per profile."
+  );
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Compiled Preference Table Benchmark");
+  console.log("=".repeat(80));
+
+  let addon;
+  try {
+    addon = require(path.join(__dirname, "../sgx/build/Release/bench-addon.node"));
+  } catch (error) {
+    console.error("\n[ERROR] Benchmark addon not available. Run: npm run build-addon");
+    process.exit(1);
+  }
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "preference-table");
+
+  // Warm-up
+  await addon.benchmarkPreferenceTables({ evaluations: 10000, allowIds: PREFERENCE_SIZES[0] });
+
+  const runs = [];
+  for (const allowIds of PREFERENCE_SIZES) {
+    console.log(`Running: ${allowIds} allowed attributes per preference, ${EVALUATIONS} evaluations per path`);
+    runs.push(await addon.benchmarkPreferenceTables({ evaluations: EVALUATIONS, allowIds }));
+  }
+
+  printResults(runs);
+
+  collector.addCustomData("evaluations", EVALUATIONS);
+  collector.addCustomData("preferenceSizes", PREFERENCE_SIZES);
+  collector.addCustomData("results", runs);
+  collector.export("preference-table");
+
+  const mismatches = runs.reduce((sum, run) => sum + run.mismatches, 0);
+  if (mismatches > 0) {
+    throw new Error(`Compiled tables disagree with evaluate() on ${mismatches} inputs`);
+  }
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
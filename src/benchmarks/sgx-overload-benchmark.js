@@ -0,0 +1,228 @@
+/**
+ * SGX Overload Benchmark (Goodput vs Offered Load)
+ *
+ * Drives the native batch dispatcher open-loop at increasing request rates
+ * and reports goodput: answers delivered before the request's deadline.
+ * Two modes are compared at every rate:
+ * 1. FIFO: no deadlines, every request is evaluated however late it is
+ * 2. Deadline-aware: EDF queue, expired requests dropped before the ECALL,
+ *    admission control rejects work that cannot meet its deadline
+ *
+ * Uses a synthetic policy, so no MongoDB is needed.
+ *
+ * Usage:
+ *   SGX_ENABLED=true npx babel-watch src/benchmarks/sgx-overload-benchmark.js
+ */
+
+import sgxEvaluator from "../sgx/index.js";
+import { createCollector } from "../metrics/collector.js";
+import os from "os";
+
+// Benchmark configuration
+const DEADLINE_MS = Number(process.env.DEADLINE_MS) || 20;
+const DURATION_MS = Number(process.env.DURATION_MS) || 3000;
+const TICK_MS = 1;
+const LOAD_FACTORS = [0.25, 0.5, 0.75, 1.0, 1.25, 1.5, 2.0, 3.0];
+const CAPACITY_PROBE_REQUESTS = 20000;
+
+/**
+ * Small synthetic nested-set policy with one app and one user
+ */
+function buildTestData() {
+  const attributes = [
+    { _id: "a0", name: "Personal", left: 1, right: 10 },
+    { _id: "a1", name: "Contact", left: 2, right: 7 },
+    { _id: "a2", name: "Email", left: 3, right: 4 },
+    { _id: "a3", name: "Phone", left: 5, right: 6 },
+    { _id: "a4", name: "Location", left: 8, right: 9 },
+  ];
+  const purposes = [
+    { _id: "p0", name: "Any", left: 1, right: 6 },
+    { _id: "p1", name: "Service", left: 2, right: 3 },
+    { _id: "p2", name: "Marketing", left: 4, right: 5 },
+  ];
+
+  return {
+    policy: { attributes, purposes },
+    app: {
+      attributes: [attributes[2]],
+      purposes: [purposes[1]],
+      timeofRetention: 3600,
+    },
+    user: {
+      privacyPreference: {
+        attributes: ["a1"],
+        exceptions: ["a4"],
+        denyAttributes: [],
+        allowedPurposes: ["p1"],
+        prohibitedPurposes: ["p2"],
+        denyPurposes: [],
+        timeofRetention: 86400,
+      },
+    },
+  };
+}
+
+/**
+ * Closed-loop saturation probe: how many evaluations per second the
+ * dispatcher sustains when it is never idle
+ */
+async function measureCapacity(testData) {
+  const startTime = process.hrtime.bigint();
+  const pending = [];
+  for (let i = 0; i < CAPACITY_PROBE_REQUESTS; i++) {
+    pending.push(sgxEvaluator.evaluate(testData.app, testData.user, testData.policy));
+  }
+  await Promise.all(pending);
+  const elapsedSec = Number(process.hrtime.bigint() - startTime) / 1e9;
+  return CAPACITY_PROBE_REQUESTS / elapsedSec;
+}
+
+/**
+ * Open-loop run at a fixed offered rate
+ */
+async function runAtRate(ratePerSec, deadlineAware, testData) {
+  sgxEvaluator.configureBatching({ admissionControl: deadlineAware });
+  sgxEvaluator.getBatchingStats(true);
+
+  const counts = { offered: 0, good: 0, late: 0, rejected: 0, expired: 0, errors: 0 };
+  const pending = [];
+  const perTick = (ratePerSec * TICK_MS) / 1000;
+  let credit = 0;
+
+  const send = () => {
+    const sentAt = process.hrtime.bigint();
+    counts.offered++;
+    const options = deadlineAware ? { deadlineMs: DEADLINE_MS } : {};
+    pending.push(
+      sgxEvaluator
+        .evaluate(testData.app, testData.user, testData.policy, options)
+        .then(() => {
+          const latencyMs = Number(process.hrtime.bigint() - sentAt) / 1e6;
+          if (latencyMs <= DEADLINE_MS) counts.good++;
+          else counts.late++;
+        })
+        .catch((error) => {
+          if (error.code === "SGX_OVERLOAD") counts.rejected++;
+          else if (error.code === "SGX_DEADLINE_EXPIRED") counts.expired++;
+          else counts.errors++;
+        })
+    );
+  };
+
+  const startTime = Date.now();
+  await new Promise((resolve) => {
+    const timer = setInterval(() => {
+      credit += perTick;
+      while (credit >= 1) {
+        send();
+        credit -= 1;
+      }
+      if (Date.now() - startTime >= DURATION_MS) {
+        clearInterval(timer);
+        resolve();
+      }
+    }, TICK_MS);
+  });
+  await Promise.all(pending);
+
+  const durationSec = DURATION_MS / 1000;
+  const stats = sgxEvaluator.getBatchingStats();
+  return {
+    mode: deadlineAware ? "deadline-aware" : "fifo",
+    offeredRPS: counts.offered / durationSec,
+    goodputRPS: counts.good / durationSec,
+    goodputRatio: counts.offered ? counts.good / counts.offered : 0,
+    ...counts,
+    p99LatencyUs: stats ? stats.lanes.realtime.latencyUs.p99 : null,
+    meanBatchSize: stats ? stats.lanes.realtime.batchSize.mean : null,
+  };
+}
+
+/**
+ * Print a goodput table for both modes
+ */
+function printResults(capacity, rows) {
+  console.log("\n" + "=".repeat(100));
+  console.log("SGX OVERLOAD BENCHMARK: GOODPUT VS OFFERED LOAD");
+  console.log("=".repeat(100));
+  console.log(`Saturation capacity: ${capacity.toFixed(0)} req/s, deadline: ${DEADLINE_MS} ms`);
+  console.log("-".repeat(100));
+  console.log(
+    "Mode".padEnd(16) +
+      "Offered/s".padStart(12) +
+      "Goodput/s".padStart(12) +
+      "Good %".padStart(9) +
+      "Late".padStart(9) +
+      "Rejected".padStart(10) +
+      "Expired".padStart(9) +
+      "p99 (us)".padStart(11) +
+      "Batch".padStart(8)
+  );
+  rows.forEach((row) => {
+    console.log(
+      row.mode.padEnd(16) +
+        row.offeredRPS.toFixed(0).padStart(12) +
+        row.goodputRPS.toFixed(0).padStart(12) +
+        (row.goodputRatio * 100).toFixed(1).padStart(9) +
+        String(row.late).padStart(9) +
+        String(row.rejected).padStart(10) +
+        String(row.expired).padStart(9) +
+        String(row.p99LatencyUs).padStart(11) +
+        (row.meanBatchSize || 0).toFixed(1).padStart(8)
+    );
+  });
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("SGX Overload Benchmark");
+  console.log("=".repeat(80));
+
+  const initialized = await sgxEvaluator.initialize();
+  if (!initialized) {
+    console.error("\n[ERROR] SGX enclave not available. Run: npm run build-sgx");
+    process.exit(1);
+  }
+
+  const testData = buildTestData();
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+    sgxEnabled: true,
+  });
+  collector.addCustomData("benchmarkType", "sgx-overload");
+
+  console.log("\nProbing saturation capacity...");
+  const capacity = await measureCapacity(testData);
+
+  const rows = [];
+  for (const factor of LOAD_FACTORS) {
+    const rate = capacity * factor;
+    console.log(`\nOffered load ${(factor * 100).toFixed(0)}% (${rate.toFixed(0)} req/s)`);
+    rows.push(await runAtRate(rate, false, testData));
+    rows.push(await runAtRate(rate, true, testData));
+  }
+
+  printResults(capacity, rows);
+
+  collector.addCustomData("capacityRPS", capacity);
+  collector.addCustomData("deadlineMs", DEADLINE_MS);
+  collector.addCustomData("goodput", rows);
+  collector.export("sgx-overload");
+
+  sgxEvaluator.destroy();
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
@@ -0,0 +1,193 @@
+/**
+ * Shared Decision Cache Benchmark
+ *
+ * Measures the host-wide shared-memory decision cache that replaces the
+ * EvaluateHash lookup on the /api/evaluate hot path:
+ * 1. Single-process cost of a hit, a miss and an insert (ns/op, JS included)
+ * 2. Aggregate throughput with 1..PROCESSES validator processes sharing the
+ *    segment, read-mostly (WRITE_RATIO of requests re-store their decision)
+ * Each run reports hits, evictions and busy-slot contention from the segment.
+ *
+ * Needs the addon (npm run build-addon); no enclave or MongoDB.
+ *
+ * Usage:
+ *   npm run shared-cache-benchmark
+ *   KEYS=500000 OPS=2000000 PROCESSES=8 npm run shared-cache-benchmark
+ */
+
+import sgxEvaluator from "../sgx/index.js";
+import { createCollector } from "../metrics/collector.js";
+import { fork } from "child_process";
+import os from "os";
+import { fileURLToPath } from "url";
+
+// Benchmark configuration
+const KEYS = Number(process.env.KEYS) || 100000;
+const OPS = Number(process.env.OPS) || 1000000;
+const PROCESSES = Number(process.env.PROCESSES) || Math.min(os.cpus().length, 8);
+const WRITE_RATIO = Number(process.env.WRITE_RATIO) || 0.05;
+const CACHE_NAME = `/privacy-decisions-bench-${process.pid}`;
+const POLICY_VERSION = "1.0";
+
+const requestKey = (i) => `user${i % KEYS}:${(i * 2654435761) >>> 0}`;
+
+/**
+ * Worker side: attach to the parent's segment and run OPS operations
+ */
+function runWorker() {
+  const { name, id } = JSON.parse(process.env.SHARED_CACHE_BENCH_WORKER);
+  sgxEvaluator.openSharedCache({ name });
+
+  let hits = 0;
+  const startTime = process.hrtime.bigint();
+  for (let n = 0; n < OPS; n++) {
+    const i = (n * 7919 + id * 104729) % KEYS;
+    const key = requestKey(i);
+    const cached = sgxEvaluator.sharedCacheGet(key, POLICY_VERSION);
+    if (cached) hits++;
+    if (!cached || n % Math.round(1 / WRITE_RATIO) === 0) {
+      sgxEvaluator.sharedCacheSet(key, POLICY_VERSION, i % 3 === 0 ? "deny" : "grant", 3600);
+    }
+  }
+  const elapsedNs = Number(process.hrtime.bigint() - startTime);
+  process.send({ id, hits, elapsedNs });
+  sgxEvaluator.closeSharedCache();
+}
+
+/**
+ * Single-process cost per operation
+ */
+function measureOperations() {
+  const keys = Array.from({ length: KEYS }, (_, i) => requestKey(i));
+  const timeLoop = (fn) => {
+    const startTime = process.hrtime.bigint();
+    for (let i = 0; i < KEYS; i++) fn(keys[i], i);
+    return Number(process.hrtime.bigint() - startTime) / KEYS;
+  };
+
+  sgxEvaluator.clearSharedCache();
+  const missNs = timeLoop((key) => sgxEvaluator.sharedCacheGet(key, POLICY_VERSION));
+  const insertNs = timeLoop((key, i) => sgxEvaluator.sharedCacheSet(key, POLICY_VERSION, i % 2 ? "grant" : "deny", 3600));
+  const hitNs = timeLoop((key) => sgxEvaluator.sharedCacheGet(key, POLICY_VERSION));
+  const staleNs = timeLoop((key) => sgxEvaluator.sharedCacheGet(key, "2.0"));
+  return { hitNs, missNs, insertNs, staleVersionNs: staleNs };
+}
+
+/**
+ * processes workers sharing one warm segment
+ */
+async function measureProcesses(processes) {
+  sgxEvaluator.clearSharedCache();
+  const before = sgxEvaluator.getSharedCacheStats();
+  const workerFile = fileURLToPath(import.meta.url);
+
+  const results = await Promise.all(
+    Array.from({ length: processes }, (_, id) => {
+      const worker = fork(workerFile, [], {
+        env: { ...process.env, SHARED_CACHE_BENCH_WORKER: JSON.stringify({ name: CACHE_NAME, id }) },
+      });
+      return new Promise((resolve, reject) => {
+        worker.once("message", resolve);
+        worker.once("error", reject);
+      });
+    })
+  );
+
+  const after = sgxEvaluator.getSharedCacheStats();
+  const slowestSec = Math.max(...results.map((r) => r.elapsedNs)) / 1e9;
+  const totalHits = results.reduce((sum, r) => sum + r.hits, 0);
+  return {
+    processes,
+    opsPerSec: (processes * OPS) / slowestSec,
+    nsPerOp: results.reduce((sum, r) => sum + r.elapsedNs, 0) / (processes * OPS),
+    hitRate: totalHits / (processes * OPS),
+    evictions: after.evictions - before.evictions,
+    contended: after.contended - before.contended,
+  };
+}
+
+function printResults(operations, runs) {
+  console.log("\n" + "=".repeat(80));
+  console.log("SHARED DECISION CACHE");
+  console.log("=".repeat(80));
+  console.log(`Hit:                 ${operations.hitNs.toFixed(0)} ns`);
+  console.log(`Miss:                ${operations.missNs.toFixed(0)} ns`);
+  console.log(`Miss (old version):  ${operations.staleVersionNs.toFixed(0)} ns`);
+  console.log(`Insert:              ${operations.insertNs.toFixed(0)} ns`);
+
+  console.log("-".repeat(80));
+  console.log(
+    "Processes".padEnd(12) +
+      "ops/s".padStart(14) +
+      "ns/op".padStart(10) +
+      "hit rate".padStart(12) +
+      "evictions".padStart(12) +
+      "contended".padStart(12)
+  );
+  runs.forEach((run) => {
+    console.log(
+      String(run.processes).padEnd(12) +
+        run.opsPerSec.toFixed(0).padStart(14) +
+        run.nsPerOp.toFixed(0).padStart(10) +
+        `${(run.hitRate * 100).toFixed(1)}%`.padStart(12) +
+        String(run.evictions).padStart(12) +
+        String(run.contended).padStart(12)
+    );
+  });
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Shared Decision Cache Benchmark");
+  console.log("=".repeat(80));
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "shared-decision-cache");
+
+  // Twice the working set keeps probe sequences short
+  const info = sgxEvaluator.openSharedCache({ name: CACHE_NAME, capacity: KEYS * 2 });
+  if (!info) {
+    throw new Error("Shared decision cache unavailable (build the addon first)");
+  }
+  console.log(`Segment: ${info.capacity} entries, ${(info.segmentBytes / 1048576).toFixed(1)} MB`);
+
+  try {
+    const operations = measureOperations();
+    const runs = [];
+    for (let processes = 1; processes <= PROCESSES; processes *= 2) {
+      console.log(`Running: ${processes} process(es)`);
+      runs.push(await measureProcesses(processes));
+    }
+
+    printResults(operations, runs);
+
+    collector.addCustomData("keys", KEYS);
+    collector.addCustomData("opsPerProcess", OPS);
+    collector.addCustomData("writeRatio", WRITE_RATIO);
+    collector.addCustomData("operations", operations);
+    collector.addCustomData("runs", runs);
+    collector.export("shared-decision-cache");
+  } finally {
+    sgxEvaluator.closeSharedCache({ remove: true });
+  }
+}
+
+if (process.env.SHARED_CACHE_BENCH_WORKER) {
+  runWorker();
+} else {
+  main().catch((error) => {
+    console.error("\n[ERROR] Benchmark failed:", error.message);
+    console.error(error.stack);
+    process.exit(1);
+  });
+}
@@ -0,0 +1,133 @@
+/**
+ * Short-Circuit Evaluation Benchmark
+ *
+ * Compares three ways of reaching a decision on a 255-attribute /
+ * 63-purpose policy, for growing preference sizes:
+ * 1. Every check, as the audit export runs them (evaluateReasons)
+ * 2. Retention, attributes, purposes in fixed order, stopping at the
+ *    first deny
+ * 3. evaluate(): retention first, then the tree check with the lower
+ *    expected cost per deny from its recorded deny rate
+ * and reports how often each stage settled evaluate()'s decisions, plus a
+ * check that all paths agree. The counters are the ones the enclave
+ * exposes through getEvaluationStages().
+ *
+ * Only the benchmark addon is needed (npm run build-addon), not SGX hardware
+ * or MongoDB.
+ *
+ * Usage:
+ *   npm run short-circuit-benchmark
+ *   PREFERENCE_SIZES=4,16,64 EVALUATIONS=500000 npm run short-circuit-benchmark
+ */
+
+import { createCollector } from "../metrics/collector.js";
+import { createRequire } from "module";
+import { fileURLToPath } from "url";
+import path from "path";
+import os from "os";
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+const require = createRequire(import.meta.url);
+
+// Benchmark configuration
+const EVALUATIONS = Number(process.env.EVALUATIONS) || 200000;
+const PREFERENCE_SIZES = (process.env.PREFERENCE_SIZES || "2,8,32").split(",").map(Number);
+
+const STAGES = ["retention", "attributes", "purposes"];
+
+function printResults(runs) {
+  console.log("\n" + "=".repeat(80));
+  console.log("SHORT-CIRCUIT EVALUATION");
+  console.log("=".repeat(80));
+  console.log(
+    "Allow IDs".padEnd(11) +
+      "full (ns)".padStart(12) +
+      "fixed (ns)".padStart(12) +
+      "ordered (ns)".padStart(14) +
+      "speedup".padStart(10) +
+      "mismatches".padStart(12)
+  );
+  for (const run of runs) {
+    console.log(
+      String(run.allowIds).padEnd(11) +
+        run.fullNs.toFixed(0).padStart(12) +
+        run.fixedNs.toFixed(0).padStart(12) +
+        run.orderedNs.toFixed(0).padStart(14) +
+        `${(run.fullNs / run.orderedNs).toFixed(2)}x`.padStart(10) +
+        String(run.mismatches).padStart(12)
+    );
+  }
+
+  console.log("\nDecisions settled per stage (share of evaluations)");
+  console.log(
+    "Allow IDs".padEnd(11) +
+      STAGES.map((stage) => stage.padStart(12)).join("") +
+      "granted".padStart(10) +
+      "purposes 1st".padStart(14)
+  );
+  for (const run of runs) {
+    const { stages } = run;
+    const share = (count) => `${((count / run.evaluations) * 100).toFixed(1)}%`;
+    console.log(
+      String(run.allowIds).padEnd(11) +
+        STAGES.map((stage) => share(stages[stage].denies).padStart(12)).join("") +
+        share(stages.grants).padStart(10) +
+        share(stages.purposesFirst).padStart(14)
+    );
+  }
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Short-Circuit Evaluation Benchmark");
+  console.log("=".repeat(80));
+
+  let addon;
+  try {
+    addon = require(path.join(__dirname, "../sgx/build/Release/bench-addon.node"));
+  } catch (error) {
+    console.error("\n[ERROR] Benchmark addon not available. Run: npm run build-addon");
+    process.exit(1);
+  }
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "short-circuit");
+
+  // Warm-up
+  await addon.benchmarkShortCircuit({ evaluations: 10000, allowIds: PREFERENCE_SIZES[0] });
+
+  const runs = [];
+  for (const allowIds of PREFERENCE_SIZES) {
+    console.log(`Running: ${allowIds} allowed attributes per preference, ${EVALUATIONS} evaluations per path`);
+    runs.push(await addon.benchmarkShortCircuit({ evaluations: EVALUATIONS, allowIds }));
+  }
+
+  printResults(runs);
+
+  collector.addCustomData("evaluations", EVALUATIONS);
+  collector.addCustomData("preferenceSizes", PREFERENCE_SIZES);
+  collector.addCustomData("results", runs);
+  collector.export("short-circuit");
+
+  const mismatches = runs.reduce((sum, run) => sum + run.mismatches, 0);
+  if (mismatches > 0) {
+    throw new Error(`Short-circuit evaluation disagrees with the full checks on ${mismatches} inputs`);
+  }
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
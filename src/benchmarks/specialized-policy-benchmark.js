@@ -0,0 +1,98 @@
+/**
+ * Specialized Policy Benchmark
+ *
+ * Compares the generic evaluate() core with the evaluator that
+ * tools/policy-compiler generates for one policy snapshot
+ * (sgx/core/SpecializedPolicy.h). Both run over the same random requests
+ * against that policy, and the benchmark exits non-zero if they disagree.
+ *
+ * The evaluators run outside the enclave, so only the benchmark addon is
+ * needed, not SGX hardware or MongoDB. The addon must be built with the
+ * generated header:
+ *
+ * Usage:
+ *   npm run build-addon
+ *   npm run policy-compiler -- --policy policy.json --output src/sgx/core/GeneratedPolicy.h
+ *   (cd src/sgx && SPECIALIZED_POLICY=1 ./build.sh)
+ *   npm run specialized-benchmark
+ *   EVALUATIONS=5000000 npm run specialized-benchmark
+ */
+
+import { createCollector } from "../metrics/collector.js";
+import { createRequire } from "module";
+import { fileURLToPath } from "url";
+import path from "path";
+import os from "os";
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+const require = createRequire(import.meta.url);
+
+// Benchmark configuration
+const EVALUATIONS = Number(process.env.EVALUATIONS) || 2000000;
+
+function printResults(run) {
+  console.log("\n" + "=".repeat(80));
+  console.log(`SPECIALIZED POLICY (version ${run.version || "-"}, ${run.attributes} attributes, ${run.purposes} purposes)`);
+  console.log("=".repeat(80));
+  console.log("Evaluator".padEnd(16) + "ns/eval".padStart(10) + "evals/sec".padStart(14) + "speedup".padStart(10));
+  const row = (name, ns) =>
+    console.log(
+      name.padEnd(16) +
+        ns.toFixed(1).padStart(10) +
+        Math.round(1e9 / ns).toLocaleString().padStart(14) +
+        `${(run.genericNs / ns).toFixed(2)}x`.padStart(10)
+    );
+  row("generic", run.genericNs);
+  row("specialized", run.specializedNs);
+  console.log(`${run.evaluations} evaluations per evaluator, ${run.mismatches} decision mismatches`);
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Specialized Policy Benchmark");
+  console.log("=".repeat(80));
+
+  let addon;
+  try {
+    addon = require(path.join(__dirname, "../sgx/build/Release/bench-addon.node"));
+  } catch (error) {
+    console.error("\n[ERROR] Benchmark addon not available. Run: npm run build-addon");
+    process.exit(1);
+  }
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "specialized-policy");
+
+  // Warm-up; also fails fast when the addon lacks the generated policy
+  await addon.benchmarkSpecializedPolicy({ evaluations: 100000 });
+
+  console.log(`Running: ${EVALUATIONS} evaluations per evaluator`);
+  const run = await addon.benchmarkSpecializedPolicy({ evaluations: EVALUATIONS });
+
+  printResults(run);
+
+  collector.addCustomData("evaluations", EVALUATIONS);
+  collector.addCustomData("results", run);
+  collector.export("specialized-policy");
+
+  if (run.mismatches > 0) {
+    throw new Error(`Specialized evaluator disagrees with evaluate() on ${run.mismatches} inputs`);
+  }
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
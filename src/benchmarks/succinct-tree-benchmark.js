@@ -0,0 +1,130 @@
+/**
+ * Succinct Tree Benchmark
+ *
+ * Compares SuccinctTree (sgx/bench/SuccinctTree.h), which stores a policy
+ * hierarchy as its balanced-parentheses string plus rank/select and min-max
+ * directories, with the left/right arrays of nested-set numbering, on
+ * complete binary trees of millions of nodes:
+ * 1. Bytes per node of each
+ * 2. ns per ancestor/descendant check on random pairs and on pairs where
+ *    one node lies a few levels under the other, and per close()
+ * 3. A check that both answer every query the same way
+ *
+ * Only the benchmark addon is needed (npm run build-addon), not SGX hardware
+ * or MongoDB.
+ *
+ * Usage:
+ *   npm run succinct-tree-benchmark
+ *   NODES=1000000,16000000 QUERIES=4194304 npm run succinct-tree-benchmark
+ */
+
+import { createCollector } from "../metrics/collector.js";
+import { createRequire } from "module";
+import { fileURLToPath } from "url";
+import path from "path";
+import os from "os";
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+const require = createRequire(import.meta.url);
+
+// Benchmark configuration
+const NODES = (process.env.NODES || "1000000,4000000").split(",").map(Number);
+const QUERIES = Number(process.env.QUERIES) || 1048576;
+const MIN_US = Number(process.env.MIN_US) || 200000;
+
+function printResults(result) {
+  console.log("\n" + "=".repeat(80));
+  console.log("SUCCINCT TREE vs INTERVAL ARRAYS");
+  console.log("=".repeat(80));
+  console.log(
+    "Nodes".padEnd(10) +
+      "interval".padStart(10) +
+      "MiB".padStart(8) +
+      "succinct".padStart(10) +
+      "MiB".padStart(8) +
+      "build (ms)".padStart(12)
+  );
+  for (const size of result.sizes) {
+    console.log(
+      String(size.nodes).padEnd(10) +
+        ((size.intervalBytes * 8) / size.nodes).toFixed(2).padStart(10) +
+        (size.intervalBytes / 1048576).toFixed(2).padStart(8) +
+        ((size.succinctBytes * 8) / size.nodes).toFixed(2).padStart(10) +
+        (size.succinctBytes / 1048576).toFixed(2).padStart(8) +
+        size.buildMs.toFixed(1).padStart(12)
+    );
+  }
+  console.log("Bits per node and MiB, intervals then the succinct tree.");
+  console.log(
+    "\n" +
+      "Nodes".padEnd(10) +
+      "random".padStart(10) +
+      "succinct".padStart(10) +
+      "ancestor".padStart(10) +
+      "succinct".padStart(10) +
+      "close".padStart(8) +
+      "mismatches".padStart(12)
+  );
+  for (const size of result.sizes) {
+    console.log(
+      String(size.nodes).padEnd(10) +
+        size.intervalRandomNs.toFixed(1).padStart(10) +
+        size.succinctRandomNs.toFixed(1).padStart(10) +
+        size.intervalAncestorNs.toFixed(1).padStart(10) +
+        size.succinctAncestorNs.toFixed(1).padStart(10) +
+        size.succinctCloseNs.toFixed(1).padStart(8) +
+        String(size.mismatches).padStart(12)
+    );
+  }
+  console.log(`ns per query over ${result.queries} queries; intervals first, then the succinct tree.`);
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Succinct Tree Benchmark");
+  console.log("=".repeat(80));
+
+  let addon;
+  try {
+    addon = require(path.join(__dirname, "../sgx/build/Release/bench-addon.node"));
+  } catch (error) {
+    console.error("\n[ERROR] Benchmark addon not available. Run: npm run build-addon");
+    process.exit(1);
+  }
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+  });
+  collector.addCustomData("benchmarkType", "succinct-tree");
+
+  console.log(`Running: ${NODES.join(", ")} nodes, ${QUERIES} queries each`);
+  const result = await addon.benchmarkSuccinctTree({ nodes: NODES, queries: QUERIES, minUs: MIN_US });
+
+  printResults(result);
+
+  collector.addCustomData("nodes", NODES);
+  collector.addCustomData("queries", QUERIES);
+  collector.addCustomData("minUs", MIN_US);
+  collector.addCustomData("results", result.sizes);
+  collector.export("succinct-tree");
+
+  const mismatches = result.sizes.reduce((sum, size) => sum + size.mismatches, 0);
+  if (mismatches > 0) {
+    throw new Error(`The succinct tree disagrees with the interval arrays on ${mismatches} queries`);
+  }
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
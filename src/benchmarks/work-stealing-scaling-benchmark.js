@@ -0,0 +1,136 @@
+/**
+ * Work-Stealing Pool Scaling Benchmark
+ *
+ * Runs a synthetic bulk job (10M evaluations of the native evaluate() core
+ * over a 63-attribute / 15-purpose nested-set policy) on the native
+ * work-stealing pool at 1 to 64 threads and reports throughput, speedup and
+ * parallel efficiency. Thread counts above the core count show the cost of
+ * oversubscription.
+ *
+ * The job runs outside the enclave, so only the benchmark addon is needed
+ * (npm run build-addon), not SGX hardware or MongoDB.
+ *
+ * Usage:
+ *   npx babel-watch src/benchmarks/work-stealing-scaling-benchmark.js
+ *   EVALUATIONS=1000000 PIN_CORES=true npm run scaling-benchmark
+ */
+
+import { createCollector } from "../metrics/collector.js";
+import { createRequire } from "module";
+import { fileURLToPath } from "url";
+import path from "path";
+import os from "os";
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+const require = createRequire(import.meta.url);
+
+// Benchmark configuration
+const EVALUATIONS = Number(process.env.EVALUATIONS) || 10000000;
+const GRAIN = Number(process.env.GRAIN) || 0;
+const PIN_CORES = process.env.PIN_CORES === "true";
+const THREAD_COUNTS = [1, 2, 4, 8, 16, 32, 64];
+const REPETITIONS = 3;
+
+/**
+ * Best of REPETITIONS runs at one thread count
+ */
+async function runAtThreads(addon, threads) {
+  let best = null;
+  for (let i = 0; i < REPETITIONS; i++) {
+    const run = await addon.benchmarkWorkStealing({
+      threads,
+      evaluations: EVALUATIONS,
+      grain: GRAIN,
+      pinCores: PIN_CORES,
+    });
+    if (!best || run.elapsedMs < best.elapsedMs) {
+      best = run;
+    }
+  }
+  return best;
+}
+
+/**
+ * Print throughput, speedup and efficiency per thread count
+ */
+function printResults(rows) {
+  console.log("\n" + "=".repeat(90));
+  console.log("WORK-STEALING POOL SCALING");
+  console.log("=".repeat(90));
+  console.log(
+    "Threads".padEnd(9) +
+      "Time (ms)".padStart(12) +
+      "Evals/s".padStart(14) +
+      "Speedup".padStart(10) +
+      "Effic. %".padStart(10) +
+      "Tasks".padStart(9) +
+      "Steals".padStart(9) +
+      "Sleeps".padStart(9)
+  );
+  rows.forEach((row) => {
+    console.log(
+      String(row.threads).padEnd(9) +
+        row.elapsedMs.toFixed(1).padStart(12) +
+        row.evaluationsPerSec.toFixed(0).padStart(14) +
+        row.speedup.toFixed(2).padStart(10) +
+        (row.efficiency * 100).toFixed(1).padStart(10) +
+        String(row.pool.tasks).padStart(9) +
+        String(row.pool.steals).padStart(9) +
+        String(row.pool.sleeps).padStart(9)
+    );
+  });
+}
+
+/**
+ * Main benchmark execution
+ */
+async function main() {
+  console.log("Work-Stealing Pool Scaling Benchmark");
+  console.log("=".repeat(80));
+
+  let addon;
+  try {
+    addon = require(path.join(__dirname, "../sgx/build/Release/bench-addon.node"));
+  } catch (error) {
+    console.error("\n[ERROR] Benchmark addon not available. Run: npm run build-addon");
+    process.exit(1);
+  }
+
+  const collector = createCollector();
+  const cpus = os.cpus();
+  collector.addSystemInfo({
+    platform: os.platform(),
+    arch: os.arch(),
+    cpuModel: cpus[0].model,
+    cpus: cpus.length,
+    nodeVersion: process.version,
+    pinCores: PIN_CORES,
+  });
+  collector.addCustomData("benchmarkType", "work-stealing-scaling");
+
+  // Warm-up: page in the code and the synthetic workload
+  await addon.benchmarkWorkStealing({ threads: 1, evaluations: Math.min(EVALUATIONS, 100000) });
+
+  const rows = [];
+  for (const threads of THREAD_COUNTS) {
+    console.log(`\n${threads} thread(s), ${EVALUATIONS} evaluations...`);
+    const run = await runAtThreads(addon, threads);
+    const baseline = rows.length > 0 ? rows[0].elapsedMs : run.elapsedMs;
+    const speedup = baseline / run.elapsedMs;
+    rows.push({ ...run, speedup, efficiency: speedup / threads });
+  }
+
+  printResults(rows);
+
+  collector.addCustomData("evaluations", EVALUATIONS);
+  collector.addCustomData("grain", GRAIN || "auto");
+  collector.addCustomData("scaling", rows);
+  collector.export("work-stealing-scaling");
+}
+
+main().catch((error) => {
+  console.error("\n[ERROR] Benchmark failed:", error.message);
+  console.error(error.stack);
+  process.exit(1);
+});
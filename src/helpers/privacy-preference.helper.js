@@ -29,6 +29,17 @@ const evaluate = async (
   return isAcceptedAttrs && isAcceptedPurposes && isTimeofRetention;
 };
 
+// policy node conditions under which node lies inside it: its own
+// [left, right], or one of the further intervals of a node with several parents
+const containedBy = (node) => [
+  { left: { $lte: node.left }, right: { $gte: node.right } },
+  {
+    intervals: {
+      $elemMatch: { left: { $lte: node.left }, right: { $gte: node.right } },
+    },
+  },
+];
+
 // evaluate timeofRetention between app and upp
 const evaluateTimeofRetention = (appTimeofRetention = 0, privacyPreference) => {
   return appTimeofRetention <= privacyPreference.timeofRetention;
@@ -120,8 +131,7 @@ const evaluateAttributeType = async (
         attributes: {
           $elemMatch: {
             _id: { $in: uppAttributes },
-            left: { $lte: appAttribute.left },
-            right: { $gte: appAttribute.right },
+            $or: containedBy(appAttribute),
           },
         },
       });
@@ -215,8 +225,7 @@ const evaluatePurposesType = async (
       purposes: {
         $elemMatch: {
           _id: { $in: uppAppPurposes },
-          left: { $lte: appPurpose.left },
-          right: { $gte: appPurpose.right },
+          $or: containedBy(appPurpose),
         },
       },
     });
@@ -7,6 +7,12 @@ var schema = new Schema(
     userId: Schema.Types.ObjectId,
     hash: String,
     result: String,
+    // Enclave's SHA-256 of the inputs behind the decision (sgx/index.js
+    // inputDigest); absent for decisions made outside the enclave
+    inputDigest: String,
+    // End of the user's retention window; MongoDB's TTL monitor deletes the
+    // document after it instead of letting expired entries accumulate
+    expiresAt: { type: Date, index: { expireAfterSeconds: 0 } },
   },
   {
     timestamps: true,
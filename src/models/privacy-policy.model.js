@@ -9,14 +9,25 @@ var schema = new Schema(
       default: () => Date.now().toString(),
       description: "Policy version for cache invalidation on policy updates",
     },
+    // A node with several parents also lists, in intervals, the merged
+    // ranges of the descendants it reaches outside [left, right]
+    // (src/sgx/tools/policy-labeler); tree nodes leave it empty
     attributes: [
       {
         name: String,
         left: Number,
         right: Number,
+        intervals: [{ _id: false, left: Number, right: Number }],
+      },
+    ],
+    purposes: [
+      {
+        name: String,
+        left: Number,
+        right: Number,
+        intervals: [{ _id: false, left: Number, right: Number }],
       },
     ],
-    purposes: [{ name: String, left: Number, right: Number }],
   },
   {
     timestamps: true,
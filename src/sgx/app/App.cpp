@@ -1,4 +1,12 @@
 #include "App.h"
+#include "Dispatcher.h"
+#include "Bulk.h"
+#include "DaemonClient.h"
+#include "SharedCache.h"
+#include "DecisionCache.h"
+#include "Snapshot.h"
+#include "SecureChannel.h"
+#include "PrivacyEvaluation_u.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -6,6 +14,9 @@
 sgx_enclave_id_t global_eid = 0;
 bool enclave_initialized = false;
 
+// Micro-batching dispatcher, started on the first evaluatePrivacyAsync call
+static BatchDispatcher* dispatcher = nullptr;
+
 #define ENCLAVE_FILE "enclave.signed.so"
 #define MAX_STRING_LEN 4096
 
@@ -24,6 +35,54 @@ std::string extractString(napi_env env, napi_value value) {
     return result;
 }
 
+// Read an optional numeric property; returns false if absent or not a number
+bool getOptionalNumber(napi_env env, napi_value obj, const char* key, double* out) {
+    bool has = false;
+    napi_has_named_property(env, obj, key, &has);
+    if (!has) return false;
+    napi_value value;
+    napi_get_named_property(env, obj, key, &value);
+    return napi_get_value_double(env, value, out) == napi_ok;
+}
+
+// Read an optional property of any type; returns false if absent
+bool getOptionalProperty(napi_env env, napi_value obj, const char* key, napi_value* out) {
+    bool has = false;
+    napi_has_named_property(env, obj, key, &has);
+    if (!has) return false;
+    return napi_get_named_property(env, obj, key, out) == napi_ok;
+}
+
+// Read an optional boolean property; leaves *out untouched if absent
+bool getOptionalBool(napi_env env, napi_value obj, const char* key, bool* out) {
+    bool has = false;
+    napi_has_named_property(env, obj, key, &has);
+    if (!has) return false;
+    napi_value value;
+    napi_get_named_property(env, obj, key, &value);
+    return napi_get_value_bool(env, value, out) == napi_ok;
+}
+
+// Read the per-lane dispatcher settings present on obj
+static void readLaneConfig(napi_env env, napi_value obj, LaneConfig* lane) {
+    double number;
+    if (getOptionalNumber(env, obj, "maxBatchSize", &number) && number >= 1) {
+        lane->maxBatchSize = (size_t)number;
+    }
+    if (getOptionalNumber(env, obj, "maxWaitUs", &number) && number >= 0) {
+        lane->maxWaitUs = (uint32_t)number;
+    }
+    if (getOptionalNumber(env, obj, "sloP99Us", &number) && number >= 1) {
+        lane->sloP99Us = (uint32_t)number;
+    }
+    if (getOptionalNumber(env, obj, "maxConcurrency", &number) && number >= 1) {
+        lane->maxConcurrency = (uint32_t)number;
+    }
+    if (getOptionalNumber(env, obj, "weight", &number) && number >= 1) {
+        lane->weight = (uint32_t)number;
+    }
+}
+
 // Create napi_value from string
 napi_value createString(napi_env env, const char* str) {
     napi_value result;
@@ -49,6 +108,9 @@ int initialize_enclave() {
 
 // Destroy the SGX enclave
 void destroy_enclave() {
+    if (dispatcher) {
+        dispatcher->stop();
+    }
     if (enclave_initialized) {
         sgx_destroy_enclave(global_eid);
         enclave_initialized = false;
@@ -136,6 +198,221 @@ napi_value EvaluatePrivacy(napi_env env, napi_callback_info info) {
     return obj;
 }
 
+// Queue req on the dispatcher and return its promise. options is the
+// optional { deadlineUs, priority } argument (may be null). Takes ownership
+// of req; returns nullptr with an exception pending on failure.
+static napi_value submitRequest(napi_env env, PendingRequest* req, napi_value options) {
+    if (!enclave_initialized) {
+        delete req;
+        napi_throw_error(env, nullptr, "Enclave not initialized");
+        return nullptr;
+    }
+
+    if (!dispatcher) {
+        dispatcher = new BatchDispatcher();
+    }
+    if (!dispatcher->running() && !dispatcher->start(env)) {
+        delete req;
+        napi_throw_error(env, nullptr, "Failed to start batch dispatcher");
+        return nullptr;
+    }
+
+    if (options) {
+        double deadlineUs;
+        if (getOptionalNumber(env, options, "deadlineUs", &deadlineUs) && deadlineUs > 0) {
+            req->deadline = DispatchClock::now() + std::chrono::microseconds((int64_t)deadlineUs);
+        }
+        napi_value priority;
+        if (getOptionalProperty(env, options, "priority", &priority) &&
+            !parsePriorityName(extractString(env, priority), &req->priority)) {
+            delete req;
+            napi_throw_error(env, nullptr, "priority must be \"realtime\" or \"bulk\"");
+            return nullptr;
+        }
+        getOptionalBool(env, options, "digest", &req->wantDigest);
+    }
+
+    napi_value promise;
+    napi_create_promise(env, &req->deferred, &promise);
+    dispatcher->submit(env, req);
+    return promise;
+}
+
+// EvaluatePrivacyAsync: Queue an evaluation for the next enclave batch
+// Optional 4th argument: { deadlineUs, priority, digest } - deadline relative
+// to the call, priority "realtime" (default) or "bulk", digest true to get the
+// enclave's SHA-256 of the evaluated inputs (enclave/EnclaveCache.h)
+// Returns a Promise resolving to { success, result, code, digest? }; code is
+// RESULT_OVERLOAD or RESULT_EXPIRED when the deadline cannot be met
+napi_value EvaluatePrivacyAsync(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    if (argc < 3) {
+        napi_throw_error(env, nullptr, "Expected 3 arguments: appJson, userJson, policyJson");
+        return nullptr;
+    }
+
+    PendingRequest* req = new PendingRequest();
+    req->appJson = extractString(env, args[0]);
+    req->userJson = extractString(env, args[1]);
+    req->policyJson = extractString(env, args[2]);
+    return submitRequest(env, req, argc >= 4 ? args[3] : nullptr);
+}
+
+// EvaluateEncryptedAsync: Queue an encrypted evaluation (enclave/Channel.h)
+// Arguments: sessionId, sealed request (Buffer: iv | tag | ciphertext of
+// "app\0user\0"), policyJson, optional { deadlineUs, priority, digest }
+// Resolves like EvaluatePrivacyAsync; code is RESULT_UNAUTHENTICATED when
+// the enclave cannot decrypt the request
+napi_value EvaluateEncryptedAsync(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    if (argc < 3) {
+        napi_throw_error(env, nullptr, "Expected 3 arguments: sessionId, sealed, policyJson");
+        return nullptr;
+    }
+
+    uint32_t sessionId = 0;
+    void* sealed = nullptr;
+    size_t sealedLen = 0;
+    bool isBuffer = false;
+    napi_is_buffer(env, args[1], &isBuffer);
+    if (napi_get_value_uint32(env, args[0], &sessionId) != napi_ok || !isBuffer) {
+        napi_throw_error(env, nullptr, "sessionId must be a number and sealed a Buffer");
+        return nullptr;
+    }
+    napi_get_buffer_info(env, args[1], &sealed, &sealedLen);
+
+    PendingRequest* req = new PendingRequest();
+    req->encrypted = true;
+    req->sessionId = sessionId;
+    req->sealedInput.assign(static_cast<const char*>(sealed), sealedLen);
+    req->policyJson = extractString(env, args[2]);
+    return submitRequest(env, req, argc >= 4 ? args[3] : nullptr);
+}
+
+// ConfigureDispatcher: Set { workers, strictPriority, adaptive,
+// defaultDeadlineUs, admissionControl, lanes: { realtime, bulk } } where each
+// lane takes { maxBatchSize, maxWaitUs, sloP99Us, maxConcurrency, weight }.
+// Top-level maxBatchSize / maxWaitUs / sloP99Us configure the realtime lane.
+// Omitted fields keep their value
+napi_value ConfigureDispatcher(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    if (!dispatcher) {
+        dispatcher = new BatchDispatcher();
+    }
+
+    DispatcherConfig config = dispatcher->config();
+    if (argc >= 1) {
+        double number;
+        readLaneConfig(env, args[0], &config.lanes[PRIORITY_REALTIME]);
+        if (getOptionalNumber(env, args[0], "defaultDeadlineUs", &number) && number >= 0) {
+            config.defaultDeadlineUs = (uint32_t)number;
+        }
+        if (getOptionalNumber(env, args[0], "workers", &number) && number >= 1) {
+            config.workers = (uint32_t)number;
+        }
+        getOptionalBool(env, args[0], "adaptive", &config.adaptive);
+        getOptionalBool(env, args[0], "admissionControl", &config.admissionControl);
+        getOptionalBool(env, args[0], "strictPriority", &config.strictPriority);
+
+        napi_value lanes;
+        if (getOptionalProperty(env, args[0], "lanes", &lanes)) {
+            for (int l = 0; l < PRIORITY_CLASSES; l++) {
+                napi_value lane;
+                if (getOptionalProperty(env, lanes, priorityName((PriorityClass)l), &lane)) {
+                    readLaneConfig(env, lane, &config.lanes[l]);
+                }
+            }
+        }
+    }
+    dispatcher->configure(config);
+
+    napi_value jsResult;
+    napi_get_undefined(env, &jsResult);
+    return jsResult;
+}
+
+// GetDispatcherStats: Per-lane batch-size, queueing-delay and latency histograms
+// Pass true to reset the counters after reading them
+napi_value GetDispatcherStats(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    napi_value obj;
+    napi_create_object(env, &obj);
+    if (!dispatcher) {
+        return obj;
+    }
+
+    dispatcher->fillStats(env, obj);
+
+    bool reset = false;
+    if (argc >= 1) {
+        napi_get_value_bool(env, args[0], &reset);
+    }
+    if (reset) {
+        dispatcher->resetStats();
+    }
+    return obj;
+}
+
+// GetEvaluationStages: How often each stage of the enclave's evaluate()
+// settled a decision. Pass true to reset the counters after reading them
+// Returns { retention, attributes, purposes: { runs, denies }, grants,
+// purposesFirst }
+napi_value GetEvaluationStages(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    if (!enclave_initialized) {
+        napi_throw_error(env, nullptr, "Enclave not initialized");
+        return nullptr;
+    }
+    bool reset = false;
+    if (argc >= 1) {
+        napi_get_value_bool(env, args[0], &reset);
+    }
+
+    uint64_t words[STAGE_COUNTER_WORDS];
+    int ret = RESULT_ERROR;
+    if (ecall_evaluation_stages(global_eid, &ret, words, STAGE_COUNTER_WORDS, reset ? 1 : 0) !=
+            SGX_SUCCESS || ret != 0) {
+        napi_throw_error(env, nullptr, "Failed to read evaluation stage counters");
+        return nullptr;
+    }
+    EvaluationStageCounts counts;
+    memcpy(&counts, words, sizeof(counts));
+
+    napi_value obj;
+    napi_create_object(env, &obj);
+    static const char* stageNames[STAGE_COUNT] = { "retention", "attributes", "purposes" };
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        napi_value stage, runs, denies;
+        napi_create_object(env, &stage);
+        napi_create_double(env, (double)counts.runs[s], &runs);
+        napi_create_double(env, (double)counts.denies[s], &denies);
+        napi_set_named_property(env, stage, "runs", runs);
+        napi_set_named_property(env, stage, "denies", denies);
+        napi_set_named_property(env, obj, stageNames[s], stage);
+    }
+    napi_value grants, purposesFirst;
+    napi_create_double(env, (double)counts.grants, &grants);
+    napi_create_double(env, (double)counts.purposesFirst, &purposesFirst);
+    napi_set_named_property(env, obj, "grants", grants);
+    napi_set_named_property(env, obj, "purposesFirst", purposesFirst);
+    return obj;
+}
+
 // ============================================================================
 // Module Initialization
 // ============================================================================
@@ -157,6 +434,148 @@ napi_value Init(napi_env env, napi_value exports) {
                         EvaluatePrivacy, nullptr, &evaluateFn);
     napi_set_named_property(env, exports, "evaluatePrivacy", evaluateFn);
 
+    napi_value evaluateAsyncFn;
+    napi_create_function(env, "evaluatePrivacyAsync", NAPI_AUTO_LENGTH,
+                        EvaluatePrivacyAsync, nullptr, &evaluateAsyncFn);
+    napi_set_named_property(env, exports, "evaluatePrivacyAsync", evaluateAsyncFn);
+
+    napi_value configureFn;
+    napi_create_function(env, "configureDispatcher", NAPI_AUTO_LENGTH,
+                        ConfigureDispatcher, nullptr, &configureFn);
+    napi_set_named_property(env, exports, "configureDispatcher", configureFn);
+
+    napi_value statsFn;
+    napi_create_function(env, "getDispatcherStats", NAPI_AUTO_LENGTH,
+                        GetDispatcherStats, nullptr, &statsFn);
+    napi_set_named_property(env, exports, "getDispatcherStats", statsFn);
+
+    napi_value bulkFn;
+    napi_create_function(env, "evaluateBulk", NAPI_AUTO_LENGTH,
+                        EvaluateBulk, nullptr, &bulkFn);
+    napi_set_named_property(env, exports, "evaluateBulk", bulkFn);
+
+    napi_value bulkPoolFn;
+    napi_create_function(env, "configureBulkPool", NAPI_AUTO_LENGTH,
+                        ConfigureBulkPool, nullptr, &bulkPoolFn);
+    napi_set_named_property(env, exports, "configureBulkPool", bulkPoolFn);
+
+    napi_value auditFn;
+    napi_create_function(env, "auditNdjson", NAPI_AUTO_LENGTH,
+                        AuditNdjson, nullptr, &auditFn);
+    napi_set_named_property(env, exports, "auditNdjson", auditFn);
+
+    napi_value scanFn;
+    napi_create_function(env, "scanDecisions", NAPI_AUTO_LENGTH,
+                        ScanDecisions, nullptr, &scanFn);
+    napi_set_named_property(env, exports, "scanDecisions", scanFn);
+
+    napi_value evaluationStagesFn;
+    napi_create_function(env, "getEvaluationStages", NAPI_AUTO_LENGTH,
+                        GetEvaluationStages, nullptr, &evaluationStagesFn);
+    napi_set_named_property(env, exports, "getEvaluationStages", evaluationStagesFn);
+
+    napi_value connectDaemonFn;
+    napi_create_function(env, "connectDaemon", NAPI_AUTO_LENGTH,
+                        ConnectDaemon, nullptr, &connectDaemonFn);
+    napi_set_named_property(env, exports, "connectDaemon", connectDaemonFn);
+
+    napi_value daemonEvaluateFn;
+    napi_create_function(env, "daemonEvaluate", NAPI_AUTO_LENGTH,
+                        DaemonEvaluate, nullptr, &daemonEvaluateFn);
+    napi_set_named_property(env, exports, "daemonEvaluate", daemonEvaluateFn);
+
+    napi_value daemonStatsFn;
+    napi_create_function(env, "getDaemonStats", NAPI_AUTO_LENGTH,
+                        GetDaemonStats, nullptr, &daemonStatsFn);
+    napi_set_named_property(env, exports, "getDaemonStats", daemonStatsFn);
+
+    napi_value disconnectDaemonFn;
+    napi_create_function(env, "disconnectDaemon", NAPI_AUTO_LENGTH,
+                        DisconnectDaemon, nullptr, &disconnectDaemonFn);
+    napi_set_named_property(env, exports, "disconnectDaemon", disconnectDaemonFn);
+
+    napi_value openCacheFn;
+    napi_create_function(env, "openSharedCache", NAPI_AUTO_LENGTH,
+                        OpenSharedCache, nullptr, &openCacheFn);
+    napi_set_named_property(env, exports, "openSharedCache", openCacheFn);
+
+    napi_value cacheGetFn;
+    napi_create_function(env, "sharedCacheGet", NAPI_AUTO_LENGTH,
+                        SharedCacheGet, nullptr, &cacheGetFn);
+    napi_set_named_property(env, exports, "sharedCacheGet", cacheGetFn);
+
+    napi_value cacheSetFn;
+    napi_create_function(env, "sharedCacheSet", NAPI_AUTO_LENGTH,
+                        SharedCacheSet, nullptr, &cacheSetFn);
+    napi_set_named_property(env, exports, "sharedCacheSet", cacheSetFn);
+
+    napi_value clearCacheFn;
+    napi_create_function(env, "clearSharedCache", NAPI_AUTO_LENGTH,
+                        ClearSharedCache, nullptr, &clearCacheFn);
+    napi_set_named_property(env, exports, "clearSharedCache", clearCacheFn);
+
+    napi_value cacheStatsFn;
+    napi_create_function(env, "getSharedCacheStats", NAPI_AUTO_LENGTH,
+                        GetSharedCacheStats, nullptr, &cacheStatsFn);
+    napi_set_named_property(env, exports, "getSharedCacheStats", cacheStatsFn);
+
+    napi_value closeCacheFn;
+    napi_create_function(env, "closeSharedCache", NAPI_AUTO_LENGTH,
+                        CloseSharedCache, nullptr, &closeCacheFn);
+    napi_set_named_property(env, exports, "closeSharedCache", closeCacheFn);
+
+    napi_value configureDecisionCacheFn;
+    napi_create_function(env, "configureDecisionCache", NAPI_AUTO_LENGTH,
+                        ConfigureDecisionCache, nullptr, &configureDecisionCacheFn);
+    napi_set_named_property(env, exports, "configureDecisionCache", configureDecisionCacheFn);
+
+    napi_value decisionGetFn;
+    napi_create_function(env, "decisionCacheGet", NAPI_AUTO_LENGTH,
+                        DecisionCacheGet, nullptr, &decisionGetFn);
+    napi_set_named_property(env, exports, "decisionCacheGet", decisionGetFn);
+
+    napi_value decisionSetFn;
+    napi_create_function(env, "decisionCacheSet", NAPI_AUTO_LENGTH,
+                        DecisionCacheSet, nullptr, &decisionSetFn);
+    napi_set_named_property(env, exports, "decisionCacheSet", decisionSetFn);
+
+    napi_value clearDecisionsFn;
+    napi_create_function(env, "clearDecisionCache", NAPI_AUTO_LENGTH,
+                        ClearDecisionCache, nullptr, &clearDecisionsFn);
+    napi_set_named_property(env, exports, "clearDecisionCache", clearDecisionsFn);
+
+    napi_value decisionStatsFn;
+    napi_create_function(env, "getDecisionCacheStats", NAPI_AUTO_LENGTH,
+                        GetDecisionCacheStats, nullptr, &decisionStatsFn);
+    napi_set_named_property(env, exports, "getDecisionCacheStats", decisionStatsFn);
+
+    // Sealed enclave snapshot (app/Snapshot.cpp)
+    napi_value saveSnapshotFn;
+    napi_create_function(env, "saveEnclaveSnapshot", NAPI_AUTO_LENGTH,
+                        SaveEnclaveSnapshot, nullptr, &saveSnapshotFn);
+    napi_set_named_property(env, exports, "saveEnclaveSnapshot", saveSnapshotFn);
+
+    napi_value loadSnapshotFn;
+    napi_create_function(env, "loadEnclaveSnapshot", NAPI_AUTO_LENGTH,
+                        LoadEnclaveSnapshot, nullptr, &loadSnapshotFn);
+    napi_set_named_property(env, exports, "loadEnclaveSnapshot", loadSnapshotFn);
+
+    // Encrypted request channel (app/SecureChannel.cpp)
+    napi_value openChannelFn;
+    napi_create_function(env, "openSecureChannel", NAPI_AUTO_LENGTH,
+                        OpenSecureChannel, nullptr, &openChannelFn);
+    napi_set_named_property(env, exports, "openSecureChannel", openChannelFn);
+
+    napi_value closeChannelFn;
+    napi_create_function(env, "closeSecureChannel", NAPI_AUTO_LENGTH,
+                        CloseSecureChannel, nullptr, &closeChannelFn);
+    napi_set_named_property(env, exports, "closeSecureChannel", closeChannelFn);
+
+    napi_value evaluateEncryptedFn;
+    napi_create_function(env, "evaluateEncryptedAsync", NAPI_AUTO_LENGTH,
+                        EvaluateEncryptedAsync, nullptr, &evaluateEncryptedFn);
+    napi_set_named_property(env, exports, "evaluateEncryptedAsync", evaluateEncryptedFn);
+
     return exports;
 }
 
@@ -2,6 +2,7 @@
 #define APP_H
 
 #include <node_api.h>
+#include <string>
 #include "sgx_urts.h"
 #include "../enclave/Enclave.h"
 
@@ -9,11 +10,26 @@
 extern sgx_enclave_id_t global_eid;
 extern bool enclave_initialized;
 
+// Node.js helpers shared by the addon modules
+std::string extractString(napi_env env, napi_value value);
+bool getOptionalNumber(napi_env env, napi_value obj, const char* key, double* out);
+bool getOptionalProperty(napi_env env, napi_value obj, const char* key, napi_value* out);
+bool getOptionalBool(napi_env env, napi_value obj, const char* key, bool* out);
+
 // Node.js addon functions
 napi_value InitializeEnclave(napi_env env, napi_callback_info info);
 napi_value EvaluatePrivacy(napi_env env, napi_callback_info info);
 napi_value DestroyEnclave(napi_env env, napi_callback_info info);
 
+// Batched evaluation through the adaptive dispatcher (app/Dispatcher.cpp)
+napi_value EvaluatePrivacyAsync(napi_env env, napi_callback_info info);
+napi_value EvaluateEncryptedAsync(napi_env env, napi_callback_info info);
+napi_value ConfigureDispatcher(napi_env env, napi_callback_info info);
+napi_value GetDispatcherStats(napi_env env, napi_callback_info info);
+
+// Stage counters of the enclave's evaluate() (enclave/Enclave.h)
+napi_value GetEvaluationStages(napi_env env, napi_callback_info info);
+
 // Module registration
 napi_value Init(napi_env env, napi_value exports);
 
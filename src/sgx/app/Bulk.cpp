@@ -0,0 +1,459 @@
+#include "Bulk.h"
+#include "App.h"
+#include "../core/DecisionColumns.h"
+#include "../core/NdjsonAudit.h"
+#include "PrivacyEvaluation_u.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Enclave.config.xml TCSNum minus the TCS reserved for the dispatcher
+// workers and the synchronous evaluatePrivacy (MAX_DISPATCH_WORKERS + 1)
+#define MAX_BULK_ECALLS 14
+// Records packed into one bulk ECALL unless the caller picks a chunk size
+#define DEFAULT_BULK_CHUNK 512
+
+typedef std::chrono::steady_clock BulkClock;
+
+static WorkStealingPool* sharedPool = nullptr;
+static std::atomic<int> activeJobs(0);
+
+static uint64_t elapsedUs(BulkClock::time_point from) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        BulkClock::now() - from).count();
+}
+
+// Called on the JS thread only
+WorkStealingPool& bulkPool() {
+    if (!sharedPool) {
+        sharedPool = new WorkStealingPool();
+    }
+    return *sharedPool;
+}
+
+// ============================================================================
+// Enclave Thread Budget
+// ============================================================================
+
+// Counting semaphore over the TCS left to bulk jobs. A pool wider than
+// MAX_BULK_ECALLS still splits and packs in parallel; only the ECALLs queue.
+class EcallSlots {
+public:
+    void acquire() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return inUse_ < MAX_BULK_ECALLS; });
+        inUse_++;
+    }
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            inUse_--;
+        }
+        cv_.notify_one();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    int inUse_ = 0;
+};
+
+static EcallSlots ecallSlots;
+
+// ============================================================================
+// evaluateBulk
+// ============================================================================
+
+struct BulkJob {
+    std::vector<std::string> appJsons;    // one entry: shared by every record
+    std::vector<std::string> userJsons;
+    std::string policyJson;
+    size_t chunk = DEFAULT_BULK_CHUNK;
+    WorkStealingPool* pool = nullptr;
+
+    std::vector<int> codes;
+    std::atomic<uint64_t> ecalls{0};
+    std::atomic<uint64_t> ecallFailures{0};
+    uint64_t elapsedUs = 0;
+
+    napi_deferred deferred = nullptr;
+    napi_async_work work = nullptr;
+};
+
+// Pack records [begin, end) and evaluate them in one enclave transition
+static void evaluateChunk(BulkJob* job, size_t begin, size_t end) {
+    size_t count = end - begin;
+    bool sharedApp = job->appJsons.size() == 1;
+
+    std::string packed;
+    for (size_t i = begin; i < end; i++) {
+        packed.append(job->appJsons[sharedApp ? 0 : i]).push_back('\0');
+        packed.append(job->userJsons[i]).push_back('\0');
+        packed.append(job->policyJson).push_back('\0');
+    }
+
+    int evaluated = RESULT_ERROR;
+    sgx_status_t status = SGX_ERROR_UNEXPECTED;
+    if (enclave_initialized) {
+        ecallSlots.acquire();
+        status = ecall_evaluate_privacy_batch(global_eid, &evaluated,
+                                              packed.data(), packed.size(),
+                                              count, &job->codes[begin], nullptr, 0);
+        ecallSlots.release();
+    }
+    job->ecalls.fetch_add(1, std::memory_order_relaxed);
+    if (status != SGX_SUCCESS || evaluated < 0) {
+        job->ecallFailures.fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = begin; i < end; i++) job->codes[i] = RESULT_ERROR;
+    }
+}
+
+static void executeBulk(napi_env env, void* data) {
+    BulkJob* job = static_cast<BulkJob*>(data);
+    BulkClock::time_point start = BulkClock::now();
+    job->pool->parallelFor(0, job->codes.size(), job->chunk, [job](size_t begin, size_t end) {
+        evaluateChunk(job, begin, end);
+    });
+    job->elapsedUs = elapsedUs(start);
+}
+
+static void completeBulk(napi_env env, napi_status status, void* data) {
+    BulkJob* job = static_cast<BulkJob*>(data);
+    activeJobs.fetch_sub(1);
+
+    size_t count = job->codes.size();
+    void* bytes = nullptr;
+    napi_value buffer, codes;
+    napi_create_arraybuffer(env, count * sizeof(int32_t), &bytes, &buffer);
+    if (count > 0) memcpy(bytes, job->codes.data(), count * sizeof(int32_t));
+    napi_create_typedarray(env, napi_int32_array, count, buffer, 0, &codes);
+
+    napi_value obj, value;
+    napi_create_object(env, &obj);
+    napi_set_named_property(env, obj, "codes", codes);
+    napi_create_double(env, job->elapsedUs / 1000.0, &value);
+    napi_set_named_property(env, obj, "elapsedMs", value);
+    napi_create_double(env, (double)job->ecalls.load(), &value);
+    napi_set_named_property(env, obj, "ecalls", value);
+    napi_create_double(env, (double)job->ecallFailures.load(), &value);
+    napi_set_named_property(env, obj, "ecallFailures", value);
+
+    napi_resolve_deferred(env, job->deferred, obj);
+    napi_delete_async_work(env, job->work);
+    delete job;
+}
+
+// Reads a JS array of strings, or a single string when allowString is set
+static bool readStringList(napi_env env, napi_value value, bool allowString,
+                           std::vector<std::string>* out) {
+    napi_valuetype type;
+    napi_typeof(env, value, &type);
+    if (allowString && type == napi_string) {
+        out->push_back(extractString(env, value));
+        return true;
+    }
+
+    bool isArray = false;
+    napi_is_array(env, value, &isArray);
+    if (!isArray) return false;
+
+    uint32_t length = 0;
+    napi_get_array_length(env, value, &length);
+    out->reserve(length);
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value item;
+        napi_get_element(env, value, i, &item);
+        out->push_back(extractString(env, item));
+    }
+    return true;
+}
+
+// EvaluateBulk: Evaluate many records on the work-stealing pool
+// Arguments: appJson (string shared by all records, or array), userJsons
+// (array), policyJson, optional { chunk } records per ECALL
+// Returns a Promise resolving to { codes: Int32Array, elapsedMs, ecalls,
+// ecallFailures } with one EvaluationResult per user
+napi_value EvaluateBulk(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    if (argc < 3) {
+        napi_throw_error(env, nullptr, "Expected 3 arguments: appJson(s), userJsons, policyJson");
+        return nullptr;
+    }
+
+    if (!enclave_initialized) {
+        napi_throw_error(env, nullptr, "Enclave not initialized");
+        return nullptr;
+    }
+
+    BulkJob* job = new BulkJob();
+    if (!readStringList(env, args[0], true, &job->appJsons) ||
+        !readStringList(env, args[1], false, &job->userJsons)) {
+        delete job;
+        napi_throw_error(env, nullptr, "appJson must be a string or array, userJsons an array");
+        return nullptr;
+    }
+    if (job->appJsons.size() != 1 && job->appJsons.size() != job->userJsons.size()) {
+        delete job;
+        napi_throw_error(env, nullptr, "appJsons and userJsons must have the same length");
+        return nullptr;
+    }
+    job->policyJson = extractString(env, args[2]);
+
+    double number;
+    if (argc >= 4 && getOptionalNumber(env, args[3], "chunk", &number) && number >= 1) {
+        job->chunk = (size_t)number;
+    }
+    job->codes.assign(job->userJsons.size(), RESULT_ERROR);
+    job->pool = &bulkPool();
+
+    napi_value promise, name;
+    napi_create_promise(env, &job->deferred, &promise);
+    napi_create_string_utf8(env, "evaluateBulk", NAPI_AUTO_LENGTH, &name);
+    napi_create_async_work(env, nullptr, name, executeBulk, completeBulk, job, &job->work);
+    activeJobs.fetch_add(1);
+    napi_queue_async_work(env, job->work);
+    return promise;
+}
+
+// ConfigureBulkPool: Replace the shared pool with { threads, pinCores }
+// threads counts the calling thread; omitted threads keeps the current width.
+// Throws while a bulk job is running
+napi_value ConfigureBulkPool(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    if (activeJobs.load() > 0) {
+        napi_throw_error(env, nullptr, "Bulk pool is busy");
+        return nullptr;
+    }
+
+    int workers = sharedPool ? (int)sharedPool->concurrency() - 1 : -1;
+    bool pinCores = sharedPool ? sharedPool->pinned() : false;
+    if (argc >= 1) {
+        double number;
+        if (getOptionalNumber(env, args[0], "threads", &number) && number >= 1) {
+            workers = (int)number - 1;
+        }
+        getOptionalBool(env, args[0], "pinCores", &pinCores);
+    }
+
+    delete sharedPool;
+    sharedPool = new WorkStealingPool(workers, pinCores);
+
+    napi_value obj, value;
+    napi_create_object(env, &obj);
+    napi_create_uint32(env, sharedPool->concurrency(), &value);
+    napi_set_named_property(env, obj, "threads", value);
+    napi_get_boolean(env, sharedPool->pinned(), &value);
+    napi_set_named_property(env, obj, "pinCores", value);
+    return obj;
+}
+
+// ============================================================================
+// auditNdjson
+// ============================================================================
+
+struct AuditJob {
+    NdjsonAuditConfig config;
+    WorkStealingPool* pool = nullptr;
+    NdjsonAuditStats stats;
+    std::string error;
+    bool ok = false;
+
+    napi_deferred deferred = nullptr;
+    napi_async_work work = nullptr;
+};
+
+static void executeAudit(napi_env env, void* data) {
+    AuditJob* job = static_cast<AuditJob*>(data);
+    job->ok = runNdjsonAudit(job->config, *job->pool, &job->stats, &job->error);
+}
+
+static void setNumber(napi_env env, napi_value obj, const char* key, double value) {
+    napi_value v;
+    napi_create_double(env, value, &v);
+    napi_set_named_property(env, obj, key, v);
+}
+
+static void completeAudit(napi_env env, napi_status status, void* data) {
+    AuditJob* job = static_cast<AuditJob*>(data);
+    activeJobs.fetch_sub(1);
+
+    if (!job->ok) {
+        napi_value message, error;
+        napi_create_string_utf8(env, job->error.c_str(), NAPI_AUTO_LENGTH, &message);
+        napi_create_error(env, nullptr, message, &error);
+        napi_reject_deferred(env, job->deferred, error);
+    } else {
+        const NdjsonAuditStats& stats = job->stats;
+        napi_value obj, mapped;
+        napi_create_object(env, &obj);
+        setNumber(env, obj, "records", (double)stats.records);
+        setNumber(env, obj, "grants", (double)stats.grants);
+        setNumber(env, obj, "denies", (double)stats.denies);
+        setNumber(env, obj, "errors", (double)stats.errors);
+        setNumber(env, obj, "inputBytes", (double)stats.inputBytes);
+        setNumber(env, obj, "outputBytes", (double)stats.outputBytes);
+        setNumber(env, obj, "columnarBytes", (double)stats.columnarBytes);
+        setNumber(env, obj, "batches", (double)stats.batches);
+        napi_get_boolean(env, stats.mapped, &mapped);
+        napi_set_named_property(env, obj, "mapped", mapped);
+        setNumber(env, obj, "elapsedMs", stats.elapsedMs);
+        setNumber(env, obj, "evaluateMs", stats.evaluateMs);
+        setNumber(env, obj, "readStallMs", stats.readStallMs);
+        setNumber(env, obj, "writeStallMs", stats.writeStallMs);
+        setNumber(env, obj, "recordsPerSec", stats.recordsPerSec);
+        setNumber(env, obj, "peakRssKb", (double)stats.peakRssKb);
+        napi_resolve_deferred(env, job->deferred, obj);
+    }
+
+    napi_delete_async_work(env, job->work);
+    delete job;
+}
+
+// AuditNdjson: Stream an NDJSON record file through the audit pipeline on
+// the shared pool. Argument: { policy, input, output, columnar, batchMb,
+// chunkKb } (paths; input/output "-" are not allowed here, columnar is
+// optional). Returns a Promise resolving to the pipeline stats. Runs
+// outside the enclave
+napi_value AuditNdjson(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    napi_value policy, input, output;
+    if (argc < 1 ||
+        !getOptionalProperty(env, args[0], "policy", &policy) ||
+        !getOptionalProperty(env, args[0], "input", &input) ||
+        !getOptionalProperty(env, args[0], "output", &output)) {
+        napi_throw_error(env, nullptr, "Expected { policy, input, output } file paths");
+        return nullptr;
+    }
+
+    AuditJob* job = new AuditJob();
+    job->config.policyPath = extractString(env, policy);
+    job->config.inputPath = extractString(env, input);
+    job->config.outputPath = extractString(env, output);
+    if (job->config.inputPath == "-" || job->config.outputPath == "-") {
+        delete job;
+        napi_throw_error(env, nullptr, "input and output must be file paths");
+        return nullptr;
+    }
+
+    napi_value columnar;
+    if (getOptionalProperty(env, args[0], "columnar", &columnar)) {
+        job->config.columnarPath = extractString(env, columnar);
+    }
+
+    double number;
+    if (getOptionalNumber(env, args[0], "batchMb", &number) && number >= 1) {
+        job->config.batchBytes = (size_t)number << 20;
+    }
+    if (getOptionalNumber(env, args[0], "chunkKb", &number) && number >= 1) {
+        job->config.chunkBytes = (size_t)number << 10;
+    }
+    job->pool = &bulkPool();
+
+    napi_value promise, name;
+    napi_create_promise(env, &job->deferred, &promise);
+    napi_create_string_utf8(env, "auditNdjson", NAPI_AUTO_LENGTH, &name);
+    napi_create_async_work(env, nullptr, name, executeAudit, completeAudit, job, &job->work);
+    activeJobs.fetch_add(1);
+    napi_queue_async_work(env, job->work);
+    return promise;
+}
+
+// ScanDecisions: Count the rows of a decision export where column is set,
+// for comparing formats. Argument: { path, format: "columnar" | "jsonl",
+// column }. JSON Lines only supports column "decision" (counts grants).
+// Returns { rows, matches, openMs, scanMs }
+napi_value ScanDecisions(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    napi_value pathValue, formatValue, columnValue;
+    if (argc < 1 ||
+        !getOptionalProperty(env, args[0], "path", &pathValue) ||
+        !getOptionalProperty(env, args[0], "format", &formatValue)) {
+        napi_throw_error(env, nullptr, "Expected { path, format, column }");
+        return nullptr;
+    }
+    std::string path = extractString(env, pathValue);
+    std::string format = extractString(env, formatValue);
+    std::string column = getOptionalProperty(env, args[0], "column", &columnValue)
+        ? extractString(env, columnValue) : "decision";
+
+    uint64_t rows = 0, matches = 0;
+    double openMs = 0, scanMs = 0;
+    std::string error;
+    BulkClock::time_point start = BulkClock::now();
+
+    if (format == "columnar") {
+        DecisionColumnReader reader;
+        if (!reader.open(path, &error)) {
+            napi_throw_error(env, nullptr, error.c_str());
+            return nullptr;
+        }
+        openMs = elapsedUs(start) / 1000.0;
+        start = BulkClock::now();
+        if (!reader.countSet(column.c_str(), &matches)) {
+            napi_throw_error(env, nullptr, "Unknown or non-boolean column");
+            return nullptr;
+        }
+        scanMs = elapsedUs(start) / 1000.0;
+        rows = reader.rows();
+    } else if (format == "jsonl" && column == "decision") {
+        // Best case for JSON Lines: a substring search per line, no parsing
+        int fd = open(path.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            if (fd >= 0) close(fd);
+            napi_throw_error(env, nullptr, "Cannot open decision file");
+            return nullptr;
+        }
+        size_t size = (size_t)st.st_size;
+        void* p = size ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+        close(fd);
+        if (p == MAP_FAILED) {
+            napi_throw_error(env, nullptr, "Cannot map decision file");
+            return nullptr;
+        }
+        openMs = elapsedUs(start) / 1000.0;
+        start = BulkClock::now();
+        static const char needle[] = "\"decision\":\"grant\"";
+        const char* pos = (const char*)p;
+        const char* end = pos + size;
+        while (pos < end) {
+            const char* newline = (const char*)memchr(pos, '\n', (size_t)(end - pos));
+            const char* lineEnd = newline ? newline : end;
+            if (memmem(pos, (size_t)(lineEnd - pos), needle, sizeof(needle) - 1)) matches++;
+            rows++;
+            pos = lineEnd + 1;
+        }
+        scanMs = elapsedUs(start) / 1000.0;
+        if (p) munmap(p, size);
+    } else {
+        napi_throw_error(env, nullptr, "format must be \"columnar\" or \"jsonl\" (column \"decision\")");
+        return nullptr;
+    }
+
+    napi_value obj;
+    napi_create_object(env, &obj);
+    setNumber(env, obj, "rows", (double)rows);
+    setNumber(env, obj, "matches", (double)matches);
+    setNumber(env, obj, "openMs", openMs);
+    setNumber(env, obj, "scanMs", scanMs);
+    return obj;
+}
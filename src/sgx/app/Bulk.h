@@ -0,0 +1,27 @@
+#ifndef BULK_H
+#define BULK_H
+
+#include <node_api.h>
+#include "../core/ThreadPool.h"
+
+// ============================================================================
+// Bulk Evaluation
+// ============================================================================
+//
+// Large offline jobs (re-evaluating every user after a policy change,
+// building decision matrices, audits) bypass the latency-oriented dispatcher
+// and run on a shared work-stealing pool. The record range is split into
+// chunks; each chunk is packed into one ecall_evaluate_privacy_batch call,
+// so a job keeps up to MAX_BULK_ECALLS enclave threads busy. NDJSON audit
+// files (core/NdjsonAudit.h) stream through the same pool.
+
+// Pool shared by every bulk API; created on first use
+WorkStealingPool& bulkPool();
+
+// Node.js addon functions
+napi_value EvaluateBulk(napi_env env, napi_callback_info info);
+napi_value ConfigureBulkPool(napi_env env, napi_callback_info info);
+napi_value AuditNdjson(napi_env env, napi_callback_info info);
+napi_value ScanDecisions(napi_env env, napi_callback_info info);
+
+#endif // BULK_H
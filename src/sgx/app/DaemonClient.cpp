@@ -0,0 +1,442 @@
+#include "DaemonClient.h"
+#include "App.h"
+#include "../core/EvalProtocol.h"
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Records per request frame; later calls go into the next frame
+#define MAX_FRAME_RECORDS 1024
+
+struct DaemonCall {
+    napi_deferred deferred = nullptr;
+    uint16_t opcode = EVAL_OP_EVALUATE;
+    std::string appJson;
+    std::string userJson;
+    std::string policyJson;
+};
+
+// Response to one request frame, settled on the JS thread
+struct DaemonReply {
+    std::vector<napi_deferred> deferreds;
+    uint16_t opcode = EVAL_OP_EVALUATE;
+    uint16_t status = EVAL_STATUS_OK;
+    std::string payload;
+    std::string error;    // transport failure: rejects every deferred
+};
+
+class DaemonClient {
+public:
+    bool connect(napi_env env, const std::string& path, std::string* error);
+    // Takes ownership of call
+    void submit(napi_env env, DaemonCall* call);
+    // JS thread; the client deletes itself once pending replies are settled
+    void disconnect();
+
+private:
+    void writerLoop();
+    void readerLoop();
+    void failAll(const std::string& error);
+    void deliver(DaemonReply* reply);
+    static void settleOnJsThread(napi_env env, napi_value jsCallback, void* context, void* data);
+    static void finalize(napi_env env, void* data, void* hint);
+
+    int fd_ = -1;
+    napi_threadsafe_function completion_ = nullptr;
+    std::thread writer_;
+    std::thread reader_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<DaemonCall*> queue_;
+    std::unordered_map<uint32_t, DaemonReply*> inflight_;    // by requestId
+    uint32_t nextRequestId_ = 1;
+    bool closing_ = false;
+    bool broken_ = false;
+    std::string brokenError_;
+
+    size_t outstanding_ = 0;    // JS thread only: unsettled promises
+};
+
+static DaemonClient* daemonClient = nullptr;
+
+// ============================================================================
+// Connection
+// ============================================================================
+
+bool DaemonClient::connect(napi_env env, const std::string& path, std::string* error) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        *error = "Invalid daemon socket path";
+        return false;
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+
+    fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0 || ::connect(fd_, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        *error = "Cannot connect to " + path + ": " + strerror(errno);
+        if (fd_ >= 0) close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    napi_value name;
+    napi_create_string_utf8(env, "sgxDaemonCompletion", NAPI_AUTO_LENGTH, &name);
+    napi_status status = napi_create_threadsafe_function(
+        env, nullptr, nullptr, name,
+        0,        // unbounded queue: the reader never blocks on JS
+        1,        // released once, by disconnect()
+        nullptr, finalize,
+        this, settleOnJsThread, &completion_);
+    if (status != napi_ok) {
+        *error = "Failed to create completion callback";
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    // Only keep the event loop alive while promises are outstanding
+    napi_unref_threadsafe_function(env, completion_);
+
+    writer_ = std::thread(&DaemonClient::writerLoop, this);
+    reader_ = std::thread(&DaemonClient::readerLoop, this);
+    return true;
+}
+
+void DaemonClient::disconnect() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closing_ = true;
+    }
+    wake_.notify_all();
+    shutdown(fd_, SHUT_RDWR);
+    writer_.join();
+    reader_.join();
+    close(fd_);
+    fd_ = -1;
+
+    // Calls that never made it onto the wire
+    failAll("Daemon client disconnected");
+    napi_release_threadsafe_function(completion_, napi_tsfn_release);
+}
+
+void DaemonClient::finalize(napi_env env, void* data, void* hint) {
+    (void)env;
+    (void)hint;
+    delete static_cast<DaemonClient*>(data);
+}
+
+// ============================================================================
+// Requests (JS thread) and writer
+// ============================================================================
+
+void DaemonClient::submit(napi_env env, DaemonCall* call) {
+    if (outstanding_++ == 0) {
+        napi_ref_threadsafe_function(env, completion_);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (broken_ || closing_) {
+        DaemonReply* reply = new DaemonReply();
+        reply->deferreds.push_back(call->deferred);
+        reply->opcode = call->opcode;
+        reply->error = broken_ ? brokenError_ : "Daemon client disconnected";
+        lock.unlock();
+        delete call;
+        deliver(reply);
+        return;
+    }
+    queue_.push_back(call);
+    lock.unlock();
+    wake_.notify_one();
+}
+
+void DaemonClient::writerLoop() {
+    std::string frame;
+    std::vector<DaemonCall*> calls;
+
+    for (;;) {
+        uint32_t requestId;
+        uint16_t opcode;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return closing_ || broken_ || !queue_.empty(); });
+            if (closing_ || broken_) return;
+
+            // Everything queued since the last write becomes one frame
+            calls.clear();
+            opcode = queue_.front()->opcode;
+            do {
+                calls.push_back(queue_.front());
+                queue_.pop_front();
+            } while (opcode == EVAL_OP_EVALUATE && !queue_.empty() &&
+                     queue_.front()->opcode == EVAL_OP_EVALUATE &&
+                     calls.size() < MAX_FRAME_RECORDS);
+
+            // Registered before sending: the response may beat send() back
+            requestId = nextRequestId_++;
+            DaemonReply* reply = new DaemonReply();
+            reply->opcode = opcode;
+            for (DaemonCall* call : calls) reply->deferreds.push_back(call->deferred);
+            inflight_[requestId] = reply;
+        }
+
+        frame.clear();
+        size_t offset = beginEvalFrame(&frame, requestId, opcode, EVAL_STATUS_OK,
+                                       opcode == EVAL_OP_EVALUATE ? (uint32_t)calls.size() : 0);
+        const std::string* previousPolicy = nullptr;
+        for (DaemonCall* call : calls) {
+            if (opcode == EVAL_OP_EVALUATE) {
+                bool samePolicy = previousPolicy && *previousPolicy == call->policyJson;
+                appendEvalRecord(&frame, call->appJson, call->userJson,
+                                 samePolicy ? nullptr : &call->policyJson);
+                previousPolicy = &call->policyJson;
+            }
+        }
+        finishEvalFrame(&frame, offset);
+        for (DaemonCall* call : calls) delete call;
+
+        if (!writeFully(fd_, frame.data(), frame.size())) {
+            failAll(std::string("Cannot write to daemon: ") + strerror(errno));
+            return;
+        }
+    }
+}
+
+// ============================================================================
+// Responses
+// ============================================================================
+
+void DaemonClient::readerLoop() {
+    EvalFrameReader reader;
+    std::string error;
+
+    for (;;) {
+        ssize_t n = reader.fill(fd_);
+        if (n <= 0) {
+            error = n == 0 ? "Daemon closed the connection"
+                           : std::string("Cannot read from daemon: ") + strerror(errno);
+            break;
+        }
+
+        bool corrupt = false;
+        for (;;) {
+            bool complete = false;
+            EvalFrameHeader header;
+            const char* payload = nullptr;
+            if (!reader.next(&complete, &header, &payload, &error)) {
+                corrupt = true;
+                break;
+            }
+            if (!complete) break;
+
+            DaemonReply* reply = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = inflight_.find(header.requestId);
+                if (it != inflight_.end()) {
+                    reply = it->second;
+                    inflight_.erase(it);
+                }
+            }
+            if (!reply) {
+                error = "Daemon rejected the stream: " + std::string(payload, header.length);
+                corrupt = true;
+                break;
+            }
+
+            reply->status = header.status;
+            reply->payload.assign(payload, header.length);
+            if (header.status == EVAL_STATUS_BAD_REQUEST) {
+                reply->error = "Daemon rejected the request: " + reply->payload;
+            } else if (reply->opcode == EVAL_OP_EVALUATE &&
+                       reply->payload.size() != reply->deferreds.size()) {
+                reply->error = "Malformed daemon response";
+            }
+            deliver(reply);
+        }
+        if (corrupt) break;
+    }
+
+    failAll(error);
+}
+
+// Settles every pending call with error; the connection is unusable afterwards
+void DaemonClient::failAll(const std::string& error) {
+    std::vector<DaemonReply*> failed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!broken_) {
+            broken_ = true;
+            brokenError_ = error;
+        }
+        for (auto& entry : inflight_) failed.push_back(entry.second);
+        inflight_.clear();
+        for (DaemonCall* call : queue_) {
+            DaemonReply* reply = new DaemonReply();
+            reply->deferreds.push_back(call->deferred);
+            reply->opcode = call->opcode;
+            failed.push_back(reply);
+            delete call;
+        }
+        queue_.clear();
+    }
+    wake_.notify_all();
+
+    for (DaemonReply* reply : failed) {
+        reply->error = error;
+        deliver(reply);
+    }
+}
+
+void DaemonClient::deliver(DaemonReply* reply) {
+    if (napi_call_threadsafe_function(completion_, reply, napi_tsfn_blocking) != napi_ok) {
+        // Environment is shutting down; the promises can no longer settle
+        delete reply;
+    }
+}
+
+void DaemonClient::settleOnJsThread(napi_env env, napi_value jsCallback, void* context, void* data) {
+    (void)jsCallback;
+    DaemonClient* self = static_cast<DaemonClient*>(context);
+    DaemonReply* reply = static_cast<DaemonReply*>(data);
+    if (env == nullptr) {
+        delete reply;
+        return;
+    }
+
+    bool failed = !reply->error.empty() || reply->status != EVAL_STATUS_OK;
+    for (size_t i = 0; i < reply->deferreds.size(); i++) {
+        napi_value value;
+        if (failed) {
+            napi_value code;
+            napi_value message;
+            napi_create_string_utf8(env, "EVAL_DAEMON_UNAVAILABLE", NAPI_AUTO_LENGTH, &code);
+            const char* text = reply->error.empty() ? "Daemon could not evaluate the request"
+                                                    : reply->error.c_str();
+            napi_create_string_utf8(env, text, NAPI_AUTO_LENGTH, &message);
+            napi_create_error(env, code, message, &value);
+            napi_reject_deferred(env, reply->deferreds[i], value);
+        } else if (reply->opcode == EVAL_OP_STATS) {
+            napi_create_string_utf8(env, reply->payload.data(), reply->payload.size(), &value);
+            napi_resolve_deferred(env, reply->deferreds[i], value);
+        } else {
+            napi_create_int32(env, (int8_t)reply->payload[i], &value);
+            napi_resolve_deferred(env, reply->deferreds[i], value);
+        }
+    }
+
+    self->outstanding_ -= reply->deferreds.size();
+    if (self->outstanding_ == 0) {
+        napi_unref_threadsafe_function(env, self->completion_);
+    }
+    delete reply;
+}
+
+// ============================================================================
+// Node.js API Functions
+// ============================================================================
+
+static void disconnectOnExit(void* arg) {
+    (void)arg;
+    if (daemonClient) {
+        daemonClient->disconnect();
+        daemonClient = nullptr;
+    }
+}
+
+// ConnectDaemon: optional socket path (EVAL_DEFAULT_SOCKET). Returns true,
+// or throws if the daemon is not reachable.
+napi_value ConnectDaemon(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    napi_value jsResult;
+    napi_get_boolean(env, true, &jsResult);
+    if (daemonClient) return jsResult;
+
+    std::string path = EVAL_DEFAULT_SOCKET;
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) napi_typeof(env, args[0], &type);
+    if (type == napi_string) path = extractString(env, args[0]);
+
+    DaemonClient* client = new DaemonClient();
+    std::string error;
+    if (!client->connect(env, path, &error)) {
+        delete client;
+        napi_throw_error(env, nullptr, error.c_str());
+        return nullptr;
+    }
+
+    static bool cleanupRegistered = false;
+    if (!cleanupRegistered) {
+        napi_add_env_cleanup_hook(env, disconnectOnExit, nullptr);
+        cleanupRegistered = true;
+    }
+    daemonClient = client;
+    return jsResult;
+}
+
+// DaemonEvaluate: appJson, userJson, policyJson. Returns a Promise of the
+// EvaluationResult code; rejects with code EVAL_DAEMON_UNAVAILABLE.
+napi_value DaemonEvaluate(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    if (argc < 3) {
+        napi_throw_error(env, nullptr, "Expected 3 arguments: appJson, userJson, policyJson");
+        return nullptr;
+    }
+    if (!daemonClient) {
+        napi_throw_error(env, nullptr, "Not connected to the evaluation daemon");
+        return nullptr;
+    }
+
+    DaemonCall* call = new DaemonCall();
+    call->appJson = extractString(env, args[0]);
+    call->userJson = extractString(env, args[1]);
+    call->policyJson = extractString(env, args[2]);
+
+    napi_value promise;
+    napi_create_promise(env, &call->deferred, &promise);
+    daemonClient->submit(env, call);
+    return promise;
+}
+
+// GetDaemonStats: Promise of the daemon counters as a JSON string
+napi_value GetDaemonStats(napi_env env, napi_callback_info info) {
+    (void)info;
+    if (!daemonClient) {
+        napi_throw_error(env, nullptr, "Not connected to the evaluation daemon");
+        return nullptr;
+    }
+
+    DaemonCall* call = new DaemonCall();
+    call->opcode = EVAL_OP_STATS;
+    napi_value promise;
+    napi_create_promise(env, &call->deferred, &promise);
+    daemonClient->submit(env, call);
+    return promise;
+}
+
+// DisconnectDaemon: pending promises reject with EVAL_DAEMON_UNAVAILABLE
+napi_value DisconnectDaemon(napi_env env, napi_callback_info info) {
+    (void)info;
+    disconnectOnExit(nullptr);
+
+    napi_value jsResult;
+    napi_get_undefined(env, &jsResult);
+    return jsResult;
+}
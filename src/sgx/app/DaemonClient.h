@@ -0,0 +1,23 @@
+#ifndef DAEMON_CLIENT_H
+#define DAEMON_CLIENT_H
+
+#include <node_api.h>
+
+// ============================================================================
+// Evaluation Daemon Client
+// ============================================================================
+//
+// Thin addon-side client for tools/eval-daemon.cpp: lets a validator share
+// the host's enclave and decision cache instead of creating its own. One
+// connection per process. Calls made while a frame is being written are
+// coalesced into the next frame (repeated policies are sent once), and any
+// number of frames may be in flight; a reader thread settles the promises
+// as responses arrive.
+
+// Node.js addon functions
+napi_value ConnectDaemon(napi_env env, napi_callback_info info);
+napi_value DaemonEvaluate(napi_env env, napi_callback_info info);
+napi_value GetDaemonStats(napi_env env, napi_callback_info info);
+napi_value DisconnectDaemon(napi_env env, napi_callback_info info);
+
+#endif // DAEMON_CLIENT_H
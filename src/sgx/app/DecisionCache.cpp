@@ -0,0 +1,224 @@
+#include "DecisionCache.h"
+#include "App.h"
+#include "../core/ExpiringDecisionCache.h"
+#include <string.h>
+#include <string>
+
+// Keys up to this length are read without a heap allocation
+#define KEY_BUFFER_LEN 256
+
+static ExpiringDecisionCache* decisionCache = nullptr;
+
+static void releaseOnExit(void* arg) {
+    (void)arg;
+    delete decisionCache;
+    decisionCache = nullptr;
+}
+
+static ExpiringDecisionCache* getCache(napi_env env) {
+    if (!decisionCache) {
+        decisionCache = new ExpiringDecisionCache();
+        napi_add_env_cleanup_hook(env, releaseOnExit, nullptr);
+    }
+    return decisionCache;
+}
+
+static void setNumber(napi_env env, napi_value obj, const char* key, double value) {
+    napi_value v;
+    napi_create_double(env, value, &v);
+    napi_set_named_property(env, obj, key, v);
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Hashes the key string and policy version of a request into a cache key
+static bool readKey(napi_env env, napi_value keyValue, napi_value versionValue, Hash128* key,
+                    uint32_t* version) {
+    napi_valuetype type;
+    napi_typeof(env, versionValue, &type);
+    if (type == napi_number) {
+        double number = 0;
+        napi_get_value_double(env, versionValue, &number);
+        *version = (uint32_t)(int64_t)number;
+    } else if (type == napi_string) {
+        std::string text = extractString(env, versionValue);
+        *version = (uint32_t)hash64(text.data(), text.size());
+    } else {
+        return false;
+    }
+
+    char buffer[KEY_BUFFER_LEN];
+    size_t length = 0;
+    if (napi_get_value_string_utf8(env, keyValue, buffer, sizeof(buffer), &length) != napi_ok) {
+        return false;
+    }
+    if (length < sizeof(buffer) - 1) {
+        *key = ExpiringDecisionCache::makeKey(buffer, length, *version);
+    } else {
+        std::string text = extractString(env, keyValue);
+        *key = ExpiringDecisionCache::makeKey(text.data(), text.size(), *version);
+    }
+    return true;
+}
+
+// Reads a hex input digest (as evaluate() returns it); false if the value
+// is not one
+static bool readDigest(napi_env env, napi_value value, uint8_t* digest) {
+    char hex[2 * EXPIRING_CACHE_DIGEST_LEN + 2];
+    size_t length = 0;
+    if (napi_get_value_string_utf8(env, value, hex, sizeof(hex), &length) != napi_ok ||
+        length != 2 * EXPIRING_CACHE_DIGEST_LEN) {
+        return false;
+    }
+    for (size_t i = 0; i < EXPIRING_CACHE_DIGEST_LEN; i++) {
+        int high = hexValue(hex[2 * i]);
+        int low = hexValue(hex[2 * i + 1]);
+        if (high < 0 || low < 0) return false;
+        digest[i] = (uint8_t)(high << 4 | low);
+    }
+    return true;
+}
+
+// ConfigureDecisionCache: optional { capacity, bloomFilter }: live entries
+// (default 1M) and whether certain misses skip the table (default true)
+napi_value ConfigureDecisionCache(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    double capacity = 0;
+    if (argc >= 1 && getOptionalNumber(env, args[0], "capacity", &capacity)) {
+        if (capacity < 1) {
+            napi_throw_error(env, nullptr, "capacity must be at least 1 entry");
+            return nullptr;
+        }
+        getCache(env)->setCapacity((size_t)capacity);
+    }
+    bool bloomFilter = true;
+    if (argc >= 1 && getOptionalBool(env, args[0], "bloomFilter", &bloomFilter)) {
+        getCache(env)->setFilterEnabled(bloomFilter);
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// DecisionCacheGet: key, policyVersion (string or number), optional
+// withDigest. Returns the EvaluationResult code of a live entry, or null on
+// a miss; with withDigest true a hit is { code, digest }, digest being the
+// stored hex input digest or null.
+napi_value DecisionCacheGet(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    napi_value result;
+    napi_get_null(env, &result);
+    Hash128 key;
+    uint32_t version;
+    if (argc < 2 || !readKey(env, args[0], args[1], &key, &version)) return result;
+    bool withDigest = false;
+    if (argc >= 3) napi_get_value_bool(env, args[2], &withDigest);
+
+    int8_t code;
+    uint8_t digest[EXPIRING_CACHE_DIGEST_LEN];
+    if (!getCache(env)->lookup(key, version, &code, withDigest ? digest : nullptr)) return result;
+    if (!withDigest) {
+        napi_create_int32(env, code, &result);
+        return result;
+    }
+
+    napi_create_object(env, &result);
+    setNumber(env, result, "code", code);
+    napi_value digestValue;
+    static const uint8_t none[EXPIRING_CACHE_DIGEST_LEN] = { 0 };
+    if (memcmp(digest, none, sizeof(none)) == 0) {
+        napi_get_null(env, &digestValue);
+    } else {
+        static const char HEX[] = "0123456789abcdef";
+        char hex[2 * EXPIRING_CACHE_DIGEST_LEN];
+        for (size_t i = 0; i < EXPIRING_CACHE_DIGEST_LEN; i++) {
+            hex[2 * i] = HEX[digest[i] >> 4];
+            hex[2 * i + 1] = HEX[digest[i] & 0x0f];
+        }
+        napi_create_string_utf8(env, hex, sizeof(hex), &digestValue);
+    }
+    napi_set_named_property(env, result, "digest", digestValue);
+    return result;
+}
+
+// DecisionCacheSet: key, policyVersion, code, ttlSeconds, optional hex
+// input digest. Returns false when the entry was not stored (cache full or
+// no retention).
+napi_value DecisionCacheSet(napi_env env, napi_callback_info info) {
+    size_t argc = 5;
+    napi_value args[5];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    bool stored = false;
+    Hash128 key;
+    uint32_t version;
+    double code = 0;
+    double ttlSeconds = 0;
+    uint8_t digest[EXPIRING_CACHE_DIGEST_LEN];
+    bool hasDigest = argc >= 5 && readDigest(env, args[4], digest);
+    if (argc >= 4 && readKey(env, args[0], args[1], &key, &version) &&
+        napi_get_value_double(env, args[2], &code) == napi_ok &&
+        napi_get_value_double(env, args[3], &ttlSeconds) == napi_ok && ttlSeconds > 0) {
+        stored = getCache(env)->insert(key, version, (int8_t)code, (uint64_t)(ttlSeconds * 1000),
+                                       hasDigest ? digest : nullptr);
+    }
+
+    napi_value result;
+    napi_get_boolean(env, stored, &result);
+    return result;
+}
+
+// ClearDecisionCache: drops every entry
+napi_value ClearDecisionCache(napi_env env, napi_callback_info info) {
+    (void)info;
+    getCache(env)->clear();
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// GetDecisionCacheStats: live entries, estimated bytes, hit/expiry counters
+// and the Bloom filter's skips and false positives
+napi_value GetDecisionCacheStats(napi_env env, napi_callback_info info) {
+    (void)info;
+    ExpiringCacheStats stats = getCache(env)->stats();
+
+    napi_value result;
+    napi_create_object(env, &result);
+    setNumber(env, result, "entries", (double)stats.entries);
+    setNumber(env, result, "capacity", (double)stats.capacity);
+    setNumber(env, result, "bytes", (double)stats.bytes);
+    setNumber(env, result, "hits", (double)stats.hits);
+    setNumber(env, result, "misses", (double)stats.misses);
+    setNumber(env, result, "inserts", (double)stats.inserts);
+    setNumber(env, result, "expired", (double)stats.expired);
+    setNumber(env, result, "rejected", (double)stats.rejected);
+
+    napi_value filter;
+    napi_create_object(env, &filter);
+    napi_value enabled;
+    napi_get_boolean(env, stats.filterEnabled, &enabled);
+    napi_set_named_property(env, filter, "enabled", enabled);
+    setNumber(env, filter, "bytes", (double)stats.filterBytes);
+    setNumber(env, filter, "skippedLookups", (double)stats.filterSkips);
+    setNumber(env, filter, "falsePositives", (double)stats.falsePositives);
+    // Share of true misses the filter failed to rule out
+    uint64_t trueMisses = stats.filterSkips + stats.falsePositives;
+    setNumber(env, filter, "falsePositiveRate", trueMisses ? (double)stats.falsePositives / trueMisses : 0);
+    setNumber(env, filter, "rebuilds", (double)stats.rebuilds);
+    napi_set_named_property(env, result, "filter", filter);
+    return result;
+}
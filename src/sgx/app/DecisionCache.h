@@ -0,0 +1,22 @@
+#ifndef DECISION_CACHE_H
+#define DECISION_CACHE_H
+
+#include <node_api.h>
+
+// ============================================================================
+// Expiring Decision Cache Bindings
+// ============================================================================
+//
+// Exposes core/ExpiringDecisionCache.h to the API server: a per-process
+// decision cache whose entries are evicted by a timing wheel the moment the
+// user's timeofRetention ends, in place of the createdAt filter on
+// EvaluateHash. JS thread only.
+
+// Node.js addon functions
+napi_value ConfigureDecisionCache(napi_env env, napi_callback_info info);
+napi_value DecisionCacheGet(napi_env env, napi_callback_info info);
+napi_value DecisionCacheSet(napi_env env, napi_callback_info info);
+napi_value ClearDecisionCache(napi_env env, napi_callback_info info);
+napi_value GetDecisionCacheStats(napi_env env, napi_callback_info info);
+
+#endif // DECISION_CACHE_H
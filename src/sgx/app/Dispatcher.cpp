@@ -0,0 +1,849 @@
+#include "Dispatcher.h"
+#include "App.h"
+#include "PrivacyEvaluation_u.h"
+#include <math.h>
+#include <string.h>
+
+// Fraction of the SLO the planner aims for; the rest absorbs jitter
+#define SLO_HEADROOM 0.8
+// Completions between two p99 feedback checks
+#define ADAPT_WINDOW 256
+// Decay of the inter-arrival EWMA and of the service-cost regression
+#define ARRIVAL_ALPHA 0.05
+#define SERVICE_DECAY 0.95
+// TCS reserved for dispatcher workers; Enclave.config.xml adds one for the
+// synchronous evaluatePrivacy and MAX_BULK_ECALLS for app/Bulk.cpp
+#define MAX_DISPATCH_WORKERS 9
+// Deadline granularity of the admission-control queue counts
+#define DEADLINE_BUCKET_US 250
+
+static uint64_t elapsedUs(DispatchClock::time_point from, DispatchClock::time_point to) {
+    if (to <= from) return 0;
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+static int64_t deadlineBucket(DispatchClock::time_point deadline) {
+    return (int64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        deadline.time_since_epoch()).count() / DEADLINE_BUCKET_US;
+}
+
+static void countDeadline(DispatchLane& lane, const PendingRequest* req) {
+    if (req->deadline == DispatchClock::time_point::max()) return;
+    lane.deadlineBuckets[deadlineBucket(req->deadline)]++;
+}
+
+static void forgetDeadline(DispatchLane& lane, const PendingRequest* req) {
+    if (req->deadline == DispatchClock::time_point::max()) return;
+    std::map<int64_t, size_t>::iterator it = lane.deadlineBuckets.find(deadlineBucket(req->deadline));
+    if (it != lane.deadlineBuckets.end() && --it->second == 0) lane.deadlineBuckets.erase(it);
+}
+
+const char* priorityName(PriorityClass priority) {
+    return priority == PRIORITY_BULK ? "bulk" : "realtime";
+}
+
+bool parsePriorityName(const std::string& name, PriorityClass* out) {
+    if (name == "realtime") {
+        *out = PRIORITY_REALTIME;
+        return true;
+    }
+    if (name == "bulk") {
+        *out = PRIORITY_BULK;
+        return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// Metrics Export
+// ============================================================================
+
+napi_value histogramToObject(napi_env env, const Log2Histogram& hist) {
+    napi_value obj;
+    napi_create_object(env, &obj);
+
+    napi_value value;
+    napi_create_double(env, (double)hist.count(), &value);
+    napi_set_named_property(env, obj, "count", value);
+    napi_create_double(env, hist.mean(), &value);
+    napi_set_named_property(env, obj, "mean", value);
+    napi_create_double(env, (double)hist.percentile(0.50), &value);
+    napi_set_named_property(env, obj, "p50", value);
+    napi_create_double(env, (double)hist.percentile(0.95), &value);
+    napi_set_named_property(env, obj, "p95", value);
+    napi_create_double(env, (double)hist.percentile(0.99), &value);
+    napi_set_named_property(env, obj, "p99", value);
+    napi_create_double(env, (double)hist.max(), &value);
+    napi_set_named_property(env, obj, "max", value);
+
+    // Sparse bucket list: [{ le, count }] for non-empty buckets
+    napi_value buckets;
+    napi_create_array(env, &buckets);
+    uint32_t index = 0;
+    size_t used = hist.usedBuckets();
+    for (size_t i = 0; i < used; i++) {
+        uint64_t n = hist.bucket(i);
+        if (n == 0) continue;
+        napi_value entry;
+        napi_create_object(env, &entry);
+        napi_create_double(env, (double)Log2Histogram::bucketUpperBound(i), &value);
+        napi_set_named_property(env, entry, "le", value);
+        napi_create_double(env, (double)n, &value);
+        napi_set_named_property(env, entry, "count", value);
+        napi_set_element(env, buckets, index++, entry);
+    }
+    napi_set_named_property(env, obj, "buckets", buckets);
+
+    return obj;
+}
+
+// ============================================================================
+// Lifecycle
+// ============================================================================
+
+BatchDispatcher::BatchDispatcher() : ecallFailures_(0) {
+    for (int lane = 0; lane < PRIORITY_CLASSES; lane++) {
+        recomputeLimits(lane);
+    }
+}
+
+BatchDispatcher::~BatchDispatcher() {
+    stop();
+}
+
+bool BatchDispatcher::start(napi_env env) {
+    if (running_) return true;
+
+    napi_value name;
+    napi_create_string_utf8(env, "sgxBatchCompletion", NAPI_AUTO_LENGTH, &name);
+    napi_status status = napi_create_threadsafe_function(
+        env, nullptr, nullptr, name,
+        0,        // unbounded queue: flush workers never block on JS
+        1,        // released once, by stop()
+        nullptr, nullptr,
+        this, completeOnJsThread, &completion_);
+    if (status != napi_ok) {
+        completion_ = nullptr;
+        return false;
+    }
+    // Only keep the event loop alive while promises are outstanding
+    napi_unref_threadsafe_function(env, completion_);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = true;
+    spawnWorkersLocked();
+    return true;
+}
+
+void BatchDispatcher::spawnWorkersLocked() {
+    while (workers_.size() < config_.workers) {
+        uint32_t workerId = (uint32_t)workers_.size();
+        busyUntil_.push_back(DispatchClock::time_point());
+        workers_.emplace_back(&BatchDispatcher::run, this, workerId);
+    }
+}
+
+void BatchDispatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+    workers_.clear();
+    busyUntil_.clear();
+
+    // Queued completions are still delivered before the function finalizes
+    napi_release_threadsafe_function(completion_, napi_tsfn_release);
+    completion_ = nullptr;
+}
+
+void BatchDispatcher::configure(const DispatcherConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    if (config_.workers == 0) config_.workers = 1;
+    if (config_.workers > MAX_DISPATCH_WORKERS) config_.workers = MAX_DISPATCH_WORKERS;
+    for (int lane = 0; lane < PRIORITY_CLASSES; lane++) {
+        LaneConfig& lc = config_.lanes[lane];
+        if (lc.maxBatchSize == 0) lc.maxBatchSize = 1;
+        if (lc.sloP99Us == 0) lc.sloP99Us = 1;
+        if (lc.maxConcurrency == 0) lc.maxConcurrency = 1;
+        if (lc.weight == 0) lc.weight = 1;
+        lanes_[lane].sloScale = 1.0;
+        recomputeLimits(lane);
+    }
+    // Growing the pool takes effect immediately; surplus workers park
+    if (running_) spawnWorkersLocked();
+    wake_.notify_all();
+}
+
+DispatcherConfig BatchDispatcher::config() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
+
+// ============================================================================
+// Submission (JS thread)
+// ============================================================================
+
+bool BatchDispatcher::submit(napi_env env, PendingRequest* req) {
+    DispatchLane& lane = lanes_[req->priority];
+    req->enqueuedAt = DispatchClock::now();
+    bool rejected = false;
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (lane.hasArrival) {
+            double gap = (double)elapsedUs(lane.lastArrival, req->enqueuedAt);
+            lane.arrivalGapUs += ARRIVAL_ALPHA * (gap - lane.arrivalGapUs);
+        }
+        lane.lastArrival = req->enqueuedAt;
+        lane.hasArrival = true;
+
+        if (req->deadline == DispatchClock::time_point::max() && config_.defaultDeadlineUs > 0) {
+            req->deadline = req->enqueuedAt + std::chrono::microseconds(config_.defaultDeadlineUs);
+        }
+
+        // Admission control: an answer after the deadline is wasted enclave
+        // time, so refuse now while the caller can still fall back or retry
+        if (config_.admissionControl && req->deadline != DispatchClock::time_point::max()) {
+            double delay = estimateQueueDelayUsLocked(req, req->enqueuedAt);
+            rejected = req->enqueuedAt + std::chrono::microseconds((int64_t)delay) > req->deadline;
+        }
+
+        if (!rejected) {
+            lane.queue.push_back(req);
+            std::push_heap(lane.queue.begin(), lane.queue.end(), LaterDeadline());
+            countDeadline(lane, req);
+            lane.arrivals.push_back(req->enqueuedAt);
+            // Wake the workers for a new batch, a full one, or a request
+            // that moved the earliest flush time forward
+            notify = lane.queue.size() == 1 || lane.queue.size() >= lane.batchLimit ||
+                     lane.queue.front() == req;
+        }
+    }
+
+    if (rejected) {
+        lane.rejectedOverload.fetch_add(1, std::memory_order_relaxed);
+        req->code = RESULT_OVERLOAD;
+        settle(env, req);
+        return false;
+    }
+
+    // req now belongs to the flush workers
+    lane.admitted.fetch_add(1, std::memory_order_relaxed);
+    if (inflight_++ == 0) {
+        napi_ref_threadsafe_function(env, completion_);
+    }
+    if (notify) wake_.notify_all();
+    return true;
+}
+
+// Time until req would leave the enclave: the wait for a free worker, the
+// batches ahead of it in its lane's EDF order spread over the workers the lane
+// may use, the wait budget of its own batch and its own ECALL. Requests ahead
+// are counted from the deadline buckets up to req's own, which may include a
+// few due up to DEADLINE_BUCKET_US after it; the walk is bounded by the
+// deadline horizon, not by the queue length.
+double BatchDispatcher::estimateQueueDelayUsLocked(const PendingRequest* req,
+                                                  DispatchClock::time_point now) const {
+    int laneIndex = req->priority;
+    const DispatchLane& lane = lanes_[laneIndex];
+    size_t ahead = 0;
+    if (req->deadline == DispatchClock::time_point::max()) {
+        ahead = lane.queue.size();
+    } else {
+        int64_t last = deadlineBucket(req->deadline);
+        for (std::map<int64_t, size_t>::const_iterator it = lane.deadlineBuckets.begin();
+             it != lane.deadlineBuckets.end() && it->first <= last; ++it) {
+            ahead += it->second;
+        }
+    }
+
+    uint32_t parallel = std::min(config_.lanes[laneIndex].maxConcurrency, config_.workers);
+    if (parallel == 0) parallel = 1;
+
+    double delay = 0.0;
+    if (!laneHasCapacityLocked(laneIndex)) {
+        // Every usable worker is in an ECALL: wait for the first to return
+        DispatchClock::time_point firstFree = DispatchClock::time_point::max();
+        for (const DispatchClock::time_point& busy : busyUntil_) {
+            if (busy != DispatchClock::time_point() && busy < firstFree) firstFree = busy;
+        }
+        if (firstFree != DispatchClock::time_point::max() && firstFree > now) {
+            delay += (double)elapsedUs(now, firstFree);
+        }
+    }
+
+    size_t fullBatches = ahead / lane.batchLimit;
+    size_t rounds = (fullBatches + parallel - 1) / parallel;
+    delay += (double)rounds * serviceEstimateUs(lane.batchLimit);
+    size_t ownBatch = ahead % lane.batchLimit + 1;
+    if (ownBatch < lane.batchLimit) delay += (double)lane.waitLimitUs;
+    delay += serviceEstimateUs(ownBatch);
+    return delay;
+}
+
+// ============================================================================
+// Flush Workers
+// ============================================================================
+
+void BatchDispatcher::run(uint32_t workerId) {
+    std::vector<PendingRequest*> batch;
+    std::vector<PendingRequest*> expired;
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        bool drained = true;
+        for (int lane = 0; lane < PRIORITY_CLASSES; lane++) {
+            if (!lanes_[lane].queue.empty()) drained = false;
+        }
+        if (!running_ && drained) break;
+
+        // Surplus worker after the pool was shrunk: park until resized.
+        // On shutdown every worker helps drain.
+        if (running_ && workerId >= config_.workers) {
+            wake_.wait(lock);
+            continue;
+        }
+
+        DispatchClock::time_point now = DispatchClock::now();
+        DispatchClock::time_point nextFlush = DispatchClock::time_point::max();
+        int lane = pickLaneLocked(now, &nextFlush);
+        if (lane < 0) {
+            if (nextFlush == DispatchClock::time_point::max()) {
+                wake_.wait(lock);
+            } else {
+                wake_.wait_until(lock, nextFlush);
+            }
+            continue;
+        }
+
+        takeBatchLocked(lane, now, batch, expired);
+        lanes_[lane].active++;
+        busyWorkers_++;
+        busyUntil_[workerId] = now +
+            std::chrono::microseconds((int64_t)serviceEstimateUs(batch.size()));
+
+        lock.unlock();
+        flush(lane, batch, expired);
+        lock.lock();
+
+        lanes_[lane].active--;
+        busyWorkers_--;
+        busyUntil_[workerId] = DispatchClock::time_point();
+        // A lane may have been waiting on its concurrency cap
+        wake_.notify_all();
+    }
+}
+
+bool BatchDispatcher::laneHasCapacityLocked(int lane) const {
+    uint32_t cap = std::min(config_.lanes[lane].maxConcurrency, config_.workers);
+    return lanes_[lane].active < cap && busyWorkers_ < config_.workers;
+}
+
+// Choose the lane the calling worker should flush next, or -1 if none is
+// ready yet (nextFlush then holds the earliest time one will be). A lane is
+// ready when its batch is full, its flush time has come, or we are draining.
+int BatchDispatcher::pickLaneLocked(DispatchClock::time_point now,
+                                    DispatchClock::time_point* nextFlush) {
+    bool ready[PRIORITY_CLASSES];
+    bool any = false;
+    for (int lane = 0; lane < PRIORITY_CLASSES; lane++) {
+        ready[lane] = false;
+        const DispatchLane& l = lanes_[lane];
+        if (l.queue.empty() || !laneHasCapacityLocked(lane)) continue;
+
+        DispatchClock::time_point flushAt = flushAtLocked(lane);
+        if (!running_ || l.queue.size() >= l.batchLimit || now >= flushAt) {
+            ready[lane] = true;
+            any = true;
+        } else if (flushAt < *nextFlush) {
+            *nextFlush = flushAt;
+        }
+    }
+    if (!any) return -1;
+
+    if (config_.strictPriority) {
+        for (int lane = 0; lane < PRIORITY_CLASSES; lane++) {
+            if (ready[lane]) return lane;
+        }
+    }
+
+    // Smooth weighted round-robin over the ready lanes
+    int best = -1;
+    int64_t total = 0;
+    for (int lane = 0; lane < PRIORITY_CLASSES; lane++) {
+        if (!ready[lane]) continue;
+        lanes_[lane].currentWeight += config_.lanes[lane].weight;
+        total += config_.lanes[lane].weight;
+        if (best < 0 || lanes_[lane].currentWeight > lanes_[best].currentWeight) {
+            best = lane;
+        }
+    }
+    lanes_[best].currentWeight -= total;
+    return best;
+}
+
+// Take the earliest deadlines first; anything already past its deadline is
+// dropped here instead of occupying a batch slot
+void BatchDispatcher::takeBatchLocked(int laneIndex, DispatchClock::time_point now,
+                                      std::vector<PendingRequest*>& batch,
+                                      std::vector<PendingRequest*>& expired) {
+    DispatchLane& lane = lanes_[laneIndex];
+    if (lane.queue.size() >= lane.batchLimit) {
+        lane.flushesBySize.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        lane.flushesByTime.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    batch.clear();
+    expired.clear();
+    while (!lane.queue.empty() && batch.size() < lane.batchLimit) {
+        std::pop_heap(lane.queue.begin(), lane.queue.end(), LaterDeadline());
+        PendingRequest* req = lane.queue.back();
+        lane.queue.pop_back();
+        forgetDeadline(lane, req);
+        lane.departed.push(req->enqueuedAt);
+        if (req->deadline <= now) {
+            req->code = RESULT_EXPIRED;
+            expired.push_back(req);
+        } else {
+            batch.push_back(req);
+        }
+    }
+    // submit() runs on the JS thread only, so arrivals is in time order and
+    // a taken request at its front is the smallest departed time
+    while (!lane.departed.empty() && lane.departed.top() == lane.arrivals.front()) {
+        lane.departed.pop();
+        lane.arrivals.pop_front();
+    }
+}
+
+// Hold a lane's batch open until its oldest request has used up the wait
+// budget, or until waiting longer would break the earliest deadline
+DispatchClock::time_point BatchDispatcher::flushAtLocked(int laneIndex) const {
+    const DispatchLane& lane = lanes_[laneIndex];
+    DispatchClock::time_point flushAt = lane.arrivals.front() +
+        std::chrono::microseconds(lane.waitLimitUs);
+
+    const PendingRequest* earliest = lane.queue.front();
+    if (earliest->deadline != DispatchClock::time_point::max()) {
+        DispatchClock::time_point latestStart = earliest->deadline -
+            std::chrono::microseconds((int64_t)serviceEstimateUs(lane.queue.size()));
+        if (latestStart < flushAt) flushAt = latestStart;
+    }
+    return flushAt;
+}
+
+static bool wantsDigests(const std::vector<PendingRequest*>& batch,
+                         const std::vector<size_t>& indices) {
+    for (size_t i : indices) {
+        if (batch[i]->wantDigest) return true;
+    }
+    return false;
+}
+
+static void collectResults(const std::vector<PendingRequest*>& batch,
+                           const std::vector<size_t>& indices, const std::vector<int>& results,
+                           const std::vector<uint8_t>& digests, std::vector<int>& codes) {
+    for (size_t k = 0; k < indices.size(); k++) {
+        codes[indices[k]] = results[k];
+        if (!digests.empty() && batch[indices[k]]->wantDigest) {
+            memcpy(batch[indices[k]]->digest, &digests[k * INPUT_DIGEST_LEN], INPUT_DIGEST_LEN);
+        }
+    }
+}
+
+// Pack records as app\0user\0policy\0 for ecall_evaluate_privacy_batch
+static bool evaluatePlain(const std::vector<PendingRequest*>& batch,
+                          const std::vector<size_t>& indices, std::vector<int>& codes) {
+    size_t packedLen = 0;
+    for (size_t i : indices) {
+        packedLen += batch[i]->appJson.size() + batch[i]->userJson.size() +
+                     batch[i]->policyJson.size() + 3;
+    }
+    std::string packed;
+    packed.reserve(packedLen);
+    for (size_t i : indices) {
+        packed.append(batch[i]->appJson).push_back('\0');
+        packed.append(batch[i]->userJson).push_back('\0');
+        packed.append(batch[i]->policyJson).push_back('\0');
+    }
+
+    std::vector<int> results(indices.size(), RESULT_ERROR);
+    std::vector<uint8_t> digests(wantsDigests(batch, indices) ? indices.size() * INPUT_DIGEST_LEN : 0);
+    int evaluated = RESULT_ERROR;
+    if (!enclave_initialized ||
+        ecall_evaluate_privacy_batch(global_eid, &evaluated, packed.data(), packed.size(),
+                                     indices.size(), results.data(),
+                                     digests.empty() ? nullptr : digests.data(),
+                                     digests.size()) != SGX_SUCCESS ||
+        evaluated < 0) {
+        return false;
+    }
+    collectResults(batch, indices, results, digests, codes);
+    return true;
+}
+
+// Pack records as sessionId | sealedLen | sealed | policy\0 (enclave/Channel.h)
+static bool evaluateSealed(const std::vector<PendingRequest*>& batch,
+                           const std::vector<size_t>& indices, std::vector<int>& codes) {
+    size_t packedLen = 0;
+    for (size_t i : indices) {
+        packedLen += 2 * sizeof(uint32_t) + batch[i]->sealedInput.size() +
+                     batch[i]->policyJson.size() + 1;
+    }
+    std::string packed;
+    packed.reserve(packedLen);
+    for (size_t i : indices) {
+        uint32_t header[2] = { batch[i]->sessionId, (uint32_t)batch[i]->sealedInput.size() };
+        packed.append(reinterpret_cast<const char*>(header), sizeof(header));
+        packed.append(batch[i]->sealedInput);
+        packed.append(batch[i]->policyJson).push_back('\0');
+    }
+
+    std::vector<int> results(indices.size(), RESULT_ERROR);
+    std::vector<uint8_t> digests(wantsDigests(batch, indices) ? indices.size() * INPUT_DIGEST_LEN : 0);
+    int evaluated = RESULT_ERROR;
+    if (!enclave_initialized ||
+        ecall_evaluate_encrypted_batch(global_eid, &evaluated,
+                                       reinterpret_cast<const uint8_t*>(packed.data()),
+                                       packed.size(), indices.size(), results.data(),
+                                       digests.empty() ? nullptr : digests.data(),
+                                       digests.size()) != SGX_SUCCESS ||
+        evaluated < 0) {
+        return false;
+    }
+    collectResults(batch, indices, results, digests, codes);
+    return true;
+}
+
+void BatchDispatcher::flush(int laneIndex, std::vector<PendingRequest*>& batch,
+                            std::vector<PendingRequest*>& expired) {
+    DispatchLane& lane = lanes_[laneIndex];
+    size_t count = batch.size();
+    DispatchClock::time_point dispatchedAt = DispatchClock::now();
+
+    lane.droppedExpired.fetch_add(expired.size(), std::memory_order_relaxed);
+    if (count == 0) {
+        deliver(new std::vector<PendingRequest*>(expired));
+        return;
+    }
+
+    lane.batchSizes.record(count);
+    // Plaintext and encrypted requests go to their own batch ECALL
+    std::vector<size_t> plain, sealed;
+    for (size_t i = 0; i < count; i++) {
+        lane.queueDelayUs.record(elapsedUs(batch[i]->enqueuedAt, dispatchedAt));
+        (batch[i]->encrypted ? sealed : plain).push_back(i);
+    }
+
+    std::vector<int> codes(count, RESULT_ERROR);
+    if (!plain.empty() && !evaluatePlain(batch, plain, codes)) {
+        ecallFailures_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!sealed.empty() && !evaluateSealed(batch, sealed, codes)) {
+        ecallFailures_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t service = elapsedUs(dispatchedAt, DispatchClock::now());
+    serviceUs_.record(service);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        observeBatch(count, service);
+        for (int l = 0; l < PRIORITY_CLASSES; l++) {
+            recomputeLimits(l);
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        batch[i]->code = codes[i];
+    }
+
+    std::vector<PendingRequest*>* done = new std::vector<PendingRequest*>(batch);
+    done->insert(done->end(), expired.begin(), expired.end());
+    deliver(done);
+}
+
+// Hand finished requests to the JS thread for promise resolution
+void BatchDispatcher::deliver(std::vector<PendingRequest*>* done) {
+    if (napi_call_threadsafe_function(completion_, done, napi_tsfn_blocking) != napi_ok) {
+        // Environment is shutting down; the promises can no longer settle
+        for (PendingRequest* req : *done) delete req;
+        delete done;
+    }
+}
+
+// ============================================================================
+// Completion (JS thread)
+// ============================================================================
+
+void BatchDispatcher::completeOnJsThread(napi_env env, napi_value jsCallback,
+                                         void* context, void* data) {
+    (void)jsCallback;
+    BatchDispatcher* self = static_cast<BatchDispatcher*>(context);
+    std::vector<PendingRequest*>* done = static_cast<std::vector<PendingRequest*>*>(data);
+    DispatchClock::time_point now = DispatchClock::now();
+    bool adapt[PRIORITY_CLASSES] = { false, false };
+
+    for (PendingRequest* req : *done) {
+        DispatchLane& lane = self->lanes_[req->priority];
+        if (req->code != RESULT_EXPIRED) {
+            uint64_t latency = elapsedUs(req->enqueuedAt, now);
+            lane.latencyUs.record(latency);
+            lane.windowLatencyUs.record(latency);
+            if (now <= req->deadline) {
+                lane.metDeadline.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                lane.missedDeadline.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (lane.windowLatencyUs.count() >= ADAPT_WINDOW) adapt[req->priority] = true;
+        }
+
+        if (env != nullptr) {
+            settle(env, req);
+        } else {
+            delete req;
+        }
+    }
+
+    if (env != nullptr) {
+        self->inflight_ -= done->size();
+        if (self->inflight_ == 0 && self->completion_ != nullptr) {
+            napi_unref_threadsafe_function(env, self->completion_);
+        }
+    }
+    delete done;
+
+    // Latency feedback: shrink a lane's planning target while its p99 misses
+    // the SLO, relax it again once there is comfortable slack
+    for (int l = 0; l < PRIORITY_CLASSES; l++) {
+        if (!adapt[l]) continue;
+        std::lock_guard<std::mutex> lock(self->mutex_);
+        DispatchLane& lane = self->lanes_[l];
+        double p99 = (double)lane.windowLatencyUs.percentile(0.99);
+        double slo = (double)self->config_.lanes[l].sloP99Us;
+        if (p99 > slo) {
+            lane.sloScale = fmax(0.05, lane.sloScale * 0.8);
+        } else if (p99 < slo * 0.7) {
+            lane.sloScale = fmin(1.0, lane.sloScale * 1.05);
+        }
+        lane.windowLatencyUs.reset();
+        self->recomputeLimits(l);
+    }
+}
+
+// Resolve the request's promise with { success, result, code } and free it
+void BatchDispatcher::settle(napi_env env, PendingRequest* req) {
+    napi_value obj;
+    napi_create_object(env, &obj);
+
+    napi_value success;
+    napi_get_boolean(env, req->code >= 0, &success);
+    napi_set_named_property(env, obj, "success", success);
+
+    const char* text = req->code == RESULT_GRANT ? "grant"
+                     : req->code == RESULT_DENY ? "deny"
+                     : req->code == RESULT_OVERLOAD ? "overload"
+                     : req->code == RESULT_EXPIRED ? "expired"
+                     : req->code == RESULT_UNAUTHENTICATED ? "unauthenticated"
+                     : "error";
+    napi_value resultStr;
+    napi_create_string_utf8(env, text, NAPI_AUTO_LENGTH, &resultStr);
+    napi_set_named_property(env, obj, "result", resultStr);
+
+    napi_value retCode;
+    napi_create_int32(env, req->code, &retCode);
+    napi_set_named_property(env, obj, "code", retCode);
+
+    if (req->wantDigest && req->code >= 0) {
+        static const char HEX[] = "0123456789abcdef";
+        char hex[2 * INPUT_DIGEST_LEN];
+        for (size_t i = 0; i < INPUT_DIGEST_LEN; i++) {
+            hex[2 * i] = HEX[req->digest[i] >> 4];
+            hex[2 * i + 1] = HEX[req->digest[i] & 0x0f];
+        }
+        napi_value digest;
+        napi_create_string_utf8(env, hex, sizeof(hex), &digest);
+        napi_set_named_property(env, obj, "digest", digest);
+    }
+
+    napi_resolve_deferred(env, req->deferred, obj);
+    delete req;
+}
+
+// ============================================================================
+// Adaptive Limits (mutex_ held)
+// ============================================================================
+
+void BatchDispatcher::observeBatch(size_t size, uint64_t serviceUs) {
+    // Exponentially weighted least squares of service = fixed + perItem * size
+    double x = (double)size;
+    double y = (double)serviceUs;
+    fitW_ = fitW_ * SERVICE_DECAY + 1.0;
+    fitX_ = fitX_ * SERVICE_DECAY + x;
+    fitY_ = fitY_ * SERVICE_DECAY + y;
+    fitXX_ = fitXX_ * SERVICE_DECAY + x * x;
+    fitXY_ = fitXY_ * SERVICE_DECAY + x * y;
+
+    double denom = fitW_ * fitXX_ - fitX_ * fitX_;
+    if (fitW_ > 4.0 && denom > 1e-6 * fitW_ * fitW_) {
+        double slope = (fitW_ * fitXY_ - fitX_ * fitY_) / denom;
+        double intercept = (fitY_ - slope * fitX_) / fitW_;
+        if (slope >= 0.0 && intercept >= 0.0) {
+            servicePerItemUs_ = slope;
+            serviceFixedUs_ = intercept;
+            return;
+        }
+    }
+    // Batch sizes too uniform to separate the terms: keep the fixed cost
+    // and attribute the remainder to the records
+    double meanX = fitX_ / fitW_;
+    double meanY = fitY_ / fitW_;
+    servicePerItemUs_ = fmax(0.0, (meanY - serviceFixedUs_) / meanX);
+}
+
+void BatchDispatcher::recomputeLimits(int laneIndex) {
+    DispatchLane& lane = lanes_[laneIndex];
+    const LaneConfig& lc = config_.lanes[laneIndex];
+    if (!config_.adaptive) {
+        lane.batchLimit = lc.maxBatchSize;
+        lane.waitLimitUs = lc.maxWaitUs;
+        return;
+    }
+
+    // A request in a batch of n waits for n-1 followers to arrive, then for
+    // the ECALL itself. Pick the largest n whose estimate fits the target.
+    double target = (double)lc.sloP99Us * SLO_HEADROOM * lane.sloScale;
+    size_t best = 1;
+    for (size_t n = 2; n <= lc.maxBatchSize; n++) {
+        double fill = (double)(n - 1) * lane.arrivalGapUs;
+        if (fill + serviceEstimateUs(n) > target) break;
+        best = n;
+    }
+
+    // Never wait longer than it takes to fill the batch at the current rate
+    double wait = fmin(target - serviceEstimateUs(best), (double)(best - 1) * lane.arrivalGapUs);
+    wait = fmax(0.0, fmin(wait, (double)lc.maxWaitUs));
+
+    lane.batchLimit = best;
+    lane.waitLimitUs = (uint32_t)wait;
+}
+
+// ============================================================================
+// Stats
+// ============================================================================
+
+static void setNumber(napi_env env, napi_value obj, const char* key, double number) {
+    napi_value value;
+    napi_create_double(env, number, &value);
+    napi_set_named_property(env, obj, key, value);
+}
+
+static void setBool(napi_env env, napi_value obj, const char* key, bool flag) {
+    napi_value value;
+    napi_get_boolean(env, flag, &value);
+    napi_set_named_property(env, obj, key, value);
+}
+
+void BatchDispatcher::fillStats(napi_env env, napi_value obj) {
+    napi_value lanes;
+    napi_create_object(env, &lanes);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        napi_value cfg;
+        napi_create_object(env, &cfg);
+        setBool(env, cfg, "adaptive", config_.adaptive);
+        setNumber(env, cfg, "defaultDeadlineUs", config_.defaultDeadlineUs);
+        setBool(env, cfg, "admissionControl", config_.admissionControl);
+        setNumber(env, cfg, "workers", config_.workers);
+        setBool(env, cfg, "strictPriority", config_.strictPriority);
+        napi_set_named_property(env, obj, "config", cfg);
+
+        napi_value model;
+        napi_create_object(env, &model);
+        setNumber(env, model, "fixedUs", serviceFixedUs_);
+        setNumber(env, model, "perItemUs", servicePerItemUs_);
+        napi_set_named_property(env, obj, "serviceModel", model);
+        setNumber(env, obj, "busyWorkers", busyWorkers_);
+
+        for (int l = 0; l < PRIORITY_CLASSES; l++) {
+            const DispatchLane& lane = lanes_[l];
+            const LaneConfig& lc = config_.lanes[l];
+
+            napi_value laneObj;
+            napi_create_object(env, &laneObj);
+
+            napi_value laneCfg;
+            napi_create_object(env, &laneCfg);
+            setNumber(env, laneCfg, "maxBatchSize", (double)lc.maxBatchSize);
+            setNumber(env, laneCfg, "maxWaitUs", lc.maxWaitUs);
+            setNumber(env, laneCfg, "sloP99Us", lc.sloP99Us);
+            setNumber(env, laneCfg, "maxConcurrency", lc.maxConcurrency);
+            setNumber(env, laneCfg, "weight", lc.weight);
+            napi_set_named_property(env, laneObj, "config", laneCfg);
+
+            napi_value limits;
+            napi_create_object(env, &limits);
+            setNumber(env, limits, "batchSize", (double)lane.batchLimit);
+            setNumber(env, limits, "waitUs", lane.waitLimitUs);
+            setNumber(env, limits, "sloScale", lane.sloScale);
+            setNumber(env, limits, "arrivalRatePerSec",
+                      lane.arrivalGapUs > 0 ? 1e6 / lane.arrivalGapUs : 0);
+            napi_set_named_property(env, laneObj, "limits", limits);
+
+            setNumber(env, laneObj, "queued", (double)lane.queue.size());
+            setNumber(env, laneObj, "active", lane.active);
+            napi_set_named_property(env, lanes, priorityName((PriorityClass)l), laneObj);
+        }
+    }
+
+    for (int l = 0; l < PRIORITY_CLASSES; l++) {
+        const DispatchLane& lane = lanes_[l];
+        napi_value laneObj;
+        napi_get_named_property(env, lanes, priorityName((PriorityClass)l), &laneObj);
+
+        napi_set_named_property(env, laneObj, "batchSize", histogramToObject(env, lane.batchSizes));
+        napi_set_named_property(env, laneObj, "queueDelayUs", histogramToObject(env, lane.queueDelayUs));
+        napi_set_named_property(env, laneObj, "latencyUs", histogramToObject(env, lane.latencyUs));
+        setNumber(env, laneObj, "flushesBySize", (double)lane.flushesBySize.load());
+        setNumber(env, laneObj, "flushesByTime", (double)lane.flushesByTime.load());
+
+        napi_value deadlines;
+        napi_create_object(env, &deadlines);
+        setNumber(env, deadlines, "admitted", (double)lane.admitted.load());
+        setNumber(env, deadlines, "rejectedOverload", (double)lane.rejectedOverload.load());
+        setNumber(env, deadlines, "droppedExpired", (double)lane.droppedExpired.load());
+        setNumber(env, deadlines, "metDeadline", (double)lane.metDeadline.load());
+        setNumber(env, deadlines, "missedDeadline", (double)lane.missedDeadline.load());
+        napi_set_named_property(env, laneObj, "deadlines", deadlines);
+    }
+    napi_set_named_property(env, obj, "lanes", lanes);
+
+    napi_set_named_property(env, obj, "serviceUs", histogramToObject(env, serviceUs_));
+    setNumber(env, obj, "ecallFailures", (double)ecallFailures_.load());
+}
+
+void BatchDispatcher::resetStats() {
+    for (int l = 0; l < PRIORITY_CLASSES; l++) {
+        DispatchLane& lane = lanes_[l];
+        lane.batchSizes.reset();
+        lane.queueDelayUs.reset();
+        lane.latencyUs.reset();
+        lane.windowLatencyUs.reset();
+        lane.flushesBySize.store(0);
+        lane.flushesByTime.store(0);
+        lane.admitted.store(0);
+        lane.rejectedOverload.store(0);
+        lane.droppedExpired.store(0);
+        lane.metDeadline.store(0);
+        lane.missedDeadline.store(0);
+    }
+    serviceUs_.reset();
+    ecallFailures_.store(0);
+}
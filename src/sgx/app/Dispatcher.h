@@ -0,0 +1,215 @@
+#ifndef DISPATCHER_H
+#define DISPATCHER_H
+
+#include <node_api.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../core/Histogram.h"
+#include "../enclave/EnclaveCache.h"
+
+// ============================================================================
+// Adaptive Micro-Batching Dispatcher
+// ============================================================================
+//
+// Collects concurrent evaluatePrivacyAsync() calls from JS and flushes them
+// to the enclave through ecall_evaluate_privacy_batch, so several requests
+// share one enclave transition. Encrypted requests (evaluateEncryptedAsync)
+// share the queues and go through ecall_evaluate_encrypted_batch. A batch is
+// flushed when it reaches the current size limit or when its oldest request
+// has waited the current time budget. Both limits adapt to the observed
+// arrival rate and service cost so the p99 end-to-end latency stays under
+// the configured SLO.
+//
+// Requests may carry a deadline. The queue is ordered earliest-deadline-first,
+// requests whose deadline has passed are dropped before the ECALL
+// (RESULT_EXPIRED), and new requests are refused up front (RESULT_OVERLOAD)
+// when the estimated queueing delay already exceeds their deadline.
+//
+// Requests are split into priority lanes: latency-critical device checks
+// (PRIORITY_REALTIME) and bulk audits (PRIORITY_BULK). Each lane has its own
+// queue, batching limits, SLO and metrics. A pool of flush workers - one
+// enclave TCS each - serves the lanes by strict priority or by weight, and a
+// per-lane concurrency cap keeps bulk work from occupying every TCS.
+
+typedef std::chrono::steady_clock DispatchClock;
+
+enum PriorityClass {
+    PRIORITY_REALTIME = 0,
+    PRIORITY_BULK = 1,
+    PRIORITY_CLASSES = 2
+};
+
+struct LaneConfig {
+    size_t maxBatchSize;       // hard cap on records per ECALL
+    uint32_t maxWaitUs;        // hard cap on time a request waits for peers
+    uint32_t sloP99Us;         // end-to-end p99 target (enqueue -> resolve)
+    uint32_t maxConcurrency;   // workers that may serve this lane at once
+    uint32_t weight;           // share of dispatch turns in weighted mode
+};
+
+struct DispatcherConfig {
+    bool adaptive = true;            // false pins the limits to the caps
+    uint32_t defaultDeadlineUs = 0;  // applied when a request has none; 0 = none
+    bool admissionControl = true;    // reject work that cannot meet its deadline
+    uint32_t workers = 4;            // concurrent ECALLs; keep below TCSNum
+    bool strictPriority = false;     // true: realtime always first; false: weighted
+    LaneConfig lanes[PRIORITY_CLASSES] = {
+        { 64, 200, 2000, 4, 8 },        // PRIORITY_REALTIME
+        { 256, 2000, 100000, 2, 1 },    // PRIORITY_BULK
+    };
+};
+
+struct PendingRequest {
+    std::string appJson;
+    std::string userJson;
+    std::string policyJson;
+    // Encrypted mode: sealedInput replaces appJson and userJson, and is only
+    // decrypted inside the enclave (enclave/Channel.h)
+    bool encrypted = false;
+    uint32_t sessionId = 0;
+    std::string sealedInput;
+    // Input digest requested by the caller (INPUT_DIGEST_LEN bytes, see
+    // enclave/EnclaveCache.h); a sub-batch asks the enclave for digests when
+    // any of its requests wants one
+    bool wantDigest = false;
+    uint8_t digest[INPUT_DIGEST_LEN] = {};
+    napi_deferred deferred = nullptr;
+    PriorityClass priority = PRIORITY_REALTIME;
+    DispatchClock::time_point enqueuedAt;
+    DispatchClock::time_point deadline = DispatchClock::time_point::max();
+    int code = -1;
+};
+
+// Heap order for the EDF queue: the earliest deadline sits at the front
+struct LaterDeadline {
+    bool operator()(const PendingRequest* a, const PendingRequest* b) const {
+        if (a->deadline != b->deadline) return a->deadline > b->deadline;
+        return a->enqueuedAt > b->enqueuedAt;
+    }
+};
+
+// Per-priority queue, adaptive state and metrics
+struct DispatchLane {
+    std::vector<PendingRequest*> queue;   // binary heap, LaterDeadline
+    // Queued requests that carry a deadline, counted per DEADLINE_BUCKET_US
+    // of deadline, so admission control need not walk the heap
+    std::map<int64_t, size_t> deadlineBuckets;
+    // Enqueue times in arrival order, and those of requests already taken;
+    // taken times are dropped from the front lazily, so arrivals.front() is
+    // the oldest queued request
+    std::deque<DispatchClock::time_point> arrivals;
+    std::priority_queue<DispatchClock::time_point, std::vector<DispatchClock::time_point>,
+                        std::greater<DispatchClock::time_point>> departed;
+    uint32_t active = 0;                  // workers currently serving this lane
+    int64_t currentWeight = 0;            // smooth weighted round-robin state
+
+    // Adaptive state (guarded by the dispatcher mutex)
+    double arrivalGapUs = 1000.0;         // EWMA of inter-arrival gap
+    DispatchClock::time_point lastArrival;
+    bool hasArrival = false;
+    double sloScale = 1.0;                // shrinks when observed p99 misses the SLO
+    size_t batchLimit = 1;
+    uint32_t waitLimitUs = 0;
+
+    // Metrics
+    Log2Histogram batchSizes;
+    Log2Histogram queueDelayUs;
+    Log2Histogram latencyUs;
+    Log2Histogram windowLatencyUs;        // reset every adaptation window
+    std::atomic<uint64_t> flushesBySize{0};
+    std::atomic<uint64_t> flushesByTime{0};
+    std::atomic<uint64_t> admitted{0};
+    std::atomic<uint64_t> rejectedOverload{0};
+    std::atomic<uint64_t> droppedExpired{0};
+    std::atomic<uint64_t> metDeadline{0};     // goodput: answered before the deadline
+    std::atomic<uint64_t> missedDeadline{0};  // evaluated, but answered late
+};
+
+// Converts a histogram into { count, mean, p50, p95, p99, max, buckets }
+napi_value histogramToObject(napi_env env, const Log2Histogram& hist);
+
+// "realtime" / "bulk" for stats keys and JS options
+const char* priorityName(PriorityClass priority);
+bool parsePriorityName(const std::string& name, PriorityClass* out);
+
+class BatchDispatcher {
+public:
+    BatchDispatcher();
+    ~BatchDispatcher();
+
+    // Creates the completion callback and starts the flush workers
+    bool start(napi_env env);
+    // Flushes what is queued and joins the flush workers
+    void stop();
+    bool running() const { return running_; }
+
+    // Called on the JS thread; takes ownership of req. Returns false when the
+    // request was refused by admission control (its promise is already
+    // resolved with RESULT_OVERLOAD).
+    bool submit(napi_env env, PendingRequest* req);
+
+    void configure(const DispatcherConfig& config);
+    DispatcherConfig config();
+
+    // Fills a JS object with per-lane batch-size / queueing-delay / latency
+    // metrics and the shared ECALL service-time histogram
+    void fillStats(napi_env env, napi_value obj);
+    void resetStats();
+
+private:
+    void run(uint32_t workerId);
+    void spawnWorkersLocked();
+    int pickLaneLocked(DispatchClock::time_point now, DispatchClock::time_point* nextFlush);
+    bool laneHasCapacityLocked(int lane) const;
+    void takeBatchLocked(int lane, DispatchClock::time_point now,
+                         std::vector<PendingRequest*>& batch,
+                         std::vector<PendingRequest*>& expired);
+    void flush(int lane, std::vector<PendingRequest*>& batch,
+               std::vector<PendingRequest*>& expired);
+    void deliver(std::vector<PendingRequest*>* done);
+    DispatchClock::time_point flushAtLocked(int lane) const;
+    double estimateQueueDelayUsLocked(const PendingRequest* req,
+                                      DispatchClock::time_point now) const;
+    double serviceEstimateUs(size_t batchSize) const {
+        return serviceFixedUs_ + servicePerItemUs_ * (double)batchSize;
+    }
+    void observeBatch(size_t size, uint64_t serviceUs);
+    void recomputeLimits(int lane);
+
+    static void completeOnJsThread(napi_env env, napi_value jsCallback,
+                                   void* context, void* data);
+    static void settle(napi_env env, PendingRequest* req);
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    DispatchLane lanes_[PRIORITY_CLASSES];
+    std::vector<std::thread> workers_;
+    std::vector<DispatchClock::time_point> busyUntil_;  // per worker, estimated ECALL end
+    uint32_t busyWorkers_ = 0;
+    bool running_ = false;
+    napi_threadsafe_function completion_ = nullptr;
+    size_t inflight_ = 0;  // JS thread only
+
+    DispatcherConfig config_;
+
+    // Shared ECALL cost model (guarded by mutex_)
+    double fitW_ = 0, fitX_ = 0, fitY_ = 0, fitXX_ = 0, fitXY_ = 0;
+    double serviceFixedUs_ = 20.0;    // fitted ECALL cost: fixed + perItem * n
+    double servicePerItemUs_ = 2.0;
+
+    // Metrics
+    Log2Histogram serviceUs_;
+    std::atomic<uint64_t> ecallFailures_;
+};
+
+#endif // DISPATCHER_H
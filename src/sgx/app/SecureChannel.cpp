@@ -0,0 +1,91 @@
+#include "SecureChannel.h"
+#include "App.h"
+#include "PrivacyEvaluation_u.h"
+#include "../enclave/Channel.h"
+
+// SEC1 uncompressed point: 0x04 | X | Y
+#define SEC1_POINT_LEN (1 + CHANNEL_POINT_LEN)
+#define COORDINATE_LEN (CHANNEL_POINT_LEN / 2)
+
+// SEC1 coordinates are big-endian, the SGX ones little-endian
+static void reverseCoordinates(const uint8_t* in, uint8_t* out) {
+    for (int c = 0; c < 2; c++) {
+        for (int i = 0; i < COORDINATE_LEN; i++) {
+            out[c * COORDINATE_LEN + i] = in[c * COORDINATE_LEN + COORDINATE_LEN - 1 - i];
+        }
+    }
+}
+
+// OpenSecureChannel: ECDH with the enclave
+// Argument: the client's public key (Buffer, uncompressed SEC1 P-256 point)
+// Returns { sessionId, enclavePublicKey (Buffer, same encoding) }
+napi_value OpenSecureChannel(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    bool isBuffer = false;
+    if (argc >= 1) napi_is_buffer(env, args[0], &isBuffer);
+    void* data = nullptr;
+    size_t length = 0;
+    if (isBuffer) napi_get_buffer_info(env, args[0], &data, &length);
+    const uint8_t* point = static_cast<const uint8_t*>(data);
+    if (!isBuffer || length != SEC1_POINT_LEN || point[0] != 0x04) {
+        napi_throw_error(env, nullptr, "Expected an uncompressed P-256 public key (65-byte Buffer)");
+        return nullptr;
+    }
+    if (!enclave_initialized) {
+        napi_throw_error(env, nullptr, "Enclave not initialized");
+        return nullptr;
+    }
+
+    uint8_t clientPublic[CHANNEL_POINT_LEN];
+    uint8_t enclavePublic[CHANNEL_POINT_LEN];
+    reverseCoordinates(point + 1, clientPublic);
+    uint32_t sessionId = 0;
+    int ret = RESULT_ERROR;
+    if (ecall_channel_open(global_eid, &ret, clientPublic, enclavePublic, &sessionId) != SGX_SUCCESS ||
+        ret != 0) {
+        napi_throw_error(env, nullptr, ret == RESULT_UNAUTHENTICATED
+                                           ? "Client public key is not on P-256"
+                                           : "Enclave failed to open the channel");
+        return nullptr;
+    }
+
+    napi_value obj;
+    napi_create_object(env, &obj);
+    napi_value id;
+    napi_create_uint32(env, sessionId, &id);
+    napi_set_named_property(env, obj, "sessionId", id);
+
+    void* out = nullptr;
+    napi_value key;
+    napi_create_buffer(env, SEC1_POINT_LEN, &out, &key);
+    uint8_t* bytes = static_cast<uint8_t*>(out);
+    bytes[0] = 0x04;
+    reverseCoordinates(enclavePublic, bytes + 1);
+    napi_set_named_property(env, obj, "enclavePublicKey", key);
+    return obj;
+}
+
+// CloseSecureChannel: Forget a session's key
+// Returns false if the session was unknown (or already replaced)
+napi_value CloseSecureChannel(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    uint32_t sessionId = 0;
+    if (argc < 1 || napi_get_value_uint32(env, args[0], &sessionId) != napi_ok) {
+        napi_throw_error(env, nullptr, "Expected 1 argument: sessionId");
+        return nullptr;
+    }
+
+    int ret = RESULT_ERROR;
+    if (enclave_initialized) {
+        ecall_channel_close(global_eid, &ret, sessionId);
+    }
+    napi_value closed;
+    napi_get_boolean(env, ret == 0, &closed);
+    return closed;
+}
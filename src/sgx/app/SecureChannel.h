@@ -0,0 +1,20 @@
+#ifndef SECURE_CHANNEL_H
+#define SECURE_CHANNEL_H
+
+#include <node_api.h>
+
+// ============================================================================
+// Encrypted Request Channel Bindings
+// ============================================================================
+//
+// Session setup for enclave/Channel.h. Public keys cross the boundary as
+// 65-byte uncompressed SEC1 points (0x04 | X | Y, big-endian) as produced
+// by Node's crypto.createECDH("prime256v1"), and are converted here to the
+// little-endian coordinates of sgx_ec256_public_t. Requests sealed under a
+// session are submitted with evaluateEncryptedAsync (App.cpp).
+
+// Node.js addon functions
+napi_value OpenSecureChannel(napi_env env, napi_callback_info info);
+napi_value CloseSecureChannel(napi_env env, napi_callback_info info);
+
+#endif // SECURE_CHANNEL_H
@@ -0,0 +1,191 @@
+#include "SharedCache.h"
+#include "App.h"
+#include "../core/SharedDecisionCache.h"
+#include <string>
+
+// Keys up to this length are read without a heap allocation
+#define KEY_BUFFER_LEN 256
+
+static SharedDecisionCache* sharedCache = nullptr;
+static std::string sharedCacheName;
+
+static void setNumber(napi_env env, napi_value obj, const char* key, double value) {
+    napi_value v;
+    napi_create_double(env, value, &v);
+    napi_set_named_property(env, obj, key, v);
+}
+
+// Hashes the key string and policy version of a request into a cache key
+static bool readKey(napi_env env, napi_value keyValue, napi_value versionValue, Hash128* key,
+                    uint32_t* version) {
+    napi_valuetype type;
+    napi_typeof(env, versionValue, &type);
+    if (type == napi_number) {
+        double number = 0;
+        napi_get_value_double(env, versionValue, &number);
+        *version = (uint32_t)(int64_t)number;
+    } else if (type == napi_string) {
+        std::string text = extractString(env, versionValue);
+        *version = (uint32_t)hash64(text.data(), text.size());
+    } else {
+        return false;
+    }
+
+    char buffer[KEY_BUFFER_LEN];
+    size_t length = 0;
+    if (napi_get_value_string_utf8(env, keyValue, buffer, sizeof(buffer), &length) != napi_ok) {
+        return false;
+    }
+    if (length < sizeof(buffer) - 1) {
+        *key = SharedDecisionCache::makeKey(buffer, length, *version);
+    } else {
+        std::string text = extractString(env, keyValue);
+        *key = SharedDecisionCache::makeKey(text.data(), text.size(), *version);
+    }
+    return true;
+}
+
+static void releaseOnExit(void* arg) {
+    (void)arg;
+    delete sharedCache;
+    sharedCache = nullptr;
+}
+
+// OpenSharedCache: optional { name, capacity }. Attaches to (or creates) the
+// host-wide segment and returns { created, capacity, segmentBytes }.
+napi_value OpenSharedCache(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    std::string name = SHARED_CACHE_DEFAULT_NAME;
+    double capacity = SHARED_CACHE_DEFAULT_CAPACITY;
+    if (argc >= 1) {
+        napi_value value;
+        if (getOptionalProperty(env, args[0], "name", &value)) name = extractString(env, value);
+        getOptionalNumber(env, args[0], "capacity", &capacity);
+    }
+    if (capacity < 1 || capacity > (double)(1u << 31)) {
+        napi_throw_error(env, nullptr, "capacity must be between 1 and 2^31 entries");
+        return nullptr;
+    }
+
+    if (!sharedCache) {
+        sharedCache = new SharedDecisionCache();
+        napi_add_env_cleanup_hook(env, releaseOnExit, nullptr);
+    }
+    std::string error;
+    if (!sharedCache->open(name, (uint32_t)capacity, &error)) {
+        napi_throw_error(env, nullptr, error.c_str());
+        return nullptr;
+    }
+    sharedCacheName = name;
+
+    SharedCacheStats stats = sharedCache->stats();
+    napi_value result;
+    napi_create_object(env, &result);
+    napi_value created;
+    napi_get_boolean(env, stats.created, &created);
+    napi_set_named_property(env, result, "created", created);
+    setNumber(env, result, "capacity", stats.capacity);
+    setNumber(env, result, "segmentBytes", (double)stats.segmentBytes);
+    return result;
+}
+
+// SharedCacheGet: key, policyVersion (string or number). Returns the
+// EvaluationResult code of a live entry, or null on a miss.
+napi_value SharedCacheGet(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    napi_value result;
+    napi_get_null(env, &result);
+    Hash128 key;
+    uint32_t version;
+    if (!sharedCache || !sharedCache->isOpen() || argc < 2 ||
+        !readKey(env, args[0], args[1], &key, &version)) {
+        return result;
+    }
+
+    int8_t code;
+    if (sharedCache->lookup(key, version, &code)) {
+        napi_create_int32(env, code, &result);
+    }
+    return result;
+}
+
+// SharedCacheSet: key, policyVersion, code, ttlSeconds. Returns false when
+// the entry could not be stored (cache closed or every slot busy).
+napi_value SharedCacheSet(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    bool stored = false;
+    Hash128 key;
+    uint32_t version;
+    double code = 0;
+    double ttlSeconds = 0;
+    if (sharedCache && sharedCache->isOpen() && argc >= 4 &&
+        readKey(env, args[0], args[1], &key, &version) &&
+        napi_get_value_double(env, args[2], &code) == napi_ok &&
+        napi_get_value_double(env, args[3], &ttlSeconds) == napi_ok && ttlSeconds >= 1) {
+        uint32_t ttl = ttlSeconds > 4294967295.0 ? 0xFFFFFFFFu : (uint32_t)ttlSeconds;
+        stored = sharedCache->insert(key, version, (int8_t)code, ttl);
+    }
+
+    napi_value result;
+    napi_get_boolean(env, stored, &result);
+    return result;
+}
+
+// ClearSharedCache: invalidates every entry for all attached processes
+napi_value ClearSharedCache(napi_env env, napi_callback_info info) {
+    (void)info;
+    if (sharedCache && sharedCache->isOpen()) sharedCache->clear();
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// GetSharedCacheStats: counters summed over every attached process
+napi_value GetSharedCacheStats(napi_env env, napi_callback_info info) {
+    (void)info;
+    napi_value result;
+    if (!sharedCache || !sharedCache->isOpen()) {
+        napi_get_null(env, &result);
+        return result;
+    }
+
+    SharedCacheStats stats = sharedCache->stats();
+    napi_create_object(env, &result);
+    setNumber(env, result, "capacity", stats.capacity);
+    setNumber(env, result, "segmentBytes", (double)stats.segmentBytes);
+    setNumber(env, result, "hits", (double)stats.hits);
+    setNumber(env, result, "misses", (double)stats.misses);
+    setNumber(env, result, "inserts", (double)stats.inserts);
+    setNumber(env, result, "evictions", (double)stats.evictions);
+    setNumber(env, result, "contended", (double)stats.contended);
+    setNumber(env, result, "reclaimed", (double)stats.reclaimed);
+    return result;
+}
+
+// CloseSharedCache: optional { remove }. Detaches this process; the segment
+// stays for the others unless remove is set (attached processes keep their
+// mapping, new ones create a fresh segment).
+napi_value CloseSharedCache(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    bool remove = false;
+    if (argc >= 1) getOptionalBool(env, args[0], "remove", &remove);
+    if (sharedCache) sharedCache->close();
+    if (remove && !sharedCacheName.empty()) SharedDecisionCache::remove(sharedCacheName);
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
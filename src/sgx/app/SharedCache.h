@@ -0,0 +1,23 @@
+#ifndef SHARED_CACHE_H
+#define SHARED_CACHE_H
+
+#include <node_api.h>
+
+// ============================================================================
+// Shared Decision Cache Bindings
+// ============================================================================
+//
+// Exposes core/SharedDecisionCache.h to the API server so that every
+// validator on a host answers repeat requests from one shared-memory table
+// instead of querying EvaluateHash in MongoDB. Calls are synchronous and
+// take well under a microsecond; they run on the JS thread only.
+
+// Node.js addon functions
+napi_value OpenSharedCache(napi_env env, napi_callback_info info);
+napi_value SharedCacheGet(napi_env env, napi_callback_info info);
+napi_value SharedCacheSet(napi_env env, napi_callback_info info);
+napi_value ClearSharedCache(napi_env env, napi_callback_info info);
+napi_value GetSharedCacheStats(napi_env env, napi_callback_info info);
+napi_value CloseSharedCache(napi_env env, napi_callback_info info);
+
+#endif // SHARED_CACHE_H
@@ -0,0 +1,182 @@
+#include "Snapshot.h"
+#include "App.h"
+#include "PrivacyEvaluation_u.h"
+#include "../enclave/EnclaveCache.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// The caches can grow between sizing and sealing; give up after this many
+// resized attempts
+#define SEAL_ATTEMPTS 4
+
+static void setNumber(napi_env env, napi_value obj, const char* key, double value) {
+    napi_value v;
+    napi_create_double(env, value, &v);
+    napi_set_named_property(env, obj, key, v);
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+static const char* snapshotError(int code) {
+    switch (code) {
+        case SNAPSHOT_ERR_BUFFER: return "Enclave caches kept growing while sealing";
+        case SNAPSHOT_ERR_SEAL: return "Enclave failed to seal or unseal the snapshot";
+        case SNAPSHOT_ERR_INVALID: return "Snapshot is corrupt or from another enclave build";
+        default: return "Snapshot ECALL failed";
+    }
+}
+
+// Writes next to the target and renames over it, so a crash mid-write
+// leaves the previous snapshot intact
+static bool writeFileAtomic(const std::string& path, const std::vector<uint8_t>& data,
+                            std::string* error) {
+    std::string tmpPath = path + ".tmp";
+    FILE* file = fopen(tmpPath.c_str(), "wb");
+    if (!file) {
+        *error = "Cannot open " + tmpPath + ": " + strerror(errno);
+        return false;
+    }
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size() &&
+                   fflush(file) == 0 && fsync(fileno(file)) == 0;
+    if (fclose(file) != 0) written = false;
+    if (!written || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        *error = "Cannot write " + path + ": " + strerror(errno);
+        unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Sets *missing when there is no snapshot yet
+static bool readFile(const std::string& path, std::vector<uint8_t>* data, bool* missing,
+                     std::string* error) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        *missing = errno == ENOENT;
+        *error = "Cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data->insert(data->end(), chunk, chunk + n);
+    }
+    bool ok = !ferror(file);
+    fclose(file);
+    if (!ok) *error = "Cannot read " + path;
+    return ok;
+}
+
+static bool getPath(napi_env env, napi_callback_info info, std::string* path) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    if (argc < 1) {
+        napi_throw_error(env, nullptr, "Expected 1 argument: path");
+        return false;
+    }
+    if (!enclave_initialized) {
+        napi_throw_error(env, nullptr, "Enclave not initialized");
+        return false;
+    }
+    *path = extractString(env, args[0]);
+    return true;
+}
+
+// SaveEnclaveSnapshot: Seal the enclave caches to `path`
+// Returns { bytes, policies, decisions, sealMs }
+napi_value SaveEnclaveSnapshot(napi_env env, napi_callback_info info) {
+    std::string path;
+    if (!getPath(env, info, &path)) return nullptr;
+
+    auto start = std::chrono::steady_clock::now();
+    int ret = SNAPSHOT_ERR_BUFFER;
+    size_t capacity = 0;
+    if (ecall_snapshot_size(global_eid, &ret, &capacity) != SGX_SUCCESS || ret != SNAPSHOT_OK) {
+        napi_throw_error(env, nullptr, snapshotError(ret));
+        return nullptr;
+    }
+
+    std::vector<uint8_t> sealed;
+    size_t written = 0, policies = 0, decisions = 0;
+    for (int attempt = 0; attempt < SEAL_ATTEMPTS; attempt++) {
+        sealed.resize(capacity);
+        if (ecall_seal_snapshot(global_eid, &ret, sealed.data(), sealed.size(), &written,
+                                &policies, &decisions) != SGX_SUCCESS) {
+            ret = SNAPSHOT_ERR_SEAL;
+            break;
+        }
+        if (ret != SNAPSHOT_ERR_BUFFER) break;
+        capacity = written;
+    }
+    if (ret != SNAPSHOT_OK) {
+        napi_throw_error(env, nullptr, snapshotError(ret));
+        return nullptr;
+    }
+    sealed.resize(written);
+    double sealMs = elapsedMs(start);
+
+    std::string error;
+    if (!writeFileAtomic(path, sealed, &error)) {
+        napi_throw_error(env, nullptr, error.c_str());
+        return nullptr;
+    }
+
+    napi_value obj;
+    napi_create_object(env, &obj);
+    setNumber(env, obj, "bytes", (double)written);
+    setNumber(env, obj, "policies", (double)policies);
+    setNumber(env, obj, "decisions", (double)decisions);
+    setNumber(env, obj, "sealMs", sealMs);
+    return obj;
+}
+
+// LoadEnclaveSnapshot: Restore the enclave caches from `path`
+// Returns { bytes, policies, decisions, unsealMs }, or null when the file
+// does not exist. Throws if the snapshot does not unseal or validate; the
+// caches are left as they were.
+napi_value LoadEnclaveSnapshot(napi_env env, napi_callback_info info) {
+    std::string path;
+    if (!getPath(env, info, &path)) return nullptr;
+
+    std::vector<uint8_t> sealed;
+    bool missing = false;
+    std::string error;
+    if (!readFile(path, &sealed, &missing, &error)) {
+        if (missing) {
+            napi_value null;
+            napi_get_null(env, &null);
+            return null;
+        }
+        napi_throw_error(env, nullptr, error.c_str());
+        return nullptr;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    int ret = SNAPSHOT_ERR_INVALID;
+    size_t policies = 0, decisions = 0;
+    if (sealed.empty() ||
+        ecall_unseal_snapshot(global_eid, &ret, sealed.data(), sealed.size(), &policies,
+                              &decisions) != SGX_SUCCESS) {
+        ret = sealed.empty() ? SNAPSHOT_ERR_INVALID : SNAPSHOT_ERR_SEAL;
+    }
+    if (ret != SNAPSHOT_OK) {
+        napi_throw_error(env, nullptr, snapshotError(ret));
+        return nullptr;
+    }
+
+    napi_value obj;
+    napi_create_object(env, &obj);
+    setNumber(env, obj, "bytes", (double)sealed.size());
+    setNumber(env, obj, "policies", (double)policies);
+    setNumber(env, obj, "decisions", (double)decisions);
+    setNumber(env, obj, "unsealMs", elapsedMs(start));
+    return obj;
+}
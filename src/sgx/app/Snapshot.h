@@ -0,0 +1,19 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <node_api.h>
+
+// ============================================================================
+// Sealed Enclave Snapshot Bindings
+// ============================================================================
+//
+// Saves the enclave's compiled policies and decision cache to disk, sealed
+// to this enclave build (enclave/Seal.cpp), and restores them after a
+// restart so the validator starts warm. The file is opaque outside the
+// enclave; a snapshot from a different enclave build fails to unseal.
+
+// Node.js addon functions
+napi_value SaveEnclaveSnapshot(napi_env env, napi_callback_info info);
+napi_value LoadEnclaveSnapshot(napi_env env, napi_callback_info info);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,144 @@
+#include "Bench.h"
+#include "Workload.h"
+#include "../enclave/ConstantTime.h"
+#include "../enclave/PolicyLayout.h"
+#include <algorithm>
+
+// ============================================================================
+// App Normalization Benchmark
+// ============================================================================
+
+struct AppNormalizationRun : BenchRun {
+    size_t attributes = 1023;
+    size_t purposes = 255;
+    size_t allowIds = 4;
+    size_t appNodes = 8;             // distinct nodes each tree asks for
+    size_t ancestors = 3;            // listed along with each of them
+    double minUs = 200000;           // timed per kernel
+
+    double rawNodes = 0;             // per app, both trees
+    double minimizedNodes = 0;
+    double minimizeNs = 0;
+    double evaluateNs = 0;
+    double evaluateMinimizedNs = 0;
+    double layoutNs = 0;
+    double layoutMinimizedNs = 0;
+    uint64_t mismatches = 0;
+
+    void execute() override;
+    void report(napi_env env, napi_value obj) override;
+};
+
+// count random nodes of a heap-ordered tree, each after up to ancestors of
+// its ancestors, as apps list "Contact" ahead of "Email" and "Phone"
+static void listWithAncestors(const std::vector<PolicyNode>& tree, size_t count,
+                              size_t ancestors, uint32_t* seed, std::vector<PolicyNode>* out) {
+    out->clear();
+    for (size_t k = 0; k < count; k++) {
+        size_t index = nextRandom(seed) % tree.size();
+        size_t first = out->size();
+        out->push_back(tree[index]);
+        for (size_t a = 0; a < ancestors && index > 0; a++) {
+            index = (index - 1) / 2;
+            out->push_back(tree[index]);
+        }
+        std::reverse(out->begin() + first, out->end());
+    }
+}
+
+void AppNormalizationRun::execute() {
+    SyntheticWorkload w;
+    buildPreferenceWorkload(attributes, purposes, allowIds, 1, &w);
+    uint32_t seed = 11;
+    for (AppRequest& app : w.apps) {
+        listWithAncestors(w.policy.attributes, appNodes, ancestors, &seed, &app.attributes);
+        listWithAncestors(w.policy.purposes, appNodes, ancestors, &seed, &app.purposes);
+    }
+    std::vector<AppRequest> minimized = w.apps;
+    for (AppRequest& app : minimized) minimizeAppRequest(&app);
+
+    PolicyLayout layout;
+    compilePolicyLayout(w.policy, &layout);
+    CtPolicy constantTime;
+    compileConstantTime(w.policy, &constantTime);
+
+    for (size_t v = 0; v < SYNTHETIC_VARIANTS; v++) {
+        const AppRequest& app = w.apps[v];
+        const UserPreference& user = w.users[v];
+        rawNodes += app.attributes.size() + app.purposes.size();
+        minimizedNodes += minimized[v].attributes.size() + minimized[v].purposes.size();
+        EvaluationResult expected = evaluate(app, user, w.policy);
+        if (evaluate(minimized[v], user, w.policy) != expected ||
+            evaluateLayout(minimized[v], user, layout) != expected ||
+            evaluateConstantTime(minimized[v], user, constantTime) != expected) {
+            mismatches++;
+        }
+    }
+    rawNodes /= SYNTHETIC_VARIANTS;
+    minimizedNodes /= SYNTHETIC_VARIANTS;
+
+    size_t mask = SYNTHETIC_VARIANTS - 1;
+    AppRequest scratch;
+    minimizeNs = timePerCall(minUs, [&](size_t i) {
+        scratch = w.apps[i & mask];
+        minimizeAppRequest(&scratch);
+        return (int)scratch.attributes.size();
+    });
+    // The copy alone, so minimizeNs is the minimization
+    minimizeNs -= timePerCall(minUs, [&](size_t i) {
+        scratch = w.apps[i & mask];
+        return (int)scratch.attributes.size();
+    });
+    evaluateNs = timePerCall(minUs, [&](size_t i) {
+        return (int)evaluate(w.apps[i & mask], w.users[i & mask], w.policy);
+    });
+    evaluateMinimizedNs = timePerCall(minUs, [&](size_t i) {
+        return (int)evaluate(minimized[i & mask], w.users[i & mask], w.policy);
+    });
+    layoutNs = timePerCall(minUs, [&](size_t i) {
+        return (int)evaluateLayout(w.apps[i & mask], w.users[i & mask], layout);
+    });
+    layoutMinimizedNs = timePerCall(minUs, [&](size_t i) {
+        return (int)evaluateLayout(minimized[i & mask], w.users[i & mask], layout);
+    });
+}
+
+void AppNormalizationRun::report(napi_env env, napi_value obj) {
+    setNumber(env, obj, "attributes", (double)attributes);
+    setNumber(env, obj, "purposes", (double)purposes);
+    setNumber(env, obj, "allowIds", (double)allowIds);
+    setNumber(env, obj, "appNodes", (double)appNodes);
+    setNumber(env, obj, "ancestors", (double)ancestors);
+    setNumber(env, obj, "rawNodes", rawNodes);
+    setNumber(env, obj, "minimizedNodes", minimizedNodes);
+    setNumber(env, obj, "minimizeNs", minimizeNs);
+    setNumber(env, obj, "evaluateNs", evaluateNs);
+    setNumber(env, obj, "evaluateMinimizedNs", evaluateMinimizedNs);
+    setNumber(env, obj, "layoutNs", layoutNs);
+    setNumber(env, obj, "layoutMinimizedNs", layoutMinimizedNs);
+    setNumber(env, obj, "mismatches", (double)mismatches);
+}
+
+// BenchmarkAppNormalization: Time evaluate() and evaluateLayout() on apps
+// that list each requested node after some of its ancestors, before and
+// after minimizeAppRequest(), and the minimization itself, untrusted.
+// Mismatches count apps whose minimized form gets another decision from
+// evaluate(), evaluateLayout() or evaluateConstantTime().
+// Options { attributes, purposes, allowIds, appNodes, ancestors, minUs }
+// Returns a Promise resolving to { attributes, purposes, allowIds,
+// appNodes, ancestors, rawNodes, minimizedNodes, minimizeNs, evaluateNs,
+// evaluateMinimizedNs, layoutNs, layoutMinimizedNs, mismatches }
+napi_value BenchmarkAppNormalization(napi_env env, napi_callback_info info) {
+    BenchOptions options(env, info);
+    AppNormalizationRun* run = new AppNormalizationRun();
+    options.count("attributes", 1, &run->attributes);
+    options.count("purposes", 1, &run->purposes);
+    options.count("allowIds", 1, &run->allowIds);
+    options.count("appNodes", 1, &run->appNodes);
+    options.count("ancestors", 0, &run->ancestors);
+    double number;
+    if (options.number("minUs", &number) && number > 0) {
+        run->minUs = number;
+    }
+    return startBenchmark(env, "benchmarkAppNormalization", run);
+}
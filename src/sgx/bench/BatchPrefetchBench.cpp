@@ -0,0 +1,110 @@
+#include "Bench.h"
+#include "Workload.h"
+#include "../enclave/PolicyLayout.h"
+#include <algorithm>
+
+// ============================================================================
+// Batch Prefetch Benchmark
+// ============================================================================
+
+struct BatchPrefetchRun : BenchRun {
+    size_t nodes = 1000000;          // attributes; purposes get a quarter
+    size_t requests = 262144;        // distinct apps and preferences
+    size_t allowIds = 4;
+    double minUs = 200000;           // timed per distance
+    std::vector<size_t> distances = { 0, 1, 2, 4, 8, 16, 32 };
+
+    double compileUs = 0;
+    double layoutBytes = 0;          // hot columns, index and pool
+    std::vector<double> ns;          // per request, per distance
+    uint64_t mismatches = 0;
+
+    void execute() override;
+    void report(napi_env env, napi_value obj) override;
+};
+
+void BatchPrefetchRun::execute() {
+    SyntheticWorkload w;
+    buildPreferenceWorkload(nodes, std::max<size_t>(3, nodes / 4), allowIds, 3, &w,
+                            requests);
+
+    PolicyLayout layout;
+    BenchClock::time_point start = BenchClock::now();
+    compilePolicyLayout(w.policy, &layout);
+    compileUs = (double)elapsedUs(start);
+    for (const TreeLayout* tree : { &layout.attributes, &layout.purposes }) {
+        layoutBytes += (double)(tree->hotBytes() + tree->indexBytes() + tree->coldBytes());
+    }
+
+    // Request i pairs app i with a scattered preference, so consecutive
+    // requests share no lines
+    std::vector<LayoutRequest> batch(requests);
+    for (size_t i = 0; i < requests; i++) {
+        batch[i].app = &w.apps[i];
+        batch[i].user = &w.users[(i * 7919) % requests];
+    }
+
+    std::vector<int> expected(requests), results(requests);
+    evaluateLayoutBatch(batch.data(), batch.size(), layout, 0, expected.data());
+    for (size_t distance : distances) {
+        size_t rounds = 0;
+        uint64_t elapsed;
+        start = BenchClock::now();
+        do {
+            evaluateLayoutBatch(batch.data(), batch.size(), layout, distance, results.data());
+            rounds++;
+            elapsed = elapsedUs(start);
+        } while ((double)elapsed < minUs);
+        ns.push_back(elapsed * 1000.0 / (rounds * requests));
+        for (size_t i = 0; i < requests; i++) {
+            if (results[i] != expected[i]) mismatches++;
+        }
+    }
+}
+
+void BatchPrefetchRun::report(napi_env env, napi_value obj) {
+    setNumber(env, obj, "nodes", (double)nodes);
+    setNumber(env, obj, "requests", (double)requests);
+    setNumber(env, obj, "allowIds", (double)allowIds);
+    setNumber(env, obj, "compileUs", compileUs);
+    setNumber(env, obj, "layoutBytes", layoutBytes);
+
+    napi_value list;
+    napi_create_array_with_length(env, distances.size(), &list);
+    for (size_t d = 0; d < distances.size(); d++) {
+        napi_value entry;
+        napi_create_object(env, &entry);
+        setNumber(env, entry, "distance", (double)distances[d]);
+        setNumber(env, entry, "ns", ns[d]);
+        setNumber(env, entry, "speedup", ns[0] / ns[d]);
+        napi_set_element(env, list, d, entry);
+    }
+    napi_set_named_property(env, obj, "distances", list);
+    setNumber(env, obj, "mismatches", (double)mismatches);
+}
+
+// BenchmarkBatchPrefetch: Time evaluateLayoutBatch() at several prefetch
+// distances against the plain loop (distance 0) on a policy larger than the
+// last-level cache, untrusted. Options { nodes, requests, allowIds, minUs,
+// distances: [...] }; distances without 0 get it added as the baseline
+// Returns a Promise resolving to { nodes, requests, allowIds, compileUs,
+// layoutBytes, distances: [{ distance, ns, speedup }], mismatches }
+napi_value BenchmarkBatchPrefetch(napi_env env, napi_callback_info info) {
+    BenchOptions options(env, info);
+    BatchPrefetchRun* run = new BatchPrefetchRun();
+    options.count("nodes", 1, &run->nodes);
+    options.count("requests", 1, &run->requests);
+    options.count("allowIds", 1, &run->allowIds);
+    double number;
+    if (options.number("minUs", &number) && number > 0) {
+        run->minUs = number;
+    }
+    std::vector<double> distances;
+    if (options.numbers("distances", &distances)) {
+        run->distances.assign(1, 0);
+        for (double distance : distances) {
+            if (distance >= 1) run->distances.push_back((size_t)distance);
+        }
+    }
+    return startBenchmark(env, "benchmarkBatchPrefetch", run);
+}
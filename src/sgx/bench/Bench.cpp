@@ -0,0 +1,181 @@
+#include "Bench.h"
+
+// ============================================================================
+// Runner
+// ============================================================================
+
+static void executeRun(napi_env env, void* data) {
+    static_cast<BenchRun*>(data)->execute();
+}
+
+static void completeRun(napi_env env, napi_status status, void* data) {
+    BenchRun* run = static_cast<BenchRun*>(data);
+
+    napi_value obj;
+    napi_create_object(env, &obj);
+    run->report(env, obj);
+
+    napi_resolve_deferred(env, run->deferred, obj);
+    napi_delete_async_work(env, run->work);
+    delete run;
+}
+
+napi_value startBenchmark(napi_env env, const char* name, BenchRun* run) {
+    napi_value promise, resource;
+    napi_create_promise(env, &run->deferred, &promise);
+    napi_create_string_utf8(env, name, NAPI_AUTO_LENGTH, &resource);
+    napi_create_async_work(env, nullptr, resource, executeRun, completeRun, run, &run->work);
+    napi_queue_async_work(env, run->work);
+    return promise;
+}
+
+void setNumber(napi_env env, napi_value obj, const char* key, double value) {
+    napi_value v;
+    napi_create_double(env, value, &v);
+    napi_set_named_property(env, obj, key, v);
+}
+
+// ============================================================================
+// Options
+// ============================================================================
+
+BenchOptions::BenchOptions(napi_env env, napi_callback_info info) : env_(env), options_(nullptr) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1 && napi_typeof(env, args[0], &type) == napi_ok && type == napi_object) {
+        options_ = args[0];
+    }
+}
+
+bool BenchOptions::property(const char* key, napi_value* out) const {
+    bool has = false;
+    if (!options_ || napi_has_named_property(env_, options_, key, &has) != napi_ok || !has) {
+        return false;
+    }
+    return napi_get_named_property(env_, options_, key, out) == napi_ok;
+}
+
+bool BenchOptions::number(const char* key, double* out) const {
+    napi_value value;
+    double number;
+    if (!property(key, &value) || napi_get_value_double(env_, value, &number) != napi_ok) {
+        return false;
+    }
+    *out = number;
+    return true;
+}
+
+bool BenchOptions::flag(const char* key, bool* out) const {
+    napi_value value;
+    bool flag;
+    if (!property(key, &value) || napi_get_value_bool(env_, value, &flag) != napi_ok) {
+        return false;
+    }
+    *out = flag;
+    return true;
+}
+
+bool BenchOptions::numbers(const char* key, std::vector<double>* out) const {
+    napi_value list;
+    bool isArray = false;
+    if (!property(key, &list) || napi_is_array(env_, list, &isArray) != napi_ok || !isArray) {
+        return false;
+    }
+    uint32_t length = 0;
+    napi_get_array_length(env_, list, &length);
+    out->clear();
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value item;
+        double number;
+        napi_get_element(env_, list, i, &item);
+        if (napi_get_value_double(env_, item, &number) == napi_ok) {
+            out->push_back(number);
+        }
+    }
+    return true;
+}
+
+void BenchOptions::count(const char* key, size_t min, size_t* out) const {
+    double number;
+    if (this->number(key, &number) && number >= (double)min) {
+        *out = (size_t)number;
+    }
+}
+
+// ============================================================================
+// Module Initialization
+// ============================================================================
+
+napi_value Init(napi_env env, napi_value exports) {
+    napi_value scalingFn;
+    napi_create_function(env, "benchmarkWorkStealing", NAPI_AUTO_LENGTH,
+                        BenchmarkWorkStealing, nullptr, &scalingFn);
+    napi_set_named_property(env, exports, "benchmarkWorkStealing", scalingFn);
+
+    napi_value constantTimeFn;
+    napi_create_function(env, "benchmarkConstantTime", NAPI_AUTO_LENGTH,
+                        BenchmarkConstantTime, nullptr, &constantTimeFn);
+    napi_set_named_property(env, exports, "benchmarkConstantTime", constantTimeFn);
+
+    napi_value specializedFn;
+    napi_create_function(env, "benchmarkSpecializedPolicy", NAPI_AUTO_LENGTH,
+                        BenchmarkSpecializedPolicy, nullptr, &specializedFn);
+    napi_set_named_property(env, exports, "benchmarkSpecializedPolicy", specializedFn);
+
+    napi_value preferenceTablesFn;
+    napi_create_function(env, "benchmarkPreferenceTables", NAPI_AUTO_LENGTH,
+                        BenchmarkPreferenceTables, nullptr, &preferenceTablesFn);
+    napi_set_named_property(env, exports, "benchmarkPreferenceTables", preferenceTablesFn);
+
+    napi_value calibratePlannerFn;
+    napi_create_function(env, "calibratePlanner", NAPI_AUTO_LENGTH,
+                        CalibratePlanner, nullptr, &calibratePlannerFn);
+    napi_set_named_property(env, exports, "calibratePlanner", calibratePlannerFn);
+
+    napi_value shortCircuitFn;
+    napi_create_function(env, "benchmarkShortCircuit", NAPI_AUTO_LENGTH,
+                        BenchmarkShortCircuit, nullptr, &shortCircuitFn);
+    napi_set_named_property(env, exports, "benchmarkShortCircuit", shortCircuitFn);
+
+    napi_value policyLayoutFn;
+    napi_create_function(env, "benchmarkPolicyLayout", NAPI_AUTO_LENGTH,
+                        BenchmarkPolicyLayout, nullptr, &policyLayoutFn);
+    napi_set_named_property(env, exports, "benchmarkPolicyLayout", policyLayoutFn);
+
+    napi_value batchPrefetchFn;
+    napi_create_function(env, "benchmarkBatchPrefetch", NAPI_AUTO_LENGTH,
+                        BenchmarkBatchPrefetch, nullptr, &batchPrefetchFn);
+    napi_set_named_property(env, exports, "benchmarkBatchPrefetch", batchPrefetchFn);
+
+    napi_value objectIdFn;
+    napi_create_function(env, "benchmarkObjectIdIngestion", NAPI_AUTO_LENGTH,
+                        BenchmarkObjectIdIngestion, nullptr, &objectIdFn);
+    napi_set_named_property(env, exports, "benchmarkObjectIdIngestion", objectIdFn);
+
+    napi_value largeRequestFn;
+    napi_create_function(env, "benchmarkLargeRequest", NAPI_AUTO_LENGTH,
+                        BenchmarkLargeRequest, nullptr, &largeRequestFn);
+    napi_set_named_property(env, exports, "benchmarkLargeRequest", largeRequestFn);
+
+    napi_value appNormalizationFn;
+    napi_create_function(env, "benchmarkAppNormalization", NAPI_AUTO_LENGTH,
+                        BenchmarkAppNormalization, nullptr, &appNormalizationFn);
+    napi_set_named_property(env, exports, "benchmarkAppNormalization", appNormalizationFn);
+
+    napi_value succinctTreeFn;
+    napi_create_function(env, "benchmarkSuccinctTree", NAPI_AUTO_LENGTH,
+                        BenchmarkSuccinctTree, nullptr, &succinctTreeFn);
+    napi_set_named_property(env, exports, "benchmarkSuccinctTree", succinctTreeFn);
+
+    napi_value policyDagFn;
+    napi_create_function(env, "benchmarkPolicyDag", NAPI_AUTO_LENGTH,
+                        BenchmarkPolicyDag, nullptr, &policyDagFn);
+    napi_set_named_property(env, exports, "benchmarkPolicyDag", policyDagFn);
+
+    return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
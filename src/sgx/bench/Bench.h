@@ -0,0 +1,91 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <node_api.h>
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+
+// ============================================================================
+// Benchmark Runner
+// ============================================================================
+//
+// Micro-benchmarks of the native evaluation kernels. They run untrusted and
+// ship as their own addon (bench-addon.node), so the validator addon exports
+// none of them and links no profiling code. Each harness is a BenchRun:
+// execute() runs on a libuv worker thread, report() fills the object the
+// returned Promise resolves to on the JS thread.
+
+typedef std::chrono::steady_clock BenchClock;
+
+struct BenchRun {
+    virtual ~BenchRun() {}
+    virtual void execute() = 0;
+    virtual void report(napi_env env, napi_value result) = 0;
+
+    napi_deferred deferred = nullptr;
+    napi_async_work work = nullptr;
+};
+
+// Queue run on the libuv pool and return its Promise; takes ownership of run
+napi_value startBenchmark(napi_env env, const char* name, BenchRun* run);
+
+// Options object passed as a harness's first argument; every read leaves
+// *out untouched when the option is absent or has the wrong type
+class BenchOptions {
+public:
+    BenchOptions(napi_env env, napi_callback_info info);
+
+    bool number(const char* key, double* out) const;
+    bool flag(const char* key, bool* out) const;
+    // Numeric elements of an array option; non-numbers are skipped
+    bool numbers(const char* key, std::vector<double>* out) const;
+    // Integer option of at least min
+    void count(const char* key, size_t min, size_t* out) const;
+
+private:
+    bool property(const char* key, napi_value* out) const;
+
+    napi_env env_;
+    napi_value options_;
+};
+
+void setNumber(napi_env env, napi_value obj, const char* key, double value);
+
+inline uint64_t elapsedUs(BenchClock::time_point from) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        BenchClock::now() - from).count();
+}
+
+// Calls kernel(0), kernel(1), ... until minUs have passed; ns per call
+template <typename Kernel>
+double timePerCall(double minUs, Kernel kernel) {
+    size_t calls = 0;
+    int acc = 0;
+    uint64_t elapsed;
+    BenchClock::time_point start = BenchClock::now();
+    do {
+        for (int b = 0; b < 16; b++, calls++) acc += kernel(calls);
+        elapsed = elapsedUs(start);
+    } while ((double)elapsed < minUs);
+    volatile int sink = acc;
+    (void)sink;
+    return elapsed * 1000.0 / calls;
+}
+
+// Harnesses exported by bench-addon.node
+napi_value BenchmarkWorkStealing(napi_env env, napi_callback_info info);
+napi_value BenchmarkConstantTime(napi_env env, napi_callback_info info);
+napi_value BenchmarkSpecializedPolicy(napi_env env, napi_callback_info info);
+napi_value BenchmarkPreferenceTables(napi_env env, napi_callback_info info);
+napi_value CalibratePlanner(napi_env env, napi_callback_info info);
+napi_value BenchmarkShortCircuit(napi_env env, napi_callback_info info);
+napi_value BenchmarkPolicyLayout(napi_env env, napi_callback_info info);
+napi_value BenchmarkBatchPrefetch(napi_env env, napi_callback_info info);
+napi_value BenchmarkObjectIdIngestion(napi_env env, napi_callback_info info);
+napi_value BenchmarkLargeRequest(napi_env env, napi_callback_info info);
+napi_value BenchmarkAppNormalization(napi_env env, napi_callback_info info);
+napi_value BenchmarkSuccinctTree(napi_env env, napi_callback_info info);
+napi_value BenchmarkPolicyDag(napi_env env, napi_callback_info info);
+
+#endif // BENCH_H
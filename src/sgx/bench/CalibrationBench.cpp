@@ -0,0 +1,246 @@
+#include "Bench.h"
+#include "Workload.h"
+#include "../enclave/EvaluationPlanner.h"
+#include "../enclave/PreferenceTable.h"
+#include <algorithm>
+
+// ============================================================================
+// Planner Calibration
+// ============================================================================
+
+// Per-call costs are kept in this order: evaluate(), evaluateSorted(),
+// compilePreference(), evaluateCompiled()
+#define CALIBRATION_KERNELS 4
+
+struct CalibrationShape {
+    size_t attributes;
+    size_t allowIds;
+    size_t appNodes;
+    double ns[CALIBRATION_KERNELS];
+    double ops[CALIBRATION_KERNELS];     // mean PlanShape counts
+    EvaluationStrategy best;             // measured
+    EvaluationStrategy planned;          // fitted constants
+    EvaluationStrategy plannedDefault;   // compiled-in constants
+};
+
+struct CalibrationRun : BenchRun {
+    double minUs = 20000;        // timed per kernel and shape
+    double expectedUses = 1;     // evaluations a table is amortized over
+
+    std::vector<CalibrationShape> shapes;
+    PlannerCosts fitted;
+    PlannerCosts defaults;
+    uint64_t mismatches = 0;
+
+    void execute() override;
+    void report(napi_env env, napi_value obj) override;
+};
+
+// Fits ns = fixedNs + perOpNs * ops by least squares on the relative error
+// (weights 1/ns^2, as the shapes span orders of magnitude), keeping both
+// terms non-negative
+static StrategyCost fitCost(const std::vector<CalibrationShape>& shapes, int kernel) {
+    double sw = 0, swx = 0, swy = 0, swxx = 0, swxy = 0;
+    for (const CalibrationShape& shape : shapes) {
+        double x = shape.ops[kernel], y = shape.ns[kernel];
+        double w = 1.0 / (y * y);
+        sw += w;
+        swx += w * x;
+        swy += w * y;
+        swxx += w * x * x;
+        swxy += w * x * y;
+    }
+    StrategyCost cost = { swy / sw, 0 };
+    double det = sw * swxx - swx * swx;
+    if (det <= 0) return cost;
+    cost.perOpNs = (sw * swxy - swx * swy) / det;
+    cost.fixedNs = (swy - cost.perOpNs * swx) / sw;
+    if (cost.perOpNs < 0) {
+        cost = { swy / sw, 0 };
+    } else if (cost.fixedNs < 0) {
+        cost = { 0, swxy / swxx };
+    }
+    return cost;
+}
+
+static EvaluationStrategy cheapest(const double* ns, double expectedUses, double* costNs) {
+    double table = ns[2] / expectedUses + ns[3];
+    EvaluationStrategy best = ns[1] < ns[0] ? STRATEGY_SORTED : STRATEGY_LINEAR;
+    double bestNs = std::min(ns[0], ns[1]);
+    if (table < bestNs) {
+        best = STRATEGY_TABLE;
+        bestNs = table;
+    }
+    if (costNs) *costNs = bestNs;
+    return best;
+}
+
+static double strategyNs(const CalibrationShape& shape, EvaluationStrategy strategy,
+                         double expectedUses) {
+    switch (strategy) {
+        case STRATEGY_SORTED: return shape.ns[1];
+        case STRATEGY_TABLE: return shape.ns[2] / expectedUses + shape.ns[3];
+        default: return shape.ns[0];
+    }
+}
+
+static void calibrateShape(CalibrationRun* run, CalibrationShape* shape) {
+    SyntheticWorkload w;
+    buildPreferenceWorkload(shape->attributes, std::max<size_t>(3, shape->attributes / 4),
+                            shape->allowIds, shape->appNodes, &w);
+    PolicyOrdinals ordinals;
+    compilePolicyOrdinals(w.policy, &ordinals);
+    std::vector<CompiledPreference> tables(SYNTHETIC_VARIANTS);
+    for (size_t i = 0; i < SYNTHETIC_VARIANTS; i++) {
+        compilePreference(w.users[i], w.policy, ordinals, &tables[i]);
+    }
+
+    // Request i pairs app i with user i * 7919, as the other benchmarks do
+    auto app = [&w](size_t i) -> const AppRequest& { return w.apps[i % SYNTHETIC_VARIANTS]; };
+    auto user = [](size_t i) { return (i * 7919) % SYNTHETIC_VARIANTS; };
+    for (int k = 0; k < CALIBRATION_KERNELS; k++) shape->ops[k] = 0;
+    for (size_t i = 0; i < SYNTHETIC_VARIANTS; i++) {
+        PlanShape counts = planShape(app(i), w.users[user(i)], w.policy);
+        shape->ops[0] += counts.linearOps / SYNTHETIC_VARIANTS;
+        shape->ops[1] += counts.sortedOps / SYNTHETIC_VARIANTS;
+        shape->ops[2] += counts.buildOps / SYNTHETIC_VARIANTS;
+        shape->ops[3] += counts.probeOps / SYNTHETIC_VARIANTS;
+    }
+    shape->ns[0] = timePerCall(run->minUs, [&](size_t i) {
+        return (int)evaluate(app(i), w.users[user(i)], w.policy);
+    });
+    shape->ns[1] = timePerCall(run->minUs, [&](size_t i) {
+        return (int)evaluateSorted(app(i), w.users[user(i)], w.policy, ordinals);
+    });
+    CompiledPreference scratch;
+    shape->ns[2] = timePerCall(run->minUs, [&](size_t i) {
+        compilePreference(w.users[user(i)], w.policy, ordinals, &scratch);
+        return scratch.timeofRetention;
+    });
+    shape->ns[3] = timePerCall(run->minUs, [&](size_t i) {
+        return (int)evaluateCompiled(app(i), tables[user(i)], w.policy, ordinals);
+    });
+
+    for (size_t i = 0; i < SYNTHETIC_VARIANTS; i += 4) {
+        EvaluationResult expected = evaluate(app(i), w.users[user(i)], w.policy);
+        if (evaluateSorted(app(i), w.users[user(i)], w.policy, ordinals) != expected ||
+            evaluateCompiled(app(i), tables[user(i)], w.policy, ordinals) != expected) {
+            run->mismatches++;
+        }
+    }
+}
+
+void CalibrationRun::execute() {
+    const size_t ATTRIBUTES[] = { 15, 63, 255 };
+    const size_t ALLOW_IDS[] = { 1, 4, 16, 64 };
+    const size_t APP_NODES[] = { 1, 4, 16 };
+    for (size_t attributes : ATTRIBUTES) {
+        for (size_t allowIds : ALLOW_IDS) {
+            for (size_t appNodes : APP_NODES) {
+                CalibrationShape shape;
+                shape.attributes = attributes;
+                shape.allowIds = allowIds;
+                shape.appNodes = appNodes;
+                calibrateShape(this, &shape);
+                shapes.push_back(shape);
+            }
+        }
+    }
+
+    fitted.linear = fitCost(shapes, 0);
+    fitted.sorted = fitCost(shapes, 1);
+    fitted.tableBuild = fitCost(shapes, 2);
+    fitted.tableProbe = fitCost(shapes, 3);
+    defaults = defaultPlannerCosts();
+
+    for (CalibrationShape& shape : shapes) {
+        PlanShape counts = { shape.ops[0], shape.ops[1], shape.ops[2], shape.ops[3] };
+        shape.best = cheapest(shape.ns, expectedUses, nullptr);
+        shape.planned = planEvaluation(counts, expectedUses, fitted);
+        shape.plannedDefault = planEvaluation(counts, expectedUses, defaults);
+    }
+}
+
+static void setCost(napi_env env, napi_value obj, const char* key, const StrategyCost& cost) {
+    napi_value value;
+    napi_create_object(env, &value);
+    setNumber(env, value, "fixedNs", cost.fixedNs);
+    setNumber(env, value, "perOpNs", cost.perOpNs);
+    napi_set_named_property(env, obj, key, value);
+}
+
+static napi_value costsObject(napi_env env, const PlannerCosts& costs) {
+    napi_value obj;
+    napi_create_object(env, &obj);
+    setCost(env, obj, "linear", costs.linear);
+    setCost(env, obj, "sorted", costs.sorted);
+    setCost(env, obj, "tableBuild", costs.tableBuild);
+    setCost(env, obj, "tableProbe", costs.tableProbe);
+    return obj;
+}
+
+void CalibrationRun::report(napi_env env, napi_value obj) {
+    static const char* STRATEGY_NAMES[] = { "linear", "sorted", "table" };
+
+    napi_value list;
+    napi_create_array(env, &list);
+    size_t hits = 0, defaultHits = 0;
+    double regret = 0, defaultRegret = 0;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        const CalibrationShape& shape = shapes[i];
+        double bestNs = strategyNs(shape, shape.best, expectedUses);
+        hits += shape.planned == shape.best;
+        defaultHits += shape.plannedDefault == shape.best;
+        regret += strategyNs(shape, shape.planned, expectedUses) / bestNs;
+        defaultRegret += strategyNs(shape, shape.plannedDefault, expectedUses) / bestNs;
+
+        napi_value entry, name;
+        napi_create_object(env, &entry);
+        setNumber(env, entry, "attributes", (double)shape.attributes);
+        setNumber(env, entry, "allowIds", (double)shape.allowIds);
+        setNumber(env, entry, "appNodes", (double)shape.appNodes);
+        setNumber(env, entry, "linearNs", shape.ns[0]);
+        setNumber(env, entry, "sortedNs", shape.ns[1]);
+        setNumber(env, entry, "buildNs", shape.ns[2]);
+        setNumber(env, entry, "probeNs", shape.ns[3]);
+        napi_create_string_utf8(env, STRATEGY_NAMES[shape.best], NAPI_AUTO_LENGTH, &name);
+        napi_set_named_property(env, entry, "best", name);
+        napi_create_string_utf8(env, STRATEGY_NAMES[shape.planned], NAPI_AUTO_LENGTH, &name);
+        napi_set_named_property(env, entry, "planned", name);
+        napi_create_string_utf8(env, STRATEGY_NAMES[shape.plannedDefault], NAPI_AUTO_LENGTH, &name);
+        napi_set_named_property(env, entry, "plannedDefault", name);
+        napi_set_element(env, list, (uint32_t)i, entry);
+    }
+    double count = shapes.empty() ? 1 : (double)shapes.size();
+
+    napi_set_named_property(env, obj, "shapes", list);
+    napi_set_named_property(env, obj, "fitted", costsObject(env, fitted));
+    napi_set_named_property(env, obj, "defaults", costsObject(env, defaults));
+    setNumber(env, obj, "expectedUses", expectedUses);
+    setNumber(env, obj, "accuracy", hits / count);
+    setNumber(env, obj, "defaultAccuracy", defaultHits / count);
+    setNumber(env, obj, "regret", regret / count);
+    setNumber(env, obj, "defaultRegret", defaultRegret / count);
+    setNumber(env, obj, "mismatches", (double)mismatches);
+}
+
+// CalibratePlanner: Time evaluate(), evaluateSorted() and compiled tables
+// untrusted over a grid of policy, preference and app sizes, and fit the
+// planner's cost constants. Options { minUs, expectedUses }
+// Returns a Promise resolving to { shapes: [{ attributes, allowIds,
+// appNodes, linearNs, sortedNs, buildNs, probeNs, best, planned,
+// plannedDefault }], fitted, defaults, expectedUses, accuracy,
+// defaultAccuracy, regret, defaultRegret, mismatches }; regret is the mean
+// of planned / best measured cost
+napi_value CalibratePlanner(napi_env env, napi_callback_info info) {
+    BenchOptions options(env, info);
+    CalibrationRun* run = new CalibrationRun();
+    double number;
+    if (options.number("minUs", &number) && number >= 100) {
+        run->minUs = number;
+    }
+    if (options.number("expectedUses", &number) && number >= 1) {
+        run->expectedUses = number;
+    }
+    return startBenchmark(env, "calibratePlanner", run);
+}
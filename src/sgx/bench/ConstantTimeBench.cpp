@@ -0,0 +1,195 @@
+#include "Bench.h"
+#include "Workload.h"
+#include "../enclave/ConstantTime.h"
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+
+// ============================================================================
+// Constant-Time Kernel Benchmark
+// ============================================================================
+
+struct ConstantTimeRun : BenchRun {
+    size_t evaluations = 2000000;
+    size_t samples = 20000;      // timed samples per input class
+    size_t batch = 16;           // evaluations per timed sample
+
+    double earlyExitNs = 0;
+    double constantTimeNs = 0;
+    uint64_t mismatches = 0;
+    // Welch's t between the two input classes, per kernel (|t| > 4.5: leaks)
+    double earlyExitT = 0;
+    double constantTimeT = 0;
+    double earlyExitClassNs[2] = { 0, 0 };
+    double constantTimeClassNs[2] = { 0, 0 };
+
+    void execute() override;
+    void report(napi_env env, napi_value obj) override;
+};
+
+// Two preferences with lists of the same lengths and ID lengths: the first
+// matches the app on its first allowed ID, the second matches nothing, so
+// an early-exit evaluation takes a different path for each
+static void buildTimingClasses(const PolicyData& policy, AppRequest* app,
+                               UserPreference* users) {
+    const std::vector<PolicyNode>& attrs = policy.attributes;
+    const std::vector<PolicyNode>& purposes = policy.purposes;
+    app->attributes = { attrs[21], attrs[43], attrs[44] };
+    app->purposes = { purposes[13] };
+    app->timeofRetention = 3600;
+
+    users[0].attributeIds = { attrs[10].id, attrs[11].id };
+    users[0].exceptionIds = { attrs[12].id };
+    users[0].allowedPurposeIds = { purposes[13].id };
+    users[0].prohibitedPurposeIds = { purposes[11].id };
+    users[0].timeofRetention = 7200;
+
+    users[1].attributeIds = { attrs[61].id, attrs[62].id };
+    users[1].exceptionIds = { attrs[13].id };
+    users[1].allowedPurposeIds = { purposes[14].id };
+    users[1].prohibitedPurposeIds = { purposes[12].id };
+    users[1].timeofRetention = 7200;
+}
+
+// A subtree copied under a second parent repeats its IDs: every node of the
+// root's right subtree takes the ID of its mirror in the left subtree
+static void mirrorIds(std::vector<PolicyNode>* nodes) {
+    for (size_t levelStart = 1, width = 2; levelStart < nodes->size();
+         levelStart = 2 * levelStart + 1, width *= 2) {
+        for (size_t i = 0; i < width / 2 && levelStart + width / 2 + i < nodes->size(); i++) {
+            (*nodes)[levelStart + width / 2 + i].id = (*nodes)[levelStart + i].id;
+        }
+    }
+}
+
+// Times batches of one kernel on randomly interleaved input classes, then
+// compares the classes with Welch's t-test after dropping samples above the
+// pooled 95th percentile (interrupts, migrations)
+template <typename Kernel>
+static double timingT(size_t samples, size_t batch, Kernel kernel, double* classNs) {
+    std::vector<double> times[2];
+    std::vector<uint8_t> order(2 * samples);
+    uint32_t seed = 7;
+    for (size_t s = 0; s < order.size(); s++) order[s] = (uint8_t)(nextRandom(&seed) & 1);
+
+    volatile int sink = 0;
+    for (size_t s = 0; s < order.size(); s++) {
+        BenchClock::time_point start = BenchClock::now();
+        int acc = 0;
+        for (size_t b = 0; b < batch; b++) acc += kernel(order[s]);
+        BenchClock::time_point end = BenchClock::now();
+        sink += acc;
+        times[order[s]].push_back(
+            std::chrono::duration<double, std::nano>(end - start).count() / (double)batch);
+    }
+    (void)sink;
+
+    std::vector<double> pooled(times[0]);
+    pooled.insert(pooled.end(), times[1].begin(), times[1].end());
+    std::nth_element(pooled.begin(), pooled.begin() + pooled.size() * 95 / 100, pooled.end());
+    double cutoff = pooled[pooled.size() * 95 / 100];
+
+    double mean[2], variance[2], count[2];
+    for (int c = 0; c < 2; c++) {
+        double sum = 0, sumSq = 0, n = 0;
+        for (double t : times[c]) {
+            if (t > cutoff) continue;
+            sum += t;
+            sumSq += t * t;
+            n++;
+        }
+        mean[c] = n > 0 ? sum / n : 0;
+        variance[c] = n > 1 ? (sumSq - n * mean[c] * mean[c]) / (n - 1) : 0;
+        count[c] = n;
+        classNs[c] = mean[c];
+    }
+    double se = sqrt(variance[0] / count[0] + variance[1] / count[1]);
+    return se > 0 ? (mean[0] - mean[1]) / se : 0;
+}
+
+void ConstantTimeRun::execute() {
+    SyntheticWorkload workload;
+    buildSyntheticWorkload(&workload);
+    CtPolicy ctPolicy;
+    compileConstantTime(workload.policy, &ctPolicy);
+
+    uint64_t grants = 0;
+    BenchClock::time_point start = BenchClock::now();
+    for (size_t i = 0; i < evaluations; i++) {
+        grants += evaluate(workload.apps[i % SYNTHETIC_VARIANTS],
+                           workload.users[(i * 7919) % SYNTHETIC_VARIANTS], workload.policy);
+    }
+    earlyExitNs = elapsedUs(start) * 1000.0 / evaluations;
+
+    start = BenchClock::now();
+    for (size_t i = 0; i < evaluations; i++) {
+        grants += evaluateConstantTime(workload.apps[i % SYNTHETIC_VARIANTS],
+                                       workload.users[(i * 7919) % SYNTHETIC_VARIANTS], ctPolicy);
+    }
+    constantTimeNs = elapsedUs(start) * 1000.0 / evaluations;
+
+    // Both the workload policy and a copy whose IDs repeat across subtrees
+    PolicyData duplicated = workload.policy;
+    mirrorIds(&duplicated.attributes);
+    mirrorIds(&duplicated.purposes);
+    CtPolicy ctDuplicated;
+    compileConstantTime(duplicated, &ctDuplicated);
+    for (size_t i = 0; i < SYNTHETIC_VARIANTS; i++) {
+        for (size_t j = 0; j < SYNTHETIC_VARIANTS; j += 7) {
+            if (evaluate(workload.apps[i], workload.users[j], workload.policy) !=
+                evaluateConstantTime(workload.apps[i], workload.users[j], ctPolicy)) {
+                mismatches++;
+            }
+            if (evaluate(workload.apps[i], workload.users[j], duplicated) !=
+                evaluateConstantTime(workload.apps[i], workload.users[j], ctDuplicated)) {
+                mismatches++;
+            }
+        }
+    }
+
+    AppRequest app;
+    UserPreference users[2];
+    buildTimingClasses(workload.policy, &app, users);
+    const PolicyData& policy = workload.policy;
+    earlyExitT = timingT(samples, batch, [&](int c) {
+        return (int)evaluate(app, users[c], policy);
+    }, earlyExitClassNs);
+    constantTimeT = timingT(samples, batch, [&](int c) {
+        return (int)evaluateConstantTime(app, users[c], ctPolicy);
+    }, constantTimeClassNs);
+}
+
+void ConstantTimeRun::report(napi_env env, napi_value obj) {
+    napi_value timing;
+    setNumber(env, obj, "evaluations", (double)evaluations);
+    setNumber(env, obj, "earlyExitNs", earlyExitNs);
+    setNumber(env, obj, "constantTimeNs", constantTimeNs);
+    setNumber(env, obj, "mismatches", (double)mismatches);
+
+    napi_create_object(env, &timing);
+    setNumber(env, timing, "samples", (double)samples);
+    setNumber(env, timing, "batch", (double)batch);
+    setNumber(env, timing, "earlyExitT", earlyExitT);
+    setNumber(env, timing, "earlyExitMatchNs", earlyExitClassNs[0]);
+    setNumber(env, timing, "earlyExitNoMatchNs", earlyExitClassNs[1]);
+    setNumber(env, timing, "constantTimeT", constantTimeT);
+    setNumber(env, timing, "constantTimeMatchNs", constantTimeClassNs[0]);
+    setNumber(env, timing, "constantTimeNoMatchNs", constantTimeClassNs[1]);
+    napi_set_named_property(env, obj, "timing", timing);
+}
+
+// BenchmarkConstantTime: Compare evaluate() with evaluateConstantTime()
+// untrusted on the synthetic workload, and test both for data-dependent
+// timing. mismatches also covers a copy of the policy whose IDs repeat
+// across subtrees. Options { evaluations, samples, batch }
+// Returns a Promise resolving to { evaluations, earlyExitNs, constantTimeNs,
+// mismatches, timing: { samples, batch, earlyExitT, constantTimeT, and the
+// per-class means earlyExitMatchNs, earlyExitNoMatchNs, ... } }
+napi_value BenchmarkConstantTime(napi_env env, napi_callback_info info) {
+    BenchOptions options(env, info);
+    ConstantTimeRun* run = new ConstantTimeRun();
+    options.count("evaluations", 1, &run->evaluations);
+    options.count("samples", 10, &run->samples);
+    options.count("batch", 1, &run->batch);
+    return startBenchmark(env, "benchmarkConstantTime", run);
+}
@@ -0,0 +1,129 @@
+#include "Bench.h"
+#include "Workload.h"
+
+// ============================================================================
+// Large Request Benchmark
+// ============================================================================
+
+struct LargeRequestRun : BenchRun {
+    size_t attributes = 255;
+    size_t purposes = 63;
+    size_t allowIds = 4;
+    double minUs = 100000;           // timed per kernel and size
+    std::vector<size_t> appNodes = { 1, 4, 10, 100, 1000 };
+
+    std::vector<double> linearNs;    // per size
+    std::vector<double> intervalNs;
+    std::vector<double> evaluateNs;
+    uint64_t mismatches = 0;
+
+    void execute() override;
+    void report(napi_env env, napi_value obj) override;
+};
+
+// The checks of evaluate() with each tree forced onto the per-node loops
+static int evaluateLinearLoops(const AppRequest& app, const UserPreference& user,
+                               const PolicyData& policy) {
+    return evaluateTimeofRetention(app, user) &&
+           evaluateAttributeType(app, user, policy, "allow") &&
+           !evaluateAttributeType(app, user, policy, "except") &&
+           evaluatePurposeType(app, user, policy, "allow") &&
+           !evaluatePurposeType(app, user, policy, "except");
+}
+
+// ... and onto the interval path
+static int evaluateIntervalTrees(const AppRequest& app, const UserPreference& user,
+                                 const PolicyData& policy) {
+    return evaluateTimeofRetention(app, user) &&
+           evaluateTreeIntervals(app.attributes, user.attributeIds, user.exceptionIds,
+                                 policy.attributes) &&
+           evaluateTreeIntervals(app.purposes, user.allowedPurposeIds, user.prohibitedPurposeIds,
+                                 policy.purposes);
+}
+
+void LargeRequestRun::execute() {
+    for (size_t size : appNodes) {
+        // Apps requesting exactly size attributes and as many purposes
+        SyntheticWorkload w;
+        buildPreferenceWorkload(attributes, purposes, allowIds, 1, &w);
+        uint32_t seed = 7;
+        for (AppRequest& app : w.apps) {
+            app.attributes.resize(size);
+            app.purposes.resize(size);
+            for (PolicyNode& node : app.attributes) {
+                node = w.policy.attributes[nextRandom(&seed) % w.policy.attributes.size()];
+            }
+            for (PolicyNode& node : app.purposes) {
+                node = w.policy.purposes[nextRandom(&seed) % w.policy.purposes.size()];
+            }
+        }
+
+        for (size_t v = 0; v < SYNTHETIC_VARIANTS; v++) {
+            int expected = evaluateLinearLoops(w.apps[v], w.users[v], w.policy);
+            if (evaluateIntervalTrees(w.apps[v], w.users[v], w.policy) != expected ||
+                (evaluate(w.apps[v], w.users[v], w.policy) == RESULT_GRANT) != (expected != 0)) {
+                mismatches++;
+            }
+        }
+
+        size_t mask = SYNTHETIC_VARIANTS - 1;
+        linearNs.push_back(timePerCall(minUs, [&](size_t i) {
+            return evaluateLinearLoops(w.apps[i & mask], w.users[i & mask], w.policy);
+        }));
+        intervalNs.push_back(timePerCall(minUs, [&](size_t i) {
+            return evaluateIntervalTrees(w.apps[i & mask], w.users[i & mask], w.policy);
+        }));
+        evaluateNs.push_back(timePerCall(minUs, [&](size_t i) {
+            return (int)evaluate(w.apps[i & mask], w.users[i & mask], w.policy);
+        }));
+    }
+}
+
+void LargeRequestRun::report(napi_env env, napi_value obj) {
+    setNumber(env, obj, "attributes", (double)attributes);
+    setNumber(env, obj, "purposes", (double)purposes);
+    setNumber(env, obj, "allowIds", (double)allowIds);
+    setNumber(env, obj, "threshold", (double)INTERVAL_MIN_APP_NODES);
+
+    napi_value sizes;
+    napi_create_array_with_length(env, appNodes.size(), &sizes);
+    for (size_t i = 0; i < appNodes.size(); i++) {
+        napi_value entry;
+        napi_create_object(env, &entry);
+        setNumber(env, entry, "appNodes", (double)appNodes[i]);
+        setNumber(env, entry, "linearNs", linearNs[i]);
+        setNumber(env, entry, "intervalNs", intervalNs[i]);
+        setNumber(env, entry, "evaluateNs", evaluateNs[i]);
+        napi_set_element(env, sizes, i, entry);
+    }
+    napi_set_named_property(env, obj, "sizes", sizes);
+    setNumber(env, obj, "mismatches", (double)mismatches);
+}
+
+// BenchmarkLargeRequest: Time the per-node loops of evaluate() against the
+// interval path, and evaluate() itself (which switches at
+// INTERVAL_MIN_APP_NODES), for apps requesting appNodes attributes and as
+// many purposes, untrusted. Options { appNodes: [...], attributes, purposes,
+// allowIds, minUs }
+// Returns a Promise resolving to { attributes, purposes, allowIds,
+// threshold, sizes: [{ appNodes, linearNs, intervalNs, evaluateNs }],
+// mismatches }
+napi_value BenchmarkLargeRequest(napi_env env, napi_callback_info info) {
+    BenchOptions options(env, info);
+    LargeRequestRun* run = new LargeRequestRun();
+    options.count("attributes", 1, &run->attributes);
+    options.count("purposes", 1, &run->purposes);
+    options.count("allowIds", 1, &run->allowIds);
+    double number;
+    if (options.number("minUs", &number) && number > 0) {
+        run->minUs = number;
+    }
+    std::vector<double> sizes;
+    if (options.numbers("appNodes", &sizes)) {
+        run->appNodes.clear();
+        for (double size : sizes) {
+            if (size >= 1) run->appNodes.push_back((size_t)size);
+        }
+    }
+    return startBenchmark(env, "benchmarkLargeRequest", run);
+}
@@ -0,0 +1,153 @@
+#include "Bench.h"
+#include "Workload.h"
+#include "../core/ObjectId.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+// ============================================================================
+// ObjectId Ingestion Benchmark
+// ============================================================================
+
+struct ObjectIdRun : BenchRun {
+    size_t nodes = 1000000;          // policy IDs
+    size_t ids = 1048576;            // incoming IDs, 1 in 16 unknown
+    double minUs = 200000;           // timed per path
+
+    size_t unknown = 0;
+    double mapBuildUs = 0;
+    double hashBuildUs = 0;          // decode and build
+    double hashBytes = 0;
+    double mapNs = 0;                // per incoming ID
+    double scalarDecodeNs = 0;
+    double simdDecodeNs = 0;
+    double scalarNs = 0;             // decode and look up
+    double simdNs = 0;
+    uint64_t rejected = 0;
+    uint64_t mismatches = 0;
+
+    void execute() override;
+    void report(napi_env env, napi_value obj) override;
+};
+
+static std::string randomObjectId(uint32_t* seed) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex(OBJECT_ID_HEX_LENGTH, '0');
+    for (size_t i = 0; i < OBJECT_ID_HEX_LENGTH; i += 8) {
+        uint32_t bits = nextRandom(seed);
+        for (size_t k = 0; k < 8; k++) hex[i + k] = digits[(bits >> (4 * k)) & 15];
+    }
+    return hex;
+}
+
+void ObjectIdRun::execute() {
+    uint32_t seed = 42;
+    std::vector<std::string> policyIds(nodes);
+    for (std::string& id : policyIds) id = randomObjectId(&seed);
+
+    // The string map PolicyIndex used before, against decode + perfect hash
+    BenchClock::time_point start = BenchClock::now();
+    std::unordered_map<std::string, size_t> map;
+    map.reserve(policyIds.size());
+    for (size_t k = 0; k < policyIds.size(); k++) map[policyIds[k]] = k;
+    mapBuildUs = (double)elapsedUs(start);
+
+    start = BenchClock::now();
+    std::vector<ObjectIdKey> keys(policyIds.size());
+    for (size_t k = 0; k < policyIds.size(); k++) {
+        decodeObjectId(policyIds[k].data(), policyIds[k].size(), &keys[k]);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    ObjectIdPerfectHash hash;
+    bool built = hash.build(keys);
+    hashBuildUs = (double)elapsedUs(start);
+    hashBytes = (double)hash.bytes();
+    if (!built) return;
+
+    std::vector<std::string> incoming(ids);
+    for (std::string& id : incoming) {
+        if (nextRandom(&seed) % 16 == 0) {
+            id = randomObjectId(&seed);
+            unknown++;
+        } else {
+            id = policyIds[nextRandom(&seed) % policyIds.size()];
+        }
+    }
+
+    // Decode + perfect hash must accept exactly the IDs the map knows, and
+    // land on their key
+    for (const std::string& id : incoming) {
+        ObjectIdKey key, expected;
+        auto it = map.find(id);
+        int32_t ordinal = decodeObjectId(id.data(), id.size(), &key) ? hash.find(key) : -1;
+        if (ordinal < 0) rejected++;
+        if (it == map.end()) {
+            if (ordinal >= 0) mismatches++;
+            continue;
+        }
+        const std::string& policyId = policyIds[it->second];
+        decodeObjectIdScalar(policyId.data(), policyId.size(), &expected);
+        if (ordinal < 0 || hash.key(ordinal) != expected) mismatches++;
+    }
+
+    size_t count = incoming.size();
+    mapNs = timePerCall(minUs, [&](size_t i) {
+        return map.find(incoming[i % count]) != map.end() ? 1 : 0;
+    });
+    scalarDecodeNs = timePerCall(minUs, [&](size_t i) {
+        ObjectIdKey key;
+        const std::string& id = incoming[i % count];
+        return decodeObjectIdScalar(id.data(), id.size(), &key) ? (int)key.bytes[0] : 0;
+    });
+    simdDecodeNs = timePerCall(minUs, [&](size_t i) {
+        ObjectIdKey key;
+        const std::string& id = incoming[i % count];
+        return decodeObjectId(id.data(), id.size(), &key) ? (int)key.bytes[0] : 0;
+    });
+    scalarNs = timePerCall(minUs, [&](size_t i) {
+        ObjectIdKey key;
+        const std::string& id = incoming[i % count];
+        return decodeObjectIdScalar(id.data(), id.size(), &key) ? hash.find(key) : -1;
+    });
+    simdNs = timePerCall(minUs, [&](size_t i) {
+        ObjectIdKey key;
+        const std::string& id = incoming[i % count];
+        return decodeObjectId(id.data(), id.size(), &key) ? hash.find(key) : -1;
+    });
+}
+
+void ObjectIdRun::report(napi_env env, napi_value obj) {
+    setNumber(env, obj, "nodes", (double)nodes);
+    setNumber(env, obj, "ids", (double)ids);
+    setNumber(env, obj, "unknown", (double)unknown);
+    setNumber(env, obj, "mapBuildUs", mapBuildUs);
+    setNumber(env, obj, "hashBuildUs", hashBuildUs);
+    setNumber(env, obj, "hashBytes", hashBytes);
+    setNumber(env, obj, "mapNs", mapNs);
+    setNumber(env, obj, "scalarDecodeNs", scalarDecodeNs);
+    setNumber(env, obj, "simdDecodeNs", simdDecodeNs);
+    setNumber(env, obj, "scalarNs", scalarNs);
+    setNumber(env, obj, "simdNs", simdNs);
+    setNumber(env, obj, "rejected", (double)rejected);
+    setNumber(env, obj, "mismatches", (double)mismatches);
+}
+
+// BenchmarkObjectIdIngestion: Time turning 24-hex ObjectId strings into
+// policy node references: the string map against decoding (scalar and
+// SIMD) plus the minimal perfect hash, untrusted. Options { nodes, ids,
+// minUs }; 1 in 16 incoming IDs is unknown
+// Returns a Promise resolving to { nodes, ids, unknown, mapBuildUs,
+// hashBuildUs, hashBytes, mapNs, scalarDecodeNs, simdDecodeNs, scalarNs,
+// simdNs, rejected, mismatches }
+napi_value BenchmarkObjectIdIngestion(napi_env env, napi_callback_info info) {
+    BenchOptions options(env, info);
+    ObjectIdRun* run = new ObjectIdRun();
+    options.count("nodes", 1, &run->nodes);
+    options.count("ids", 1, &run->ids);
+    double number;
+    if (options.number("minUs", &number) && number > 0) {
+        run->minUs = number;
+    }
+    return startBenchmark(env, "benchmarkObjectIdIngestion", run);
+}
@@ -0,0 +1,277 @@
+#include "Bench.h"
+#include "../core/PolicyDag.h"
+#include "Workload.h"
+#include <algorithm>
+
+// ============================================================================
+// Policy DAG Benchmark
+// ============================================================================
+
+struct PolicyDagRun : BenchRun {
+    size_t nodes = 1000000;
+    std::vector<double> shared = { 0, 0.01, 0.05 };
+    size_t queries = 1 << 20;        // pairs per set, cycled through
+    double minUs = 200000;           // timed per kernel, set and sharing
+
+    struct Sharing {
+        double shared;
+        size_t edges;
+        size_t intervals;
+        size_t maxIntervals;
+        size_t duplicatedNodes;
+        double buildMs;
+        size_t dagBytes;
+        size_t duplicatedBytes;
+        double dagRandomNs;
+        double scalarRandomNs;
+        double duplicatedRandomNs;
+        double dagAncestorNs;
+        double scalarAncestorNs;
+        double duplicatedAncestorNs;
+        uint64_t mismatches;
+    };
+    std::vector<Sharing> runs;
+
+    void execute() override;
+    void report(napi_env env, napi_value obj) override;
+};
+
+// The flattened form: every node copied under each path from a root,
+// copies numbered as nested sets and grouped by node
+struct DuplicatedTree {
+    std::vector<uint32_t> start;     // node i's copies: [start[i], start[i + 1])
+    std::vector<int32_t> left;
+    std::vector<int32_t> right;
+
+    size_t bytes() const {
+        return start.size() * sizeof(uint32_t) + (left.size() + right.size()) * sizeof(int32_t);
+    }
+    bool contains(uint32_t ancestor, uint32_t descendant) const {
+        for (uint32_t i = start[ancestor]; i < start[ancestor + 1]; i++) {
+            for (uint32_t j = start[descendant]; j < start[descendant + 1]; j++) {
+                if (left[i] <= left[j] && right[i] >= right[j]) return true;
+            }
+        }
+        return false;
+    }
+};
+
+// Complete binary tree in heap order; a shared fraction of the nodes also
+// sits under a random node on their parent's level, as "Location" sits
+// under "Device" and "Personal"
+static void buildDag(size_t count, double shared, uint32_t* seed,
+                     std::vector<std::vector<uint32_t>>* parents) {
+    parents->assign(count, std::vector<uint32_t>());
+    uint32_t threshold = (uint32_t)(shared * 65536);
+    for (size_t i = 1; i < count; i++) {
+        uint32_t parent = (uint32_t)((i - 1) / 2);
+        (*parents)[i].push_back(parent);
+        if ((nextRandom(seed) & 0xFFFF) >= threshold) continue;
+        size_t levelStart = 0;
+        while (2 * levelStart + 1 <= parent) levelStart = 2 * levelStart + 1;
+        uint32_t other = (uint32_t)(levelStart + nextRandom(seed) % (i - levelStart));
+        if (other != parent && other < i) (*parents)[i].push_back(other);
+    }
+}
+
+static void duplicateTree(const std::vector<std::vector<uint32_t>>& parents,
+                          DuplicatedTree* tree) {
+    size_t n = parents.size();
+    std::vector<uint32_t> childStart(n + 1, 0);
+    for (size_t i = 0; i < n; i++) {
+        for (uint32_t parent : parents[i]) childStart[parent + 1]++;
+    }
+    for (size_t i = 0; i < n; i++) childStart[i + 1] += childStart[i];
+    std::vector<uint32_t> children(childStart[n]);
+    std::vector<uint32_t> fill(childStart.begin(), childStart.end() - 1);
+    for (size_t i = 0; i < n; i++) {
+        for (uint32_t parent : parents[i]) children[fill[parent]++] = (uint32_t)i;
+    }
+
+    // Copies in preorder: owning node and nested-set numbers
+    struct Frame { uint32_t node; uint32_t next; size_t copy; };
+    std::vector<uint32_t> owner;
+    std::vector<int32_t> left, right;
+    std::vector<Frame> stack;
+    int32_t counter = 1;
+    for (size_t root = 0; root < n; root++) {
+        if (!parents[root].empty()) continue;
+        stack.push_back({ (uint32_t)root, childStart[root], owner.size() });
+        owner.push_back((uint32_t)root);
+        left.push_back(counter++);
+        right.push_back(0);
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            if (frame.next == childStart[frame.node + 1]) {
+                right[frame.copy] = counter++;
+                stack.pop_back();
+                continue;
+            }
+            uint32_t child = children[frame.next++];
+            stack.push_back({ child, childStart[child], owner.size() });
+            owner.push_back(child);
+            left.push_back(counter++);
+            right.push_back(0);
+        }
+    }
+
+    tree->start.assign(n + 1, 0);
+    for (uint32_t node : owner) tree->start[node + 1]++;
+    for (size_t i = 0; i < n; i++) tree->start[i + 1] += tree->start[i];
+    tree->left.resize(owner.size());
+    tree->right.resize(owner.size());
+    fill.assign(tree->start.begin(), tree->start.end() - 1);
+    for (size_t c = 0; c < owner.size(); c++) {
+        uint32_t slot = fill[owner[c]]++;
+        tree->left[slot] = left[c];
+        tree->right[slot] = right[c];
+    }
+}
+
+void PolicyDagRun::execute() {
+    for (double fraction : shared) {
+        PolicyDagRun::Sharing sharing = {};
+        sharing.shared = fraction;
+
+        uint32_t seed = 7;
+        std::vector<std::vector<uint32_t>> parents;
+        buildDag(nodes, fraction, &seed, &parents);
+        for (const std::vector<uint32_t>& list : parents) sharing.edges += list.size();
+
+        PolicyDag dag;
+        std::vector<uint32_t> postorder;
+        BenchClock::time_point start = BenchClock::now();
+        dag.build(parents, &postorder);
+        sharing.buildMs = elapsedUs(start) / 1000.0;
+        sharing.dagBytes = dag.bytes();
+        sharing.intervals = dag.intervals();
+        for (uint32_t node = 0; node < nodes; node++) {
+            sharing.maxIntervals = std::max<size_t>(sharing.maxIntervals, dag.intervalCount(node));
+        }
+
+        DuplicatedTree tree;
+        duplicateTree(parents, &tree);
+        sharing.duplicatedNodes = tree.left.size();
+        sharing.duplicatedBytes = tree.bytes();
+
+        // Random pairs, and pairs whose first node is reached from the
+        // second by walking up to 24 random parents
+        std::vector<uint32_t> randomPairs(2 * queries), ancestorPairs(2 * queries);
+        for (size_t q = 0; q < queries; q++) {
+            randomPairs[2 * q] = nextRandom(&seed) % nodes;
+            randomPairs[2 * q + 1] = nextRandom(&seed) % nodes;
+            uint32_t node = nextRandom(&seed) % nodes;
+            uint32_t ancestor = node;
+            for (uint32_t up = nextRandom(&seed) % 24; up > 0 && !parents[ancestor].empty(); up--) {
+                ancestor = parents[ancestor][nextRandom(&seed) % parents[ancestor].size()];
+            }
+            ancestorPairs[2 * q] = ancestor;
+            ancestorPairs[2 * q + 1] = node;
+        }
+        parents = std::vector<std::vector<uint32_t>>();
+
+        // The same pairs by PolicyDag ordinal
+        std::vector<uint32_t> dagRandomPairs(2 * queries), dagAncestorPairs(2 * queries);
+        for (size_t i = 0; i < 2 * queries; i++) {
+            dagRandomPairs[i] = postorder[randomPairs[i]];
+            dagAncestorPairs[i] = postorder[ancestorPairs[i]];
+        }
+        for (size_t q = 0; q < queries; q++) {
+            for (int set = 0; set < 2; set++) {
+                const std::vector<uint32_t>& pairs = set ? ancestorPairs : randomPairs;
+                const std::vector<uint32_t>& dagPairs = set ? dagAncestorPairs : dagRandomPairs;
+                uint32_t a = dagPairs[2 * q], b = dagPairs[2 * q + 1];
+                bool expected = tree.contains(pairs[2 * q], pairs[2 * q + 1]);
+                if (dag.contains(a, b) != expected || dag.containsScalar(a, b) != expected) {
+                    sharing.mismatches++;
+                }
+            }
+        }
+
+        size_t mask = queries - 1;
+        auto dagKernel = [&](const std::vector<uint32_t>& pairs) {
+            return timePerCall(minUs, [&](size_t i) {
+                return (int)dag.contains(pairs[2 * (i & mask)], pairs[2 * (i & mask) + 1]);
+            });
+        };
+        auto scalarKernel = [&](const std::vector<uint32_t>& pairs) {
+            return timePerCall(minUs, [&](size_t i) {
+                return (int)dag.containsScalar(pairs[2 * (i & mask)], pairs[2 * (i & mask) + 1]);
+            });
+        };
+        auto duplicatedKernel = [&](const std::vector<uint32_t>& pairs) {
+            return timePerCall(minUs, [&](size_t i) {
+                return (int)tree.contains(pairs[2 * (i & mask)], pairs[2 * (i & mask) + 1]);
+            });
+        };
+        sharing.dagRandomNs = dagKernel(dagRandomPairs);
+        sharing.scalarRandomNs = scalarKernel(dagRandomPairs);
+        sharing.duplicatedRandomNs = duplicatedKernel(randomPairs);
+        sharing.dagAncestorNs = dagKernel(dagAncestorPairs);
+        sharing.scalarAncestorNs = scalarKernel(dagAncestorPairs);
+        sharing.duplicatedAncestorNs = duplicatedKernel(ancestorPairs);
+        runs.push_back(sharing);
+    }
+}
+
+void PolicyDagRun::report(napi_env env, napi_value obj) {
+    napi_value list;
+    setNumber(env, obj, "nodes", (double)nodes);
+    setNumber(env, obj, "queries", (double)queries);
+    napi_create_array_with_length(env, runs.size(), &list);
+    for (size_t i = 0; i < runs.size(); i++) {
+        const PolicyDagRun::Sharing& sharing = runs[i];
+        napi_value entry;
+        napi_create_object(env, &entry);
+        setNumber(env, entry, "shared", sharing.shared);
+        setNumber(env, entry, "edges", (double)sharing.edges);
+        setNumber(env, entry, "intervals", (double)sharing.intervals);
+        setNumber(env, entry, "maxIntervals", (double)sharing.maxIntervals);
+        setNumber(env, entry, "duplicatedNodes", (double)sharing.duplicatedNodes);
+        setNumber(env, entry, "buildMs", sharing.buildMs);
+        setNumber(env, entry, "dagBytes", (double)sharing.dagBytes);
+        setNumber(env, entry, "duplicatedBytes", (double)sharing.duplicatedBytes);
+        setNumber(env, entry, "dagRandomNs", sharing.dagRandomNs);
+        setNumber(env, entry, "scalarRandomNs", sharing.scalarRandomNs);
+        setNumber(env, entry, "duplicatedRandomNs", sharing.duplicatedRandomNs);
+        setNumber(env, entry, "dagAncestorNs", sharing.dagAncestorNs);
+        setNumber(env, entry, "scalarAncestorNs", sharing.scalarAncestorNs);
+        setNumber(env, entry, "duplicatedAncestorNs", sharing.duplicatedAncestorNs);
+        setNumber(env, entry, "mismatches", (double)sharing.mismatches);
+        napi_set_element(env, list, i, entry);
+    }
+    napi_set_named_property(env, obj, "runs", list);
+}
+
+// BenchmarkPolicyDag: Compare PolicyDag (bench/PolicyDag.h) with the
+// duplicated-subtree workaround on a complete binary tree where a shared
+// fraction of the nodes has a second parent: intervals, nodes and bytes of
+// each, and ns per containment check on random pairs and on ancestor pairs,
+// PolicyDag vectorized and scalar. Options { nodes, shared: [...], queries
+// (rounded down to a power of two), minUs }
+// Returns a Promise resolving to { nodes, queries, runs: [{ shared, edges,
+// intervals, maxIntervals, duplicatedNodes, buildMs, dagBytes,
+// duplicatedBytes, dagRandomNs, scalarRandomNs, duplicatedRandomNs,
+// dagAncestorNs, scalarAncestorNs, duplicatedAncestorNs, mismatches }] }
+napi_value BenchmarkPolicyDag(napi_env env, napi_callback_info info) {
+    BenchOptions options(env, info);
+    PolicyDagRun* run = new PolicyDagRun();
+    options.count("nodes", 1, &run->nodes);
+    double number;
+    if (options.number("queries", &number) && number >= 1) {
+        size_t queries = 1;
+        while (queries * 2 <= (size_t)number) queries *= 2;
+        run->queries = queries;
+    }
+    if (options.number("minUs", &number) && number > 0) {
+        run->minUs = number;
+    }
+    std::vector<double> fractions;
+    if (options.numbers("shared", &fractions)) {
+        run->shared.clear();
+        for (double fraction : fractions) {
+            if (fraction >= 0 && fraction <= 1) run->shared.push_back(fraction);
+        }
+    }
+    return startBenchmark(env, "benchmarkPolicyDag", run);
+}
@@ -0,0 +1,158 @@
+#include "Bench.h"
+#include "Workload.h"
+#include "../enclave/PolicyLayout.h"
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+
+// ============================================================================
+// Policy Layout Benchmark
+// ============================================================================
+
+struct PolicyLayoutRun : BenchRun {
+    size_t nodes = 100000;           // attributes; purposes get a quarter
+    size_t allowIds = 4;
+    size_t genericEvaluations = 200;
+    size_t layoutEvaluations = 200000;
+
+    double compileUs = 0;
+    double nodeBytes = 0;            // PolicyNode vectors, string heap included
+    double hotBytes = 0;
+    double indexBytes = 0;
+    double coldBytes = 0;
+    double genericNs = 0;
+    double layoutNs = 0;
+    double genericMisses = -1;       // LLC misses per evaluation, -1 if unavailable
+    double layoutMisses = -1;
+    uint64_t mismatches = 0;
+
+    void execute() override;
+    void report(napi_env env, napi_value obj) override;
+};
+
+// Hardware cache-miss counter (last-level cache on most CPUs) of the
+// calling thread, user space only; -1 when the kernel or a VM does not
+// expose one
+static int openLlcCounter() {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// Runs kernel(0) ... kernel(calls - 1); returns ns per call and sets
+// *misses to LLC misses per call when counter is open
+template <typename Kernel>
+static double countPerCall(int counter, size_t calls, Kernel kernel, double* misses) {
+    int acc = 0;
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    BenchClock::time_point start = BenchClock::now();
+    for (size_t i = 0; i < calls; i++) acc += kernel(i);
+    double ns = elapsedUs(start) * 1000.0 / calls;
+    uint64_t count = 0;
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter, &count, sizeof(count)) == (ssize_t)sizeof(count)) {
+            *misses = (double)count / calls;
+        }
+    }
+    volatile int sink = acc;
+    (void)sink;
+    return ns;
+}
+
+static double nodeVectorBytes(const std::vector<PolicyNode>& nodes) {
+    double bytes = (double)nodes.capacity() * sizeof(PolicyNode);
+    for (const PolicyNode& node : nodes) {
+        // Strings past the small-string buffer live on the heap
+        if (node.id.capacity() > 15) bytes += node.id.capacity() + 1;
+        if (node.name.capacity() > 15) bytes += node.name.capacity() + 1;
+    }
+    return bytes;
+}
+
+void PolicyLayoutRun::execute() {
+    SyntheticWorkload w;
+    buildPreferenceWorkload(nodes, std::max<size_t>(3, nodes / 4), allowIds, 3, &w);
+
+    PolicyLayout layout;
+    BenchClock::time_point start = BenchClock::now();
+    compilePolicyLayout(w.policy, &layout);
+    compileUs = (double)elapsedUs(start);
+    nodeBytes = nodeVectorBytes(w.policy.attributes) + nodeVectorBytes(w.policy.purposes);
+    hotBytes = (double)(layout.attributes.hotBytes() + layout.purposes.hotBytes());
+    indexBytes = (double)(layout.attributes.indexBytes() + layout.purposes.indexBytes());
+    coldBytes = (double)(layout.attributes.coldBytes() + layout.purposes.coldBytes());
+
+    auto app = [&w](size_t i) -> const AppRequest& { return w.apps[i % SYNTHETIC_VARIANTS]; };
+    auto user = [&w](size_t i) -> const UserPreference& {
+        return w.users[(i * 7919) % SYNTHETIC_VARIANTS];
+    };
+    for (size_t i = 0; i < SYNTHETIC_VARIANTS; i += 4) {
+        if (evaluate(app(i), user(i), w.policy) != evaluateLayout(app(i), user(i), layout)) {
+            mismatches++;
+        }
+    }
+
+    int counter = openLlcCounter();
+    genericNs = countPerCall(counter, genericEvaluations, [&](size_t i) {
+        return (int)evaluate(app(i), user(i), w.policy);
+    }, &genericMisses);
+    layoutNs = countPerCall(counter, layoutEvaluations, [&](size_t i) {
+        return (int)evaluateLayout(app(i), user(i), layout);
+    }, &layoutMisses);
+    if (counter >= 0) close(counter);
+}
+
+void PolicyLayoutRun::report(napi_env env, napi_value obj) {
+    setNumber(env, obj, "nodes", (double)nodes);
+    setNumber(env, obj, "allowIds", (double)allowIds);
+    setNumber(env, obj, "genericEvaluations", (double)genericEvaluations);
+    setNumber(env, obj, "layoutEvaluations", (double)layoutEvaluations);
+    setNumber(env, obj, "compileUs", compileUs);
+    setNumber(env, obj, "nodeBytes", nodeBytes);
+    setNumber(env, obj, "hotBytes", hotBytes);
+    setNumber(env, obj, "indexBytes", indexBytes);
+    setNumber(env, obj, "coldBytes", coldBytes);
+    setNumber(env, obj, "genericNs", genericNs);
+    setNumber(env, obj, "layoutNs", layoutNs);
+    if (genericMisses >= 0) {
+        setNumber(env, obj, "genericLlcMisses", genericMisses);
+        setNumber(env, obj, "layoutLlcMisses", layoutMisses);
+    } else {
+        napi_value misses;
+        napi_get_null(env, &misses);
+        napi_set_named_property(env, obj, "genericLlcMisses", misses);
+        napi_set_named_property(env, obj, "layoutLlcMisses", misses);
+    }
+    setNumber(env, obj, "mismatches", (double)mismatches);
+}
+
+// BenchmarkPolicyLayout: Compare evaluate() over PolicyNode vectors with
+// evaluateLayout() over the hot columns of a large tree, untrusted, with
+// LLC misses per evaluation where perf events are available. Options
+// { nodes, allowIds, genericEvaluations, layoutEvaluations }
+// Returns a Promise resolving to { nodes, allowIds, genericEvaluations,
+// layoutEvaluations, compileUs, nodeBytes, hotBytes, indexBytes, coldBytes,
+// genericNs, layoutNs, genericLlcMisses, layoutLlcMisses, mismatches }; the
+// miss counts are null without a hardware counter
+napi_value BenchmarkPolicyLayout(napi_env env, napi_callback_info info) {
+    BenchOptions options(env, info);
+    PolicyLayoutRun* run = new PolicyLayoutRun();
+    options.count("nodes", 1, &run->nodes);
+    options.count("allowIds", 1, &run->allowIds);
+    options.count("genericEvaluations", 1, &run->genericEvaluations);
+    options.count("layoutEvaluations", 1, &run->layoutEvaluations);
+    return startBenchmark(env, "benchmarkPolicyLayout", run);
+}
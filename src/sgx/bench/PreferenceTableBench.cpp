@@ -0,0 +1,102 @@
+#include "Bench.h"
+#include "Workload.h"
+#include "../enclave/PreferenceTable.h"
+
+// ============================================================================
+// Preference Table Benchmark
+// ============================================================================
+
+struct PreferenceTableRun : BenchRun {
+    size_t evaluations = 200000;
+    size_t allowIds = 16;        // allowed attribute IDs per preference
+    size_t attributes = 255;
+    size_t purposes = 63;
+
+    double ordinalsUs = 0;       // once per policy
+    double buildNs = 0;          // per preference profile
+    double genericNs = 0;
+    double tableNs = 0;
+    uint64_t mismatches = 0;
+
+    void execute() override;
+    void report(napi_env env, napi_value obj) override;
+};
+
+void PreferenceTableRun::execute() {
+    SyntheticWorkload workload;
+    buildPreferenceWorkload(attributes, purposes, allowIds, 3, &workload);
+
+    PolicyOrdinals ordinals;
+    BenchClock::time_point start = BenchClock::now();
+    compilePolicyOrdinals(workload.policy, &ordinals);
+    ordinalsUs = (double)elapsedUs(start);
+
+    std::vector<CompiledPreference> tables(SYNTHETIC_VARIANTS);
+    const int BUILD_ROUNDS = 8;
+    start = BenchClock::now();
+    for (int r = 0; r < BUILD_ROUNDS; r++) {
+        for (size_t i = 0; i < SYNTHETIC_VARIANTS; i++) {
+            compilePreference(workload.users[i], workload.policy, ordinals, &tables[i]);
+        }
+    }
+    buildNs = elapsedUs(start) * 1000.0 / (BUILD_ROUNDS * SYNTHETIC_VARIANTS);
+
+    uint64_t grants = 0;
+    start = BenchClock::now();
+    for (size_t i = 0; i < evaluations; i++) {
+        grants += evaluate(workload.apps[i % SYNTHETIC_VARIANTS],
+                           workload.users[(i * 7919) % SYNTHETIC_VARIANTS], workload.policy);
+    }
+    genericNs = elapsedUs(start) * 1000.0 / evaluations;
+
+    start = BenchClock::now();
+    for (size_t i = 0; i < evaluations; i++) {
+        grants += evaluateCompiled(workload.apps[i % SYNTHETIC_VARIANTS],
+                                   tables[(i * 7919) % SYNTHETIC_VARIANTS],
+                                   workload.policy, ordinals);
+    }
+    tableNs = elapsedUs(start) * 1000.0 / evaluations;
+    volatile uint64_t sink = grants;
+    (void)sink;
+
+    for (size_t i = 0; i < SYNTHETIC_VARIANTS; i++) {
+        for (size_t j = 0; j < SYNTHETIC_VARIANTS; j += 7) {
+            if (evaluate(workload.apps[i], workload.users[j], workload.policy) !=
+                evaluateCompiled(workload.apps[i], tables[j], workload.policy, ordinals)) {
+                mismatches++;
+            }
+        }
+    }
+}
+
+void PreferenceTableRun::report(napi_env env, napi_value obj) {
+    double saved = genericNs - tableNs;
+
+    setNumber(env, obj, "evaluations", (double)evaluations);
+    setNumber(env, obj, "allowIds", (double)allowIds);
+    setNumber(env, obj, "attributes", (double)attributes);
+    setNumber(env, obj, "purposes", (double)purposes);
+    setNumber(env, obj, "ordinalsUs", ordinalsUs);
+    setNumber(env, obj, "buildNs", buildNs);
+    setNumber(env, obj, "genericNs", genericNs);
+    setNumber(env, obj, "tableNs", tableNs);
+    // Evaluations of one profile after which its table has paid for itself
+    setNumber(env, obj, "breakEven", saved > 0 ? buildNs / saved : -1);
+    setNumber(env, obj, "mismatches", (double)mismatches);
+}
+
+// BenchmarkPreferenceTables: Compare evaluate() with compiled preference
+// tables untrusted, and measure what a table costs to build. Options
+// { evaluations, allowIds, attributes, purposes }
+// Returns a Promise resolving to { evaluations, allowIds, attributes,
+// purposes, ordinalsUs, buildNs, genericNs, tableNs, breakEven,
+// mismatches }
+napi_value BenchmarkPreferenceTables(napi_env env, napi_callback_info info) {
+    BenchOptions options(env, info);
+    PreferenceTableRun* run = new PreferenceTableRun();
+    options.count("evaluations", 1, &run->evaluations);
+    options.count("allowIds", 1, &run->allowIds);
+    options.count("attributes", 1, &run->attributes);
+    options.count("purposes", 1, &run->purposes);
+    return startBenchmark(env, "benchmarkPreferenceTables", run);
+}
@@ -0,0 +1,109 @@
+#include "Bench.h"
+#include "Workload.h"
+
+// ============================================================================
+// Short-Circuit Benchmark
+// ============================================================================
+
+struct ShortCircuitRun : BenchRun {
+    size_t evaluations = 200000;
+    size_t allowIds = 16;        // allowed attribute IDs per preference
+    size_t attributes = 255;
+    size_t purposes = 63;
+
+    double fullNs = 0;           // every check, as evaluateReasons()
+    double fixedNs = 0;          // retention, attributes, purposes; first deny stops
+    double orderedNs = 0;        // evaluate()
+    EvaluationStageCounts stages;
+    uint64_t mismatches = 0;
+
+    void execute() override;
+    void report(napi_env env, napi_value obj) override;
+};
+
+void ShortCircuitRun::execute() {
+    SyntheticWorkload workload;
+    buildPreferenceWorkload(attributes, purposes, allowIds, 3, &workload);
+    const PolicyData& policy = workload.policy;
+
+    for (size_t i = 0; i < SYNTHETIC_VARIANTS; i++) {
+        for (size_t j = 0; j < SYNTHETIC_VARIANTS; j += 7) {
+            bool grant = reasonsGrant(evaluateReasons(workload.apps[i], workload.users[j], policy));
+            if (grant != (evaluate(workload.apps[i], workload.users[j], policy) == RESULT_GRANT)) {
+                mismatches++;
+            }
+        }
+    }
+
+    uint64_t grants = 0;
+    BenchClock::time_point start = BenchClock::now();
+    for (size_t i = 0; i < evaluations; i++) {
+        grants += reasonsGrant(evaluateReasons(workload.apps[i % SYNTHETIC_VARIANTS],
+                                               workload.users[(i * 7919) % SYNTHETIC_VARIANTS],
+                                               policy));
+    }
+    fullNs = elapsedUs(start) * 1000.0 / evaluations;
+
+    start = BenchClock::now();
+    for (size_t i = 0; i < evaluations; i++) {
+        const AppRequest& app = workload.apps[i % SYNTHETIC_VARIANTS];
+        const UserPreference& user = workload.users[(i * 7919) % SYNTHETIC_VARIANTS];
+        grants += evaluateTimeofRetention(app, user) && evaluateAttributes(app, user, policy) &&
+                  evaluatePurposes(app, user, policy);
+    }
+    fixedNs = elapsedUs(start) * 1000.0 / evaluations;
+
+    // The counters are process-wide; this run's evaluations are the only
+    // ones on this thread between the reset and the read
+    resetEvaluationStageCounts();
+    start = BenchClock::now();
+    for (size_t i = 0; i < evaluations; i++) {
+        grants += evaluate(workload.apps[i % SYNTHETIC_VARIANTS],
+                           workload.users[(i * 7919) % SYNTHETIC_VARIANTS], policy);
+    }
+    orderedNs = elapsedUs(start) * 1000.0 / evaluations;
+    evaluationStageCounts(&stages);
+    volatile uint64_t sink = grants;
+    (void)sink;
+}
+
+void ShortCircuitRun::report(napi_env env, napi_value obj) {
+    setNumber(env, obj, "evaluations", (double)evaluations);
+    setNumber(env, obj, "allowIds", (double)allowIds);
+    setNumber(env, obj, "attributes", (double)attributes);
+    setNumber(env, obj, "purposes", (double)purposes);
+    setNumber(env, obj, "fullNs", fullNs);
+    setNumber(env, obj, "fixedNs", fixedNs);
+    setNumber(env, obj, "orderedNs", orderedNs);
+
+    napi_value counts;
+    napi_create_object(env, &counts);
+    static const char* stageNames[STAGE_COUNT] = { "retention", "attributes", "purposes" };
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        napi_value stage;
+        napi_create_object(env, &stage);
+        setNumber(env, stage, "runs", (double)stages.runs[s]);
+        setNumber(env, stage, "denies", (double)stages.denies[s]);
+        napi_set_named_property(env, counts, stageNames[s], stage);
+    }
+    setNumber(env, counts, "grants", (double)stages.grants);
+    setNumber(env, counts, "purposesFirst", (double)stages.purposesFirst);
+    napi_set_named_property(env, obj, "stages", counts);
+    setNumber(env, obj, "mismatches", (double)mismatches);
+}
+
+// BenchmarkShortCircuit: Compare running every check of a decision with
+// stopping at the first deny, in fixed order and in evaluate()'s cost-ordered
+// sequence, untrusted. Options { evaluations, allowIds, attributes, purposes }
+// Returns a Promise resolving to { evaluations, allowIds, attributes,
+// purposes, fullNs, fixedNs, orderedNs, stages: { retention, attributes,
+// purposes: { runs, denies }, grants, purposesFirst }, mismatches }
+napi_value BenchmarkShortCircuit(napi_env env, napi_callback_info info) {
+    BenchOptions options(env, info);
+    ShortCircuitRun* run = new ShortCircuitRun();
+    options.count("evaluations", 1, &run->evaluations);
+    options.count("allowIds", 1, &run->allowIds);
+    options.count("attributes", 1, &run->attributes);
+    options.count("purposes", 1, &run->purposes);
+    return startBenchmark(env, "benchmarkShortCircuit", run);
+}
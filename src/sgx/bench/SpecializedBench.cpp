@@ -0,0 +1,141 @@
+#include "Bench.h"
+#include "Workload.h"
+#ifdef SPECIALIZED_POLICY
+#include "../core/GeneratedPolicy.h"
+#include <algorithm>
+#include <string>
+#endif
+
+// ============================================================================
+// Specialized Policy Benchmark
+// ============================================================================
+
+#ifdef SPECIALIZED_POLICY
+struct SpecializedRun : BenchRun {
+    size_t evaluations = 2000000;
+
+    std::string version;
+    size_t attributes = 0;
+    size_t purposes = 0;
+    double genericNs = 0;
+    double specializedNs = 0;
+    uint64_t mismatches = 0;
+
+    void execute() override;
+    void report(napi_env env, napi_value obj) override;
+};
+
+template <typename Tree>
+static void specNodes(std::vector<PolicyNode>& nodes) {
+    nodes.resize(Tree::kCount);
+    for (size_t i = 0; i < Tree::kCount; i++) {
+        nodes[i].id = Tree::kNodes[i].id;
+        nodes[i].name = nodes[i].id;
+        nodes[i].left = Tree::kNodes[i].left;
+        nodes[i].right = Tree::kNodes[i].right;
+    }
+}
+
+// The synthetic request mix of buildSyntheticWorkload over the generated
+// policy: preferences draw from the first nodes in preorder (the upper
+// levels of a nested-set tree), apps from anywhere
+static void buildSpecializedWorkload(SyntheticWorkload* w) {
+    specNodes<GeneratedPolicy::Attributes>(w->policy.attributes);
+    specNodes<GeneratedPolicy::Purposes>(w->policy.purposes);
+    const std::vector<PolicyNode>& attrs = w->policy.attributes;
+    const std::vector<PolicyNode>& purposes = w->policy.purposes;
+    size_t upperAttrs = std::min<size_t>(attrs.size(), 15);
+    size_t upperPurposes = std::min<size_t>(purposes.size(), 3);
+
+    uint32_t seed = 42;
+    w->apps.resize(SYNTHETIC_VARIANTS);
+    w->users.resize(SYNTHETIC_VARIANTS);
+    for (size_t i = 0; i < SYNTHETIC_VARIANTS; i++) {
+        AppRequest& app = w->apps[i];
+        for (uint32_t k = 1 + nextRandom(&seed) % 3; k > 0; k--) {
+            app.attributes.push_back(attrs[nextRandom(&seed) % attrs.size()]);
+        }
+        for (uint32_t k = 1 + nextRandom(&seed) % 2; k > 0; k--) {
+            app.purposes.push_back(purposes[nextRandom(&seed) % purposes.size()]);
+        }
+        app.timeofRetention = 3600 * (1 + nextRandom(&seed) % 48);
+
+        UserPreference& user = w->users[i];
+        for (uint32_t k = 1 + nextRandom(&seed) % 2; k > 0; k--) {
+            user.attributeIds.push_back(attrs[nextRandom(&seed) % upperAttrs].id);
+        }
+        if (nextRandom(&seed) % 2) {
+            user.exceptionIds.push_back(attrs[nextRandom(&seed) % attrs.size()].id);
+        }
+        user.allowedPurposeIds.push_back(purposes[nextRandom(&seed) % upperPurposes].id);
+        if (nextRandom(&seed) % 2) {
+            user.prohibitedPurposeIds.push_back(purposes[nextRandom(&seed) % purposes.size()].id);
+        }
+        user.timeofRetention = 3600 * (1 + nextRandom(&seed) % 48);
+    }
+}
+
+void SpecializedRun::execute() {
+    typedef SpecializedEvaluator<GeneratedPolicy> Specialized;
+    SyntheticWorkload workload;
+    buildSpecializedWorkload(&workload);
+    version = GeneratedPolicy::kVersion;
+    attributes = workload.policy.attributes.size();
+    purposes = workload.policy.purposes.size();
+
+    uint64_t grants = 0;
+    BenchClock::time_point start = BenchClock::now();
+    for (size_t i = 0; i < evaluations; i++) {
+        grants += evaluate(workload.apps[i % SYNTHETIC_VARIANTS],
+                           workload.users[(i * 7919) % SYNTHETIC_VARIANTS], workload.policy);
+    }
+    genericNs = elapsedUs(start) * 1000.0 / evaluations;
+
+    start = BenchClock::now();
+    for (size_t i = 0; i < evaluations; i++) {
+        grants += Specialized::evaluate(workload.apps[i % SYNTHETIC_VARIANTS],
+                                        workload.users[(i * 7919) % SYNTHETIC_VARIANTS]);
+    }
+    specializedNs = elapsedUs(start) * 1000.0 / evaluations;
+    volatile uint64_t sink = grants;
+    (void)sink;
+
+    for (size_t i = 0; i < SYNTHETIC_VARIANTS; i++) {
+        for (size_t j = 0; j < SYNTHETIC_VARIANTS; j += 7) {
+            if (evaluate(workload.apps[i], workload.users[j], workload.policy) !=
+                Specialized::evaluate(workload.apps[i], workload.users[j])) {
+                mismatches++;
+            }
+        }
+    }
+}
+void SpecializedRun::report(napi_env env, napi_value obj) {
+    napi_value versionValue;
+    napi_create_string_utf8(env, version.c_str(), version.size(), &versionValue);
+    napi_set_named_property(env, obj, "version", versionValue);
+    setNumber(env, obj, "attributes", (double)attributes);
+    setNumber(env, obj, "purposes", (double)purposes);
+    setNumber(env, obj, "evaluations", (double)evaluations);
+    setNumber(env, obj, "genericNs", genericNs);
+    setNumber(env, obj, "specializedNs", specializedNs);
+    setNumber(env, obj, "mismatches", (double)mismatches);
+}
+#endif
+
+// BenchmarkSpecializedPolicy: Compare evaluate() with the evaluator generated
+// by tools/policy-compiler, untrusted, on requests over the generated policy.
+// Options { evaluations }; requires a SPECIALIZED_POLICY build
+// Returns a Promise resolving to { version, attributes, purposes,
+// evaluations, genericNs, specializedNs, mismatches }
+napi_value BenchmarkSpecializedPolicy(napi_env env, napi_callback_info info) {
+#ifdef SPECIALIZED_POLICY
+    BenchOptions options(env, info);
+    SpecializedRun* run = new SpecializedRun();
+    options.count("evaluations", 1, &run->evaluations);
+    return startBenchmark(env, "benchmarkSpecializedPolicy", run);
+#else
+    napi_throw_error(env, nullptr,
+                     "Addon built without SPECIALIZED_POLICY; run tools/policy-compiler first");
+    return nullptr;
+#endif
+}
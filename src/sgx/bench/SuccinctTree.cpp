@@ -0,0 +1,292 @@
+#include "SuccinctTree.h"
+#include <algorithm>
+
+// ============================================================================
+// Byte Tables
+// ============================================================================
+
+// Per byte of the string, lowest bit first: the excess it adds, the lowest
+// excess reached within it, its opens and the position of each, and where
+// the excess first falls by 1-8 (8 if it does not)
+struct ParenTables {
+    int8_t total[256];
+    int8_t lowest[256];
+    uint8_t opens[256];
+    uint8_t select[256][8];
+    uint8_t fall[256][8];
+
+    ParenTables() {
+        for (int value = 0; value < 256; value++) {
+            int excess = 0, low = 8, count = 0;
+            for (int drop = 0; drop < 8; drop++) fall[value][drop] = 8;
+            for (int b = 0; b < 8; b++) {
+                if (value >> b & 1) {
+                    excess++;
+                    select[value][count++] = (uint8_t)b;
+                } else {
+                    excess--;
+                }
+                if (excess < 0 && fall[value][-excess - 1] == 8) {
+                    fall[value][-excess - 1] = (uint8_t)b;
+                }
+                low = std::min(low, excess);
+            }
+            total[value] = (int8_t)excess;
+            lowest[value] = (int8_t)low;
+            opens[value] = (uint8_t)count;
+        }
+    }
+};
+
+static const ParenTables parenTables;
+
+static uint64_t selectInWord(uint64_t word, uint32_t remaining) {
+    for (int shift = 0;; shift += 8) {
+        uint8_t byte = (uint8_t)(word >> shift);
+        uint32_t opens = parenTables.opens[byte];
+        if (remaining < opens) return shift + parenTables.select[byte][remaining];
+        remaining -= opens;
+    }
+}
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+bool SuccinctTree::build(const std::vector<PolicyNode>& nodes, std::vector<uint32_t>* preorder) {
+    struct Endpoint {
+        int value;
+        uint32_t node;
+        bool opens;
+    };
+    std::vector<Endpoint> endpoints;
+    endpoints.reserve(2 * nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        endpoints.push_back({ nodes[i].left, (uint32_t)i, true });
+        endpoints.push_back({ nodes[i].right, (uint32_t)i, false });
+    }
+    std::sort(endpoints.begin(), endpoints.end(), [](const Endpoint& a, const Endpoint& b) {
+        return a.value < b.value;
+    });
+
+    count_ = nodes.size();
+    words_.assign((endpoints.size() + 63) / 64, 0);
+    if (preorder) preorder->assign(nodes.size(), 0);
+
+    // Each close must end the innermost open node
+    std::vector<uint32_t> open;
+    uint32_t ordinal = 0;
+    bool valid = true;
+    for (size_t p = 0; p < endpoints.size() && valid; p++) {
+        const Endpoint& endpoint = endpoints[p];
+        if (p > 0 && endpoint.value == endpoints[p - 1].value) {
+            valid = false;
+        } else if (endpoint.opens) {
+            words_[p >> 6] |= 1ULL << (p & 63);
+            if (preorder) (*preorder)[endpoint.node] = ordinal;
+            ordinal++;
+            open.push_back(endpoint.node);
+        } else if (open.empty() || open.back() != endpoint.node) {
+            valid = false;
+        } else {
+            open.pop_back();
+        }
+    }
+    if (!valid) {
+        count_ = 0;
+        words_.clear();
+        if (preorder) preorder->clear();
+    }
+    buildDirectories();
+    return valid;
+}
+
+void SuccinctTree::buildDirectories() {
+    size_t blocks = (size_t)((bits() + SUCCINCT_BLOCK_BITS - 1) / SUCCINCT_BLOCK_BITS);
+    blockRanks_.assign(blocks + 1, 0);
+    wordRanks_.assign(blocks, 0);
+    selectBlocks_.clear();
+    for (size_t b = 0; b < blocks; b++) {
+        // Words past the end of the string add nothing
+        uint32_t opens = 0;
+        for (size_t inBlock = 0; inBlock < SUCCINCT_BLOCK_WORDS; inBlock++) {
+            size_t w = b * SUCCINCT_BLOCK_WORDS + inBlock;
+            if (inBlock > 0) wordRanks_[b] |= (uint64_t)opens << (9 * (inBlock - 1));
+            if (w < words_.size()) opens += (uint32_t)__builtin_popcountll(words_[w]);
+        }
+        // Samples falling in this block
+        for (uint32_t next = (uint32_t)selectBlocks_.size() * SUCCINCT_SELECT_SAMPLE;
+             next < blockRanks_[b] + opens; next += SUCCINCT_SELECT_SAMPLE) {
+            selectBlocks_.push_back((uint32_t)b);
+        }
+        blockRanks_[b + 1] = blockRanks_[b] + opens;
+    }
+
+    wordLowest_.assign(words_.size(), 0);
+    for (size_t w = 0; w < words_.size(); w++) {
+        int excess = 0, low = 64;
+        for (int shift = 0; shift < 64; shift += 8) {
+            uint8_t byte = (uint8_t)(words_[w] >> shift);
+            low = std::min(low, excess + parenTables.lowest[byte]);
+            excess += parenTables.total[byte];
+        }
+        wordLowest_[w] = (int8_t)low;
+    }
+
+    leaves_ = 1;
+    while (leaves_ < blocks) leaves_ *= 2;
+    minExcess_.assign(2 * leaves_, INT32_MAX);
+    int64_t excess = 0;
+    for (uint64_t p = 0; p < bits(); p++) {
+        excess += bit(p) ? 1 : -1;
+        int32_t& lowest = minExcess_[leaves_ + p / SUCCINCT_BLOCK_BITS];
+        lowest = std::min<int32_t>(lowest, (int32_t)excess);
+    }
+    for (size_t v = leaves_ - 1; v >= 1; v--) {
+        minExcess_[v] = std::min(minExcess_[2 * v], minExcess_[2 * v + 1]);
+    }
+}
+
+size_t SuccinctTree::bytes() const {
+    return words_.size() * sizeof(uint64_t) + blockRanks_.size() * sizeof(uint32_t) +
+           wordRanks_.size() * sizeof(uint64_t) + wordLowest_.size() * sizeof(int8_t) +
+           selectBlocks_.size() * sizeof(uint32_t) + minExcess_.size() * sizeof(int32_t);
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+
+// Opens before word inBlock (0-7) of a block, from its packed counts
+static uint32_t wordRank(uint64_t packed, size_t inBlock) {
+    return inBlock == 0 ? 0 : (uint32_t)(packed >> (9 * (inBlock - 1)) & 511);
+}
+
+uint64_t SuccinctTree::rank(uint64_t position) const {
+    size_t block = (size_t)(position / SUCCINCT_BLOCK_BITS);
+    if (block == blockRanks_.size() - 1) return blockRanks_[block];
+    size_t word = (size_t)(position >> 6);
+    uint64_t opens = blockRanks_[block] + wordRank(wordRanks_[block], word % SUCCINCT_BLOCK_WORDS);
+    if (position & 63) opens += __builtin_popcountll(words_[word] << (64 - (position & 63)));
+    return opens;
+}
+
+uint64_t SuccinctTree::select(uint32_t ordinal) const {
+    // Usually the sampled block; runs of closes can put others between
+    // two samples, so those are found by binary search on the counts
+    size_t sample = ordinal / SUCCINCT_SELECT_SAMPLE;
+    size_t block = selectBlocks_[sample];
+    if (blockRanks_[block + 1] <= ordinal) {
+        size_t last = sample + 1 < selectBlocks_.size() ? selectBlocks_[sample + 1]
+                                                        : blockRanks_.size() - 2;
+        block = (size_t)(std::upper_bound(blockRanks_.begin() + block + 1,
+                                          blockRanks_.begin() + last + 1, ordinal) -
+                         blockRanks_.begin()) - 1;
+    }
+    uint32_t remaining = ordinal - blockRanks_[block];
+    uint64_t packed = wordRanks_[block];
+    size_t inBlock = 0;
+    while (inBlock + 1 < SUCCINCT_BLOCK_WORDS && wordRank(packed, inBlock + 1) <= remaining) {
+        inBlock++;
+    }
+    size_t word = block * SUCCINCT_BLOCK_WORDS + inBlock;
+    return (uint64_t)word * 64 + selectInWord(words_[word], remaining - wordRank(packed, inBlock));
+}
+
+uint64_t SuccinctTree::scan(uint64_t from, uint64_t end, int64_t start, int64_t target) const {
+    int64_t excess = start;
+    uint64_t q = from;
+    // The first count (1-8) bits from q: the position where the excess
+    // reaches target, or end
+    auto partialByte = [&](uint64_t count) -> uint64_t {
+        uint8_t byte = (uint8_t)(words_[q >> 6] >> (q & 63));
+        int64_t drop = excess - target;
+        if (drop <= 8 && parenTables.fall[byte][drop - 1] < count) {
+            return q + parenTables.fall[byte][drop - 1];
+        }
+        excess += 2 * (int64_t)parenTables.opens[byte & ((1u << count) - 1)] - (int64_t)count;
+        q += count;
+        return end;
+    };
+
+    // Up to a byte boundary, bytes to a word boundary, then whole words
+    // and bytes while the excess cannot reach target within them
+    if ((q & 7) && q < end) {
+        uint64_t found = partialByte(std::min<uint64_t>(8 - (q & 7), end - q));
+        if (found < end) return found;
+    }
+    bool reached = false;
+    for (; q + 8 <= end && (q & 63); q += 8) {
+        uint8_t byte = (uint8_t)(words_[q >> 6] >> (q & 63));
+        if ((reached = excess + parenTables.lowest[byte] <= target)) break;
+        excess += parenTables.total[byte];
+    }
+    if (!reached) {
+        for (; q + 64 <= end; q += 64) {
+            if (excess + wordLowest_[q >> 6] <= target) break;
+            excess += 2 * (int64_t)__builtin_popcountll(words_[q >> 6]) - 64;
+        }
+        for (; q + 8 <= end; q += 8) {
+            uint8_t byte = (uint8_t)(words_[q >> 6] >> (q & 63));
+            if (excess + parenTables.lowest[byte] <= target) break;
+            excess += parenTables.total[byte];
+        }
+    }
+    return q < end ? partialByte(std::min<uint64_t>(8, end - q)) : end;
+}
+
+uint64_t SuccinctTree::blockEnd(uint64_t position) const {
+    return std::min<uint64_t>(bits(), (position / SUCCINCT_BLOCK_BITS + 1) * SUCCINCT_BLOCK_BITS);
+}
+
+int64_t SuccinctTree::blockStartExcess(size_t block) const {
+    return 2 * (int64_t)blockRanks_[block] - (int64_t)block * SUCCINCT_BLOCK_BITS;
+}
+
+uint64_t SuccinctTree::findClose(uint64_t position) const {
+    int64_t target = excess(position) - 1;
+    uint64_t from = position + 1;
+    if (from >= bits()) return bits();
+    if (!bit(from)) return from;        // a leaf
+    uint64_t end = blockEnd(from);
+    uint64_t found = scan(from, end, target + 1, target);
+    if (found < end) return found;
+
+    // The next block to the right whose lowest excess reaches target
+    size_t v = leaves_ + (size_t)(from / SUCCINCT_BLOCK_BITS);
+    for (;; v >>= 1) {
+        if (v == 1) return bits();
+        if (!(v & 1) && minExcess_[v + 1] <= target) {
+            v++;
+            break;
+        }
+    }
+    while (v < leaves_) {
+        v *= 2;
+        if (minExcess_[v] > target) v++;
+    }
+    size_t block = v - leaves_;
+    uint64_t blockStart = (uint64_t)block * SUCCINCT_BLOCK_BITS;
+    return scan(blockStart, blockEnd(blockStart), blockStartExcess(block), target);
+}
+
+// descendant opens inside ancestor unless the excess falls below the
+// ancestor's own between the two opens
+bool SuccinctTree::contains(uint32_t ancestor, uint32_t descendant) const {
+    uint64_t outer = select(ancestor), inner = select(descendant);
+    if (inner <= outer) return inner == outer;
+    int64_t target = excess(outer) - 1;
+    uint64_t end = std::min(inner, blockEnd(outer));
+    if (scan(outer + 1, end, target + 1, target) < end) return false;
+    if (end == inner) return true;
+
+    // Whole blocks between the two, through the min-max tree
+    size_t first = (size_t)(outer / SUCCINCT_BLOCK_BITS) + 1;
+    size_t last = (size_t)(inner / SUCCINCT_BLOCK_BITS);
+    for (size_t l = leaves_ + first, r = leaves_ + last; l < r; l >>= 1, r >>= 1) {
+        if ((l & 1) && minExcess_[l++] <= target) return false;
+        if ((r & 1) && minExcess_[--r] <= target) return false;
+    }
+    uint64_t blockStart = (uint64_t)last * SUCCINCT_BLOCK_BITS;
+    return scan(blockStart, inner, blockStartExcess(last), target) == inner;
+}
@@ -0,0 +1,92 @@
+#ifndef SUCCINCT_TREE_H
+#define SUCCINCT_TREE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "../enclave/Enclave.h"
+
+// ============================================================================
+// Succinct Policy Hierarchy
+// ============================================================================
+//
+// Written in preorder, a tree is a balanced-parentheses string: "(" when a
+// node is entered and ")" when it is left. Nested-set numbering counts the
+// same events, so with numbers 1..2n a node's left and right are the
+// positions (plus one) of its two parentheses. A SuccinctTree stores the
+// string as 2n bits, where the left/right columns take 64 bits per node.
+// Nodes are named by preorder ordinal:
+//   open(k)        position of the k-th "(" (select), left - 1
+//   close(k)       position of the ")" matching it (findclose), right - 1
+//   contains(a, b) open(a) <= open(b) <= close(a), as isDescendant()
+// The directories add about 0.95 bits per node: per 512-bit block, the
+// opens before it and before each of its words (seven 9-bit counts in one
+// uint64), so rank is one popcount; one block number per 512 opens for
+// select; and the lowest excess (opens minus closes) in each word, each
+// block and each run of blocks, the last two as a range min-max tree.
+// findClose and contains() scan at most two partial blocks, mostly a word
+// at a time, and cover the blocks between through the min-max tree in
+// O(log(n / 512)) steps.
+
+#define SUCCINCT_BLOCK_BITS 512
+#define SUCCINCT_BLOCK_WORDS (SUCCINCT_BLOCK_BITS / 64)
+#define SUCCINCT_SELECT_SAMPLE 512
+
+class SuccinctTree {
+public:
+    // Builds the string from nested-set nodes. Their numbers need not be
+    // 1..2n, only distinct and properly nested; they are ranked. preorder,
+    // if not null, receives each node's ordinal. False (and an empty tree)
+    // if two intervals overlap without nesting or share an endpoint.
+    bool build(const std::vector<PolicyNode>& nodes, std::vector<uint32_t>* preorder);
+
+    size_t size() const { return count_; }
+    // Bytes used in all, directories included
+    size_t bytes() const;
+
+    uint64_t open(uint32_t ordinal) const { return select(ordinal); }
+    uint64_t close(uint32_t ordinal) const { return findClose(select(ordinal)); }
+    // Whether descendant is ancestor or lies under it
+    bool contains(uint32_t ancestor, uint32_t descendant) const;
+    // Enclosing nodes above ordinal
+    uint32_t depth(uint32_t ordinal) const { return (uint32_t)(excess(select(ordinal)) - 1); }
+    // Nodes under ordinal, itself included
+    uint32_t subtreeSize(uint32_t ordinal) const {
+        uint64_t position = select(ordinal);
+        return (uint32_t)((findClose(position) - position + 1) / 2);
+    }
+
+    // Opens in [0, position)
+    uint64_t rank(uint64_t position) const;
+    // Position of the (ordinal + 1)-th open
+    uint64_t select(uint32_t ordinal) const;
+    // Opens minus closes in [0, position]
+    int64_t excess(uint64_t position) const {
+        return 2 * (int64_t)rank(position + 1) - (int64_t)(position + 1);
+    }
+    // Position of the close matching the open at position
+    uint64_t findClose(uint64_t position) const;
+
+private:
+    bool bit(uint64_t position) const { return (words_[position >> 6] >> (position & 63)) & 1; }
+    // First q in [from, end) with excess(q) == target, given
+    // excess(from - 1) == start > target; end if there is none
+    uint64_t scan(uint64_t from, uint64_t end, int64_t start, int64_t target) const;
+    uint64_t blockEnd(uint64_t position) const;
+    int64_t blockStartExcess(size_t block) const;
+    void buildDirectories();
+    uint64_t bits() const { return 2 * (uint64_t)count_; }
+
+    size_t count_ = 0;
+    std::vector<uint64_t> words_;         // bit i set: position i opens
+    std::vector<uint32_t> blockRanks_;    // opens before each block, one more at the end
+    std::vector<uint64_t> wordRanks_;     // per block, 9 bits per word 1-7: opens before it
+    std::vector<uint32_t> selectBlocks_;  // block of every SUCCINCT_SELECT_SAMPLE-th open
+    std::vector<int8_t> wordLowest_;      // lowest excess within each word, from its start
+    // Min-max tree over blocks, heap-ordered from 1: leaf b at leaves_ + b
+    // holds the lowest excess in block b; padding leaves hold INT32_MAX
+    std::vector<int32_t> minExcess_;
+    size_t leaves_ = 0;
+};
+
+#endif // SUCCINCT_TREE_H
@@ -0,0 +1,153 @@
+#include "Bench.h"
+#include "SuccinctTree.h"
+#include "Workload.h"
+
+// ============================================================================
+// Succinct Tree Benchmark
+// ============================================================================
+
+struct SuccinctTreeRun : BenchRun {
+    std::vector<size_t> nodes = { 1000000, 4000000 };
+    size_t queries = 1 << 20;        // pairs per set, cycled through
+    double minUs = 200000;           // timed per kernel, set and size
+
+    struct Size {
+        size_t nodes;
+        double buildMs;
+        size_t intervalBytes;
+        size_t succinctBytes;
+        double intervalRandomNs;
+        double succinctRandomNs;
+        double intervalAncestorNs;
+        double succinctAncestorNs;
+        double succinctCloseNs;
+        uint64_t mismatches;
+    };
+    std::vector<Size> sizes;
+
+    void execute() override;
+    void report(napi_env env, napi_value obj) override;
+};
+
+void SuccinctTreeRun::execute() {
+    for (size_t count : nodes) {
+        SuccinctTreeRun::Size size = {};
+        size.nodes = count;
+
+        std::vector<PolicyNode> policyNodes;
+        buildTree(policyNodes, count, "attr-");
+        SuccinctTree tree;
+        std::vector<uint32_t> preorder;
+        BenchClock::time_point start = BenchClock::now();
+        tree.build(policyNodes, &preorder);
+        size.buildMs = elapsedUs(start) / 1000.0;
+        size.succinctBytes = tree.bytes();
+
+        // The interval arrays it replaces, by the same ordinals
+        std::vector<int32_t> left(count), right(count);
+        for (size_t i = 0; i < count; i++) {
+            left[preorder[i]] = policyNodes[i].left;
+            right[preorder[i]] = policyNodes[i].right;
+        }
+        size.intervalBytes = 2 * count * sizeof(int32_t);
+        policyNodes = std::vector<PolicyNode>();
+
+        // Random pairs, and pairs whose first node is an ancestor of the
+        // second (any number of levels up the heap-ordered tree)
+        uint32_t seed = 5;
+        std::vector<uint32_t> randomPairs(2 * queries), ancestorPairs(2 * queries);
+        for (size_t q = 0; q < queries; q++) {
+            randomPairs[2 * q] = nextRandom(&seed) % count;
+            randomPairs[2 * q + 1] = nextRandom(&seed) % count;
+            size_t node = ((size_t)nextRandom(&seed) << 8 ^ nextRandom(&seed)) % count;
+            size_t ancestor = node;
+            for (uint32_t up = nextRandom(&seed) % 24; up > 0 && ancestor > 0; up--) {
+                ancestor = (ancestor - 1) / 2;
+            }
+            ancestorPairs[2 * q] = preorder[ancestor];
+            ancestorPairs[2 * q + 1] = preorder[node];
+        }
+
+        for (const std::vector<uint32_t>* pairs : { &randomPairs, &ancestorPairs }) {
+            for (size_t q = 0; q < queries; q++) {
+                uint32_t a = (*pairs)[2 * q], b = (*pairs)[2 * q + 1];
+                bool expected = left[a] <= left[b] && right[a] >= right[b];
+                if (tree.contains(a, b) != expected) size.mismatches++;
+            }
+        }
+
+        size_t mask = queries - 1;
+        auto intervalKernel = [&](const std::vector<uint32_t>& pairs) {
+            return timePerCall(minUs, [&](size_t i) {
+                uint32_t a = pairs[2 * (i & mask)], b = pairs[2 * (i & mask) + 1];
+                return (int)(left[a] <= left[b] && right[a] >= right[b]);
+            });
+        };
+        auto succinctKernel = [&](const std::vector<uint32_t>& pairs) {
+            return timePerCall(minUs, [&](size_t i) {
+                return (int)tree.contains(pairs[2 * (i & mask)], pairs[2 * (i & mask) + 1]);
+            });
+        };
+        size.intervalRandomNs = intervalKernel(randomPairs);
+        size.succinctRandomNs = succinctKernel(randomPairs);
+        size.intervalAncestorNs = intervalKernel(ancestorPairs);
+        size.succinctAncestorNs = succinctKernel(ancestorPairs);
+        size.succinctCloseNs = timePerCall(minUs, [&](size_t i) {
+            return (int)tree.close(randomPairs[2 * (i & mask)]);
+        });
+        sizes.push_back(size);
+    }
+}
+
+void SuccinctTreeRun::report(napi_env env, napi_value obj) {
+    setNumber(env, obj, "queries", (double)queries);
+    napi_value list;
+    napi_create_array_with_length(env, sizes.size(), &list);
+    for (size_t i = 0; i < sizes.size(); i++) {
+        const SuccinctTreeRun::Size& size = sizes[i];
+        napi_value entry;
+        napi_create_object(env, &entry);
+        setNumber(env, entry, "nodes", (double)size.nodes);
+        setNumber(env, entry, "buildMs", size.buildMs);
+        setNumber(env, entry, "intervalBytes", (double)size.intervalBytes);
+        setNumber(env, entry, "succinctBytes", (double)size.succinctBytes);
+        setNumber(env, entry, "intervalRandomNs", size.intervalRandomNs);
+        setNumber(env, entry, "succinctRandomNs", size.succinctRandomNs);
+        setNumber(env, entry, "intervalAncestorNs", size.intervalAncestorNs);
+        setNumber(env, entry, "succinctAncestorNs", size.succinctAncestorNs);
+        setNumber(env, entry, "succinctCloseNs", size.succinctCloseNs);
+        setNumber(env, entry, "mismatches", (double)size.mismatches);
+        napi_set_element(env, list, i, entry);
+    }
+    napi_set_named_property(env, obj, "sizes", list);
+}
+
+// BenchmarkSuccinctTree: Compare SuccinctTree (bench/SuccinctTree.h) with
+// left/right int32 arrays on complete binary trees of each size: bytes,
+// and ns per containment check on random pairs and on ancestor pairs, plus
+// ns per close(). Options { nodes: [...], queries (rounded down to a power
+// of two), minUs }
+// Returns a Promise resolving to { queries, sizes: [{ nodes, buildMs,
+// intervalBytes, succinctBytes, intervalRandomNs, succinctRandomNs,
+// intervalAncestorNs, succinctAncestorNs, succinctCloseNs, mismatches }] }
+napi_value BenchmarkSuccinctTree(napi_env env, napi_callback_info info) {
+    BenchOptions options(env, info);
+    SuccinctTreeRun* run = new SuccinctTreeRun();
+    double number;
+    if (options.number("queries", &number) && number >= 1) {
+        size_t queries = 1;
+        while (queries * 2 <= (size_t)number) queries *= 2;
+        run->queries = queries;
+    }
+    if (options.number("minUs", &number) && number > 0) {
+        run->minUs = number;
+    }
+    std::vector<double> sizes;
+    if (options.numbers("nodes", &sizes)) {
+        run->nodes.clear();
+        for (double size : sizes) {
+            if (size >= 1) run->nodes.push_back((size_t)size);
+        }
+    }
+    return startBenchmark(env, "benchmarkSuccinctTree", run);
+}
@@ -0,0 +1,72 @@
+#include "Bench.h"
+#include "Workload.h"
+#include "../core/ThreadPool.h"
+#include <atomic>
+
+// ============================================================================
+// Scaling Benchmark
+// ============================================================================
+
+struct ScalingRun : BenchRun {
+    unsigned threads = 1;
+    size_t evaluations = 10000000;
+    size_t grain = 0;
+    bool pinCores = false;
+
+    uint64_t wallUs = 0;
+    std::atomic<uint64_t> grants{0};
+    ThreadPoolStats stats;
+
+    void execute() override {
+        SyntheticWorkload workload;
+        buildSyntheticWorkload(&workload);
+
+        // Pool start-up is outside the timed region
+        WorkStealingPool pool((int)threads - 1, pinCores);
+        BenchClock::time_point start = BenchClock::now();
+        pool.parallelFor(0, evaluations, grain, [this, &workload](size_t begin, size_t end) {
+            uint64_t granted = 0;
+            for (size_t i = begin; i < end; i++) {
+                const AppRequest& app = workload.apps[i % SYNTHETIC_VARIANTS];
+                const UserPreference& user = workload.users[(i * 7919) % SYNTHETIC_VARIANTS];
+                if (evaluate(app, user, workload.policy) == RESULT_GRANT) granted++;
+            }
+            grants.fetch_add(granted, std::memory_order_relaxed);
+        });
+        wallUs = elapsedUs(start);
+        stats = pool.stats();
+    }
+
+    void report(napi_env env, napi_value obj) override {
+        double elapsedSec = wallUs / 1e6;
+        setNumber(env, obj, "threads", threads);
+        setNumber(env, obj, "evaluations", (double)evaluations);
+        setNumber(env, obj, "grants", (double)grants.load());
+        setNumber(env, obj, "elapsedMs", wallUs / 1000.0);
+        setNumber(env, obj, "evaluationsPerSec", elapsedSec > 0 ? evaluations / elapsedSec : 0);
+
+        napi_value pool;
+        napi_create_object(env, &pool);
+        setNumber(env, pool, "tasks", (double)stats.tasks);
+        setNumber(env, pool, "splits", (double)stats.splits);
+        setNumber(env, pool, "steals", (double)stats.steals);
+        setNumber(env, pool, "sleeps", (double)stats.sleeps);
+        napi_set_named_property(env, obj, "pool", pool);
+    }
+};
+
+// BenchmarkWorkStealing: Run a synthetic evaluation job untrusted, on a
+// dedicated pool of { threads, evaluations, grain, pinCores }
+// Returns a Promise resolving to { threads, evaluations, grants, elapsedMs,
+// evaluationsPerSec, pool: { tasks, splits, steals, sleeps } }
+napi_value BenchmarkWorkStealing(napi_env env, napi_callback_info info) {
+    BenchOptions options(env, info);
+    ScalingRun* run = new ScalingRun();
+    size_t threads = run->threads;
+    options.count("threads", 1, &threads);
+    run->threads = (unsigned)threads;
+    options.count("evaluations", 1, &run->evaluations);
+    options.count("grain", 1, &run->grain);
+    options.flag("pinCores", &run->pinCores);
+    return startBenchmark(env, "benchmarkWorkStealing", run);
+}
@@ -0,0 +1,91 @@
+#include "Workload.h"
+#include <algorithm>
+#include <string>
+
+// Preorder nested-set numbering of a complete binary tree stored heap-style
+static int numberTree(std::vector<PolicyNode>& nodes, size_t index, int counter) {
+    if (index >= nodes.size()) return counter;
+    nodes[index].left = counter++;
+    counter = numberTree(nodes, 2 * index + 1, counter);
+    counter = numberTree(nodes, 2 * index + 2, counter);
+    nodes[index].right = counter++;
+    return counter;
+}
+
+void buildTree(std::vector<PolicyNode>& nodes, size_t count, const char* prefix) {
+    nodes.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        nodes[i].id = prefix + std::to_string(i);
+        nodes[i].name = nodes[i].id;
+    }
+    numberTree(nodes, 0, 1);
+}
+
+void buildSyntheticWorkload(SyntheticWorkload* w) {
+    buildTree(w->policy.attributes, 63, "attr-");
+    buildTree(w->policy.purposes, 15, "purpose-");
+    const std::vector<PolicyNode>& attrs = w->policy.attributes;
+    const std::vector<PolicyNode>& purposes = w->policy.purposes;
+
+    uint32_t seed = 42;
+    w->apps.resize(SYNTHETIC_VARIANTS);
+    w->users.resize(SYNTHETIC_VARIANTS);
+    for (size_t i = 0; i < SYNTHETIC_VARIANTS; i++) {
+        AppRequest& app = w->apps[i];
+        for (uint32_t k = 1 + nextRandom(&seed) % 3; k > 0; k--) {
+            app.attributes.push_back(attrs[nextRandom(&seed) % attrs.size()]);
+        }
+        for (uint32_t k = 1 + nextRandom(&seed) % 2; k > 0; k--) {
+            app.purposes.push_back(purposes[nextRandom(&seed) % purposes.size()]);
+        }
+        app.timeofRetention = 3600 * (1 + nextRandom(&seed) % 48);
+
+        UserPreference& user = w->users[i];
+        for (uint32_t k = 1 + nextRandom(&seed) % 2; k > 0; k--) {
+            user.attributeIds.push_back(attrs[nextRandom(&seed) % 15].id);
+        }
+        if (nextRandom(&seed) % 2) {
+            user.exceptionIds.push_back(attrs[nextRandom(&seed) % attrs.size()].id);
+        }
+        user.allowedPurposeIds.push_back(purposes[nextRandom(&seed) % 3].id);
+        if (nextRandom(&seed) % 2) {
+            user.prohibitedPurposeIds.push_back(purposes[nextRandom(&seed) % purposes.size()].id);
+        }
+        user.timeofRetention = 3600 * (1 + nextRandom(&seed) % 48);
+    }
+}
+
+void buildPreferenceWorkload(size_t attributes, size_t purposeCount, size_t allowIds,
+                             size_t appNodes, SyntheticWorkload* w, size_t variants) {
+    buildTree(w->policy.attributes, attributes, "attr-");
+    buildTree(w->policy.purposes, purposeCount, "purpose-");
+    const std::vector<PolicyNode>& attrs = w->policy.attributes;
+    const std::vector<PolicyNode>& purposes = w->policy.purposes;
+
+    uint32_t seed = 42;
+    w->apps.resize(variants);
+    w->users.resize(variants);
+    for (size_t i = 0; i < variants; i++) {
+        AppRequest& app = w->apps[i];
+        for (size_t k = 1 + nextRandom(&seed) % appNodes; k > 0; k--) {
+            app.attributes.push_back(attrs[nextRandom(&seed) % attrs.size()]);
+        }
+        for (size_t k = 1 + nextRandom(&seed) % ((appNodes + 1) / 2); k > 0; k--) {
+            app.purposes.push_back(purposes[nextRandom(&seed) % purposes.size()]);
+        }
+        app.timeofRetention = 3600 * (1 + nextRandom(&seed) % 48);
+
+        UserPreference& user = w->users[i];
+        for (size_t k = 0; k < allowIds; k++) {
+            user.attributeIds.push_back(attrs[nextRandom(&seed) % attrs.size()].id);
+        }
+        for (size_t k = 0; k < allowIds / 2; k++) {
+            user.exceptionIds.push_back(attrs[nextRandom(&seed) % attrs.size()].id);
+        }
+        for (size_t k = 0; k < std::max<size_t>(1, allowIds / 4); k++) {
+            user.allowedPurposeIds.push_back(purposes[nextRandom(&seed) % purposes.size()].id);
+            user.prohibitedPurposeIds.push_back(purposes[nextRandom(&seed) % purposes.size()].id);
+        }
+        user.timeofRetention = 3600 * (1 + nextRandom(&seed) % 48);
+    }
+}
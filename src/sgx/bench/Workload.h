@@ -0,0 +1,46 @@
+#ifndef BENCH_WORKLOAD_H
+#define BENCH_WORKLOAD_H
+
+#include "../enclave/Enclave.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// ============================================================================
+// Synthetic Workloads
+// ============================================================================
+//
+// Deterministic policies and request mixes shared by the harnesses, so the
+// same seed gives the same decisions in every benchmark.
+
+// Distinct app requests / user preferences the synthetic benchmarks cycle through
+#define SYNTHETIC_VARIANTS 1024
+
+struct SyntheticWorkload {
+    PolicyData policy;
+    std::vector<AppRequest> apps;
+    std::vector<UserPreference> users;
+};
+
+inline uint32_t nextRandom(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+// count nodes named prefix0, prefix1, ... numbered as a complete binary tree
+// stored heap-style
+void buildTree(std::vector<PolicyNode>& nodes, size_t count, const char* prefix);
+
+// 63 attributes and 15 purposes; users reference inner nodes so that grants
+// and denies both occur
+void buildSyntheticWorkload(SyntheticWorkload* w);
+
+// variants preferences with allowIds allowed attributes, half as many
+// exceptions and a quarter as many allowed and prohibited purposes, anywhere
+// in the trees; as many apps, requesting up to appNodes attributes and half
+// as many purposes
+void buildPreferenceWorkload(size_t attributes, size_t purposeCount, size_t allowIds,
+                             size_t appNodes, SyntheticWorkload* w,
+                             size_t variants = SYNTHETIC_VARIANTS);
+
+#endif // BENCH_WORKLOAD_H
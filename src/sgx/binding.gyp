@@ -1,12 +1,63 @@
 {
+  "variables": {
+    "sgx_mode%": "HW",
+    "specialized_policy%": "0"
+  },
   "targets": [
     {
       "target_name": "sgx-addon",
       "sources": [
         "app/App.cpp",
         "app/App.h",
+        "app/Dispatcher.cpp",
+        "app/Dispatcher.h",
+        "app/Bulk.cpp",
+        "app/Bulk.h",
+        "app/DaemonClient.cpp",
+        "app/DaemonClient.h",
+        "app/DecisionCache.cpp",
+        "app/DecisionCache.h",
+        "app/SharedCache.cpp",
+        "app/SharedCache.h",
+        "app/SecureChannel.cpp",
+        "app/SecureChannel.h",
+        "app/Snapshot.cpp",
+        "app/Snapshot.h",
+        "core/BloomFilter.h",
+        "core/DecisionColumns.cpp",
+        "core/DecisionColumns.h",
+        "core/EvalProtocol.cpp",
+        "core/EvalProtocol.h",
+        "core/EvaluationInput.cpp",
+        "core/EvaluationInput.h",
+        "core/ExpiringDecisionCache.cpp",
+        "core/ExpiringDecisionCache.h",
+        "core/Hash.h",
+        "core/Json.cpp",
+        "core/Json.h",
+        "core/NdjsonAudit.cpp",
+        "core/NdjsonAudit.h",
+        "core/ObjectId.cpp",
+        "core/ObjectId.h",
+        "core/SharedDecisionCache.cpp",
+        "core/SharedDecisionCache.h",
+        "core/SpecializedPolicy.h",
+        "core/ThreadPool.cpp",
+        "core/ThreadPool.h",
+        "core/TimingWheel.h",
+        "enclave/Channel.h",
+        "enclave/ConstantTime.cpp",
+        "enclave/ConstantTime.h",
         "enclave/Enclave.cpp",
         "enclave/Enclave.h",
+        "enclave/EnclaveCache.cpp",
+        "enclave/EnclaveCache.h",
+        "enclave/EvaluationPlanner.cpp",
+        "enclave/EvaluationPlanner.h",
+        "enclave/PolicyLayout.cpp",
+        "enclave/PolicyLayout.h",
+        "enclave/PreferenceTable.cpp",
+        "enclave/PreferenceTable.h",
         "enclave/Edl/PrivacyEvaluation_edl.c",
         "enclave/Edl/PrivacyEvaluation_u.c",
         "enclave/Edl/PrivacyEvaluation_t.c"
@@ -15,25 +66,227 @@
         "<!(node -e \"require('nan')\")",
         "/opt/intel/sgxsdk/include",
         "enclave",
-        "app"
+        "app",
+        "core"
       ],
       "libraries": [
-        "-lsgx_urts",
-        "-lsgx_uae_service",
+        "-lrt",
         "-L/opt/intel/sgxsdk/lib64"
       ],
       "cflags!": [ "-fno-exceptions" ],
       "cflags_cc!": [ "-fno-exceptions" ],
       "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS" ],
       "conditions": [
+        [
+          "specialized_policy==1",
+          { "defines": [ "SPECIALIZED_POLICY" ] }
+        ],
+        [
+          "sgx_mode=='SIM'",
+          { "libraries": [ "-lsgx_urts_sim", "-lsgx_uae_service_sim" ] },
+          { "libraries": [ "-lsgx_urts", "-lsgx_uae_service" ] }
+        ],
+        [
+          "OS=='linux'",
+          {
+            "cflags": [ "-fPIC", "-pthread" ],
+            "cflags_cc": [ "-fPIC", "-std=c++17", "-pthread" ]
+          }
+        ]
+      ]
+    },
+    {
+      "target_name": "bench-addon",
+      "sources": [
+        "bench/AppNormalizationBench.cpp",
+        "bench/BatchPrefetchBench.cpp",
+        "bench/Bench.cpp",
+        "bench/Bench.h",
+        "bench/CalibrationBench.cpp",
+        "bench/ConstantTimeBench.cpp",
+        "bench/LargeRequestBench.cpp",
+        "bench/ObjectIdBench.cpp",
+        "bench/PolicyDagBench.cpp",
+        "bench/PolicyLayoutBench.cpp",
+        "bench/PreferenceTableBench.cpp",
+        "bench/ShortCircuitBench.cpp",
+        "bench/SpecializedBench.cpp",
+        "bench/SuccinctTree.cpp",
+        "bench/SuccinctTree.h",
+        "bench/SuccinctTreeBench.cpp",
+        "bench/WorkStealingBench.cpp",
+        "bench/Workload.cpp",
+        "bench/Workload.h",
+        "core/EvaluationInput.cpp",
+        "core/Json.cpp",
+        "core/ObjectId.cpp",
+        "core/PolicyDag.cpp",
+        "core/PolicyDag.h",
+        "core/ThreadPool.cpp",
+        "enclave/ConstantTime.cpp",
+        "enclave/Enclave.cpp",
+        "enclave/EnclaveCache.cpp",
+        "enclave/EvaluationPlanner.cpp",
+        "enclave/PolicyLayout.cpp",
+        "enclave/PreferenceTable.cpp"
+      ],
+      "include_dirs": [
+        "/opt/intel/sgxsdk/include",
+        "enclave",
+        "core"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS" ],
+      "conditions": [
+        [
+          "specialized_policy==1",
+          { "defines": [ "SPECIALIZED_POLICY" ] }
+        ],
+        [
+          "OS=='linux'",
+          {
+            "cflags": [ "-fPIC", "-pthread" ],
+            "cflags_cc": [ "-fPIC", "-std=c++17", "-pthread" ]
+          }
+        ]
+      ]
+    },
+    {
+      "target_name": "ndjson-audit",
+      "type": "executable",
+      "sources": [
+        "tools/ndjson-audit.cpp",
+        "core/DecisionColumns.cpp",
+        "core/EvaluationInput.cpp",
+        "core/Json.cpp",
+        "core/NdjsonAudit.cpp",
+        "core/ObjectId.cpp",
+        "core/ThreadPool.cpp",
+        "enclave/ConstantTime.cpp",
+        "enclave/Enclave.cpp",
+        "enclave/EnclaveCache.cpp",
+        "enclave/EvaluationPlanner.cpp",
+        "enclave/PolicyLayout.cpp",
+        "enclave/PreferenceTable.cpp"
+      ],
+      "include_dirs": [
+        "/opt/intel/sgxsdk/include",
+        "enclave",
+        "core"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "conditions": [
+        [
+          "specialized_policy==1",
+          { "defines": [ "SPECIALIZED_POLICY" ] }
+        ],
         [
           "OS=='linux'",
           {
-            "cflags": [ "-fPIC" ],
-            "cflags_cc": [ "-fPIC", "-std=c++17" ]
+            "cflags": [ "-pthread" ],
+            "cflags_cc": [ "-std=c++17", "-pthread" ],
+            "ldflags": [ "-pthread" ]
           }
         ]
       ]
+    },
+    {
+      "target_name": "eval-daemon",
+      "type": "executable",
+      "sources": [
+        "tools/eval-daemon.cpp",
+        "core/EvalDaemon.cpp",
+        "core/EvalProtocol.cpp",
+        "core/EvaluationInput.cpp",
+        "core/Json.cpp",
+        "core/ObjectId.cpp",
+        "enclave/ConstantTime.cpp",
+        "enclave/Enclave.cpp",
+        "enclave/EnclaveCache.cpp",
+        "enclave/EvaluationPlanner.cpp",
+        "enclave/PolicyLayout.cpp",
+        "enclave/PreferenceTable.cpp",
+        "enclave/Edl/PrivacyEvaluation_u.c"
+      ],
+      "include_dirs": [
+        "/opt/intel/sgxsdk/include",
+        "enclave",
+        "app",
+        "core"
+      ],
+      "libraries": [
+        "-L/opt/intel/sgxsdk/lib64"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "conditions": [
+        [
+          "specialized_policy==1",
+          { "defines": [ "SPECIALIZED_POLICY" ] }
+        ],
+        [
+          "sgx_mode=='SIM'",
+          { "libraries": [ "-lsgx_urts_sim" ] },
+          { "libraries": [ "-lsgx_urts" ] }
+        ],
+        [
+          "OS=='linux'",
+          {
+            "cflags": [ "-pthread" ],
+            "cflags_cc": [ "-std=c++17", "-pthread" ],
+            "ldflags": [ "-pthread" ]
+          }
+        ]
+      ]
+    },
+    {
+      "target_name": "policy-compiler",
+      "type": "executable",
+      "sources": [
+        "tools/policy-compiler.cpp",
+        "core/EvaluationInput.cpp",
+        "core/Json.cpp",
+        "core/ObjectId.cpp",
+        "enclave/PolicyLayout.cpp"
+      ],
+      "include_dirs": [
+        "enclave",
+        "core"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "conditions": [
+        [
+          "OS=='linux'",
+          { "cflags_cc": [ "-std=c++17" ] }
+        ]
+      ]
+    },
+    {
+      "target_name": "policy-labeler",
+      "type": "executable",
+      "sources": [
+        "tools/policy-labeler.cpp",
+        "core/EvaluationInput.cpp",
+        "core/Json.cpp",
+        "core/ObjectId.cpp",
+        "core/PolicyDag.cpp",
+        "enclave/PolicyLayout.cpp"
+      ],
+      "include_dirs": [
+        "enclave",
+        "core"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "conditions": [
+        [
+          "OS=='linux'",
+          { "cflags_cc": [ "-std=c++17" ] }
+        ]
+      ]
     }
   ]
 }
@@ -32,6 +32,50 @@ ENCLAVE_DIR="$SCRIPT_DIR/enclave"
 APP_DIR="$SCRIPT_DIR/app"
 EDL_DIR="$ENCLAVE_DIR/Edl"
 
+# SGX_MODE=SIM builds against the simulation libraries (no SGX hardware)
+if [ "$SGX_MODE" = "SIM" ]; then
+    TRTS_LIB=sgx_trts_sim
+    TSERVICE_LIB=sgx_tservice_sim
+    echo -e "${YELLOW}Building in simulation mode${NC}"
+else
+    TRTS_LIB=sgx_trts
+    TSERVICE_LIB=sgx_tservice
+fi
+
+# CONSTANT_TIME=1 evaluates cache misses with the branch-free kernel
+# (enclave/ConstantTime.h); the choice is part of the enclave measurement
+ENCLAVE_DEFINES="-DENCLAVE_CODE"
+if [ "$CONSTANT_TIME" = "1" ]; then
+    ENCLAVE_DEFINES="$ENCLAVE_DEFINES -DCONSTANT_TIME_EVALUATION"
+    echo -e "${YELLOW}Building with constant-time evaluation${NC}"
+fi
+
+# PREFERENCE_TABLES=1 plans each decision-cache miss (enclave/EvaluationPlanner.h)
+# and compiles recurring preference profiles into verdict tables over policy
+# ordinals (enclave/PreferenceTable.h)
+if [ "$PREFERENCE_TABLES" = "1" ]; then
+    ENCLAVE_DEFINES="$ENCLAVE_DEFINES -DPREFERENCE_TABLES"
+    echo -e "${YELLOW}Building with compiled preference tables${NC}"
+fi
+
+# POLICY_LAYOUT=1 keeps each compiled policy in cache-line aligned hot columns
+# with a separate string pool (enclave/PolicyLayout.h) and evaluates misses there
+if [ "$POLICY_LAYOUT" = "1" ]; then
+    ENCLAVE_DEFINES="$ENCLAVE_DEFINES -DPOLICY_LAYOUT"
+    echo -e "${YELLOW}Building with the hot/cold policy layout${NC}"
+fi
+
+# SPECIALIZED_POLICY=1 compiles core/GeneratedPolicy.h (tools/policy-compiler)
+# into the enclave and the addon; that policy is then evaluated with bit tests
+if [ "$SPECIALIZED_POLICY" = "1" ]; then
+    if [ ! -f "$SCRIPT_DIR/core/GeneratedPolicy.h" ]; then
+        echo -e "${RED}Error: core/GeneratedPolicy.h not found; run policy-compiler first${NC}"
+        exit 1
+    fi
+    ENCLAVE_DEFINES="$ENCLAVE_DEFINES -DSPECIALIZED_POLICY"
+    echo -e "${YELLOW}Building with the specialized policy evaluator${NC}"
+fi
+
 # Create build directory
 mkdir -p "$BUILD_DIR"
 
@@ -58,16 +102,26 @@ echo -e "${YELLOW}Step 2: Building SGX Enclave...${NC}"
 
 cd "$BUILD_DIR"
 
-# Compile enclave
+# Compile enclave (requests are parsed with the native tools' JSON readers
+# from core/)
 g++ -g -O2 -fPIC -std=c++17 \
     -I"$SGX_SDK/include" \
     -I"$ENCLAVE_DIR" \
     -I"$EDL_DIR" \
-    -DENCLAVE_CODE \
+    $ENCLAVE_DEFINES \
+    -c \
     "$ENCLAVE_DIR/Enclave.cpp" \
-    "$ENCLAVE_DIR/PrivacyEvaluation_t.c" \
-    -o "$BUILD_DIR/enclave.o" \
-    -c
+    "$ENCLAVE_DIR/EnclaveCache.cpp" \
+    "$ENCLAVE_DIR/ConstantTime.cpp" \
+    "$ENCLAVE_DIR/PreferenceTable.cpp" \
+    "$ENCLAVE_DIR/EvaluationPlanner.cpp" \
+    "$ENCLAVE_DIR/PolicyLayout.cpp" \
+    "$ENCLAVE_DIR/Seal.cpp" \
+    "$ENCLAVE_DIR/Channel.cpp" \
+    "$SCRIPT_DIR/core/Json.cpp" \
+    "$SCRIPT_DIR/core/EvaluationInput.cpp" \
+    "$SCRIPT_DIR/core/ObjectId.cpp" \
+    "$ENCLAVE_DIR/PrivacyEvaluation_t.c"
 
 if [ $? -ne 0 ]; then
     echo -e "${RED}Error: Enclave compilation failed${NC}"
@@ -76,7 +130,8 @@ fi
 
 # Link enclave
 g++ -g -O2 \
-    "$BUILD_DIR/enclave.o" \
+    Enclave.o EnclaveCache.o ConstantTime.o PreferenceTable.o EvaluationPlanner.o PolicyLayout.o Seal.o Channel.o \
+    Json.o EvaluationInput.o ObjectId.o PrivacyEvaluation_t.o \
     -o "$BUILD_DIR/enclave.so" \
     -Wl,--no-undefined \
     -Wl,-z,noexecstack \
@@ -84,8 +139,9 @@ g++ -g -O2 \
     -L"$SGX_SDK/lib64" \
     -lsgx_tstdc \
     -lsgx_tcxx \
-    -lsgx_tservice \
-    -lsgx_trts \
+    -l$TSERVICE_LIB \
+    -lsgx_tcrypto \
+    -l$TRTS_LIB \
     -Wl,--version-script="$ENCLAVE_DIR/Enclave.lds"
 
 # Generate Enclave.lds if it doesn't exist
@@ -133,7 +189,9 @@ cd "$SCRIPT_DIR"
 cp "$BUILD_DIR/enclave.signed.so" "$APP_DIR/enclave.signed.so"
 
 # Build with node-gyp
-npm run build-addon || node-gyp rebuild
+# (node-gyp passes --sgx_mode and --specialized_policy through to binding.gyp
+# as variables)
+node-gyp rebuild --sgx_mode="${SGX_MODE:-HW}" --specialized_policy="${SPECIALIZED_POLICY:-0}"
 
 if [ $? -ne 0 ]; then
     echo -e "${RED}Error: node-gyp build failed${NC}"
@@ -0,0 +1,65 @@
+/**
+ * Encrypted Request Channel - client side
+ *
+ * Seals app requests and privacy preferences so that only the enclave can
+ * read them (enclave/Channel.h). Runs on the gateway or device:
+ *
+ *   const client = new SecureChannelClient();
+ *   // send client.publicKey to POST /api/channel, then
+ *   client.accept(response);              // { sessionId, enclavePublicKey }
+ *   const sealed = client.seal(app, user.privacyPreference);
+ *
+ * Uses only Node's crypto module; no addon needed.
+ */
+
+import crypto from "crypto";
+
+// Must match CHANNEL_KEY_LABEL / CHANNEL_IV_LEN in enclave/Channel.h
+const KEY_LABEL = "privacy-channel-v1";
+const IV_LENGTH = 12;
+
+export class SecureChannelClient {
+  constructor() {
+    this.ecdh = crypto.createECDH("prime256v1");
+    this.publicKey = this.ecdh.generateKeys();
+    this.sessionId = null;
+    this.key = null;
+  }
+
+  /**
+   * Derive the session key from the enclave's half of the exchange
+   * @param {Object} response - { sessionId, enclavePublicKey (Buffer) }
+   */
+  accept({ sessionId, enclavePublicKey }) {
+    // The enclave hashes the shared x coordinate little-endian
+    const shared = Buffer.from(this.ecdh.computeSecret(enclavePublicKey)).reverse();
+    this.key = crypto
+      .createHash("sha256")
+      .update(KEY_LABEL)
+      .update(shared)
+      .digest()
+      .subarray(0, 16);
+    this.sessionId = sessionId;
+  }
+
+  /**
+   * Encrypt one request for evaluateEncrypted()
+   * @param {Object} app - { attributes, purposes, timeofRetention }
+   * @param {Object} preference - The user's privacyPreference
+   * @returns {Buffer} - iv | tag | ciphertext
+   */
+  seal(app, preference) {
+    if (!this.key) {
+      throw new Error("Channel not established: call accept() first");
+    }
+    const iv = crypto.randomBytes(IV_LENGTH);
+    const aad = Buffer.alloc(4);
+    aad.writeUInt32LE(this.sessionId);
+
+    const cipher = crypto.createCipheriv("aes-128-gcm", this.key, iv);
+    cipher.setAAD(aad);
+    const plaintext = Buffer.from(`${JSON.stringify(app)}\0${JSON.stringify(preference)}\0`);
+    const ciphertext = Buffer.concat([cipher.update(plaintext), cipher.final()]);
+    return Buffer.concat([iv, cipher.getAuthTag(), ciphertext]);
+  }
+}
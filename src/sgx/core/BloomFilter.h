@@ -0,0 +1,68 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "Hash.h"
+
+// ============================================================================
+// Split-Block Bloom Filter
+// ============================================================================
+//
+// Approximate membership for 64-bit key hashes. Each key maps to one
+// 64-byte block (a single cache line) and sets one bit in each of its eight
+// words, so a query touches one line and never has false negatives. At
+// BLOOM_BITS_PER_ENTRY bits per designed entry the false-positive rate is
+// about 0.2%. Entries cannot be removed; owners rebuild the filter from
+// their live keys instead. Not thread-safe.
+
+#define BLOOM_BITS_PER_ENTRY 16
+#define BLOOM_MIN_BLOCKS 64
+
+class BloomFilter {
+public:
+    explicit BloomFilter(size_t expectedEntries) {
+        size_t wanted = expectedEntries * BLOOM_BITS_PER_ENTRY / 512 + 1;
+        size_t blocks = BLOOM_MIN_BLOCKS;
+        while (blocks < wanted) blocks <<= 1;
+        blocks_.resize(blocks);
+        mask_ = blocks - 1;
+        designedEntries_ = blocks * 512 / BLOOM_BITS_PER_ENTRY;
+    }
+
+    void add(uint64_t hash) {
+        Block& block = blocks_[blockIndex(hash)];
+        uint64_t bits = hashMix(hash);
+        for (int i = 0; i < 8; i++) {
+            block.words[i] |= 1ULL << ((bits >> (i * 6)) & 63);
+        }
+    }
+
+    bool mayContain(uint64_t hash) const {
+        const Block& block = blocks_[blockIndex(hash)];
+        uint64_t bits = hashMix(hash);
+        uint64_t missing = 0;
+        for (int i = 0; i < 8; i++) {
+            missing |= ~block.words[i] & (1ULL << ((bits >> (i * 6)) & 63));
+        }
+        return missing == 0;
+    }
+
+    // Entries the filter was sized for; beyond that the error rate climbs
+    size_t designedEntries() const { return designedEntries_; }
+    size_t bytes() const { return blocks_.size() * sizeof(Block); }
+
+private:
+    struct alignas(64) Block {
+        uint64_t words[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    };
+
+    size_t blockIndex(uint64_t hash) const { return (size_t)(hash >> 32) & mask_; }
+
+    std::vector<Block> blocks_;
+    size_t mask_;
+    size_t designedEntries_;
+};
+
+#endif // BLOOM_FILTER_H
@@ -0,0 +1,314 @@
+#include "DecisionColumns.h"
+#include "../enclave/Enclave.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define HAVE_AVX2_DISPATCH 1
+#endif
+
+// Column data alignment inside the file
+#define COLUMN_ALIGN 64
+// Reason columns stored as bitmaps; retention is run-length encoded instead
+#define BITMAP_REASONS 4
+
+static const char* const reasonColumnNames[BITMAP_REASONS] = {
+    "attr_allowed", "attr_excepted", "purpose_allowed", "purpose_prohibited"
+};
+
+// ============================================================================
+// Bitmap Scan
+// ============================================================================
+
+#ifdef HAVE_AVX2_DISPATCH
+// Nibble-lookup popcount (Mula): per-byte counts via pshufb, summed with
+// psadbw every 31 rounds before the byte lanes can overflow
+__attribute__((target("avx2")))
+static uint64_t popcountAvx2(const uint64_t* words, size_t n) {
+    const __m256i lookup = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowNibble = _mm256_set1_epi8(0x0F);
+    __m256i total = _mm256_setzero_si256();
+
+    size_t i = 0;
+    size_t vectorEnd = n & ~(size_t)3;
+    while (i < vectorEnd) {
+        size_t blockEnd = std::min(vectorEnd, i + 4 * 31);
+        __m256i bytes = _mm256_setzero_si256();
+        for (; i < blockEnd; i += 4) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(words + i));
+            __m256i lo = _mm256_and_si256(v, lowNibble);
+            __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibble);
+            bytes = _mm256_add_epi8(bytes, _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                                           _mm256_shuffle_epi8(lookup, hi)));
+        }
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+    }
+
+    uint64_t count = (uint64_t)_mm256_extract_epi64(total, 0) + (uint64_t)_mm256_extract_epi64(total, 1) +
+                     (uint64_t)_mm256_extract_epi64(total, 2) + (uint64_t)_mm256_extract_epi64(total, 3);
+    for (; i < n; i++) count += (uint64_t)__builtin_popcountll(words[i]);
+    return count;
+}
+#endif
+
+uint64_t popcountWords(const uint64_t* words, size_t n) {
+#ifdef HAVE_AVX2_DISPATCH
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2) return popcountAvx2(words, n);
+#endif
+    uint64_t count = 0;
+    for (size_t i = 0; i < n; i++) count += (uint64_t)__builtin_popcountll(words[i]);
+    return count;
+}
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+uint32_t DecisionColumnWriter::Dictionary::encode(const std::string& id) {
+    auto inserted = codes.emplace(id, (uint32_t)entries.size());
+    if (inserted.second) entries.push_back(&inserted.first->first);
+    return inserted.first->second;
+}
+
+void DecisionColumnWriter::setBit(std::vector<uint64_t>& bitmap, bool value) {
+    uint64_t row = rows_ - 1;
+    if (row % 64 == 0) bitmap.push_back(0);
+    if (value) bitmap.back() |= 1ull << (row % 64);
+}
+
+void DecisionColumnWriter::append(const std::string& appId, const std::string& userId,
+                                  int result, uint32_t reasons) {
+    rows_++;
+    apps_.rowCodes.push_back(apps_.encode(appId));
+    users_.rowCodes.push_back(users_.encode(userId));
+
+    bool valid = result == RESULT_GRANT || result == RESULT_DENY;
+    if (!valid) reasons = 0;
+    setBit(decision_, result == RESULT_GRANT);
+    setBit(valid_, valid);
+
+    if (reasons_.empty()) reasons_.resize(BITMAP_REASONS);
+    for (int r = 0; r < BITMAP_REASONS; r++) {
+        setBit(reasons_[r], (reasons >> r) & 1);
+    }
+
+    bool retention = (reasons & REASON_RETENTION_OK) != 0;
+    if (rows_ == 1) {
+        retentionFirst_ = retention;
+        retentionRuns_.push_back(1);
+    } else if (retention == retentionLast_ && retentionRuns_.back() < UINT32_MAX) {
+        retentionRuns_.back()++;
+    } else {
+        if (retention == retentionLast_) retentionRuns_.push_back(0);  // run overflow
+        retentionRuns_.push_back(1);
+    }
+    retentionLast_ = retention;
+}
+
+struct PendingColumn {
+    ColumnEntry entry;
+    std::string data;
+};
+
+static PendingColumn makeColumn(const char* name, ColumnEncoding encoding, uint32_t param,
+                                const void* data, size_t bytes) {
+    PendingColumn column;
+    memset(&column.entry, 0, sizeof(column.entry));
+    strncpy(column.entry.name, name, COLUMN_NAME_LEN - 1);
+    column.entry.encoding = encoding;
+    column.entry.param = param;
+    column.entry.bytes = bytes;
+    column.data.assign((const char*)data, bytes);
+    return column;
+}
+
+static PendingColumn dictionaryColumn(const char* name, const std::vector<const std::string*>& entries) {
+    std::vector<uint32_t> offsets(1, 0);
+    std::string bytes;
+    for (const std::string* entry : entries) {
+        bytes.append(*entry);
+        offsets.push_back((uint32_t)bytes.size());
+    }
+    std::string data((const char*)offsets.data(), offsets.size() * sizeof(uint32_t));
+    data.append(bytes);
+    return makeColumn(name, COLUMN_DICT, (uint32_t)entries.size(), data.data(), data.size());
+}
+
+static PendingColumn bitpackedColumn(const char* name, const std::vector<uint32_t>& codes,
+                                     size_t dictionarySize) {
+    uint32_t width = 1;
+    while (width < 32 && ((size_t)1 << width) < dictionarySize) width++;
+
+    std::vector<uint64_t> words((codes.size() * width + 63) / 64, 0);
+    for (size_t row = 0; row < codes.size(); row++) {
+        uint64_t bit = (uint64_t)row * width;
+        size_t word = bit / 64;
+        uint32_t shift = bit % 64;
+        words[word] |= (uint64_t)codes[row] << shift;
+        if (shift + width > 64) words[word + 1] |= (uint64_t)codes[row] >> (64 - shift);
+    }
+    return makeColumn(name, COLUMN_BITPACKED, width, words.data(), words.size() * sizeof(uint64_t));
+}
+
+static PendingColumn bitmapColumn(const char* name, const std::vector<uint64_t>& words) {
+    return makeColumn(name, COLUMN_BITMAP, 0, words.data(), words.size() * sizeof(uint64_t));
+}
+
+bool DecisionColumnWriter::write(const std::string& path, uint64_t* bytes, std::string* error) {
+    if (reasons_.empty()) reasons_.resize(BITMAP_REASONS);
+
+    std::vector<PendingColumn> columns;
+    columns.push_back(dictionaryColumn("app_dict", apps_.entries));
+    columns.push_back(bitpackedColumn("app", apps_.rowCodes, apps_.entries.size()));
+    columns.push_back(dictionaryColumn("user_dict", users_.entries));
+    columns.push_back(bitpackedColumn("user", users_.rowCodes, users_.entries.size()));
+    columns.push_back(bitmapColumn("decision", decision_));
+    columns.push_back(bitmapColumn("valid", valid_));
+    columns.push_back(makeColumn("retention", COLUMN_RLE, retentionFirst_ ? 1 : 0,
+                                 retentionRuns_.data(), retentionRuns_.size() * sizeof(uint32_t)));
+    for (int r = 0; r < BITMAP_REASONS; r++) {
+        columns.push_back(bitmapColumn(reasonColumnNames[r], reasons_[r]));
+    }
+
+    ColumnFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, COLUMN_FILE_MAGIC, sizeof(COLUMN_FILE_MAGIC));
+    header.version = COLUMN_FILE_VERSION;
+    header.columns = (uint32_t)columns.size();
+    header.rows = rows_;
+
+    uint64_t offset = sizeof(header) + columns.size() * sizeof(ColumnEntry);
+    for (PendingColumn& column : columns) {
+        offset = (offset + COLUMN_ALIGN - 1) & ~(uint64_t)(COLUMN_ALIGN - 1);
+        column.entry.offset = offset;
+        offset += column.entry.bytes;
+    }
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        *error = "cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+    static const char padding[COLUMN_ALIGN] = { 0 };
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (const PendingColumn& column : columns) {
+        ok = ok && fwrite(&column.entry, sizeof(ColumnEntry), 1, file) == 1;
+    }
+    uint64_t written = sizeof(header) + columns.size() * sizeof(ColumnEntry);
+    for (const PendingColumn& column : columns) {
+        ok = ok && fwrite(padding, 1, column.entry.offset - written, file) == column.entry.offset - written;
+        ok = ok && fwrite(column.data.data(), 1, column.data.size(), file) == column.data.size();
+        written = column.entry.offset + column.entry.bytes;
+    }
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        *error = "write failed: " + path;
+        return false;
+    }
+    *bytes = written;
+    return true;
+}
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+DecisionColumnReader::~DecisionColumnReader() {
+    if (data_) munmap((void*)data_, size_);
+}
+
+bool DecisionColumnReader::open(const std::string& path, std::string* error) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        *error = "cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ColumnFileHeader)) {
+        close(fd);
+        *error = path + " is not a decision column file";
+        return false;
+    }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        *error = "cannot map " + path + ": " + strerror(errno);
+        return false;
+    }
+    data_ = (const uint8_t*)p;
+    size_ = (size_t)st.st_size;
+
+    header_ = (const ColumnFileHeader*)data_;
+    entries_ = (const ColumnEntry*)(data_ + sizeof(ColumnFileHeader));
+    bool valid = memcmp(header_->magic, COLUMN_FILE_MAGIC, sizeof(COLUMN_FILE_MAGIC)) == 0 &&
+                 header_->version == COLUMN_FILE_VERSION &&
+                 sizeof(ColumnFileHeader) + (uint64_t)header_->columns * sizeof(ColumnEntry) <= size_;
+    for (uint32_t i = 0; valid && i < header_->columns; i++) {
+        valid = entries_[i].offset <= size_ && entries_[i].bytes <= size_ - entries_[i].offset;
+    }
+    if (!valid) {
+        header_ = nullptr;
+        *error = path + " is not a decision column file";
+        return false;
+    }
+    return true;
+}
+
+const ColumnEntry* DecisionColumnReader::column(const char* name) const {
+    if (!header_) return nullptr;
+    for (uint32_t i = 0; i < header_->columns; i++) {
+        if (strncmp(entries_[i].name, name, COLUMN_NAME_LEN) == 0) return &entries_[i];
+    }
+    return nullptr;
+}
+
+bool DecisionColumnReader::countSet(const char* name, uint64_t* count) const {
+    const ColumnEntry* entry = column(name);
+    if (!entry) return false;
+
+    if (entry->encoding == COLUMN_BITMAP) {
+        *count = popcountWords((const uint64_t*)(data_ + entry->offset), entry->bytes / sizeof(uint64_t));
+        return true;
+    }
+    if (entry->encoding == COLUMN_RLE) {
+        const uint32_t* runs = (const uint32_t*)(data_ + entry->offset);
+        size_t n = entry->bytes / sizeof(uint32_t);
+        uint64_t total = 0;
+        for (size_t i = entry->param ? 0 : 1; i < n; i += 2) total += runs[i];
+        *count = total;
+        return true;
+    }
+    return false;
+}
+
+uint32_t DecisionColumnReader::code(const ColumnEntry& entry, uint64_t row) const {
+    const uint64_t* words = (const uint64_t*)(data_ + entry.offset);
+    uint32_t width = entry.param;
+    uint64_t bit = row * width;
+    size_t word = bit / 64;
+    uint32_t shift = bit % 64;
+    uint64_t value = words[word] >> shift;
+    if (shift + width > 64) value |= words[word + 1] << (64 - shift);
+    return (uint32_t)(value & ((1ull << width) - 1));
+}
+
+bool DecisionColumnReader::dictionaryEntry(const char* name, uint32_t code, std::string* out) const {
+    std::string dictName = std::string(name) + "_dict";
+    const ColumnEntry* entry = column(dictName.c_str());
+    if (!entry || entry->encoding != COLUMN_DICT || code >= entry->param) return false;
+
+    const uint32_t* offsets = (const uint32_t*)(data_ + entry->offset);
+    const char* bytes = (const char*)(offsets + entry->param + 1);
+    out->assign(bytes + offsets[code], offsets[code + 1] - offsets[code]);
+    return true;
+}
@@ -0,0 +1,113 @@
+#ifndef DECISION_COLUMNS_H
+#define DECISION_COLUMNS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// Columnar Decision Files
+// ============================================================================
+//
+// Compact export of bulk audit decisions for analytics. One row per
+// evaluated record, stored column by column:
+//
+//   app_dict, user_dict   COLUMN_DICT       distinct IDs, in first-seen order
+//   app, user             COLUMN_BITPACKED  dictionary codes, ceil(log2 n) bits
+//   decision, valid       COLUMN_BITMAP     grant / evaluated without error
+//   retention             COLUMN_RLE        REASON_RETENTION_OK as runs
+//   attr_allowed, ...     COLUMN_BITMAP     one column per ReasonBit
+//
+// Layout: ColumnFileHeader, ColumnEntry[columns], then each column's data
+// at a 64-byte aligned offset so bitmap scans can use aligned vector loads.
+// All integers are little-endian.
+
+#define COLUMN_FILE_MAGIC "PDCOLS1"
+#define COLUMN_FILE_VERSION 1
+#define COLUMN_NAME_LEN 24
+
+enum ColumnEncoding {
+    COLUMN_BITMAP = 1,      // uint64 words, bit i of word i / 64 is row i
+    COLUMN_BITPACKED = 2,   // param-bit codes packed LSB-first into uint64 words
+    COLUMN_RLE = 3,         // uint32 run lengths, alternating from value param
+    COLUMN_DICT = 4         // param entries: uint32 offsets[param + 1], bytes
+};
+
+struct ColumnFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t columns;
+    uint64_t rows;
+};
+
+struct ColumnEntry {
+    char name[COLUMN_NAME_LEN];
+    uint32_t encoding;
+    uint32_t param;
+    uint64_t offset;
+    uint64_t bytes;
+};
+
+// Accumulates rows in memory and writes the file in one go. Not thread-safe;
+// the audit pipeline feeds it from its writer stage in input order.
+class DecisionColumnWriter {
+public:
+    // result is an EvaluationResult; reasons are ReasonBits (ignored on error)
+    void append(const std::string& appId, const std::string& userId, int result, uint32_t reasons);
+    uint64_t rows() const { return rows_; }
+
+    // Returns the file size in *bytes
+    bool write(const std::string& path, uint64_t* bytes, std::string* error);
+
+private:
+    struct Dictionary {
+        std::unordered_map<std::string, uint32_t> codes;
+        std::vector<const std::string*> entries;   // keys of codes, by code
+        std::vector<uint32_t> rowCodes;
+        uint32_t encode(const std::string& id);
+    };
+
+    void setBit(std::vector<uint64_t>& bitmap, bool value);
+
+    uint64_t rows_ = 0;
+    Dictionary apps_;
+    Dictionary users_;
+    std::vector<uint64_t> decision_;
+    std::vector<uint64_t> valid_;
+    std::vector<std::vector<uint64_t>> reasons_;   // per ReasonBit except retention
+    std::vector<uint32_t> retentionRuns_;
+    bool retentionFirst_ = false;
+    bool retentionLast_ = false;
+};
+
+// Memory-maps a decision file for scans
+class DecisionColumnReader {
+public:
+    ~DecisionColumnReader();
+
+    bool open(const std::string& path, std::string* error);
+    uint64_t rows() const { return header_ ? header_->rows : 0; }
+    const ColumnEntry* column(const char* name) const;
+
+    // Rows whose value is 1 in a COLUMN_BITMAP or COLUMN_RLE column. Bitmaps
+    // are scanned with AVX2 when the CPU has it.
+    bool countSet(const char* name, uint64_t* count) const;
+
+    // Dictionary code of one row in a COLUMN_BITPACKED column
+    uint32_t code(const ColumnEntry& entry, uint64_t row) const;
+    // ID for a code of app / user, looked up in <name>_dict
+    bool dictionaryEntry(const char* name, uint32_t code, std::string* out) const;
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    const ColumnFileHeader* header_ = nullptr;
+    const ColumnEntry* entries_ = nullptr;
+};
+
+// Popcount over n words; AVX2 when available, scalar otherwise
+uint64_t popcountWords(const uint64_t* words, size_t n);
+
+#endif // DECISION_COLUMNS_H
@@ -0,0 +1,458 @@
+#include "EvalDaemon.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <chrono>
+
+// Parsed policies kept by the native engine (one per policy version in use)
+#define MAX_CACHED_POLICIES 64
+// Minimized app requests kept by the native engine, across policies
+#define MAX_CACHED_APPS 65536
+// Decision cache shards; each has its own lock
+#define MEMO_SHARDS 64
+#define LISTEN_BACKLOG 128
+
+// ============================================================================
+// Native Engine
+// ============================================================================
+
+std::shared_ptr<const PolicyIndex> NativeEvalEngine::policyFor(const char* json, size_t length,
+                                                               const Hash128& key) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = policies_.find(key);
+        if (it != policies_.end()) return it->second;
+    }
+
+    // Parse outside the lock; two threads may race to insert the same policy
+    JsonValue parsed;
+    std::string error;
+    std::shared_ptr<PolicyIndex> index = std::make_shared<PolicyIndex>();
+    if (!parseJson(json, json + length, &parsed) || !index->load(parsed, &error)) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (policies_.size() >= MAX_CACHED_POLICIES) policies_.clear();
+    policies_[key] = index;
+    return index;
+}
+
+// IDs resolve through the policy, so an app is keyed by both
+std::shared_ptr<const AppRequest> NativeEvalEngine::appFor(const char* json, size_t length,
+                                                           const Hash128& policyKey,
+                                                           const PolicyIndex& index) {
+    Hash128 key = hash128(json, length, policyKey);
+    {
+        std::lock_guard<std::mutex> lock(appMutex_);
+        auto it = apps_.find(key);
+        if (it != apps_.end()) return it->second;
+    }
+
+    JsonValue parsed;
+    std::string error;
+    std::shared_ptr<AppRequest> app = std::make_shared<AppRequest>();
+    if (!parseJson(json, json + length, &parsed) ||
+        !appRequestFromJson(parsed, index, app.get(), &error)) {
+        return nullptr;
+    }
+    minimizeAppRequest(app.get());
+
+    std::lock_guard<std::mutex> lock(appMutex_);
+    if (apps_.size() >= MAX_CACHED_APPS) apps_.clear();
+    apps_[key] = app;
+    return app;
+}
+
+bool NativeEvalEngine::evaluate(const EvalRecordView* const* records, size_t count, int8_t* codes) {
+    const char* lastPolicy = nullptr;
+    Hash128 policyKey = { 0, 0 };
+    std::shared_ptr<const PolicyIndex> index;
+    JsonValue json;
+    std::string error;
+
+    // Parse the whole batch, then evaluate runs of records that share a
+    // policy together so their lookups can be pipelined
+    std::vector<std::shared_ptr<const AppRequest>> apps(count);
+    std::vector<UserPreference> users(count);
+    std::vector<std::shared_ptr<const PolicyIndex>> indexes(count);
+    for (size_t i = 0; i < count; i++) {
+        const EvalRecordView& record = *records[i];
+        // Records of one frame usually share the policy bytes
+        if (record.policy != lastPolicy) {
+            policyKey = hash128(record.policy, record.policyLen);
+            index = policyFor(record.policy, record.policyLen, policyKey);
+            lastPolicy = record.policy;
+        }
+
+        codes[i] = RESULT_ERROR;
+        if (index &&
+            (apps[i] = appFor(record.app, record.appLen, policyKey, *index)) &&
+            parseJson(record.user, record.user + record.userLen, &json) &&
+            userPreferenceFromJson(json, &users[i], &error)) {
+            indexes[i] = index;
+        }
+    }
+
+    std::vector<LayoutRequest> run;
+    std::vector<size_t> positions;
+    std::vector<int> results;
+    for (size_t i = 0; i < count;) {
+        if (!indexes[i]) {
+            i++;
+            continue;
+        }
+        const PolicyIndex* runIndex = indexes[i].get();
+        run.clear();
+        positions.clear();
+        for (; i < count && (!indexes[i] || indexes[i].get() == runIndex); i++) {
+            if (!indexes[i]) continue;
+            LayoutRequest request = { apps[i].get(), &users[i] };
+            run.push_back(request);
+            positions.push_back(i);
+        }
+        results.resize(run.size());
+        evaluateLayoutBatch(run.data(), run.size(), runIndex->layout(), prefetchDistance_,
+                            results.data());
+        for (size_t r = 0; r < run.size(); r++) codes[positions[r]] = (int8_t)results[r];
+    }
+    return true;
+}
+
+// ============================================================================
+// Decision Cache
+// ============================================================================
+
+DecisionMemo::DecisionMemo(size_t capacity)
+    : shardCapacity_(capacity == 0 ? 0 : (capacity + 2 * MEMO_SHARDS - 1) / (2 * MEMO_SHARDS)),
+      shards_(MEMO_SHARDS) {}
+
+bool DecisionMemo::lookup(const Hash128& key, int8_t* code) {
+    Shard& shard = shards_[key.lo % MEMO_SHARDS];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.current.find(key);
+    if (it != shard.current.end()) {
+        *code = it->second;
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    it = shard.previous.find(key);
+    if (it == shard.previous.end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Still in use: promote so the next generation change keeps it
+    *code = it->second;
+    shard.previous.erase(it);
+    shard.current[key] = *code;
+    if (shard.current.size() >= shardCapacity_) {
+        shard.previous.swap(shard.current);
+        shard.current.clear();
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void DecisionMemo::insert(const Hash128& key, int8_t code) {
+    Shard& shard = shards_[key.lo % MEMO_SHARDS];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.current[key] = code;
+    if (shard.current.size() >= shardCapacity_) {
+        shard.previous.swap(shard.current);
+        shard.current.clear();
+    }
+}
+
+size_t DecisionMemo::size() {
+    size_t total = 0;
+    for (Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.current.size() + shard.previous.size();
+    }
+    return total;
+}
+
+// ============================================================================
+// Server
+// ============================================================================
+
+EvalDaemon::EvalDaemon(EvalEngine* engine, const EvalDaemonConfig& config)
+    : engine_(engine), config_(config), memo_(config.cacheEntries) {}
+
+EvalDaemon::~EvalDaemon() {
+    if (listenFd_ >= 0) close(listenFd_);
+    if (wakeFds_[0] >= 0) close(wakeFds_[0]);
+    if (wakeFds_[1] >= 0) close(wakeFds_[1]);
+}
+
+bool EvalDaemon::listen(std::string* error) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (config_.socketPath.empty() || config_.socketPath.size() >= sizeof(addr.sun_path)) {
+        *error = "socket path must be 1-" + std::to_string(sizeof(addr.sun_path) - 1) + " bytes";
+        return false;
+    }
+    memcpy(addr.sun_path, config_.socketPath.c_str(), config_.socketPath.size());
+
+    // A socket file nobody answers on is left over from a crash
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe >= 0) {
+        bool live = connect(probe, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+        close(probe);
+        if (live) {
+            *error = "another daemon is listening on " + config_.socketPath;
+            return false;
+        }
+    }
+    unlink(config_.socketPath.c_str());
+
+    listenFd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0 ||
+        bind(listenFd_, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        chmod(config_.socketPath.c_str(), config_.socketMode) != 0 ||
+        ::listen(listenFd_, LISTEN_BACKLOG) != 0) {
+        *error = "cannot listen on " + config_.socketPath + ": " + strerror(errno);
+        return false;
+    }
+    if (pipe2(wakeFds_, O_CLOEXEC | O_NONBLOCK) != 0) {
+        *error = std::string("pipe2: ") + strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+void EvalDaemon::stop() {
+    // Only async-signal-safe calls: may run in a signal handler
+    stopping_.store(true);
+    if (wakeFds_[1] >= 0) {
+        char byte = 1;
+        ssize_t ignored = write(wakeFds_[1], &byte, 1);
+        (void)ignored;
+    }
+}
+
+void EvalDaemon::serve() {
+    struct pollfd fds[2];
+    fds[0].fd = listenFd_;
+    fds[0].events = POLLIN;
+    fds[1].fd = wakeFds_[0];
+    fds[1].events = POLLIN;
+
+    while (!stopping_.load()) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents) break;
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        int fd = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EMFILE || errno == ENFILE) {
+                // Out of descriptors: back off instead of spinning on poll
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            continue;
+        }
+
+        reapConnections(false);
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        if (connections_.size() >= config_.maxConnections) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            close(fd);
+            continue;
+        }
+        accepted_.fetch_add(1, std::memory_order_relaxed);
+        connections_.emplace_back(new Connection());
+        Connection* connection = connections_.back().get();
+        connection->fd = fd;
+        connection->thread = std::thread(&EvalDaemon::handleConnection, this, connection);
+    }
+
+    // Wake every connection thread out of read()
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        for (auto& connection : connections_) shutdown(connection->fd, SHUT_RDWR);
+    }
+    reapConnections(true);
+    close(listenFd_);
+    listenFd_ = -1;
+    unlink(config_.socketPath.c_str());
+}
+
+// Joins finished connection threads (all of them once stopping)
+void EvalDaemon::reapConnections(bool all) {
+    std::list<std::unique_ptr<Connection>> finished;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        for (auto it = connections_.begin(); it != connections_.end();) {
+            if (all || (*it)->done.load()) {
+                finished.push_back(std::move(*it));
+                it = connections_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (auto& connection : finished) {
+        connection->thread.join();
+        close(connection->fd);
+    }
+}
+
+void EvalDaemon::handleConnection(Connection* connection) {
+    EvalFrameReader reader;
+    std::vector<EvalFrameHeader> headers;
+    std::vector<const char*> payloads;
+    std::string out;
+
+    while (!stopping_.load() && reader.fill(connection->fd) > 0) {
+        // Everything the client has pipelined so far becomes one batch
+        headers.clear();
+        payloads.clear();
+        std::string error;
+        bool corrupt = false;
+        for (;;) {
+            bool complete = false;
+            EvalFrameHeader header;
+            const char* payload = nullptr;
+            if (!reader.next(&complete, &header, &payload, &error)) {
+                corrupt = true;
+                break;
+            }
+            if (!complete) break;
+            headers.push_back(header);
+            payloads.push_back(payload);
+        }
+
+        out.clear();
+        bool keepOpen = headers.empty() || answerFrames(headers, payloads, &out);
+        if (corrupt) {
+            badFrames_.fetch_add(1, std::memory_order_relaxed);
+            size_t frame = beginEvalFrame(&out, 0, 0, EVAL_STATUS_BAD_REQUEST, 0);
+            out.append(error);
+            finishEvalFrame(&out, frame);
+            keepOpen = false;
+        }
+        if (!out.empty() && !writeFully(connection->fd, out.data(), out.size())) break;
+        if (!keepOpen) break;
+    }
+    connection->done.store(true);
+}
+
+bool EvalDaemon::answerFrames(const std::vector<EvalFrameHeader>& headers,
+                              const std::vector<const char*>& payloads, std::string* out) {
+    frames_.fetch_add(headers.size(), std::memory_order_relaxed);
+
+    // Decode every evaluate frame; a bad one is answered and ends the connection
+    std::vector<EvalRecordView> records;
+    std::vector<size_t> firstRecord(headers.size() + 1, 0);
+    size_t valid = headers.size();
+    std::string error;
+    for (size_t f = 0; f < headers.size(); f++) {
+        firstRecord[f] = records.size();
+        if (headers[f].opcode == EVAL_OP_EVALUATE &&
+            !decodeEvalRecords(headers[f], payloads[f], &records, &error)) {
+            records.resize(firstRecord[f]);
+            valid = f;
+            break;
+        }
+        if (headers[f].opcode != EVAL_OP_EVALUATE && headers[f].opcode != EVAL_OP_STATS) {
+            error = "unknown opcode " + std::to_string(headers[f].opcode);
+            valid = f;
+            break;
+        }
+    }
+    firstRecord[valid] = records.size();
+    records_.fetch_add(records.size(), std::memory_order_relaxed);
+
+    // Cache lookups, then one engine call for the misses
+    std::vector<int8_t> codes(records.size(), RESULT_ERROR);
+    std::vector<Hash128> keys(memo_.enabled() ? records.size() : 0);
+    std::vector<const EvalRecordView*> misses;
+    std::vector<size_t> missIndex;
+    const char* lastPolicy = nullptr;
+    Hash128 policyHash = { 0, 0 };
+    for (size_t i = 0; i < records.size(); i++) {
+        const EvalRecordView& record = records[i];
+        if (memo_.enabled()) {
+            if (record.policy != lastPolicy) {
+                policyHash = hash128(record.policy, record.policyLen);
+                lastPolicy = record.policy;
+            }
+            keys[i] = hash128(record.app, record.appLen,
+                              hash128(record.user, record.userLen, policyHash));
+            if (memo_.lookup(keys[i], &codes[i])) continue;
+        }
+        misses.push_back(&record);
+        missIndex.push_back(i);
+    }
+
+    bool engineOk = true;
+    if (!misses.empty()) {
+        std::vector<int8_t> missCodes(misses.size(), RESULT_ERROR);
+        engineOk = engine_->evaluate(misses.data(), misses.size(), missCodes.data());
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        engineRecords_.fetch_add(misses.size(), std::memory_order_relaxed);
+        if (!engineOk) engineFailures_.fetch_add(1, std::memory_order_relaxed);
+        for (size_t m = 0; m < misses.size(); m++) {
+            size_t i = missIndex[m];
+            codes[i] = missCodes[m];
+            // Only definite decisions are worth remembering
+            if (engineOk && memo_.enabled() && codes[i] >= 0) memo_.insert(keys[i], codes[i]);
+        }
+    }
+
+    // Responses in request order
+    for (size_t f = 0; f < valid; f++) {
+        if (headers[f].opcode == EVAL_OP_STATS) {
+            size_t frame = beginEvalFrame(out, headers[f].requestId, EVAL_OP_STATS, EVAL_STATUS_OK, 0);
+            out->append(statsJson());
+            finishEvalFrame(out, frame);
+            continue;
+        }
+        uint32_t count = headers[f].count;
+        size_t frame = beginEvalFrame(out, headers[f].requestId, EVAL_OP_EVALUATE,
+                                      engineOk ? EVAL_STATUS_OK : EVAL_STATUS_UNAVAILABLE, count);
+        out->append(reinterpret_cast<const char*>(&codes[firstRecord[f]]), count);
+        finishEvalFrame(out, frame);
+    }
+    if (valid < headers.size()) {
+        badFrames_.fetch_add(1, std::memory_order_relaxed);
+        size_t frame = beginEvalFrame(out, headers[valid].requestId, headers[valid].opcode,
+                                      EVAL_STATUS_BAD_REQUEST, 0);
+        out->append(error);
+        finishEvalFrame(out, frame);
+        return false;
+    }
+    return true;
+}
+
+std::string EvalDaemon::statsJson() {
+    size_t open;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        open = connections_.size();
+    }
+    char buffer[640];
+    snprintf(buffer, sizeof(buffer),
+             "{\"engine\":\"%s\",\"connections\":%zu,\"accepted\":%llu,\"rejected\":%llu,"
+             "\"frames\":%llu,\"records\":%llu,\"batches\":%llu,\"engineRecords\":%llu,"
+             "\"engineFailures\":%llu,\"badFrames\":%llu,\"cacheEntries\":%zu,"
+             "\"cacheHits\":%llu,\"cacheMisses\":%llu}",
+             engine_->name(), open,
+             (unsigned long long)accepted_.load(), (unsigned long long)rejected_.load(),
+             (unsigned long long)frames_.load(), (unsigned long long)records_.load(),
+             (unsigned long long)batches_.load(), (unsigned long long)engineRecords_.load(),
+             (unsigned long long)engineFailures_.load(), (unsigned long long)badFrames_.load(),
+             memo_.size(), (unsigned long long)memo_.hits(), (unsigned long long)memo_.misses());
+    return buffer;
+}
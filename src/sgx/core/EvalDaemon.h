@@ -0,0 +1,158 @@
+#ifndef EVAL_DAEMON_H
+#define EVAL_DAEMON_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "EvalProtocol.h"
+#include "EvaluationInput.h"
+#include "Hash.h"
+
+// ============================================================================
+// Local Evaluation Daemon
+// ============================================================================
+//
+// One process per host owns the evaluation engine (the enclave or the native
+// evaluator) and a decision cache, and serves every validator process on the
+// host over a Unix socket (core/EvalProtocol.h). Each connection gets a
+// thread that drains all pipelined frames it has received, looks their
+// records up in the shared cache and hands the misses to the engine as one
+// batch, so a busy client costs one enclave transition per socket read
+// instead of one per request.
+
+// Evaluates a batch of records; implementations must be thread-safe
+class EvalEngine {
+public:
+    virtual ~EvalEngine() {}
+    virtual const char* name() const = 0;
+    // Sets codes[i] to the EvaluationResult of records[i]. Returns false if
+    // the engine itself failed (the requests are answered UNAVAILABLE).
+    virtual bool evaluate(const EvalRecordView* const* records, size_t count, int8_t* codes) = 0;
+};
+
+// evaluate() on the host, with parsed policies cached by content hash.
+// Decisions leave the enclave boundary, as with the NDJSON audit. A batch
+// is parsed first, then each run of records on one policy is evaluated by
+// evaluateLayoutBatch (enclave/PolicyLayout.h) prefetchDistance apart.
+// App requests are parsed once per policy and kept minimized
+// (minimizeAppRequest), since a few apps make most requests.
+class NativeEvalEngine : public EvalEngine {
+public:
+    explicit NativeEvalEngine(size_t prefetchDistance = LAYOUT_PREFETCH_DISTANCE)
+        : prefetchDistance_(prefetchDistance) {}
+    const char* name() const override { return "native"; }
+    bool evaluate(const EvalRecordView* const* records, size_t count, int8_t* codes) override;
+
+private:
+    std::shared_ptr<const PolicyIndex> policyFor(const char* json, size_t length,
+                                                 const Hash128& key);
+    std::shared_ptr<const AppRequest> appFor(const char* json, size_t length,
+                                             const Hash128& policyKey, const PolicyIndex& index);
+
+    struct Hash128Hasher {
+        size_t operator()(const Hash128& h) const { return (size_t)h.lo; }
+    };
+
+    size_t prefetchDistance_;
+    std::mutex mutex_;
+    std::unordered_map<Hash128, std::shared_ptr<const PolicyIndex>, Hash128Hasher> policies_;
+    std::mutex appMutex_;
+    std::unordered_map<Hash128, std::shared_ptr<const AppRequest>, Hash128Hasher> apps_;
+};
+
+// Bounded grant/deny cache keyed by a 128-bit hash of (app, user, policy).
+// Sharded; each shard keeps a current and a previous generation and drops
+// the previous one when the current fills, which approximates LRU without
+// per-hit bookkeeping. Holds between capacity / 2 and capacity entries.
+class DecisionMemo {
+public:
+    explicit DecisionMemo(size_t capacity);
+
+    bool enabled() const { return shardCapacity_ > 0; }
+    bool lookup(const Hash128& key, int8_t* code);
+    void insert(const Hash128& key, int8_t code);
+    size_t size();
+
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+private:
+    struct Hash128Hasher {
+        size_t operator()(const Hash128& h) const { return (size_t)h.hi; }
+    };
+    typedef std::unordered_map<Hash128, int8_t, Hash128Hasher> Generation;
+
+    struct Shard {
+        std::mutex mutex;
+        Generation current;
+        Generation previous;
+    };
+
+    size_t shardCapacity_;
+    std::vector<Shard> shards_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
+struct EvalDaemonConfig {
+    std::string socketPath = EVAL_DEFAULT_SOCKET;
+    size_t cacheEntries = 1 << 20;    // 0 disables the decision cache
+    size_t maxConnections = 256;
+    unsigned socketMode = 0660;       // validators share a group with the daemon
+};
+
+class EvalDaemon {
+public:
+    EvalDaemon(EvalEngine* engine, const EvalDaemonConfig& config);
+    ~EvalDaemon();
+
+    // Binds the socket, replacing a stale one left by a crashed daemon
+    bool listen(std::string* error);
+    // Accepts connections until stop()
+    void serve();
+    // Safe from any thread; closes every connection and removes the socket
+    void stop();
+
+    // Counters as a JSON object (also the EVAL_OP_STATS response)
+    std::string statsJson();
+
+private:
+    struct Connection {
+        int fd = -1;
+        std::thread thread;
+        std::atomic<bool> done{false};
+    };
+
+    void handleConnection(Connection* connection);
+    bool answerFrames(const std::vector<EvalFrameHeader>& headers,
+                      const std::vector<const char*>& payloads, std::string* out);
+    void reapConnections(bool all);
+
+    EvalEngine* engine_;
+    EvalDaemonConfig config_;
+    DecisionMemo memo_;
+    int listenFd_ = -1;
+    int wakeFds_[2] = { -1, -1 };     // self-pipe that interrupts serve()
+    std::atomic<bool> stopping_{false};
+
+    std::mutex connectionsMutex_;
+    std::list<std::unique_ptr<Connection>> connections_;
+
+    std::atomic<uint64_t> accepted_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> engineRecords_{0};
+    std::atomic<uint64_t> engineFailures_{0};
+    std::atomic<uint64_t> badFrames_{0};
+};
+
+#endif // EVAL_DAEMON_H
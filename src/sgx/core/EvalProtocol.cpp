@@ -0,0 +1,160 @@
+#include "EvalProtocol.h"
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Bytes read from the socket per fill()
+#define READ_CHUNK (64 << 10)
+
+// ============================================================================
+// Encoding
+// ============================================================================
+
+static void appendU32(std::string* out, uint32_t value) {
+    out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+size_t beginEvalFrame(std::string* out, uint32_t requestId, uint16_t opcode,
+                      uint16_t status, uint32_t count) {
+    EvalFrameHeader header;
+    header.length = 0;
+    header.requestId = requestId;
+    header.opcode = opcode;
+    header.status = status;
+    header.count = count;
+    size_t offset = out->size();
+    out->append(reinterpret_cast<const char*>(&header), sizeof(header));
+    return offset;
+}
+
+void finishEvalFrame(std::string* out, size_t frameOffset) {
+    uint32_t length = (uint32_t)(out->size() - frameOffset - sizeof(EvalFrameHeader));
+    memcpy(&(*out)[frameOffset], &length, sizeof(length));
+}
+
+void appendEvalRecord(std::string* out, const std::string& app, const std::string& user,
+                      const std::string* policy) {
+    appendU32(out, (uint32_t)app.size());
+    appendU32(out, (uint32_t)user.size());
+    appendU32(out, policy ? (uint32_t)policy->size() : EVAL_SAME_POLICY);
+    out->append(app);
+    out->append(user);
+    if (policy) out->append(*policy);
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+bool decodeEvalRecords(const EvalFrameHeader& header, const char* payload,
+                       std::vector<EvalRecordView>* out, std::string* error) {
+    const char* cursor = payload;
+    const char* end = payload + header.length;
+    const char* policy = nullptr;
+    uint32_t policyLen = 0;
+
+    // Every record needs at least its three lengths
+    if (header.count > header.length / (3 * sizeof(uint32_t))) {
+        *error = "record count exceeds payload";
+        return false;
+    }
+    out->reserve(out->size() + header.count);
+
+    for (uint32_t i = 0; i < header.count; i++) {
+        uint32_t lengths[3];
+        if ((size_t)(end - cursor) < sizeof(lengths)) {
+            *error = "truncated record header";
+            return false;
+        }
+        memcpy(lengths, cursor, sizeof(lengths));
+        cursor += sizeof(lengths);
+
+        bool samePolicy = lengths[2] == EVAL_SAME_POLICY;
+        if (samePolicy && !policy) {
+            *error = "first record must carry a policy";
+            return false;
+        }
+        uint64_t bytes = (uint64_t)lengths[0] + lengths[1] + (samePolicy ? 0 : lengths[2]);
+        if (bytes > (uint64_t)(end - cursor)) {
+            *error = "truncated record";
+            return false;
+        }
+
+        EvalRecordView record;
+        record.app = cursor;
+        record.appLen = lengths[0];
+        record.user = cursor + lengths[0];
+        record.userLen = lengths[1];
+        cursor += lengths[0] + lengths[1];
+        if (!samePolicy) {
+            policy = cursor;
+            policyLen = lengths[2];
+            cursor += policyLen;
+        }
+        record.policy = policy;
+        record.policyLen = policyLen;
+        out->push_back(record);
+    }
+
+    if (cursor != end) {
+        *error = "trailing bytes after records";
+        return false;
+    }
+    return true;
+}
+
+ssize_t EvalFrameReader::fill(int fd) {
+    // Drop consumed frames before growing the buffer
+    if (begin_ > 0) {
+        buffer_.erase(0, begin_);
+        begin_ = 0;
+    }
+
+    size_t used = buffer_.size();
+    buffer_.resize(used + READ_CHUNK);
+    ssize_t n;
+    do {
+        n = read(fd, &buffer_[used], READ_CHUNK);
+    } while (n < 0 && errno == EINTR);
+    buffer_.resize(used + (n > 0 ? (size_t)n : 0));
+    return n;
+}
+
+bool EvalFrameReader::next(bool* complete, EvalFrameHeader* header, const char** payload,
+                           std::string* error) {
+    *complete = false;
+    size_t available = buffer_.size() - begin_;
+    if (available < sizeof(EvalFrameHeader)) return true;
+
+    memcpy(header, buffer_.data() + begin_, sizeof(EvalFrameHeader));
+    if (header->length > EVAL_MAX_FRAME_BYTES) {
+        *error = "frame exceeds EVAL_MAX_FRAME_BYTES";
+        return false;
+    }
+    if (available - sizeof(EvalFrameHeader) < header->length) {
+        return true;
+    }
+
+    *payload = buffer_.data() + begin_ + sizeof(EvalFrameHeader);
+    begin_ += sizeof(EvalFrameHeader) + header->length;
+    *complete = true;
+    return true;
+}
+
+// ============================================================================
+// Socket I/O
+// ============================================================================
+
+bool writeFully(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = send(fd, data, length, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
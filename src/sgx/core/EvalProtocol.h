@@ -0,0 +1,99 @@
+#ifndef EVAL_PROTOCOL_H
+#define EVAL_PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Evaluation Daemon Wire Protocol
+// ============================================================================
+//
+// Binary frames over a Unix stream socket between the addon client
+// (app/DaemonClient.cpp) and the evaluation daemon (tools/eval-daemon.cpp).
+// Every frame is an EvalFrameHeader followed by length payload bytes:
+//
+//   EVAL_OP_EVALUATE request   count records, each
+//                              uint32 appLen, userLen, policyLen + the bytes;
+//                              policyLen EVAL_SAME_POLICY repeats the policy
+//                              of the previous record in the frame
+//   EVAL_OP_EVALUATE response  int8 EvaluationResult per record
+//   EVAL_OP_STATS request      empty
+//   EVAL_OP_STATS response     JSON object with the daemon counters
+//
+// Clients may pipeline: any number of requests can be in flight on one
+// connection. The daemon answers them in order and echoes requestId, and
+// evaluates every request that has arrived as one batch. Integers are in
+// host order (both ends run on the same machine).
+
+#define EVAL_DEFAULT_SOCKET "/tmp/privacy-evald.sock"
+#define EVAL_MAX_FRAME_BYTES (64u << 20)
+#define EVAL_SAME_POLICY 0xFFFFFFFFu
+
+enum EvalOpcode {
+    EVAL_OP_EVALUATE = 1,
+    EVAL_OP_STATS = 2
+};
+
+enum EvalStatus {
+    EVAL_STATUS_OK = 0,
+    EVAL_STATUS_BAD_REQUEST = 1,    // malformed frame; connection is closed after it
+    EVAL_STATUS_UNAVAILABLE = 2     // engine failed, e.g. the ECALL did not complete
+};
+
+struct EvalFrameHeader {
+    uint32_t length;       // payload bytes after the header
+    uint32_t requestId;    // chosen by the client, echoed in the response
+    uint16_t opcode;
+    uint16_t status;       // EvalStatus; 0 in requests
+    uint32_t count;        // records in the payload
+};
+
+static_assert(sizeof(EvalFrameHeader) == 16, "EvalFrameHeader is part of the wire format");
+
+// Points into a received payload; valid while the frame buffer is
+struct EvalRecordView {
+    const char* app;
+    uint32_t appLen;
+    const char* user;
+    uint32_t userLen;
+    const char* policy;
+    uint32_t policyLen;
+};
+
+// Appends a header with length 0 and returns its offset for finishEvalFrame
+size_t beginEvalFrame(std::string* out, uint32_t requestId, uint16_t opcode,
+                      uint16_t status, uint32_t count);
+// Patches the payload length once everything after the header is appended
+void finishEvalFrame(std::string* out, size_t frameOffset);
+
+// Appends one EVAL_OP_EVALUATE record; policy may be null for EVAL_SAME_POLICY
+void appendEvalRecord(std::string* out, const std::string& app, const std::string& user,
+                      const std::string* policy);
+
+// Splits an EVAL_OP_EVALUATE payload into header.count records
+bool decodeEvalRecords(const EvalFrameHeader& header, const char* payload,
+                       std::vector<EvalRecordView>* out, std::string* error);
+
+// Incremental frame parser over a connection's receive buffer
+class EvalFrameReader {
+public:
+    // Reads once from fd into the buffer: > 0 bytes read, 0 on EOF, -1 on error
+    ssize_t fill(int fd);
+
+    // Next complete frame, if any; payload points into the buffer and stays
+    // valid until the following fill(). Returns false with *error set when
+    // the stream is corrupt.
+    bool next(bool* complete, EvalFrameHeader* header, const char** payload, std::string* error);
+
+private:
+    std::string buffer_;
+    size_t begin_ = 0;
+};
+
+// Writes the whole buffer, retrying on EINTR; never raises SIGPIPE
+bool writeFully(int fd, const char* data, size_t length);
+
+#endif // EVAL_PROTOCOL_H
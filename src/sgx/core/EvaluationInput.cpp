@@ -0,0 +1,275 @@
+#include "EvaluationInput.h"
+#include <algorithm>
+#include <climits>
+
+bool readObjectId(const JsonValue& value, std::string* out) {
+    if (value.isString()) {
+        *out = value.string;
+        return true;
+    }
+    if (!value.isObject()) return false;
+
+    const JsonValue* id = value.get("$oid");
+    if (!id) id = value.get("_id");
+    if (!id) id = value.get("id");
+    return id && readObjectId(*id, out);
+}
+
+// A missing or non-numeric field reads as 0. Numbers outside int (or not
+// finite, which strtod gives for 1e400) are an error rather than a cast.
+static bool readInt(const JsonValue* value, const std::string& field, int* out,
+                    std::string* error) {
+    *out = 0;
+    if (!value || !value->isNumber()) return true;
+    double number = value->number;
+    if (!(number >= (double)INT_MIN && number <= (double)INT_MAX)) {
+        *error = field + " is out of range";
+        return false;
+    }
+    *out = (int)number;
+    return true;
+}
+
+// ============================================================================
+// Policy
+// ============================================================================
+
+// A DAG node's further intervals, [{ "left", "right" }, ...]; absent or
+// null for a tree node
+static bool loadIntervals(const JsonValue* array, const std::string& field,
+                          std::vector<PrefInterval>* intervals, std::string* error) {
+    if (!array || array->type == JSON_NULL) return true;
+    if (!array->isArray()) {
+        *error = field + " intervals must be an array";
+        return false;
+    }
+    intervals->reserve(array->items.size());
+    for (const JsonValue& item : array->items) {
+        int left, right;
+        if (!readInt(item.get("left"), field + " interval left", &left, error) ||
+            !readInt(item.get("right"), field + " interval right", &right, error)) {
+            return false;
+        }
+        intervals->push_back({ left, right });
+    }
+    return true;
+}
+
+static bool loadNodes(const JsonValue* array, const char* kind,
+                      std::vector<PolicyNode>* nodes, std::string* error) {
+    nodes->clear();
+    if (!array) return true;
+    if (!array->isArray()) {
+        *error = std::string("policy ") + kind + " must be an array";
+        return false;
+    }
+
+    nodes->reserve(array->items.size());
+    for (const JsonValue& item : array->items) {
+        PolicyNode node;
+        const JsonValue* name = item.get("name");
+        if (!readObjectId(item, &node.id)) {
+            *error = std::string("policy ") + kind + " entry without _id";
+            return false;
+        }
+        node.name = name && name->isString() ? name->string : "";
+        std::string field = std::string("policy ") + kind + " " + node.id;
+        if (!readInt(item.get("left"), field + " left", &node.left, error) ||
+            !readInt(item.get("right"), field + " right", &node.right, error) ||
+            !loadIntervals(item.get("intervals"), field, &node.intervals, error)) {
+            return false;
+        }
+        nodes->push_back(node);
+    }
+    return true;
+}
+
+void PolicyIndex::NodeIds::build(const std::vector<PolicyNode>& policyNodes) {
+    objectIds = false;
+    perfectHash = ObjectIdPerfectHash();
+    nodes.clear();
+    strings.clear();
+
+    // Decoded keys with their node, sorted so that a repeated key keeps only
+    // its last node
+    std::vector<std::pair<ObjectIdKey, uint32_t>> decoded(policyNodes.size());
+    bool allObjectIds = true;
+    for (size_t k = 0; k < policyNodes.size() && allObjectIds; k++) {
+        const std::string& id = policyNodes[k].id;
+        allObjectIds = decodeObjectId(id.data(), id.size(), &decoded[k].first);
+        decoded[k].second = (uint32_t)k;
+    }
+    if (allObjectIds) {
+        std::stable_sort(decoded.begin(), decoded.end(),
+                         [](const std::pair<ObjectIdKey, uint32_t>& a,
+                            const std::pair<ObjectIdKey, uint32_t>& b) { return a.first < b.first; });
+        std::vector<ObjectIdKey> keys;
+        std::vector<uint32_t> keyNodes;
+        for (size_t i = 0; i < decoded.size() && allObjectIds; i++) {
+            if (i + 1 < decoded.size() && decoded[i + 1].first == decoded[i].first) {
+                // IDs that differ only in case are distinct nodes to the map
+                allObjectIds = policyNodes[decoded[i + 1].second].id ==
+                               policyNodes[decoded[i].second].id;
+                continue;
+            }
+            keys.push_back(decoded[i].first);
+            keyNodes.push_back(decoded[i].second);
+        }
+        if (allObjectIds && perfectHash.build(keys)) {
+            nodes.resize(keys.size());
+            for (size_t i = 0; i < keys.size(); i++) nodes[perfectHash.find(keys[i])] = keyNodes[i];
+            objectIds = true;
+            return;
+        }
+    }
+
+    for (size_t k = 0; k < policyNodes.size(); k++) strings[policyNodes[k].id] = k;
+}
+
+const PolicyNode* PolicyIndex::NodeIds::find(const std::vector<PolicyNode>& policyNodes,
+                                             const std::string& id) const {
+    if (objectIds) {
+        ObjectIdKey key;
+        if (!decodeObjectId(id.data(), id.size(), &key)) return nullptr;
+        int32_t ordinal = perfectHash.find(key);
+        if (ordinal < 0) return nullptr;
+        // Decoding ignores case; preferences and the map compare IDs as text
+        const PolicyNode& node = policyNodes[nodes[ordinal]];
+        return node.id == id ? &node : nullptr;
+    }
+    auto it = strings.find(id);
+    return it == strings.end() ? nullptr : &policyNodes[it->second];
+}
+
+bool PolicyIndex::load(const JsonValue& json, std::string* error) {
+    const JsonValue* doc = &json;
+    if (doc->isArray() && !doc->items.empty()) doc = &doc->items[0];
+    if (!doc->isObject()) {
+        *error = "policy must be a JSON object";
+        return false;
+    }
+    PolicyData policy;
+    if (!loadNodes(doc->get("attributes"), "attributes", &policy.attributes, error) ||
+        !loadNodes(doc->get("purposes"), "purposes", &policy.purposes, error)) {
+        return false;
+    }
+    load(std::move(policy));
+    return true;
+}
+
+void PolicyIndex::load(PolicyData policy) {
+    policy_ = std::move(policy);
+    attributeIds_.build(policy_.attributes);
+    purposeIds_.build(policy_.purposes);
+    compilePolicyLayout(policy_, &layout_);
+}
+
+const PolicyNode* PolicyIndex::attribute(const std::string& id) const {
+    return attributeIds_.find(policy_.attributes, id);
+}
+
+const PolicyNode* PolicyIndex::purpose(const std::string& id) const {
+    return purposeIds_.find(policy_.purposes, id);
+}
+
+// ============================================================================
+// App Request
+// ============================================================================
+
+static bool resolveNodes(const JsonValue* array, const char* kind, const PolicyIndex& index,
+                         bool attributes, std::vector<PolicyNode>* nodes,
+                         std::string* error) {
+    nodes->clear();
+    if (!array) return true;
+    if (!array->isArray()) {
+        *error = std::string("app ") + kind + " must be an array";
+        return false;
+    }
+
+    std::string id;
+    for (const JsonValue& item : array->items) {
+        if (item.isObject() && item.get("left") && item.get("right")) {
+            PolicyNode node;
+            readObjectId(item, &node.id);
+            std::string field = std::string("app ") + kind + " " + node.id;
+            if (!readInt(item.get("left"), field + " left", &node.left, error) ||
+                !readInt(item.get("right"), field + " right", &node.right, error)) {
+                return false;
+            }
+            nodes->push_back(node);
+            continue;
+        }
+
+        if (!readObjectId(item, &id)) {
+            *error = std::string("app ") + kind + " entry without an ID";
+            return false;
+        }
+        const PolicyNode* node = attributes ? index.attribute(id) : index.purpose(id);
+        if (!node) {
+            *error = std::string(attributes ? "Attribute " : "Purpose ") + id + " not found";
+            return false;
+        }
+        // An app node is only ever the descendant side of a check, so a
+        // DAG node's further intervals are not copied
+        nodes->push_back({ node->id, node->name, node->left, node->right, {} });
+    }
+    return true;
+}
+
+bool appRequestFromJson(const JsonValue& json, const PolicyIndex& index,
+                        AppRequest* out, std::string* error) {
+    if (!json.isObject()) {
+        *error = "app must be a JSON object";
+        return false;
+    }
+    if (!readInt(json.get("timeofRetention"), "app timeofRetention", &out->timeofRetention,
+                 error)) {
+        return false;
+    }
+    return resolveNodes(json.get("attributes"), "attributes", index, true, &out->attributes, error) &&
+           resolveNodes(json.get("purposes"), "purposes", index, false, &out->purposes, error);
+}
+
+// ============================================================================
+// User Preference
+// ============================================================================
+
+static bool readIds(const JsonValue& pref, const char* key,
+                    std::vector<std::string>* ids, std::string* error) {
+    ids->clear();
+    const JsonValue* array = pref.get(key);
+    if (!array || array->type == JSON_NULL) return true;
+    if (!array->isArray()) {
+        *error = std::string("privacyPreference.") + key + " must be an array";
+        return false;
+    }
+
+    ids->resize(array->items.size());
+    for (size_t i = 0; i < array->items.size(); i++) {
+        if (!readObjectId(array->items[i], &(*ids)[i])) {
+            *error = std::string("privacyPreference.") + key + " entry without an ID";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool userPreferenceFromJson(const JsonValue& json, UserPreference* out, std::string* error) {
+    const JsonValue* pref = json.get("privacyPreference");
+    if (!pref) pref = &json;
+    if (!pref->isObject()) {
+        *error = "privacyPreference must be a JSON object";
+        return false;
+    }
+
+    if (!readInt(pref->get("timeofRetention"), "privacyPreference.timeofRetention",
+                 &out->timeofRetention, error)) {
+        return false;
+    }
+    return readIds(*pref, "attributes", &out->attributeIds, error) &&
+           readIds(*pref, "exceptions", &out->exceptionIds, error) &&
+           readIds(*pref, "denyAttributes", &out->denyAttributeIds, error) &&
+           readIds(*pref, "allowedPurposes", &out->allowedPurposeIds, error) &&
+           readIds(*pref, "prohibitedPurposes", &out->prohibitedPurposeIds, error) &&
+           readIds(*pref, "denyPurposes", &out->denyPurposeIds, error);
+}
@@ -0,0 +1,69 @@
+#ifndef EVALUATION_INPUT_H
+#define EVALUATION_INPUT_H
+
+#include <string>
+#include <unordered_map>
+#include "Json.h"
+#include "ObjectId.h"
+#include "../enclave/Enclave.h"
+#include "../enclave/PolicyLayout.h"
+
+// ============================================================================
+// Evaluation Inputs from JSON
+// ============================================================================
+//
+// Builds the evaluate() structs from the JSON shapes the API and mongoexport
+// produce. IDs may be plain strings, { "$oid": ... } or objects carrying
+// _id / id. App requests store attribute and purpose IDs only (see
+// models/app.js), so they are resolved to nested-set nodes through the
+// policy, like the aggregate lookups in privacy-preference.helper.js.
+// Policy nodes with several parents carry their further intervals in an
+// optional "intervals" array of { left, right } (PolicyNode).
+// When every node ID of a policy tree is an ObjectId, app IDs are decoded
+// (ObjectId.h) and resolved through a minimal perfect hash built at load
+// instead of a string map.
+
+// Reads an ID from "id", { "$oid": "id" }, { "_id": ... } or { "id": ... }
+bool readObjectId(const JsonValue& value, std::string* out);
+
+class PolicyIndex {
+public:
+    // Accepts the policy document, or an array whose first element is it
+    bool load(const JsonValue& json, std::string* error);
+    // Indexes nodes that were already read (a restored enclave snapshot)
+    void load(PolicyData policy);
+
+    const PolicyData& policy() const { return policy_; }
+    // Hot/cold copy of policy() for batch evaluation
+    const PolicyLayout& layout() const { return layout_; }
+    const PolicyNode* attribute(const std::string& id) const;
+    const PolicyNode* purpose(const std::string& id) const;
+
+private:
+    // Node index by ID for one tree; a repeated ID maps to its last node
+    struct NodeIds {
+        bool objectIds = false;
+        ObjectIdPerfectHash perfectHash;
+        std::vector<uint32_t> nodes;                     // by hash ordinal
+        std::unordered_map<std::string, size_t> strings; // when !objectIds
+
+        void build(const std::vector<PolicyNode>& policyNodes);
+        const PolicyNode* find(const std::vector<PolicyNode>& policyNodes,
+                               const std::string& id) const;
+    };
+
+    PolicyData policy_;
+    PolicyLayout layout_;
+    NodeIds attributeIds_;
+    NodeIds purposeIds_;
+};
+
+// App entries are IDs (resolved through the policy) or full nodes with
+// left/right. Unknown IDs are an error, as in the JS evaluator.
+bool appRequestFromJson(const JsonValue& json, const PolicyIndex& index,
+                        AppRequest* out, std::string* error);
+
+// Accepts a user document (reads privacyPreference) or the preference itself
+bool userPreferenceFromJson(const JsonValue& json, UserPreference* out, std::string* error);
+
+#endif // EVALUATION_INPUT_H
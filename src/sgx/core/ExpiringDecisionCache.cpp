@@ -0,0 +1,215 @@
+#include "ExpiringDecisionCache.h"
+
+ExpiringDecisionCache::ExpiringDecisionCache(size_t capacity)
+    : origin_(std::chrono::steady_clock::now()), wheel_(0), capacity_(capacity),
+      filter_(new BloomFilter(EXPIRING_CACHE_MIN_FILTER)) {}
+
+ExpiringDecisionCache::~ExpiringDecisionCache() {
+    if (rebuildThread_.joinable()) rebuildThread_.join();
+}
+
+Hash128 ExpiringDecisionCache::makeKey(const char* key, size_t keyLen, uint32_t version) {
+    return hash128(key, keyLen, Hash128{HASH_PRIME_3 ^ version, HASH_PRIME_2});
+}
+
+uint64_t ExpiringDecisionCache::nowMs() const {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - origin_).count();
+}
+
+// ============================================================================
+// Live Key Arrays
+// ============================================================================
+
+void ExpiringDecisionCache::track(Entry* entry) {
+    entry->liveIndex = (uint32_t)liveEntries_.size();
+    liveHashes_.push_back(entry->key.hi);
+    liveVersions_.push_back(entry->version);
+    liveEntries_.push_back(entry);
+}
+
+void ExpiringDecisionCache::untrack(Entry* entry) {
+    uint32_t index = entry->liveIndex;
+    Entry* last = liveEntries_.back();
+    liveHashes_[index] = liveHashes_.back();
+    liveVersions_[index] = liveVersions_.back();
+    liveEntries_[index] = last;
+    last->liveIndex = index;
+    liveHashes_.pop_back();
+    liveVersions_.pop_back();
+    liveEntries_.pop_back();
+}
+
+// ============================================================================
+// Filter Rebuild
+// ============================================================================
+
+void ExpiringDecisionCache::startRebuild() {
+    std::vector<uint64_t> keys;
+    keys.reserve(liveHashes_.size());
+    for (size_t i = 0; i < liveHashes_.size(); i++) {
+        if (liveVersions_[i] == filterVersion_) keys.push_back(liveHashes_[i]);
+    }
+    size_t designed = keys.size() * 2 > EXPIRING_CACHE_MIN_FILTER ? keys.size() * 2
+                                                                  : EXPIRING_CACHE_MIN_FILTER;
+
+    if (rebuildThread_.joinable()) rebuildThread_.join();
+    rebuilding_ = true;
+    rebuildSeeded_ = keys.size();
+    addedDuringRebuild_.clear();
+    rebuildDone_.store(false, std::memory_order_relaxed);
+    rebuildThread_ = std::thread([this, designed](std::vector<uint64_t> snapshot) {
+        std::unique_ptr<BloomFilter> filter(new BloomFilter(designed));
+        for (uint64_t hash : snapshot) filter->add(hash);
+        rebuilt_ = std::move(filter);
+        rebuildDone_.store(true, std::memory_order_release);
+    }, std::move(keys));
+}
+
+// Swaps in a finished rebuild, replaying the keys added meanwhile
+void ExpiringDecisionCache::finishRebuild() {
+    if (!rebuilding_ || !rebuildDone_.load(std::memory_order_acquire)) return;
+    rebuildThread_.join();
+    rebuilding_ = false;
+    counters_.rebuilds++;
+
+    // The version moved on while this one was being built
+    if (rebuildAgain_) {
+        rebuildAgain_ = false;
+        rebuilt_.reset();
+        startRebuild();
+        return;
+    }
+    for (uint64_t hash : addedDuringRebuild_) rebuilt_->add(hash);
+    filterAdded_ = rebuildSeeded_ + addedDuringRebuild_.size();
+    addedDuringRebuild_.clear();
+    filter_ = std::move(rebuilt_);
+    filterValid_ = true;
+}
+
+void ExpiringDecisionCache::setFilterEnabled(bool enabled) {
+    filterEnabled_ = enabled;
+}
+
+// ============================================================================
+// Cache Operations
+// ============================================================================
+
+void ExpiringDecisionCache::expire() {
+    wheel_.advance(nowMs(), [this](TimerNode* node) {
+        Entry* entry = reinterpret_cast<Entry*>(node);
+        Hash128 key = entry->key;
+        untrack(entry);
+        counters_.expired++;
+        entries_.erase(key);
+    });
+}
+
+bool ExpiringDecisionCache::lookup(const Hash128& key, uint32_t version, int8_t* code,
+                                   uint8_t* digest) {
+    finishRebuild();
+    expire();
+
+    // Only keys of the filter's version are guaranteed to be in it
+    bool filtered = filterEnabled_ && filterValid_ && version == filterVersion_;
+    if (filtered && !filter_->mayContain(key.hi)) {
+        counters_.filterSkips++;
+        counters_.misses++;
+        return false;
+    }
+
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        if (filtered) counters_.falsePositives++;
+        counters_.misses++;
+        return false;
+    }
+    counters_.hits++;
+    *code = it->second.code;
+    if (digest) memcpy(digest, it->second.digest, EXPIRING_CACHE_DIGEST_LEN);
+    return true;
+}
+
+bool ExpiringDecisionCache::insert(const Hash128& key, uint32_t version, int8_t code, uint64_t ttlMs,
+                                   const uint8_t* digest) {
+    if (ttlMs == 0) return false;
+    finishRebuild();
+    expire();
+
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        if (entries_.size() >= capacity_) {
+            counters_.rejected++;
+            return false;
+        }
+        it = entries_.emplace(key, Entry()).first;
+        it->second.key = key;
+        it->second.version = version;
+        track(&it->second);
+    } else {
+        wheel_.cancel(&it->second.timer);
+        it->second.version = version;
+        liveVersions_[it->second.liveIndex] = version;
+    }
+    it->second.code = code;
+    if (digest) {
+        memcpy(it->second.digest, digest, EXPIRING_CACHE_DIGEST_LEN);
+    } else {
+        memset(it->second.digest, 0, EXPIRING_CACHE_DIGEST_LEN);
+    }
+    wheel_.schedule(&it->second.timer, wheel_.now() + ttlMs);
+    counters_.inserts++;
+
+    // A new policy version: older entries can no longer be hit, rebuild
+    // the filter from this version's keys alone
+    if (version != filterVersion_) {
+        filterVersion_ = version;
+        filterValid_ = false;
+        if (rebuilding_) {
+            rebuildAgain_ = true;
+        } else {
+            startRebuild();
+        }
+    }
+
+    filter_->add(key.hi);
+    if (rebuilding_) addedDuringRebuild_.push_back(key.hi);
+    // Expired keys leave their bits behind: once the filter has taken more
+    // keys than it was sized for, rebuild it from the live ones
+    if (++filterAdded_ > filter_->designedEntries() && !rebuilding_) startRebuild();
+    return true;
+}
+
+bool ExpiringDecisionCache::erase(const Hash128& key) {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return false;
+    wheel_.cancel(&it->second.timer);
+    untrack(&it->second);
+    entries_.erase(it);
+    return true;
+}
+
+void ExpiringDecisionCache::clear() {
+    wheel_.reset();
+    entries_.clear();
+    liveHashes_.clear();
+    liveVersions_.clear();
+    liveEntries_.clear();
+}
+
+ExpiringCacheStats ExpiringDecisionCache::stats() {
+    finishRebuild();
+    expire();
+    ExpiringCacheStats stats = counters_;
+    stats.entries = entries_.size();
+    stats.capacity = capacity_;
+    stats.filterEnabled = filterEnabled_;
+    stats.filterBytes = filter_->bytes();
+    // One heap node per entry (value, next pointer, cached hash) plus
+    // buckets, the live key arrays and the filter
+    stats.bytes = entries_.size() * (sizeof(std::pair<const Hash128, Entry>) + 2 * sizeof(void*)) +
+                  entries_.bucket_count() * sizeof(void*) +
+                  liveEntries_.capacity() * (sizeof(uint64_t) + sizeof(uint32_t) + sizeof(Entry*)) +
+                  stats.filterBytes;
+    return stats;
+}
@@ -0,0 +1,134 @@
+#ifndef EXPIRING_DECISION_CACHE_H
+#define EXPIRING_DECISION_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "BloomFilter.h"
+#include "Hash.h"
+#include "TimingWheel.h"
+
+// ============================================================================
+// Expiring Decision Cache
+// ============================================================================
+//
+// Process-local grant/deny cache whose entries live exactly as long as the
+// user's retention window. Every entry carries a timer on a millisecond
+// timing wheel; each call first advances the wheel to the current time, so
+// expired entries are freed as soon as their window ends (O(1) each) and a
+// lookup can never return one. Memory therefore tracks the live working set
+// rather than everything ever cached, unlike filtering on createdAt at query
+// time.
+//
+// A Bloom filter over the live keys of the current policy version sits in
+// front of the table, so most first-time requests are answered "miss"
+// without probing it. Expired entries leave stale bits behind and a policy
+// change makes every older entry unreachable, so the filter is rebuilt from
+// the live keys on a background thread when the version changes or it
+// outgrows its design size; until the new one is swapped in the old one
+// keeps answering (a superset, so still no false negatives).
+//
+// Not thread-safe: the addon uses it from the JS thread only.
+
+#define EXPIRING_CACHE_DEFAULT_CAPACITY (1u << 20)
+// Smallest filter, in entries; rebuilds size for twice the live keys
+#define EXPIRING_CACHE_MIN_FILTER 4096
+// Enclave input digest kept with a decision (INPUT_DIGEST_LEN)
+#define EXPIRING_CACHE_DIGEST_LEN 32
+
+struct ExpiringCacheStats {
+    size_t entries = 0;
+    size_t capacity = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t inserts = 0;
+    uint64_t expired = 0;             // entries freed by the wheel
+    uint64_t rejected = 0;            // inserts refused at capacity
+    size_t bytes = 0;                 // estimated heap footprint
+    // Bloom filter
+    bool filterEnabled = true;
+    uint64_t filterSkips = 0;         // misses answered without a table probe
+    uint64_t falsePositives = 0;      // filter said maybe, table said no
+    uint64_t rebuilds = 0;
+    size_t filterBytes = 0;
+};
+
+class ExpiringDecisionCache {
+public:
+    explicit ExpiringDecisionCache(size_t capacity = EXPIRING_CACHE_DEFAULT_CAPACITY);
+    ~ExpiringDecisionCache();
+
+    // Key of one decision: the caller's request key and policy version
+    static Hash128 makeKey(const char* key, size_t keyLen, uint32_t version);
+
+    // Returns true with *code (EvaluationResult) on a live hit; digest, if
+    // given, receives the entry's input digest (all zero if it has none)
+    bool lookup(const Hash128& key, uint32_t version, int8_t* code,
+                uint8_t* digest = nullptr);
+    // Stores (or replaces) a decision valid for ttlMs, with the enclave's
+    // input digest if there is one; false at capacity or for a zero TTL.
+    // A new version retargets the filter to it.
+    bool insert(const Hash128& key, uint32_t version, int8_t code, uint64_t ttlMs,
+                const uint8_t* digest = nullptr);
+    bool erase(const Hash128& key);
+    void clear();
+
+    // Further inserts are refused while the cache holds capacity entries
+    void setCapacity(size_t capacity) { capacity_ = capacity; }
+    void setFilterEnabled(bool enabled);
+    // Frees every entry whose window has ended; lookup and insert call it
+    void expire();
+    ExpiringCacheStats stats();
+
+private:
+    struct Entry {
+        TimerNode timer;              // first: the wheel hands back &timer
+        Hash128 key;
+        uint32_t version;
+        uint32_t liveIndex;           // position in the live* arrays
+        int8_t code;
+        uint8_t digest[EXPIRING_CACHE_DIGEST_LEN];   // zero if none
+    };
+    struct Hash128Hasher {
+        size_t operator()(const Hash128& h) const { return (size_t)h.lo; }
+    };
+
+    uint64_t nowMs() const;
+    void track(Entry* entry);
+    void untrack(Entry* entry);
+    void startRebuild();
+    void finishRebuild();
+
+    std::chrono::steady_clock::time_point origin_;
+    std::unordered_map<Hash128, Entry, Hash128Hasher> entries_;
+    TimingWheel wheel_;
+    size_t capacity_;
+    ExpiringCacheStats counters_;
+
+    // Live keys in flat arrays, so a rebuild snapshot is a linear copy
+    std::vector<uint64_t> liveHashes_;
+    std::vector<uint32_t> liveVersions_;
+    std::vector<Entry*> liveEntries_;
+
+    // Bloom filter for filterVersion_, and the one being rebuilt
+    std::unique_ptr<BloomFilter> filter_;
+    uint32_t filterVersion_ = 0;
+    bool filterEnabled_ = true;
+    bool filterValid_ = true;         // false until a rebuild covers filterVersion_
+    size_t filterAdded_ = 0;          // keys added since the last build
+    std::unique_ptr<BloomFilter> rebuilt_;
+    size_t rebuildSeeded_ = 0;
+    std::vector<uint64_t> addedDuringRebuild_;
+    std::thread rebuildThread_;
+    std::atomic<bool> rebuildDone_{false};
+    bool rebuilding_ = false;
+    bool rebuildAgain_ = false;
+};
+
+#endif // EXPIRING_DECISION_CACHE_H
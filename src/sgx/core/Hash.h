@@ -0,0 +1,98 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ============================================================================
+// Non-cryptographic Hashing
+// ============================================================================
+//
+// Fast hashes for cache keys over untrusted JSON. Not collision resistant
+// against an adversary: the mixers are invertible, so colliding inputs can
+// be built offline. Keys that decide a grant use keyedHash128, with a secret
+// the adversary never sees.
+
+#define HASH_PRIME_1 0x9E3779B97F4A7C15ULL
+#define HASH_PRIME_2 0xC2B2AE3D27D4EB4FULL
+#define HASH_PRIME_3 0x165667B19E3779F9ULL
+
+struct Hash128 {
+    uint64_t lo;
+    uint64_t hi;
+
+    bool operator==(const Hash128& other) const { return lo == other.lo && hi == other.hi; }
+    bool operator!=(const Hash128& other) const { return !(*this == other); }
+};
+
+inline uint64_t hashMix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+inline uint64_t hashLoad(const uint8_t* p, size_t n) {
+    uint64_t word = 0;
+    memcpy(&word, p, n < 8 ? n : 8);
+    return word;
+}
+
+// Continues h over bytes; chain calls to hash several fields
+inline uint64_t hash64(const void* data, size_t length, uint64_t h = HASH_PRIME_3) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    h ^= length * HASH_PRIME_1;
+    for (; length >= 8; p += 8, length -= 8) {
+        h = (h ^ hashMix(hashLoad(p, 8) * HASH_PRIME_2)) * HASH_PRIME_1;
+    }
+    if (length) {
+        h = (h ^ hashMix(hashLoad(p, length) * HASH_PRIME_2)) * HASH_PRIME_1;
+    }
+    return hashMix(h);
+}
+
+inline Hash128 hash128(const void* data, size_t length, Hash128 h = { HASH_PRIME_3, HASH_PRIME_2 }) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    h.lo ^= length * HASH_PRIME_1;
+    h.hi ^= length * HASH_PRIME_3;
+    for (; length >= 8; p += 8, length -= 8) {
+        uint64_t word = hashLoad(p, 8);
+        h.lo = (h.lo ^ hashMix(word * HASH_PRIME_2)) * HASH_PRIME_1;
+        h.hi = (h.hi ^ hashMix(word + HASH_PRIME_1)) * HASH_PRIME_2;
+    }
+    if (length) {
+        uint64_t word = hashLoad(p, length);
+        h.lo = (h.lo ^ hashMix(word * HASH_PRIME_2)) * HASH_PRIME_1;
+        h.hi = (h.hi ^ hashMix(word + HASH_PRIME_1)) * HASH_PRIME_2;
+    }
+    return { hashMix(h.lo ^ (h.hi >> 29)), hashMix(h.hi ^ (h.lo >> 31)) };
+}
+
+// hash128 with every word masked by a secret before the mixers, so a
+// differential through them cannot be chosen without knowing it. h
+// defaults to the secret; chain calls by passing the previous result.
+inline Hash128 keyedHash128(const void* data, size_t length, const Hash128& secret, Hash128 h) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    h.lo ^= length * HASH_PRIME_1;
+    h.hi ^= length * HASH_PRIME_3;
+    for (; length >= 8; p += 8, length -= 8) {
+        uint64_t word = hashLoad(p, 8);
+        h.lo = (h.lo ^ hashMix((word ^ secret.lo) * HASH_PRIME_2)) * HASH_PRIME_1;
+        h.hi = (h.hi ^ hashMix((word ^ secret.hi) + HASH_PRIME_1)) * HASH_PRIME_2;
+    }
+    if (length) {
+        uint64_t word = hashLoad(p, length);
+        h.lo = (h.lo ^ hashMix((word ^ secret.lo) * HASH_PRIME_2)) * HASH_PRIME_1;
+        h.hi = (h.hi ^ hashMix((word ^ secret.hi) + HASH_PRIME_1)) * HASH_PRIME_2;
+    }
+    return { hashMix(h.lo ^ (h.hi >> 29)), hashMix(h.hi ^ (h.lo >> 31)) };
+}
+
+inline Hash128 keyedHash128(const void* data, size_t length, const Hash128& secret) {
+    return keyedHash128(data, length, secret, secret);
+}
+
+#endif // HASH_H
@@ -0,0 +1,107 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// ============================================================================
+// Log2 Histogram
+// ============================================================================
+//
+// Lock-free histogram with power-of-two buckets: bucket i counts values in
+// [2^(i-1), 2^i), bucket 0 counts zeros. Writers are typically one or a few
+// worker threads, readers are the JS thread collecting stats, so every
+// counter is a relaxed atomic and snapshots are approximate.
+
+class Log2Histogram {
+public:
+    static const size_t BUCKETS = 64;
+
+    Log2Histogram() { reset(); }
+
+    void record(uint64_t value) {
+        buckets_[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+        uint64_t prev = max_.load(std::memory_order_relaxed);
+        while (value > prev &&
+               !max_.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    void reset() {
+        for (size_t i = 0; i < BUCKETS; i++) {
+            buckets_[i].store(0, std::memory_order_relaxed);
+        }
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+    double mean() const {
+        uint64_t n = count();
+        return n ? (double)sum() / (double)n : 0.0;
+    }
+
+    uint64_t bucket(size_t i) const {
+        return buckets_[i].load(std::memory_order_relaxed);
+    }
+
+    // Inclusive upper bound of the values counted in bucket i
+    static uint64_t bucketUpperBound(size_t i) {
+        if (i == 0) return 0;
+        if (i >= 64) return UINT64_MAX;
+        return (((uint64_t)1) << i) - 1;
+    }
+
+    // Estimate of the q-th quantile (0 < q <= 1), interpolated linearly
+    // inside the bucket that holds it
+    uint64_t percentile(double q) const {
+        uint64_t n = count();
+        if (n == 0) return 0;
+        uint64_t rank = (uint64_t)(q * (double)n);
+        if (rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; i++) {
+            uint64_t inBucket = bucket(i);
+            if (seen + inBucket >= rank && inBucket > 0) {
+                uint64_t lo = i == 0 ? 0 : bucketUpperBound(i - 1) + 1;
+                uint64_t hi = bucketUpperBound(i);
+                double frac = (double)(rank - seen) / (double)inBucket;
+                uint64_t estimate = lo + (uint64_t)(frac * (double)(hi - lo));
+                uint64_t m = max();
+                return estimate < m ? estimate : m;
+            }
+            seen += inBucket;
+        }
+        return max();
+    }
+
+    // Index of the highest non-empty bucket plus one (for compact export)
+    size_t usedBuckets() const {
+        size_t used = 0;
+        for (size_t i = 0; i < BUCKETS; i++) {
+            if (bucket(i)) used = i + 1;
+        }
+        return used;
+    }
+
+private:
+    static size_t bucketFor(uint64_t value) {
+        if (value == 0) return 0;
+        size_t i = 64 - (size_t)__builtin_clzll(value);
+        return i < BUCKETS ? i : BUCKETS - 1;
+    }
+
+    std::atomic<uint64_t> buckets_[BUCKETS];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+};
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,279 @@
+#include "Json.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Nesting limit; policy and record documents are a few levels deep
+#define MAX_JSON_DEPTH 64
+
+const JsonValue* JsonValue::get(const char* key) const {
+    if (type != JSON_OBJECT) return nullptr;
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (keys[i] == key) return &items[i];
+    }
+    return nullptr;
+}
+
+// ============================================================================
+// Parser
+// ============================================================================
+
+struct JsonParser {
+    const char* pos;
+    const char* end;
+    const char* error;
+    int depth;
+
+    bool fail(const char* message) {
+        if (!error) error = message;
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r')) pos++;
+    }
+
+    bool literal(const char* word) {
+        size_t len = strlen(word);
+        if ((size_t)(end - pos) < len || memcmp(pos, word, len) != 0) {
+            return fail("invalid literal");
+        }
+        pos += len;
+        return true;
+    }
+
+    bool hex4(unsigned* out) {
+        if (end - pos < 4) return fail("truncated \\u escape");
+        unsigned value = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = *pos++;
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else return fail("invalid \\u escape");
+        }
+        *out = value;
+        return true;
+    }
+
+    static void appendUtf8(std::string* out, unsigned cp) {
+        if (cp < 0x80) {
+            out->push_back((char)cp);
+        } else if (cp < 0x800) {
+            out->push_back((char)(0xC0 | (cp >> 6)));
+            out->push_back((char)(0x80 | (cp & 0x3F)));
+        } else if (cp < 0x10000) {
+            out->push_back((char)(0xE0 | (cp >> 12)));
+            out->push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+            out->push_back((char)(0x80 | (cp & 0x3F)));
+        } else {
+            out->push_back((char)(0xF0 | (cp >> 18)));
+            out->push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+            out->push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+            out->push_back((char)(0x80 | (cp & 0x3F)));
+        }
+    }
+
+    bool parseString(std::string* out) {
+        pos++;  // opening quote
+        out->clear();
+        while (pos < end) {
+            // Copy the unescaped run in one go
+            const char* run = pos;
+            while (pos < end && *pos != '"' && *pos != '\\') pos++;
+            out->append(run, pos - run);
+            if (pos >= end) break;
+            if (*pos == '"') {
+                pos++;
+                return true;
+            }
+
+            pos++;  // backslash
+            if (pos >= end) break;
+            char c = *pos++;
+            switch (c) {
+                case '"': out->push_back('"'); break;
+                case '\\': out->push_back('\\'); break;
+                case '/': out->push_back('/'); break;
+                case 'b': out->push_back('\b'); break;
+                case 'f': out->push_back('\f'); break;
+                case 'n': out->push_back('\n'); break;
+                case 'r': out->push_back('\r'); break;
+                case 't': out->push_back('\t'); break;
+                case 'u': {
+                    unsigned cp;
+                    if (!hex4(&cp)) return false;
+                    // Unpaired surrogates become U+FFFD, as when node encodes
+                    // the string JSON.parse returns as UTF-8; an escape that
+                    // does not complete a pair is left for the next iteration
+                    if (cp >= 0xD800 && cp <= 0xDBFF) {
+                        const char* next = pos;
+                        unsigned low = 0;
+                        if (end - pos >= 6 && pos[0] == '\\' && pos[1] == 'u') {
+                            pos += 2;
+                            if (!hex4(&low)) return false;
+                        }
+                        if (low >= 0xDC00 && low <= 0xDFFF) {
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        } else {
+                            pos = next;
+                            cp = 0xFFFD;
+                        }
+                    } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                        cp = 0xFFFD;
+                    }
+                    appendUtf8(out, cp);
+                    break;
+                }
+                default:
+                    return fail("invalid escape");
+            }
+        }
+        return fail("unterminated string");
+    }
+
+    bool parseNumber(double* out) {
+        // Copy into a terminated buffer: the input may not be NUL-terminated
+        char buffer[64];
+        size_t len = 0;
+        while (pos < end && len < sizeof(buffer) - 1 &&
+               (strchr("+-.eE", *pos) || (*pos >= '0' && *pos <= '9'))) {
+            buffer[len++] = *pos++;
+        }
+        buffer[len] = '\0';
+        char* parsedEnd = nullptr;
+        *out = strtod(buffer, &parsedEnd);
+        if (len == 0 || parsedEnd != buffer + len) return fail("invalid number");
+        return true;
+    }
+
+    bool parseValue(JsonValue* out) {
+        skipWhitespace();
+        if (pos >= end) return fail("unexpected end of input");
+
+        out->keys.clear();
+        out->items.clear();
+        switch (*pos) {
+            case '{': return parseObject(out);
+            case '[': return parseArray(out);
+            case '"':
+                out->type = JSON_STRING;
+                return parseString(&out->string);
+            case 't':
+                out->type = JSON_BOOL;
+                out->boolean = true;
+                return literal("true");
+            case 'f':
+                out->type = JSON_BOOL;
+                out->boolean = false;
+                return literal("false");
+            case 'n':
+                out->type = JSON_NULL;
+                return literal("null");
+            default:
+                out->type = JSON_NUMBER;
+                return parseNumber(&out->number);
+        }
+    }
+
+    bool parseArray(JsonValue* out) {
+        out->type = JSON_ARRAY;
+        if (++depth > MAX_JSON_DEPTH) return fail("nesting too deep");
+        pos++;
+        skipWhitespace();
+        if (pos < end && *pos == ']') {
+            pos++;
+            depth--;
+            return true;
+        }
+        while (true) {
+            out->items.emplace_back();
+            if (!parseValue(&out->items.back())) return false;
+            skipWhitespace();
+            if (pos >= end) return fail("unterminated array");
+            if (*pos == ',') {
+                pos++;
+                continue;
+            }
+            if (*pos == ']') {
+                pos++;
+                depth--;
+                return true;
+            }
+            return fail("expected ',' or ']'");
+        }
+    }
+
+    bool parseObject(JsonValue* out) {
+        out->type = JSON_OBJECT;
+        if (++depth > MAX_JSON_DEPTH) return fail("nesting too deep");
+        pos++;
+        skipWhitespace();
+        if (pos < end && *pos == '}') {
+            pos++;
+            depth--;
+            return true;
+        }
+        while (true) {
+            skipWhitespace();
+            if (pos >= end || *pos != '"') return fail("expected object key");
+            out->keys.emplace_back();
+            if (!parseString(&out->keys.back())) return false;
+            skipWhitespace();
+            if (pos >= end || *pos != ':') return fail("expected ':'");
+            pos++;
+            out->items.emplace_back();
+            if (!parseValue(&out->items.back())) return false;
+            skipWhitespace();
+            if (pos >= end) return fail("unterminated object");
+            if (*pos == ',') {
+                pos++;
+                continue;
+            }
+            if (*pos == '}') {
+                pos++;
+                depth--;
+                return true;
+            }
+            return fail("expected ',' or '}'");
+        }
+    }
+};
+
+bool parseJson(const char* begin, const char* end, JsonValue* out, const char** error) {
+    JsonParser parser = { begin, end, nullptr, 0 };
+    bool ok = parser.parseValue(out);
+    if (ok) {
+        parser.skipWhitespace();
+        if (parser.pos != end) ok = parser.fail("trailing characters");
+    }
+    if (!ok && error) *error = parser.error;
+    return ok;
+}
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+void appendJsonString(std::string* out, const std::string& s) {
+    static const char hex[] = "0123456789abcdef";
+    out->push_back('"');
+    for (unsigned char c : s) {
+        switch (c) {
+            case '"': out->append("\\\""); break;
+            case '\\': out->append("\\\\"); break;
+            case '\n': out->append("\\n"); break;
+            case '\r': out->append("\\r"); break;
+            case '\t': out->append("\\t"); break;
+            default:
+                if (c < 0x20) {
+                    out->append("\\u00");
+                    out->push_back(hex[c >> 4]);
+                    out->push_back(hex[c & 0xF]);
+                } else {
+                    out->push_back((char)c);
+                }
+        }
+    }
+    out->push_back('"');
+}
@@ -0,0 +1,51 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Minimal JSON Reader
+// ============================================================================
+//
+// Small DOM parser for the native tools (NDJSON audits, policy snapshots)
+// and the enclave's request parsing (EnclaveCache.cpp).
+// It never reads past `end`, so it can parse lines straight out of a memory
+// mapping, and reports failures by return value rather than exceptions.
+// Objects keep their keys in `keys` and their values in `items`, in order.
+
+enum JsonType {
+    JSON_NULL,
+    JSON_BOOL,
+    JSON_NUMBER,
+    JSON_STRING,
+    JSON_ARRAY,
+    JSON_OBJECT
+};
+
+struct JsonValue {
+    JsonType type = JSON_NULL;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<std::string> keys;    // JSON_OBJECT only
+    std::vector<JsonValue> items;     // array elements or object values
+
+    // Member lookup on objects; nullptr if absent or not an object
+    const JsonValue* get(const char* key) const;
+    bool isString() const { return type == JSON_STRING; }
+    bool isNumber() const { return type == JSON_NUMBER; }
+    bool isArray() const { return type == JSON_ARRAY; }
+    bool isObject() const { return type == JSON_OBJECT; }
+};
+
+// Parses one JSON document from [begin, end); trailing whitespace is
+// allowed, anything else is an error. On failure *error (if given) points
+// to a static message.
+bool parseJson(const char* begin, const char* end, JsonValue* out, const char** error = nullptr);
+
+// Appends s as a quoted, escaped JSON string
+void appendJsonString(std::string* out, const std::string& s);
+
+#endif // JSON_H
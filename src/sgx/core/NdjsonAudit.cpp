@@ -0,0 +1,479 @@
+#include "NdjsonAudit.h"
+#include "DecisionColumns.h"
+#include "EvaluationInput.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+
+// Batches buffered between two stages
+#define STAGE_QUEUE_DEPTH 2
+// read() size for piped input
+#define READ_BLOCK (1 << 20)
+// stdio buffer for the decision stream
+#define OUTPUT_BUFFER (1 << 20)
+
+typedef std::chrono::steady_clock AuditClock;
+
+static double msSince(AuditClock::time_point from) {
+    return std::chrono::duration<double, std::milli>(AuditClock::now() - from).count();
+}
+
+// ============================================================================
+// Stage Plumbing
+// ============================================================================
+
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity) {}
+
+    // Blocks while full; returns the time spent waiting in ms
+    double push(T item) {
+        AuditClock::time_point start = AuditClock::now();
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return items_.size() < capacity_; });
+        double waited = msSince(start);
+        items_.push_back(item);
+        notEmpty_.notify_one();
+        return waited;
+    }
+
+    // Blocks while empty; returns false once closed and drained
+    bool pop(T* item, double* waitedMs) {
+        AuditClock::time_point start = AuditClock::now();
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return !items_.empty() || closed_; });
+        if (waitedMs) *waitedMs = msSince(start);
+        if (items_.empty()) return false;
+        *item = items_.front();
+        items_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        notEmpty_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::deque<T> items_;
+    size_t capacity_;
+    bool closed_ = false;
+};
+
+// One evaluated record, kept for the columnar export
+struct DecisionRow {
+    std::string appId;
+    std::string userId;
+    int result;
+    uint32_t reasons;
+};
+
+struct AuditBatch {
+    const char* data = nullptr;
+    size_t size = 0;
+    std::string owned;                  // backing storage for piped input
+    std::vector<size_t> chunkStarts;    // chunk i is [chunkStarts[i], chunkStarts[i + 1])
+    std::vector<uint64_t> firstLines;   // input line number of each chunk's first line
+    std::vector<std::string> outputs;   // decisions per chunk
+    std::vector<std::vector<DecisionRow>> rows;   // per chunk, columnar export only
+};
+
+struct AuditCounters {
+    std::atomic<uint64_t> records{0};
+    std::atomic<uint64_t> grants{0};
+    std::atomic<uint64_t> denies{0};
+    std::atomic<uint64_t> errors{0};
+};
+
+// End of the first line that ends at or after pos + target (exclusive)
+static size_t lineAlignedCut(const char* data, size_t pos, size_t size, size_t target) {
+    if (size - pos <= target) return size;
+    const char* newline = (const char*)memchr(data + pos + target, '\n', size - pos - target);
+    return newline ? (size_t)(newline - data) + 1 : size;
+}
+
+// ============================================================================
+// Reader Stage
+// ============================================================================
+
+static void readMapped(const char* data, size_t size, size_t batchBytes,
+                       BoundedQueue<AuditBatch*>& queue) {
+    uintptr_t pageMask = ~(uintptr_t)(sysconf(_SC_PAGESIZE) - 1);
+    size_t pos = 0;
+    while (pos < size) {
+        size_t cut = lineAlignedCut(data, pos, size, batchBytes);
+        AuditBatch* batch = new AuditBatch();
+        batch->data = data + pos;
+        batch->size = cut - pos;
+
+        // Fault the following batch in while this one is evaluated
+        if (cut < size) {
+            uintptr_t from = (uintptr_t)(data + cut) & pageMask;
+            size_t length = std::min(batchBytes, size - cut) + ((uintptr_t)(data + cut) - from);
+            madvise((void*)from, length, MADV_WILLNEED);
+        }
+        queue.push(batch);
+        pos = cut;
+    }
+    queue.close();
+}
+
+static void readStream(int fd, size_t batchBytes, BoundedQueue<AuditBatch*>& queue,
+                       std::string* error) {
+    std::string carry;   // partial last line of the previous batch
+    bool eof = false;
+    while (!eof) {
+        AuditBatch* batch = new AuditBatch();
+        batch->owned.swap(carry);
+
+        // Fill to batchBytes, and further if no complete line arrived yet
+        while (!eof && (batch->owned.size() < batchBytes ||
+                        batch->owned.find('\n') == std::string::npos)) {
+            size_t used = batch->owned.size();
+            batch->owned.resize(used + READ_BLOCK);
+            ssize_t n = read(fd, &batch->owned[used], READ_BLOCK);
+            if (n < 0 && errno == EINTR) {
+                batch->owned.resize(used);
+                continue;
+            }
+            if (n < 0) {
+                *error = std::string("read failed: ") + strerror(errno);
+                n = 0;
+            }
+            batch->owned.resize(used + (size_t)n);
+            if (n == 0) eof = true;
+        }
+
+        if (!eof) {
+            size_t lastNewline = batch->owned.rfind('\n');
+            carry.assign(batch->owned, lastNewline + 1, std::string::npos);
+            batch->owned.resize(lastNewline + 1);
+        }
+        if (batch->owned.empty()) {
+            delete batch;
+            continue;
+        }
+        batch->data = batch->owned.data();
+        batch->size = batch->owned.size();
+        queue.push(batch);
+    }
+    queue.close();
+}
+
+// ============================================================================
+// Evaluate Stage
+// ============================================================================
+
+static void appendDecision(std::string* out, int result, const std::string& error) {
+    out->append(",\"decision\":");
+    out->append(result == RESULT_GRANT ? "\"grant\"" : result == RESULT_DENY ? "\"deny\"" : "\"error\"");
+    if (!error.empty()) {
+        out->append(",\"error\":");
+        appendJsonString(out, error);
+    }
+    out->append("}\n");
+}
+
+static int evaluateRecord(const char* begin, const char* end, uint64_t line,
+                          const PolicyIndex& index, JsonValue& record,
+                          AppRequest& app, UserPreference& user, std::string* out,
+                          DecisionRow* row) {
+    out->append("{\"line\":");
+    out->append(std::to_string(line));
+
+    std::string error;
+    const char* parseError = nullptr;
+    int result = RESULT_ERROR;
+    if (!parseJson(begin, end, &record, &parseError)) {
+        error = std::string("invalid JSON: ") + parseError;
+    } else {
+        std::string id;
+        const JsonValue* idValue = record.get("id");
+        if (idValue && idValue->isNumber()) {
+            char number[32];
+            snprintf(number, sizeof(number), ",\"id\":%.17g", idValue->number);
+            out->append(number);
+        } else if (idValue && readObjectId(*idValue, &id)) {
+            out->append(",\"id\":");
+            appendJsonString(out, id);
+        }
+
+        const JsonValue* appJson = record.get("app");
+        const JsonValue* userJson = record.get("user");
+        if (!appJson || !userJson) {
+            error = "record needs \"app\" and \"user\"";
+        } else if (appRequestFromJson(*appJson, index, &app, &error) &&
+                   userPreferenceFromJson(*userJson, &user, &error)) {
+            // evaluate(), with the individual checks kept for the export
+            row->reasons = evaluateReasons(app, user, index.policy());
+            result = reasonsGrant(row->reasons) ? RESULT_GRANT : RESULT_DENY;
+        }
+        if (appJson) readObjectId(*appJson, &row->appId);
+        if (userJson) readObjectId(*userJson, &row->userId);
+    }
+
+    appendDecision(out, result, error);
+    return result;
+}
+
+static void evaluateChunk(AuditBatch* batch, size_t chunk, const PolicyIndex& index,
+                          bool columnar, AuditCounters* counters) {
+    const char* pos = batch->data + batch->chunkStarts[chunk];
+    const char* end = batch->data + batch->chunkStarts[chunk + 1];
+    uint64_t line = batch->firstLines[chunk];
+    std::string& out = batch->outputs[chunk];
+    out.reserve((size_t)(end - pos) / 8);
+
+    JsonValue record;
+    AppRequest app;
+    UserPreference user;
+    uint64_t records = 0, grants = 0, denies = 0, errors = 0;
+
+    while (pos < end) {
+        const char* newline = (const char*)memchr(pos, '\n', (size_t)(end - pos));
+        const char* lineEnd = newline ? newline : end;
+        const char* trimmed = lineEnd;
+        while (trimmed > pos && (trimmed[-1] == '\r' || trimmed[-1] == ' ' || trimmed[-1] == '\t')) {
+            trimmed--;
+        }
+
+        if (trimmed > pos) {
+            DecisionRow row = { std::string(), std::string(), RESULT_ERROR, 0 };
+            int result = evaluateRecord(pos, trimmed, line, index, record, app, user, &out, &row);
+            if (columnar) {
+                row.result = result;
+                batch->rows[chunk].push_back(std::move(row));
+            }
+            records++;
+            if (result == RESULT_GRANT) grants++;
+            else if (result == RESULT_DENY) denies++;
+            else errors++;
+        }
+        line++;
+        pos = newline ? newline + 1 : end;
+    }
+
+    counters->records.fetch_add(records, std::memory_order_relaxed);
+    counters->grants.fetch_add(grants, std::memory_order_relaxed);
+    counters->denies.fetch_add(denies, std::memory_order_relaxed);
+    counters->errors.fetch_add(errors, std::memory_order_relaxed);
+}
+
+// Cuts the batch into line-aligned chunks, numbers their lines, then parses
+// and evaluates the chunks in parallel
+static void evaluateBatch(AuditBatch* batch, const PolicyIndex& index, WorkStealingPool& pool,
+                          size_t chunkBytes, bool columnar, uint64_t* nextLine,
+                          AuditCounters* counters) {
+    for (size_t pos = 0; pos < batch->size; pos = lineAlignedCut(batch->data, pos, batch->size, chunkBytes)) {
+        batch->chunkStarts.push_back(pos);
+    }
+    batch->chunkStarts.push_back(batch->size);
+    size_t chunks = batch->chunkStarts.size() - 1;
+
+    std::vector<uint64_t> lines(chunks);
+    pool.parallelFor(0, chunks, 1, [batch, &lines](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            const char* from = batch->data + batch->chunkStarts[c];
+            const char* to = batch->data + batch->chunkStarts[c + 1];
+            lines[c] = (uint64_t)std::count(from, to, '\n') + (to[-1] != '\n' ? 1 : 0);
+        }
+    });
+
+    batch->firstLines.resize(chunks);
+    for (size_t c = 0; c < chunks; c++) {
+        batch->firstLines[c] = *nextLine;
+        *nextLine += lines[c];
+    }
+
+    batch->outputs.resize(chunks);
+    if (columnar) batch->rows.resize(chunks);
+    pool.parallelFor(0, chunks, 1, [batch, &index, columnar, counters](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            evaluateChunk(batch, c, index, columnar, counters);
+        }
+    });
+}
+
+// ============================================================================
+// Writer Stage
+// ============================================================================
+
+static void writeBatches(BoundedQueue<AuditBatch*>& queue, FILE* out,
+                         DecisionColumnWriter* columns, uint64_t* outputBytes,
+                         std::string* error) {
+    uintptr_t pageMask = ~(uintptr_t)(sysconf(_SC_PAGESIZE) - 1);
+    AuditBatch* batch;
+    while (queue.pop(&batch, nullptr)) {
+        for (const std::string& chunk : batch->outputs) {
+            if (error->empty() && fwrite(chunk.data(), 1, chunk.size(), out) != chunk.size()) {
+                *error = std::string("write failed: ") + strerror(errno);
+            }
+            *outputBytes += chunk.size();
+        }
+        if (columns) {
+            for (const std::vector<DecisionRow>& rows : batch->rows) {
+                for (const DecisionRow& row : rows) {
+                    columns->append(row.appId, row.userId, row.result, row.reasons);
+                }
+            }
+        }
+
+        // Drop mapped input pages once decided, so RSS stays at a few batches
+        if (batch->owned.empty()) {
+            uintptr_t from = (uintptr_t)batch->data & pageMask;
+            uintptr_t to = (uintptr_t)(batch->data + batch->size) & pageMask;
+            if (to > from) madvise((void*)from, to - from, MADV_DONTNEED);
+        }
+        delete batch;
+    }
+    if (error->empty() && fflush(out) != 0) {
+        *error = std::string("write failed: ") + strerror(errno);
+    }
+}
+
+// ============================================================================
+// Pipeline
+// ============================================================================
+
+static bool readWholeFile(const std::string& path, std::string* out, std::string* error) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        *error = "cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+    char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        out->append(buffer, n);
+    }
+    fclose(file);
+    return true;
+}
+
+bool runNdjsonAudit(const NdjsonAuditConfig& config, WorkStealingPool& pool,
+                    NdjsonAuditStats* stats, std::string* error) {
+    *stats = NdjsonAuditStats();
+    AuditClock::time_point start = AuditClock::now();
+
+    // Policy snapshot
+    std::string policyText;
+    if (!readWholeFile(config.policyPath, &policyText, error)) return false;
+    JsonValue policyJson;
+    const char* parseError = nullptr;
+    if (!parseJson(policyText.data(), policyText.data() + policyText.size(), &policyJson, &parseError)) {
+        *error = std::string("invalid policy JSON: ") + parseError;
+        return false;
+    }
+    PolicyIndex index;
+    if (!index.load(policyJson, error)) return false;
+
+    // Input: map regular files, stream pipes
+    bool fromStdin = config.inputPath == "-";
+    int fd = fromStdin ? STDIN_FILENO : open(config.inputPath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        *error = "cannot open " + config.inputPath + ": " + strerror(errno);
+        return false;
+    }
+    const char* mapped = nullptr;
+    size_t mappedSize = 0;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            mapped = (const char*)p;
+            mappedSize = (size_t)st.st_size;
+            madvise(p, mappedSize, MADV_SEQUENTIAL);
+        }
+    }
+    stats->mapped = mapped != nullptr;
+
+    bool toStdout = config.outputPath == "-";
+    FILE* out = toStdout ? stdout : fopen(config.outputPath.c_str(), "wb");
+    if (!out) {
+        *error = "cannot open " + config.outputPath + ": " + strerror(errno);
+        if (mapped) munmap((void*)mapped, mappedSize);
+        if (!fromStdin) close(fd);
+        return false;
+    }
+    std::vector<char> outBuffer;
+    if (!toStdout) {
+        outBuffer.resize(OUTPUT_BUFFER);
+        setvbuf(out, outBuffer.data(), _IOFBF, outBuffer.size());
+    }
+
+    size_t batchBytes = std::max<size_t>(config.batchBytes, 1);
+    size_t chunkBytes = std::max<size_t>(config.chunkBytes, 1);
+    BoundedQueue<AuditBatch*> toEvaluate(STAGE_QUEUE_DEPTH);
+    BoundedQueue<AuditBatch*> toWrite(STAGE_QUEUE_DEPTH);
+    std::string readError, writeError;
+
+    std::thread reader([&] {
+        if (mapped) readMapped(mapped, mappedSize, batchBytes, toEvaluate);
+        else readStream(fd, batchBytes, toEvaluate, &readError);
+    });
+    bool columnar = !config.columnarPath.empty();
+    DecisionColumnWriter columns;
+    std::thread writer([&] {
+        writeBatches(toWrite, out, columnar ? &columns : nullptr, &stats->outputBytes, &writeError);
+    });
+
+    AuditCounters counters;
+    uint64_t nextLine = 1;
+    AuditBatch* batch;
+    double waited = 0;
+    while (toEvaluate.pop(&batch, &waited)) {
+        stats->readStallMs += waited;
+        stats->batches++;
+        stats->inputBytes += batch->size;
+
+        AuditClock::time_point evaluateStart = AuditClock::now();
+        evaluateBatch(batch, index, pool, chunkBytes, columnar, &nextLine, &counters);
+        stats->evaluateMs += msSince(evaluateStart);
+        stats->writeStallMs += toWrite.push(batch);
+    }
+    toWrite.close();
+    reader.join();
+    writer.join();
+
+    if (mapped) munmap((void*)mapped, mappedSize);
+    if (!fromStdin) close(fd);
+    if (!toStdout) fclose(out);
+    if (columnar && writeError.empty()) {
+        columns.write(config.columnarPath, &stats->columnarBytes, &writeError);
+    }
+
+    stats->records = counters.records.load();
+    stats->grants = counters.grants.load();
+    stats->denies = counters.denies.load();
+    stats->errors = counters.errors.load();
+    stats->elapsedMs = msSince(start);
+    stats->recordsPerSec = stats->elapsedMs > 0 ? stats->records / (stats->elapsedMs / 1000.0) : 0;
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        stats->peakRssKb = usage.ru_maxrss;
+    }
+
+    if (!readError.empty()) {
+        *error = readError;
+        return false;
+    }
+    if (!writeError.empty()) {
+        *error = writeError;
+        return false;
+    }
+    return true;
+}
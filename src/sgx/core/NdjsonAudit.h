@@ -0,0 +1,62 @@
+#ifndef NDJSON_AUDIT_H
+#define NDJSON_AUDIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include "ThreadPool.h"
+
+// ============================================================================
+// Streaming NDJSON Audit Pipeline
+// ============================================================================
+//
+// Evaluates a file of { "id", "app", "user" } records, one per line, against
+// a policy snapshot with the same evaluate() the enclave runs, and streams
+// one decision line per record:
+//
+//   {"line":12,"id":"r-12","decision":"grant"}
+//   {"line":13,"decision":"error","error":"Attribute 5f... not found"}
+//
+// Three stages overlap: a reader thread memory-maps the input (or reads it
+// from a pipe) and cuts it into line-aligned batches, the calling thread
+// fans each batch out over the work-stealing pool in chunks that are parsed
+// and evaluated in parallel, and a writer thread appends the decisions in
+// input order. Bounded queues between the stages cap memory at a few batches.
+// Decisions are computed outside the enclave, so only run it on snapshots
+// that may leave it. With columnarPath set the decisions and their reason
+// bits are also written as a columnar file (core/DecisionColumns.h).
+
+struct NdjsonAuditConfig {
+    std::string policyPath;
+    std::string inputPath = "-";     // "-" reads stdin
+    std::string outputPath = "-";    // "-" writes stdout
+    std::string columnarPath;        // optional columnar export
+    size_t batchBytes = 8 << 20;     // input handed to the pool per step
+    size_t chunkBytes = 256 << 10;   // unit of parallel parse + evaluate
+};
+
+struct NdjsonAuditStats {
+    uint64_t records = 0;
+    uint64_t grants = 0;
+    uint64_t denies = 0;
+    uint64_t errors = 0;
+    uint64_t inputBytes = 0;
+    uint64_t outputBytes = 0;
+    uint64_t columnarBytes = 0;
+    uint64_t batches = 0;
+    bool mapped = false;             // input was memory-mapped
+    double elapsedMs = 0;
+    double evaluateMs = 0;           // pool busy on parse + evaluate
+    double readStallMs = 0;          // evaluation waiting for input
+    double writeStallMs = 0;         // evaluation waiting for the writer
+    double recordsPerSec = 0;
+    long peakRssKb = 0;              // process high-water mark (getrusage)
+};
+
+// Runs the whole pipeline; returns false with *error set if the policy,
+// input or output cannot be used. Malformed records are reported inline and
+// counted in stats.errors instead.
+bool runNdjsonAudit(const NdjsonAuditConfig& config, WorkStealingPool& pool,
+                    NdjsonAuditStats* stats, std::string* error);
+
+#endif // NDJSON_AUDIT_H
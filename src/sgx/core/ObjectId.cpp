@@ -0,0 +1,165 @@
+#include "ObjectId.h"
+#include <math.h>
+#include <algorithm>
+
+// CPUID faults inside an enclave, so enclave builds use the scalar decoder
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(ENCLAVE_CODE)
+#include <immintrin.h>
+#define HAVE_SSSE3_DISPATCH 1
+#endif
+
+// ============================================================================
+// Hex Decoding
+// ============================================================================
+
+static int hexDigit(unsigned char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Digit value per byte, -1 for non-digits, so the scalar loop has no
+// data-dependent branches
+struct HexTable {
+    int8_t values[256];
+
+    HexTable() {
+        for (int c = 0; c < 256; c++) values[c] = (int8_t)hexDigit((unsigned char)c);
+    }
+};
+
+static const HexTable hexTable;
+
+bool decodeObjectIdScalar(const char* hex, size_t length, ObjectIdKey* out) {
+    if (length != OBJECT_ID_HEX_LENGTH) return false;
+    int invalid = 0;
+    for (size_t i = 0; i < OBJECT_ID_BYTES; i++) {
+        int high = hexTable.values[(unsigned char)hex[2 * i]];
+        int low = hexTable.values[(unsigned char)hex[2 * i + 1]];
+        invalid |= high | low;
+        out->bytes[i] = (uint8_t)(high << 4 | low);
+    }
+    return invalid >= 0;
+}
+
+#ifdef HAVE_SSSE3_DISPATCH
+// Nibble value of each byte in *nibbles; returns the movemask of the bytes
+// that are hex digits. Bytes of 0x80 and up compare negative, so fail both
+// ranges.
+__attribute__((target("ssse3")))
+static int hexNibbles(__m128i chars, __m128i* nibbles) {
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+    __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+    __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                   _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    // '0'-'9' and 'a'-'f' / 'A'-'F' carry 0-9 and 1-6 in their low nibble
+    *nibbles = _mm_add_epi8(_mm_and_si128(chars, _mm_set1_epi8(0x0F)),
+                            _mm_and_si128(letter, _mm_set1_epi8(9)));
+    return _mm_movemask_epi8(_mm_or_si128(digit, letter));
+}
+
+// 16 digits, then the last 8 through a 64-bit load, so nothing past the ID
+// is read. pmaddubsw joins digit pairs as high * 16 + low, packuswb narrows
+// them to bytes.
+__attribute__((target("ssse3")))
+static bool decodeObjectIdSsse3(const char* hex, ObjectIdKey* out) {
+    __m128i head, tail;
+    int headValid = hexNibbles(_mm_loadu_si128((const __m128i*)hex), &head);
+    int tailValid = hexNibbles(_mm_loadl_epi64((const __m128i*)(hex + 16)), &tail);
+    if (headValid != 0xFFFF || (tailValid & 0xFF) != 0xFF) return false;
+
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(head, weights),
+                                     _mm_maddubs_epi16(tail, weights));
+    uint8_t buffer[16];
+    _mm_storeu_si128((__m128i*)buffer, bytes);
+    memcpy(out->bytes, buffer, OBJECT_ID_BYTES);
+    return true;
+}
+#endif
+
+bool decodeObjectId(const char* hex, size_t length, ObjectIdKey* out) {
+    if (length != OBJECT_ID_HEX_LENGTH) return false;
+#ifdef HAVE_SSSE3_DISPATCH
+    static const bool ssse3 = __builtin_cpu_supports("ssse3");
+    if (ssse3) return decodeObjectIdSsse3(hex, out);
+#endif
+    return decodeObjectIdScalar(hex, length, out);
+}
+
+// ============================================================================
+// Minimal Perfect Hash
+// ============================================================================
+
+bool ObjectIdPerfectHash::build(const std::vector<ObjectIdKey>& keys) {
+    for (int attempt = 0; attempt < OBJECT_ID_BUILD_ATTEMPTS; attempt++) {
+        seed_ = hashMix(HASH_PRIME_3 + attempt * HASH_PRIME_1);
+        if (tryBuild(keys)) return true;
+    }
+    pilots_.clear();
+    keys_.clear();
+    return false;
+}
+
+bool ObjectIdPerfectHash::tryBuild(const std::vector<ObjectIdKey>& keys) {
+    size_t n = keys.size();
+    keys_.assign(n, ObjectIdKey());
+    pilots_.clear();
+    if (n == 0) return true;
+
+    double perBucket = std::max(1.0, log2((double)n) / OBJECT_ID_BUCKET_SCALE);
+    size_t buckets = std::max<size_t>(2, (size_t)ceil((double)n / perBucket));
+    pilots_.assign(buckets, 0);
+    denseBuckets_ = std::max<size_t>(1, (size_t)(buckets * OBJECT_ID_DENSE_BUCKETS));
+    denseThreshold_ = (uint64_t)(OBJECT_ID_DENSE_KEYS * 4294967296.0);
+
+    // Keys grouped by bucket (CSR), buckets ordered largest first
+    std::vector<uint64_t> hashes(n);
+    std::vector<uint32_t> start(buckets + 1, 0);
+    for (size_t i = 0; i < n; i++) {
+        hashes[i] = keyHash(keys[i]);
+        start[bucket(hashes[i]) + 1]++;
+    }
+    size_t largest = 0;
+    for (size_t b = 0; b < buckets; b++) {
+        largest = std::max<size_t>(largest, start[b + 1]);
+        start[b + 1] += start[b];
+    }
+    std::vector<uint32_t> members(n);
+    std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+    for (size_t i = 0; i < n; i++) members[fill[bucket(hashes[i])]++] = (uint32_t)i;
+
+    std::vector<uint32_t> order(buckets);
+    for (size_t b = 0; b < buckets; b++) order[b] = (uint32_t)b;
+    std::stable_sort(order.begin(), order.end(), [&start](uint32_t a, uint32_t b) {
+        return start[a + 1] - start[a] > start[b + 1] - start[b];
+    });
+
+    // Expected tries for the last single-key bucket are about n
+    uint64_t pilotLimit = std::min<uint64_t>(UINT32_MAX, 16 * (uint64_t)n + 1024);
+    std::vector<uint8_t> taken(n, 0);
+    std::vector<size_t> placed;
+    placed.reserve(largest);
+    for (uint32_t b : order) {
+        uint32_t first = start[b], last = start[b + 1];
+        if (first == last) break;
+        uint64_t pilot = 0;
+        for (; pilot < pilotLimit; pilot++) {
+            placed.clear();
+            for (uint32_t m = first; m < last; m++) {
+                size_t p = position(hashes[members[m]], (uint32_t)pilot);
+                if (taken[p]) break;
+                taken[p] = 1;
+                placed.push_back(p);
+            }
+            if (placed.size() == last - first) break;
+            for (size_t p : placed) taken[p] = 0;
+        }
+        if (pilot == pilotLimit) return false;
+        pilots_[b] = (uint32_t)pilot;
+        for (uint32_t m = first; m < last; m++) keys_[placed[m - first]] = keys[members[m]];
+    }
+    return true;
+}
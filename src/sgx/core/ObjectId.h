@@ -0,0 +1,103 @@
+#ifndef OBJECT_ID_H
+#define OBJECT_ID_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "Hash.h"
+
+// ============================================================================
+// ObjectId Keys
+// ============================================================================
+//
+// App requests and preferences name policy nodes by MongoDB ObjectId, sent
+// as 24 hex digits. decodeObjectId validates and decodes them into the 12
+// bytes they stand for, 16 digits at a time with SSSE3 when the CPU has it.
+// Either case is accepted, as ObjectId() does.
+
+#define OBJECT_ID_HEX_LENGTH 24
+#define OBJECT_ID_BYTES 12
+
+struct ObjectIdKey {
+    uint8_t bytes[OBJECT_ID_BYTES];
+
+    bool operator==(const ObjectIdKey& other) const {
+        return memcmp(bytes, other.bytes, OBJECT_ID_BYTES) == 0;
+    }
+    bool operator!=(const ObjectIdKey& other) const { return !(*this == other); }
+    bool operator<(const ObjectIdKey& other) const {
+        return memcmp(bytes, other.bytes, OBJECT_ID_BYTES) < 0;
+    }
+};
+
+// False unless hex is exactly OBJECT_ID_HEX_LENGTH hex digits
+bool decodeObjectId(const char* hex, size_t length, ObjectIdKey* out);
+// The portable path decodeObjectId falls back to, for comparison
+bool decodeObjectIdScalar(const char* hex, size_t length, ObjectIdKey* out);
+
+// ============================================================================
+// Minimal Perfect Hash
+// ============================================================================
+//
+// Maps a fixed set of n keys to the ordinals 0..n-1 without collisions.
+// Keys are split into buckets, about 60% of them into the first 30% of
+// buckets, and each bucket stores a pilot: the first value that, mixed into
+// its keys' hash, sends all of them to free ordinals (hash and displace,
+// largest buckets first). A lookup is one hash, one pilot read and one
+// compare against the key stored at the ordinal, which is how keys outside
+// the set are rejected. About OBJECT_ID_BUCKET_SCALE / log2(n) pilots per
+// key; build time grows slightly faster than n.
+
+#define OBJECT_ID_BUCKET_SCALE 5.0
+#define OBJECT_ID_DENSE_KEYS 0.6
+#define OBJECT_ID_DENSE_BUCKETS 0.3
+#define OBJECT_ID_BUILD_ATTEMPTS 8
+
+class ObjectIdPerfectHash {
+public:
+    // keys must be distinct. False only if no seed in
+    // OBJECT_ID_BUILD_ATTEMPTS gave a hash function.
+    bool build(const std::vector<ObjectIdKey>& keys);
+
+    // Ordinal of key, or -1 if key was not built in
+    int32_t find(const ObjectIdKey& key) const {
+        if (keys_.empty()) return -1;
+        uint64_t hash = keyHash(key);
+        size_t ordinal = position(hash, pilots_[bucket(hash)]);
+        return keys_[ordinal] == key ? (int32_t)ordinal : -1;
+    }
+
+    size_t size() const { return keys_.size(); }
+    const ObjectIdKey& key(size_t ordinal) const { return keys_[ordinal]; }
+    size_t bytes() const {
+        return pilots_.size() * sizeof(uint32_t) + keys_.size() * sizeof(ObjectIdKey);
+    }
+
+private:
+    uint64_t keyHash(const ObjectIdKey& key) const {
+        uint64_t head = 0, tail = 0;
+        memcpy(&head, key.bytes, 8);
+        memcpy(&tail, key.bytes + 8, OBJECT_ID_BYTES - 8);
+        return hashMix(hashMix(head ^ seed_) ^ (tail * HASH_PRIME_2));
+    }
+    // High half picks dense or sparse buckets, low half the bucket
+    size_t bucket(uint64_t hash) const {
+        uint64_t low = (uint32_t)hash;
+        if ((hash >> 32) < denseThreshold_) return (size_t)((low * denseBuckets_) >> 32);
+        return denseBuckets_ + (size_t)((low * (pilots_.size() - denseBuckets_)) >> 32);
+    }
+    size_t position(uint64_t hash, uint32_t pilot) const {
+        uint64_t mixed = hashMix(hash ^ (pilot * HASH_PRIME_1));
+        return (size_t)(((unsigned __int128)mixed * keys_.size()) >> 64);
+    }
+    bool tryBuild(const std::vector<ObjectIdKey>& keys);
+
+    uint64_t seed_ = 0;
+    uint64_t denseThreshold_ = 0;
+    size_t denseBuckets_ = 0;
+    std::vector<uint32_t> pilots_;
+    std::vector<ObjectIdKey> keys_;      // by ordinal
+};
+
+#endif // OBJECT_ID_H
@@ -0,0 +1,202 @@
+#include "PolicyDag.h"
+#include <algorithm>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define HAVE_AVX2_DISPATCH 1
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// ============================================================================
+// Labeling
+// ============================================================================
+
+struct DagInterval {
+    int32_t low;
+    int32_t high;
+
+    bool operator<(const DagInterval& other) const { return low < other.low; }
+};
+
+bool PolicyDag::build(const std::vector<std::vector<uint32_t>>& parents,
+                      std::vector<uint32_t>* postorder) {
+    size_t n = parents.size();
+    offsets_.clear();
+    lows_.clear();
+    highs_.clear();
+
+    // Children of every node (CSR)
+    std::vector<uint32_t> start(n + 1, 0);
+    for (size_t i = 0; i < n; i++) {
+        for (uint32_t parent : parents[i]) {
+            if (parent >= n || parent == i) return false;
+            start[parent + 1]++;
+        }
+    }
+    for (size_t i = 0; i < n; i++) start[i + 1] += start[i];
+    std::vector<uint32_t> children(start[n]);
+    std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+    for (size_t i = 0; i < n; i++) {
+        for (uint32_t parent : parents[i]) children[fill[parent]++] = (uint32_t)i;
+    }
+
+    // Parents before children (Kahn); a cycle leaves nodes out
+    std::vector<uint32_t> order, pending(n);
+    order.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        pending[i] = (uint32_t)parents[i].size();
+        if (pending[i] == 0) order.push_back((uint32_t)i);
+    }
+    for (size_t k = 0; k < order.size(); k++) {
+        uint32_t node = order[k];
+        for (uint32_t c = start[node]; c < start[node + 1]; c++) {
+            if (--pending[children[c]] == 0) order.push_back(children[c]);
+        }
+    }
+    if (order.size() != n) return false;
+
+    // Postorder over the spanning tree: a node's subtree is numbered
+    // [low[node], label], itself last
+    std::vector<int32_t> labels(n, 0), low(n, -1);
+    std::vector<uint32_t> stack, next(start.begin(), start.end() - 1);
+    int32_t counter = 0;
+    for (size_t root = 0; root < n; root++) {
+        if (!parents[root].empty()) continue;
+        low[root] = counter;
+        stack.push_back((uint32_t)root);
+        while (!stack.empty()) {
+            uint32_t node = stack.back();
+            if (next[node] == start[node + 1]) {
+                labels[node] = counter++;
+                stack.pop_back();
+                continue;
+            }
+            uint32_t child = children[next[node]++];
+            if (parents[child][0] != node || low[child] >= 0) continue;
+            low[child] = counter;
+            stack.push_back(child);
+        }
+    }
+
+    // Children before parents: a node's intervals are its subtree's merged
+    // with its children's, leaving out those inside its subtree already
+    std::vector<uint32_t> first(n), count(n);
+    std::vector<DagInterval> all, merged;
+    for (size_t k = n; k-- > 0;) {
+        uint32_t node = order[k];
+        merged.clear();
+        merged.push_back({ low[node], labels[node] });
+        for (uint32_t c = start[node]; c < start[node + 1]; c++) {
+            uint32_t child = children[c];
+            for (uint32_t i = first[child]; i < first[child] + count[child]; i++) {
+                if (all[i].low < low[node] || all[i].high > labels[node]) merged.push_back(all[i]);
+            }
+        }
+        std::sort(merged.begin(), merged.end());
+        first[node] = (uint32_t)all.size();
+        DagInterval current = merged[0];
+        for (size_t i = 1; i < merged.size(); i++) {
+            if (merged[i].low <= current.high + 1) {
+                current.high = std::max(current.high, merged[i].high);
+            } else {
+                all.push_back(current);
+                current = merged[i];
+            }
+        }
+        all.push_back(current);
+        count[node] = (uint32_t)all.size() - first[node];
+    }
+
+    // By ordinal, the interval holding the node's own label moved first
+    offsets_.assign(n + 1, 0);
+    for (size_t i = 0; i < n; i++) offsets_[labels[i] + 1] = count[i];
+    for (size_t i = 0; i < n; i++) offsets_[i + 1] += offsets_[i];
+    // Empty intervals (low above high) match nothing
+    lows_.assign(offsets_[n] + DAG_PADDING, INT32_MAX);
+    highs_.assign(offsets_[n] + DAG_PADDING, INT32_MIN);
+    for (size_t i = 0; i < n; i++) {
+        DagInterval* intervals = &all[first[i]];
+        DagInterval* own = intervals;
+        while (own->high < labels[i]) own++;
+        std::rotate(intervals, own, own + 1);
+        for (uint32_t j = 0; j < count[i]; j++) {
+            lows_[offsets_[labels[i]] + j] = intervals[j].low;
+            highs_[offsets_[labels[i]] + j] = intervals[j].high;
+        }
+    }
+    if (postorder) postorder->assign(labels.begin(), labels.end());
+    return true;
+}
+
+size_t PolicyDag::bytes() const {
+    return offsets_.size() * sizeof(uint32_t) + (lows_.size() + highs_.size()) * sizeof(int32_t);
+}
+
+// ============================================================================
+// Containment
+// ============================================================================
+
+#ifdef HAVE_AVX2_DISPATCH
+__attribute__((target("avx2")))
+static bool scanAvx2(const int32_t* lows, const int32_t* highs, uint32_t count, int32_t label) {
+    const __m256i value = _mm256_set1_epi32(label);
+    for (uint32_t i = 0; i < count; i += 8) {
+        __m256i outside = _mm256_or_si256(
+            _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(lows + i)), value),
+            _mm256_cmpgt_epi32(value, _mm256_loadu_si256((const __m256i*)(highs + i))));
+        int inside = ~_mm256_movemask_ps(_mm256_castsi256_ps(outside)) & 0xFF;
+        if (count - i < 8) inside &= (1 << (count - i)) - 1;
+        if (inside) return true;
+    }
+    return false;
+}
+#endif
+
+#ifdef __SSE2__
+static bool scanSse2(const int32_t* lows, const int32_t* highs, uint32_t count, int32_t label) {
+    const __m128i value = _mm_set1_epi32(label);
+    for (uint32_t i = 0; i < count; i += 4) {
+        __m128i outside = _mm_or_si128(
+            _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(lows + i)), value),
+            _mm_cmpgt_epi32(value, _mm_loadu_si128((const __m128i*)(highs + i))));
+        int inside = ~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xF;
+        if (count - i < 4) inside &= (1 << (count - i)) - 1;
+        if (inside) return true;
+    }
+    return false;
+}
+#endif
+
+bool PolicyDag::contains(uint32_t ancestor, uint32_t descendant) const {
+    int32_t label = (int32_t)descendant;
+    uint32_t first = offsets_[ancestor], count = offsets_[ancestor + 1] - first - 1;
+    if (lows_[first] <= label && label <= highs_[first]) return true;
+    if (count == 0) return false;
+    // The others, sorted
+    const int32_t* lows = lows_.data() + first + 1;
+    const int32_t* highs = highs_.data() + first + 1;
+    if (count > DAG_SCAN_INTERVALS) {
+        // Last interval starting at or below label
+        const int32_t* after = std::upper_bound(lows, lows + count, label);
+        return after != lows && label <= highs[after - lows - 1];
+    }
+#ifdef HAVE_AVX2_DISPATCH
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2) return scanAvx2(lows, highs, count, label);
+#endif
+#ifdef __SSE2__
+    return scanSse2(lows, highs, count, label);
+#else
+    return containsScalar(ancestor, descendant);
+#endif
+}
+
+bool PolicyDag::containsScalar(uint32_t ancestor, uint32_t descendant) const {
+    int32_t label = (int32_t)descendant;
+    for (uint32_t i = offsets_[ancestor]; i < offsets_[ancestor + 1]; i++) {
+        if (lows_[i] <= label && label <= highs_[i]) return true;
+    }
+    return false;
+}
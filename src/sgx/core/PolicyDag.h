@@ -0,0 +1,69 @@
+#ifndef POLICY_DAG_H
+#define POLICY_DAG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// ============================================================================
+// DAG Policy Hierarchy
+// ============================================================================
+//
+// Nested-set numbering gives each node one [left, right] interval, so each
+// node has one parent. Attributes with several ("Location" under both
+// "Device" and "Personal") are flattened by copying the shared subtree under
+// every parent, which multiplies the nodes, their IDs and every index over
+// them. A PolicyDag labels the DAG itself, after Agrawal, Borgida and
+// Jagadish: nodes are numbered in postorder over a spanning tree that keeps
+// each node's first parent, and each node carries the numbers below it as a
+// few disjoint intervals (its spanning subtree, and whatever it reaches
+// through children it is not the first parent of). Nodes are named by that
+// number, so a node lies under another if its own number is in one of the
+// other's intervals, and a tree needs one interval per node, as nested sets
+// do. The interval holding a node's own number is kept first, the rest
+// sorted, so descendants along first parents are found with one compare.
+//
+// contains() tests the rest 4 intervals per step with SSE2, 8 with AVX2
+// when the CPU has it, and binary-searches them past DAG_SCAN_INTERVALS.
+//
+// tools/policy-labeler writes these labels into a policy: a node's first
+// interval becomes its left and right, the rest its intervals. Every
+// number below a node is in its intervals and none above it, and the
+// intervals are merged where they touch, so a descendant's first interval
+// lies inside one of them: the nested-set comparison of evaluate() holds
+// for each, as it does for a tree.
+
+#define DAG_SCAN_INTERVALS 32
+// Intervals read past the last one by a vector load
+#define DAG_PADDING 7
+
+class PolicyDag {
+public:
+    // parents[i] lists the nodes node i sits directly under, the first one
+    // being its spanning-tree parent; nodes with none are roots. postorder,
+    // if not null, receives each node's ordinal. False (and an empty DAG) if
+    // a parent is out of range or the edges have a cycle.
+    bool build(const std::vector<std::vector<uint32_t>>& parents,
+               std::vector<uint32_t>* postorder);
+
+    size_t size() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+    size_t intervals() const { return size() == 0 ? 0 : offsets_.back(); }
+    uint32_t intervalCount(uint32_t node) const { return offsets_[node + 1] - offsets_[node]; }
+    // Bounds of interval i of ordinal node, the one holding node first
+    int32_t low(uint32_t node, uint32_t i) const { return lows_[offsets_[node] + i]; }
+    int32_t high(uint32_t node, uint32_t i) const { return highs_[offsets_[node] + i]; }
+    // Bytes used in all
+    size_t bytes() const;
+
+    // Whether descendant is ancestor or lies under it along any path
+    bool contains(uint32_t ancestor, uint32_t descendant) const;
+    // The same, one interval at a time, for comparison
+    bool containsScalar(uint32_t ancestor, uint32_t descendant) const;
+
+private:
+    std::vector<uint32_t> offsets_;   // ordinal i's intervals: [offsets_[i], offsets_[i + 1])
+    std::vector<int32_t> lows_;       // interval bounds, DAG_PADDING empty ones at the end
+    std::vector<int32_t> highs_;
+};
+
+#endif // POLICY_DAG_H
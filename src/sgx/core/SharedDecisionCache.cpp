@@ -0,0 +1,352 @@
+#include "SharedDecisionCache.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// How long to wait for another process to finish creating the segment
+#define ATTACH_TIMEOUT_MS 1000
+// Seqlock read attempts before a moving entry counts as busy
+#define READ_RETRIES 4
+// Sequence numbers handed out by reclaim, far above any a writer reaches
+#define RECLAIMED_SEQUENCE_BASE (1ULL << 62)
+// meta of a reclaimed slot: reusable like an expired entry, but unlike an
+// empty one it does not end a lookup's probe sequence
+#define RECLAIMED_META 1
+// Operations between folding the local counters into the shared header
+#define STATS_FLUSH_OPS 256
+
+static uint64_t monotonicMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+// Expiry is absolute so it survives process restarts
+static uint32_t wallSeconds() {
+    return (uint32_t)time(nullptr);
+}
+
+static uint64_t packMeta(uint32_t expiresAt, uint32_t version, int8_t code) {
+    return ((uint64_t)expiresAt << 32) | ((uint64_t)(version & 0xFFFFFF) << 8) | (uint8_t)code;
+}
+
+static uint32_t metaExpiresAt(uint64_t meta) { return (uint32_t)(meta >> 32); }
+static uint32_t metaVersion(uint64_t meta) { return (uint32_t)(meta >> 8) & 0xFFFFFF; }
+static int8_t metaCode(uint64_t meta) { return (int8_t)(uint8_t)meta; }
+
+// ============================================================================
+// Segment
+// ============================================================================
+
+SharedDecisionCache::~SharedDecisionCache() {
+    close();
+}
+
+bool SharedDecisionCache::open(const std::string& name, uint32_t capacity, std::string* error) {
+    close();
+
+    uint32_t entries = SHARED_CACHE_PROBES;
+    while (entries < capacity && entries < (1u << 31)) entries <<= 1;
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+        if (fd >= 0) {
+            // Creator: size, then publish the header (the pages read as zero)
+            size_t bytes = SHARED_CACHE_ENTRIES_OFFSET + (size_t)entries * sizeof(SharedCacheEntry);
+            void* p = MAP_FAILED;
+            if (ftruncate(fd, (off_t)bytes) == 0) {
+                p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+            int savedErrno = errno;
+            ::close(fd);
+            if (p == MAP_FAILED) {
+                shm_unlink(name.c_str());
+                *error = "cannot create shared cache " + name + ": " + strerror(savedErrno);
+                return false;
+            }
+            header_ = static_cast<SharedCacheHeader*>(p);
+            header_->layout = SHARED_CACHE_LAYOUT;
+            header_->capacity = entries;
+            header_->magic.store(SHARED_CACHE_MAGIC, std::memory_order_release);
+            mappedBytes_ = bytes;
+            created_ = true;
+            break;
+        }
+        if (errno != EEXIST) {
+            *error = "cannot open shared cache " + name + ": " + strerror(errno);
+            return false;
+        }
+
+        // Attach: wait for the creator to publish the header
+        fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) continue;    // removed in between; try to create it
+        uint64_t deadline = monotonicMs() + ATTACH_TIMEOUT_MS;
+        while (!header_ && monotonicMs() < deadline) {
+            struct stat st;
+            if (fstat(fd, &st) == 0 && (size_t)st.st_size >= SHARED_CACHE_ENTRIES_OFFSET) {
+                void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (p != MAP_FAILED) {
+                    SharedCacheHeader* header = static_cast<SharedCacheHeader*>(p);
+                    if (header->magic.load(std::memory_order_acquire) == SHARED_CACHE_MAGIC) {
+                        header_ = header;
+                        mappedBytes_ = (size_t)st.st_size;
+                        break;
+                    }
+                    munmap(p, (size_t)st.st_size);
+                }
+            }
+            usleep(1000);
+        }
+        ::close(fd);
+
+        if (!header_) {
+            // The creator died before publishing: start over
+            shm_unlink(name.c_str());
+            continue;
+        }
+        size_t expected = SHARED_CACHE_ENTRIES_OFFSET +
+                          (size_t)header_->capacity * sizeof(SharedCacheEntry);
+        if (header_->layout != SHARED_CACHE_LAYOUT || mappedBytes_ < expected ||
+            header_->capacity < SHARED_CACHE_PROBES ||
+            (header_->capacity & (header_->capacity - 1)) != 0) {
+            close();
+            *error = "shared cache " + name + " has an incompatible layout";
+            return false;
+        }
+        break;
+    }
+
+    if (!header_) {
+        *error = "cannot attach to shared cache " + name;
+        return false;
+    }
+    entries_ = reinterpret_cast<SharedCacheEntry*>(
+        reinterpret_cast<uint8_t*>(header_) + SHARED_CACHE_ENTRIES_OFFSET);
+    mask_ = header_->capacity - 1;
+    recover();
+    return true;
+}
+
+void SharedDecisionCache::close() {
+    if (header_) {
+        flushCounters();
+        munmap(header_, mappedBytes_);
+    }
+    header_ = nullptr;
+    entries_ = nullptr;
+    mappedBytes_ = 0;
+    mask_ = 0;
+    created_ = false;
+}
+
+bool SharedDecisionCache::remove(const std::string& name) {
+    return shm_unlink(name.c_str()) == 0;
+}
+
+Hash128 SharedDecisionCache::makeKey(const char* key, size_t keyLen, uint32_t version) {
+    Hash128 seed = { HASH_PRIME_3 ^ version, HASH_PRIME_2 + version };
+    Hash128 h = hash128(key, keyLen, seed);
+    // Zero marks an empty slot
+    if (h.lo == 0 && h.hi == 0) h.lo = 1;
+    return h;
+}
+
+// ============================================================================
+// Entries
+// ============================================================================
+
+bool SharedDecisionCache::readEntry(SharedCacheEntry& entry, uint64_t* sequence, uint64_t* keyLo,
+                                    uint64_t* keyHi, uint64_t* meta) {
+    for (int attempt = 0; attempt < READ_RETRIES; attempt++) {
+        uint64_t before = entry.sequence.load(std::memory_order_acquire);
+        if (before & 1) return false;
+        *keyLo = entry.keyLo.load(std::memory_order_relaxed);
+        *keyHi = entry.keyHi.load(std::memory_order_relaxed);
+        *meta = entry.meta.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (entry.sequence.load(std::memory_order_relaxed) == before) {
+            *sequence = before;
+            return true;
+        }
+    }
+    return false;
+}
+
+// A busy word carries the claim time; past the lease its writer is gone
+bool SharedDecisionCache::reclaimIfStale(SharedCacheEntry& entry, uint64_t sequence, uint64_t nowMs) {
+    uint64_t claimedAt = sequence >> 1;
+    if (!(sequence & 1) || claimedAt > nowMs || nowMs - claimedAt < SHARED_CACHE_LEASE_MS) {
+        return false;
+    }
+    uint64_t busy = (nowMs << 1) | 1;
+    if (!entry.sequence.compare_exchange_strong(sequence, busy, std::memory_order_acq_rel)) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.keyLo.store(0, std::memory_order_relaxed);
+    entry.keyHi.store(0, std::memory_order_relaxed);
+    entry.meta.store(RECLAIMED_META, std::memory_order_relaxed);
+    // A sequence no reader can have seen before the crash
+    uint64_t nonce = header_->reclaimNonce.fetch_add(1, std::memory_order_relaxed);
+    entry.sequence.store((RECLAIMED_SEQUENCE_BASE + nonce) << 1, std::memory_order_release);
+    header_->reclaimed.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+uint64_t SharedDecisionCache::recover() {
+    if (!header_) return 0;
+    uint64_t nowMs = monotonicMs();
+    uint64_t count = 0;
+    for (uint32_t i = 0; i <= mask_; i++) {
+        uint64_t sequence = entries_[i].sequence.load(std::memory_order_relaxed);
+        if ((sequence & 1) && reclaimIfStale(entries_[i], sequence, nowMs)) count++;
+    }
+    return count;
+}
+
+// Entries store the caller's version shifted by the epoch, so clear() turns
+// all of them into stale versions
+uint32_t SharedDecisionCache::effectiveVersion(uint32_t version) const {
+    uint64_t epoch = header_->epoch.load(std::memory_order_acquire);
+    return (uint32_t)(version + epoch * HASH_PRIME_1) & 0xFFFFFF;
+}
+
+void SharedDecisionCache::clear() {
+    header_->epoch.fetch_add(1, std::memory_order_acq_rel);
+}
+
+bool SharedDecisionCache::lookup(const Hash128& key, uint32_t version, int8_t* code) {
+    version = effectiveVersion(version);
+    uint32_t now = wallSeconds();
+    uint32_t slot = (uint32_t)key.lo & mask_;
+
+    for (uint32_t probe = 0; probe < SHARED_CACHE_PROBES; probe++) {
+        SharedCacheEntry& entry = entries_[(slot + probe) & mask_];
+        uint64_t sequence, keyLo, keyHi, meta;
+        if (!readEntry(entry, &sequence, &keyLo, &keyHi, &meta)) {
+            local_.contended++;
+            continue;
+        }
+        // Keys are placed in the first free slot of their window
+        if (meta == 0) break;
+        if (keyLo != key.lo || keyHi != key.hi) continue;
+
+        if (metaVersion(meta) == (version & 0xFFFFFF) && metaExpiresAt(meta) > now) {
+            *code = metaCode(meta);
+            local_.hits++;
+            countOperation();
+            return true;
+        }
+        break;
+    }
+    local_.misses++;
+    countOperation();
+    return false;
+}
+
+bool SharedDecisionCache::insert(const Hash128& key, uint32_t version, int8_t code, uint32_t ttlSeconds) {
+    if (ttlSeconds == 0) return false;
+    version = effectiveVersion(version);
+    uint32_t now = wallSeconds();
+    uint64_t expiresAt = (uint64_t)now + ttlSeconds;
+    uint64_t meta = packMeta(expiresAt > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)expiresAt, version, code);
+    uint32_t slot = (uint32_t)key.lo & mask_;
+
+    // Same key, else the first free slot (empty, expired or from an old
+    // policy version), else the live entry closest to expiry
+    SharedCacheEntry* target = nullptr;
+    uint64_t targetSequence = 0;
+    bool targetLive = false;
+    SharedCacheEntry* victim = nullptr;
+    uint64_t victimSequence = 0;
+    uint32_t victimExpiresAt = 0xFFFFFFFFu;
+    uint64_t nowMs = 0;
+
+    for (uint32_t probe = 0; probe < SHARED_CACHE_PROBES; probe++) {
+        SharedCacheEntry& entry = entries_[(slot + probe) & mask_];
+        uint64_t sequence, keyLo, keyHi, entryMeta;
+        if (!readEntry(entry, &sequence, &keyLo, &keyHi, &entryMeta)) {
+            if (!nowMs) nowMs = monotonicMs();
+            sequence = entry.sequence.load(std::memory_order_relaxed);
+            if (!reclaimIfStale(entry, sequence, nowMs) ||
+                !readEntry(entry, &sequence, &keyLo, &keyHi, &entryMeta)) {
+                local_.contended++;
+                continue;
+            }
+        }
+
+        if (entryMeta != 0 && keyLo == key.lo && keyHi == key.hi) {
+            target = &entry;
+            targetSequence = sequence;
+            break;
+        }
+        bool free = entryMeta == 0 || metaExpiresAt(entryMeta) <= now ||
+                    metaVersion(entryMeta) != (version & 0xFFFFFF);
+        if (free && !target) {
+            target = &entry;
+            targetSequence = sequence;
+        } else if (!free && metaExpiresAt(entryMeta) < victimExpiresAt) {
+            victim = &entry;
+            victimSequence = sequence;
+            victimExpiresAt = metaExpiresAt(entryMeta);
+        }
+    }
+    if (!target && victim) {
+        target = victim;
+        targetSequence = victimSequence;
+        targetLive = true;
+    }
+    if (!target) return false;
+
+    // Lost the race for the slot: another writer owns it now
+    uint64_t busy = ((nowMs ? nowMs : monotonicMs()) << 1) | 1;
+    if (!target->sequence.compare_exchange_strong(targetSequence, busy, std::memory_order_acq_rel)) {
+        local_.contended++;
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    target->keyLo.store(key.lo, std::memory_order_relaxed);
+    target->keyHi.store(key.hi, std::memory_order_relaxed);
+    target->meta.store(meta, std::memory_order_relaxed);
+    target->sequence.store(targetSequence + 2, std::memory_order_release);
+
+    local_.inserts++;
+    if (targetLive) local_.evictions++;
+    countOperation();
+    return true;
+}
+
+// Per-process counters keep the header line from bouncing between cores
+void SharedDecisionCache::countOperation() {
+    if (++pendingOps_ >= STATS_FLUSH_OPS) flushCounters();
+}
+
+void SharedDecisionCache::flushCounters() {
+    header_->hits.fetch_add(local_.hits, std::memory_order_relaxed);
+    header_->misses.fetch_add(local_.misses, std::memory_order_relaxed);
+    header_->inserts.fetch_add(local_.inserts, std::memory_order_relaxed);
+    header_->evictions.fetch_add(local_.evictions, std::memory_order_relaxed);
+    header_->contended.fetch_add(local_.contended, std::memory_order_relaxed);
+    local_ = SharedCacheStats();
+    pendingOps_ = 0;
+}
+
+SharedCacheStats SharedDecisionCache::stats() {
+    SharedCacheStats stats;
+    if (!header_) return stats;
+    flushCounters();
+    stats.capacity = header_->capacity;
+    stats.hits = header_->hits.load(std::memory_order_relaxed);
+    stats.misses = header_->misses.load(std::memory_order_relaxed);
+    stats.inserts = header_->inserts.load(std::memory_order_relaxed);
+    stats.evictions = header_->evictions.load(std::memory_order_relaxed);
+    stats.contended = header_->contended.load(std::memory_order_relaxed);
+    stats.reclaimed = header_->reclaimed.load(std::memory_order_relaxed);
+    stats.segmentBytes = mappedBytes_;
+    stats.created = created_;
+    return stats;
+}
@@ -0,0 +1,128 @@
+#ifndef SHARED_DECISION_CACHE_H
+#define SHARED_DECISION_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include "Hash.h"
+
+// ============================================================================
+// Shared-Memory Decision Cache
+// ============================================================================
+//
+// Grant/deny decisions shared by every validator process on a host through
+// a POSIX shared-memory segment (/dev/shm/<name>). Open addressing with
+// linear probing over a power-of-two table of 32-byte entries; a key probes
+// at most SHARED_CACHE_PROBES slots (four cache lines).
+//
+// Entries are versioned: the key includes the policy version and the entry
+// stores it, so a policy change turns old decisions into misses and frees
+// their slots for reuse; clear() does the same for every version at once
+// by bumping the segment epoch. Each entry expires at its own TTL (the user's
+// timeofRetention), checked against wall-clock seconds on every read.
+//
+// No locks: each entry is a seqlock. A writer claims it by CASing the
+// sequence word to "busy" (bit 0) stamped with the monotonic time in ms,
+// writes the fields and publishes an even sequence; readers retry or miss
+// when the sequence moved. A writer that dies mid-write leaves a busy word
+// behind; once it is older than SHARED_CACHE_LEASE_MS any writer (or the
+// next process to attach) reclaims the slot as empty. Busy slots are
+// treated as misses, never waited on.
+
+#define SHARED_CACHE_MAGIC 0x314543444350ULL    // "PCDCE1"
+#define SHARED_CACHE_LAYOUT 1
+#define SHARED_CACHE_DEFAULT_NAME "/privacy-decisions"
+#define SHARED_CACHE_DEFAULT_CAPACITY (1u << 20)
+#define SHARED_CACHE_PROBES 8
+#define SHARED_CACHE_LEASE_MS 1000
+
+struct SharedCacheEntry {
+    std::atomic<uint64_t> sequence;   // even: stable (0 = never written), odd: busy
+    std::atomic<uint64_t> keyLo;
+    std::atomic<uint64_t> keyHi;
+    std::atomic<uint64_t> meta;       // expiresAt (s) << 32 | version (24 bits) << 8 | code
+};
+
+static_assert(sizeof(SharedCacheEntry) == 32, "two entries per cache line");
+
+struct SharedCacheHeader {
+    std::atomic<uint64_t> magic;      // set last by the creating process
+    uint32_t layout;
+    uint32_t capacity;                // entries, power of two
+    std::atomic<uint64_t> reclaimNonce;
+    std::atomic<uint64_t> epoch;      // bumped by clear(); part of every version
+    // Counters across all attached processes
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> inserts;
+    std::atomic<uint64_t> evictions;  // live entries overwritten for space
+    std::atomic<uint64_t> contended;  // reads or writes that met a busy slot
+    std::atomic<uint64_t> reclaimed;  // busy slots left by dead writers
+};
+
+// Entries start on the first cache line after the header
+#define SHARED_CACHE_ENTRIES_OFFSET ((sizeof(SharedCacheHeader) + 63) & ~(size_t)63)
+
+struct SharedCacheStats {
+    uint32_t capacity = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t inserts = 0;
+    uint64_t evictions = 0;
+    uint64_t contended = 0;
+    uint64_t reclaimed = 0;
+    size_t segmentBytes = 0;
+    bool created = false;             // this process created the segment
+};
+
+// One object per thread: the counters are batched per object. Any number of
+// threads and processes may attach to the same segment.
+class SharedDecisionCache {
+public:
+    ~SharedDecisionCache();
+
+    // Attaches to the named segment, creating it with capacity entries
+    // (rounded up to a power of two) if it does not exist yet. An existing
+    // segment keeps its own capacity.
+    bool open(const std::string& name, uint32_t capacity, std::string* error);
+    void close();
+    // Removes the segment name; attached processes keep their mapping
+    static bool remove(const std::string& name);
+    bool isOpen() const { return header_ != nullptr; }
+
+    // Key of one decision: the caller's request key and policy version
+    static Hash128 makeKey(const char* key, size_t keyLen, uint32_t version);
+
+    // Returns true with *code (EvaluationResult) on a live hit
+    bool lookup(const Hash128& key, uint32_t version, int8_t* code);
+    // Stores a decision valid for ttlSeconds; best effort (false if every
+    // candidate slot was busy)
+    bool insert(const Hash128& key, uint32_t version, int8_t code, uint32_t ttlSeconds);
+    // Invalidates every entry in O(1), for all attached processes
+    void clear();
+
+    // Reclaims every slot a crashed writer left busy; run on attach
+    uint64_t recover();
+    // Counters of every attached process (this one's are folded in first)
+    SharedCacheStats stats();
+
+private:
+    // Consistent snapshot of a stable entry; false while it is busy
+    bool readEntry(SharedCacheEntry& entry, uint64_t* sequence, uint64_t* keyLo,
+                   uint64_t* keyHi, uint64_t* meta);
+    bool reclaimIfStale(SharedCacheEntry& entry, uint64_t sequence, uint64_t nowMs);
+    uint32_t effectiveVersion(uint32_t version) const;
+    void countOperation();
+    void flushCounters();
+
+    SharedCacheHeader* header_ = nullptr;
+    SharedCacheEntry* entries_ = nullptr;
+    size_t mappedBytes_ = 0;
+    uint32_t mask_ = 0;
+    bool created_ = false;
+    SharedCacheStats local_;
+    uint32_t pendingOps_ = 0;
+};
+
+#endif // SHARED_DECISION_CACHE_H
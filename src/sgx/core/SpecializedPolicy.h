@@ -0,0 +1,161 @@
+#ifndef SPECIALIZED_POLICY_H
+#define SPECIALIZED_POLICY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "../enclave/Enclave.h"
+
+// ============================================================================
+// Compile-Time Policy Specialization
+// ============================================================================
+//
+// Evaluator for one policy fixed at build time. tools/policy-compiler turns
+// a policy snapshot into a header (by default core/GeneratedPolicy.h) that
+// describes each tree as a Tree type:
+//
+//   struct Attributes {
+//       static constexpr size_t kCount = ...;
+//       static constexpr SpecNode kNodes[kCount] = { { "id", left, right }, ... };
+//       static int ordinal(const std::string& id);   // switch on specIdHash
+//   };
+//
+// plus a Policy type holding Attributes, Purposes and kVersion. From those
+// tables SpecializedTree computes, at compile time, which node contains which
+// (the isDescendant comparisons of evaluate()), as one bitset per node. At
+// run time a preference ID becomes an ordinal through the generated switch,
+// and a containment check is a bit test. SpecializedEvaluator<Policy> gives
+// the same decisions as evaluate() for that policy, including its use of the
+// exception lists for the deny checks.
+//
+// Only std is used, so the generated code builds into the enclave
+// (SPECIALIZED_POLICY=1 ./build.sh) as well as the native core.
+
+// Trees larger than this are left to the generic evaluator: the containment
+// table is kCount^2 bits, and computing it for 512 nodes already takes a few
+// seconds within GCC's default constexpr operation limit
+#define SPEC_MAX_NODES 512
+
+struct SpecNode {
+    const char* id;
+    int32_t left;
+    int32_t right;
+};
+
+// FNV-1a; the generated ordinal() switches on it with constant case labels
+constexpr uint64_t specIdHash(const char* s, size_t length) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < length; i++) {
+        h = (h ^ (uint8_t)s[i]) * 0x100000001B3ULL;
+    }
+    return h;
+}
+
+template <size_t L>
+constexpr uint64_t specIdHash(const char (&s)[L]) {
+    return specIdHash(s, L - 1);
+}
+
+// bits[o] has bit k set when node o contains node k
+template <size_t N>
+struct SpecCover {
+    static constexpr size_t kWords = (N + 63) / 64;
+    uint64_t bits[N][kWords] = {};
+};
+
+template <size_t N>
+constexpr SpecCover<N> buildSpecCover(const SpecNode (&nodes)[N]) {
+    SpecCover<N> cover;
+    for (size_t o = 0; o < N; o++) {
+        for (size_t k = 0; k < N; k++) {
+            if (nodes[o].left <= nodes[k].left && nodes[o].right >= nodes[k].right) {
+                cover.bits[o][k / 64] |= 1ULL << (k % 64);
+            }
+        }
+    }
+    return cover;
+}
+
+template <typename Tree>
+class SpecializedTree {
+public:
+    static_assert(Tree::kCount > 0 && Tree::kCount <= SPEC_MAX_NODES,
+                  "specialized trees hold 1 to SPEC_MAX_NODES nodes");
+    static constexpr size_t kWords = SpecCover<Tree::kCount>::kWords;
+    static constexpr SpecCover<Tree::kCount> kCover = buildSpecCover(Tree::kNodes);
+
+    // evaluateAttributeType / evaluatePurposeType for one preference list
+    static bool anyContains(const std::vector<std::string>& prefIds,
+                            const std::vector<PolicyNode>& appNodes) {
+        uint64_t mask[kWords] = {};
+        bool any = false;
+        for (const std::string& id : prefIds) {
+            int o = Tree::ordinal(id);
+            if (o < 0) continue;
+            for (size_t w = 0; w < kWords; w++) mask[w] |= kCover.bits[o][w];
+            any = true;
+        }
+        if (!any) return false;
+
+        for (const PolicyNode& node : appNodes) {
+            int k = Tree::ordinal(node.id);
+            if (k >= 0 && Tree::kNodes[k].left == node.left && Tree::kNodes[k].right == node.right) {
+                if ((mask[k / 64] >> (k % 64)) & 1) return true;
+            } else if (containsInterval(prefIds, node)) {
+                // App node that is not a node of this policy: compare intervals
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // True when nodes lists the same IDs and intervals, in order. Generated
+    // trees have no DAG nodes, so a node with further intervals never matches.
+    static bool matches(const std::vector<PolicyNode>& nodes) {
+        if (nodes.size() != Tree::kCount) return false;
+        for (size_t i = 0; i < nodes.size(); i++) {
+            const SpecNode& spec = Tree::kNodes[i];
+            if (nodes[i].id != spec.id || nodes[i].left != spec.left ||
+                nodes[i].right != spec.right || !nodes[i].intervals.empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    static bool containsInterval(const std::vector<std::string>& prefIds, const PolicyNode& node) {
+        for (const std::string& id : prefIds) {
+            int o = Tree::ordinal(id);
+            if (o >= 0 && Tree::kNodes[o].left <= node.left && Tree::kNodes[o].right >= node.right) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+template <typename Policy>
+class SpecializedEvaluator {
+public:
+    typedef SpecializedTree<typename Policy::Attributes> Attributes;
+    typedef SpecializedTree<typename Policy::Purposes> Purposes;
+
+    // Same result as evaluate(app, userPref, policy) when matches(policy)
+    static EvaluationResult evaluate(const AppRequest& app, const UserPreference& userPref) {
+        bool attributes = Attributes::anyContains(userPref.attributeIds, app.attributes) &&
+                          !Attributes::anyContains(userPref.exceptionIds, app.attributes);
+        bool purposes = Purposes::anyContains(userPref.allowedPurposeIds, app.purposes) &&
+                        !Purposes::anyContains(userPref.prohibitedPurposeIds, app.purposes);
+        bool retention = app.timeofRetention <= userPref.timeofRetention;
+        return attributes && purposes && retention ? RESULT_GRANT : RESULT_DENY;
+    }
+
+    // True when policy is the snapshot the header was generated from
+    static bool matches(const PolicyData& policy) {
+        return Attributes::matches(policy.attributes) && Purposes::matches(policy.purposes);
+    }
+};
+
+#endif // SPECIALIZED_POLICY_H
@@ -0,0 +1,216 @@
+#include "ThreadPool.h"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Rounds a worker spins over the deques before parking
+#define STEAL_ATTEMPTS 64
+
+// Per-thread xorshift state for victim selection
+static uint32_t nextVictimSeed() {
+    static thread_local uint32_t state =
+        (uint32_t)std::hash<std::thread::id>()(std::this_thread::get_id()) | 1u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// ============================================================================
+// Lifecycle
+// ============================================================================
+
+WorkStealingPool::WorkStealingPool(int workers, bool pinCores)
+    : pinCores_(pinCores), queuedTasks_(0), sleepers_(0), stopping_(false),
+      jobs_(0), tasks_(0), splits_(0), steals_(0), sleeps_(0) {
+    unsigned threads = (unsigned)workers;
+    if (workers < 0) {
+        unsigned hardware = std::thread::hardware_concurrency();
+        threads = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    for (unsigned i = 0; i <= threads; i++) {
+        deques_.push_back(new TaskDeque());
+    }
+    externalSlot_ = threads;
+
+    for (unsigned i = 0; i < threads; i++) {
+        workers_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+#ifdef __linux__
+        if (pinCores_) {
+            unsigned cpus = std::thread::hardware_concurrency();
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpus ? i % cpus : 0, &set);
+            pthread_setaffinity_np(workers_.back().native_handle(), sizeof(set), &set);
+        }
+#endif
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_.store(true);
+    }
+    sleepCv_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    for (TaskDeque* deque : deques_) {
+        delete deque;
+    }
+}
+
+// ============================================================================
+// Deque Operations
+// ============================================================================
+
+void WorkStealingPool::push(unsigned slot, const RangeTask& task) {
+    {
+        std::lock_guard<std::mutex> lock(deques_[slot]->lock);
+        deques_[slot]->tasks.push_back(task);
+    }
+    queuedTasks_.fetch_add(1);
+    if (sleepers_.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        sleepCv_.notify_one();
+    }
+}
+
+bool WorkStealingPool::popOwn(unsigned slot, RangeTask* task) {
+    std::lock_guard<std::mutex> lock(deques_[slot]->lock);
+    std::deque<RangeTask>& tasks = deques_[slot]->tasks;
+    if (tasks.empty()) return false;
+    *task = tasks.back();
+    tasks.pop_back();
+    queuedTasks_.fetch_sub(1);
+    return true;
+}
+
+// Take the oldest (largest) range from a random victim, scanning all slots
+bool WorkStealingPool::steal(unsigned thief, RangeTask* task) {
+    unsigned count = (unsigned)deques_.size();
+    unsigned start = nextVictimSeed() % count;
+    for (unsigned i = 0; i < count; i++) {
+        unsigned victim = (start + i) % count;
+        if (victim == thief) continue;
+        std::lock_guard<std::mutex> lock(deques_[victim]->lock);
+        std::deque<RangeTask>& tasks = deques_[victim]->tasks;
+        if (tasks.empty()) continue;
+        *task = tasks.front();
+        tasks.pop_front();
+        queuedTasks_.fetch_sub(1);
+        steals_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool WorkStealingPool::runOne(unsigned slot) {
+    RangeTask task;
+    if (popOwn(slot, &task) || steal(slot, &task)) {
+        execute(slot, task);
+        return true;
+    }
+    return false;
+}
+
+// Split off right halves until the range fits the grain, then run it
+void WorkStealingPool::execute(unsigned slot, RangeTask task) {
+    Job* job = task.job;
+    while (task.end - task.begin > job->grain) {
+        size_t mid = task.begin + (task.end - task.begin) / 2;
+        push(slot, RangeTask{ job, mid, task.end });
+        splits_.fetch_add(1, std::memory_order_relaxed);
+        task.end = mid;
+    }
+
+    (*job->body)(task.begin, task.end);
+    tasks_.fetch_add(1, std::memory_order_relaxed);
+    job->remaining.fetch_sub(task.end - task.begin, std::memory_order_acq_rel);
+}
+
+// ============================================================================
+// Workers
+// ============================================================================
+
+void WorkStealingPool::workerLoop(unsigned slot) {
+    while (!stopping_.load()) {
+        bool ran = false;
+        for (int attempt = 0; attempt < STEAL_ATTEMPTS && !ran; attempt++) {
+            ran = runOne(slot);
+            if (!ran) std::this_thread::yield();
+        }
+        if (ran) continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepers_.fetch_add(1);
+        sleeps_.fetch_add(1, std::memory_order_relaxed);
+        sleepCv_.wait(lock, [this] {
+            return stopping_.load() || queuedTasks_.load() > 0;
+        });
+        sleepers_.fetch_sub(1);
+    }
+}
+
+// ============================================================================
+// Jobs
+// ============================================================================
+
+void WorkStealingPool::parallelFor(size_t begin, size_t end, size_t grain, const RangeBody& body) {
+    if (end <= begin) return;
+    size_t count = end - begin;
+    if (grain == 0) {
+        grain = count / ((size_t)concurrency() * 8);
+        if (grain == 0) grain = 1;
+    }
+
+    jobs_.fetch_add(1, std::memory_order_relaxed);
+    if (count <= grain || workers_.empty()) {
+        body(begin, end);
+        tasks_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Job job;
+    job.body = &body;
+    job.grain = grain;
+    job.remaining.store(count);
+
+    // External callers share one slot; a worker calling in (nested job) keeps
+    // using its own deque. Either way the caller helps until the job is done,
+    // possibly running other jobs' ranges meanwhile.
+    unsigned slot = externalSlot_;
+    std::thread::id self = std::this_thread::get_id();
+    for (unsigned i = 0; i < workers_.size(); i++) {
+        if (workers_[i].get_id() == self) {
+            slot = i;
+            break;
+        }
+    }
+
+    execute(slot, RangeTask{ &job, begin, end });
+    while (job.remaining.load(std::memory_order_acquire) > 0) {
+        if (!runOne(slot)) std::this_thread::yield();
+    }
+}
+
+ThreadPoolStats WorkStealingPool::stats() const {
+    ThreadPoolStats s;
+    s.jobs = jobs_.load();
+    s.tasks = tasks_.load();
+    s.splits = splits_.load();
+    s.steals = steals_.load();
+    s.sleeps = sleeps_.load();
+    return s;
+}
+
+void WorkStealingPool::resetStats() {
+    jobs_.store(0);
+    tasks_.store(0);
+    splits_.store(0);
+    steals_.store(0);
+    sleeps_.store(0);
+}
@@ -0,0 +1,106 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// Work-Stealing Thread Pool
+// ============================================================================
+//
+// Shared scheduler for the bulk APIs (batch re-evaluation after a policy
+// change, decision matrices, audits). Every worker owns a deque of index
+// ranges: it pushes and pops at the back, idle workers steal from the front,
+// where the largest unsplit ranges sit. A range is split lazily in halves
+// until it is no larger than the grain, so a 10M-record job costs
+// O(threads * log(n / grain)) task pushes instead of one task per record.
+//
+// The thread calling parallelFor() joins in until its job is finished, so a
+// pool of N workers runs a job on N + 1 threads and nested calls from inside
+// a body cannot deadlock.
+
+typedef std::function<void(size_t begin, size_t end)> RangeBody;
+
+struct ThreadPoolStats {
+    uint64_t jobs;
+    uint64_t tasks;        // leaf ranges executed
+    uint64_t splits;       // ranges halved and pushed
+    uint64_t steals;       // ranges taken from another worker's deque
+    uint64_t sleeps;       // times a worker ran out of work and parked
+};
+
+class WorkStealingPool {
+public:
+    // workers < 0 uses std::thread::hardware_concurrency() - 1 workers (the
+    // caller is the last thread); 0 runs every job inline on the caller.
+    // pinCores binds worker i to CPU i.
+    explicit WorkStealingPool(int workers = -1, bool pinCores = false);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Threads that execute a job: the workers plus the calling thread
+    unsigned concurrency() const { return (unsigned)workers_.size() + 1; }
+    bool pinned() const { return pinCores_; }
+
+    // Run body over [begin, end) in chunks of at most grain records and
+    // return once every chunk is done. grain == 0 picks a grain that yields
+    // about 8 chunks per thread.
+    void parallelFor(size_t begin, size_t end, size_t grain, const RangeBody& body);
+
+    ThreadPoolStats stats() const;
+    void resetStats();
+
+private:
+    struct Job {
+        const RangeBody* body;
+        size_t grain;
+        std::atomic<size_t> remaining;  // records not yet executed
+    };
+
+    struct RangeTask {
+        Job* job;
+        size_t begin;
+        size_t end;
+    };
+
+    // One per worker plus one shared slot for external callers
+    struct alignas(64) TaskDeque {
+        std::mutex lock;
+        std::deque<RangeTask> tasks;
+    };
+
+    void workerLoop(unsigned slot);
+    void push(unsigned slot, const RangeTask& task);
+    bool popOwn(unsigned slot, RangeTask* task);
+    bool steal(unsigned thief, RangeTask* task);
+    bool runOne(unsigned slot);
+    void execute(unsigned slot, RangeTask task);
+
+    std::vector<std::thread> workers_;
+    std::vector<TaskDeque*> deques_;     // workers_.size() + 1 entries
+    unsigned externalSlot_;
+    bool pinCores_;
+
+    std::atomic<size_t> queuedTasks_;
+    std::atomic<unsigned> sleepers_;
+    std::atomic<bool> stopping_;
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCv_;
+
+    std::atomic<uint64_t> jobs_;
+    std::atomic<uint64_t> tasks_;
+    std::atomic<uint64_t> splits_;
+    std::atomic<uint64_t> steals_;
+    std::atomic<uint64_t> sleeps_;
+};
+
+#endif // THREAD_POOL_H
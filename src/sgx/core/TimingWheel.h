@@ -0,0 +1,167 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================================================
+// Hierarchical Timing Wheel
+// ============================================================================
+//
+// Fires intrusive timers on the exact tick they are due. TIMING_WHEEL_LEVELS
+// wheels of 64 slots each: a timer sits on the level of the highest 6-bit
+// digit in which its due tick differs from the current tick, and drops one
+// level each time the wheel reaches that digit. Schedule and cancel are
+// O(1), and a timer moves at most LEVELS - 1 times before it fires.
+//
+// Each level keeps a 64-bit occupancy mask, so advance() jumps straight to
+// the next occupied slot and idle time costs nothing. Timers beyond the
+// wheel span (2^36 ticks) are parked in an overflow list and placed again
+// when the wheel enters their block. Not thread-safe.
+
+#define TIMING_WHEEL_LEVELS 6
+#define TIMING_WHEEL_SLOT_BITS 6
+#define TIMING_WHEEL_SLOTS (1u << TIMING_WHEEL_SLOT_BITS)
+#define TIMING_WHEEL_SPAN_BITS (TIMING_WHEEL_LEVELS * TIMING_WHEEL_SLOT_BITS)
+#define TIMING_WHEEL_OVERFLOW (TIMING_WHEEL_LEVELS * TIMING_WHEEL_SLOTS)
+
+struct TimerNode {
+    TimerNode* prev = nullptr;
+    TimerNode* next = nullptr;
+    uint64_t due = 0;           // absolute tick
+    uint16_t slot = 0;          // level * SLOTS + slot, or TIMING_WHEEL_OVERFLOW
+};
+
+class TimingWheel {
+public:
+    explicit TimingWheel(uint64_t now = 0) : now_(now) {
+        for (size_t i = 0; i <= TIMING_WHEEL_OVERFLOW; i++) {
+            slots_[i].prev = slots_[i].next = &slots_[i];
+        }
+        for (size_t l = 0; l < TIMING_WHEEL_LEVELS; l++) occupied_[l] = 0;
+    }
+    // Slot heads point at themselves
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    uint64_t now() const { return now_; }
+    size_t size() const { return size_; }
+
+    // Schedules node to fire at tick due; false (not scheduled) if due is
+    // not in the future
+    bool schedule(TimerNode* node, uint64_t due) {
+        if (due <= now_) return false;
+        node->due = due;
+        place(node);
+        size_++;
+        return true;
+    }
+
+    void cancel(TimerNode* node) {
+        unlink(node);
+        size_--;
+    }
+
+    // Drops every timer without firing it
+    void reset() {
+        for (size_t i = 0; i <= TIMING_WHEEL_OVERFLOW; i++) {
+            slots_[i].prev = slots_[i].next = &slots_[i];
+        }
+        for (size_t l = 0; l < TIMING_WHEEL_LEVELS; l++) occupied_[l] = 0;
+        size_ = 0;
+    }
+
+    // Moves the wheel forward to tick target, calling onExpire(node) for
+    // every timer due at or before it, in tick order. onExpire may free the
+    // node and may schedule or cancel other timers.
+    template <typename F>
+    void advance(uint64_t target, F onExpire) {
+        while (now_ < target && size_ > 0) {
+            size_t index;
+            uint64_t next = nextEvent(&index);
+            if (next > target) break;
+            now_ = next;
+
+            // Detach the slot first: placing a timer may refill it
+            TimerNode pending;
+            TimerNode* head = &slots_[index];
+            pending.next = head->next;
+            pending.prev = head->prev;
+            pending.next->prev = &pending;
+            pending.prev->next = &pending;
+            head->prev = head->next = head;
+            if (index < TIMING_WHEEL_OVERFLOW) {
+                occupied_[index / TIMING_WHEEL_SLOTS] &= ~(1ULL << (index % TIMING_WHEEL_SLOTS));
+            }
+
+            while (pending.next != &pending) {
+                TimerNode* node = pending.next;
+                pending.next = node->next;
+                node->next->prev = &pending;
+                if (node->due <= now_) {
+                    size_--;
+                    node->prev = node->next = nullptr;
+                    onExpire(node);
+                } else {
+                    place(node);
+                }
+            }
+        }
+        if (now_ < target) now_ = target;
+    }
+
+private:
+    // Tick of the earliest occupied slot and its index. Lower levels always
+    // come first: everything on level l is due after the current level-l
+    // digit, everything on level l + 1 after the current level-(l+1) digit.
+    uint64_t nextEvent(size_t* index) const {
+        for (unsigned level = 0; level < TIMING_WHEEL_LEVELS; level++) {
+            unsigned shift = level * TIMING_WHEEL_SLOT_BITS;
+            unsigned digit = (unsigned)(now_ >> shift) & (TIMING_WHEEL_SLOTS - 1);
+            uint64_t later = digit == TIMING_WHEEL_SLOTS - 1 ? 0 : occupied_[level] & (~0ULL << (digit + 1));
+            if (later) {
+                unsigned slot = (unsigned)__builtin_ctzll(later);
+                uint64_t block = now_ & ~((1ULL << (shift + TIMING_WHEEL_SLOT_BITS)) - 1);
+                *index = level * TIMING_WHEEL_SLOTS + slot;
+                return block | ((uint64_t)slot << shift);
+            }
+        }
+        // Only overflow timers left: revisit them at the start of the next span
+        *index = TIMING_WHEEL_OVERFLOW;
+        return (now_ | ((1ULL << TIMING_WHEEL_SPAN_BITS) - 1)) + 1;
+    }
+
+    void place(TimerNode* node) {
+        uint64_t diff = node->due ^ now_;
+        size_t index = TIMING_WHEEL_OVERFLOW;
+        if ((diff >> TIMING_WHEEL_SPAN_BITS) == 0) {
+            unsigned level = (63 - (unsigned)__builtin_clzll(diff)) / TIMING_WHEEL_SLOT_BITS;
+            unsigned slot = (unsigned)(node->due >> (level * TIMING_WHEEL_SLOT_BITS)) & (TIMING_WHEEL_SLOTS - 1);
+            index = level * TIMING_WHEEL_SLOTS + slot;
+            occupied_[level] |= 1ULL << slot;
+        }
+        TimerNode* head = &slots_[index];
+        node->slot = (uint16_t)index;
+        node->prev = head->prev;
+        node->next = head;
+        head->prev->next = node;
+        head->prev = node;
+    }
+
+    void unlink(TimerNode* node) {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        node->prev = node->next = nullptr;
+        size_t index = node->slot;
+        if (index < TIMING_WHEEL_OVERFLOW && slots_[index].next == &slots_[index]) {
+            occupied_[index / TIMING_WHEEL_SLOTS] &= ~(1ULL << (index % TIMING_WHEEL_SLOTS));
+        }
+    }
+
+    uint64_t now_;
+    size_t size_ = 0;
+    uint64_t occupied_[TIMING_WHEEL_LEVELS];
+    TimerNode slots_[TIMING_WHEEL_OVERFLOW + 1];
+};
+
+#endif // TIMING_WHEEL_H
@@ -0,0 +1,191 @@
+#include "Channel.h"
+#include "EnclaveCache.h"
+#include "PrivacyEvaluation_edl.h"
+#include "sgx_tcrypto.h"
+#include <string.h>
+#include <mutex>
+
+struct ChannelSession {
+    uint32_t id;                    // 0: slot free
+    sgx_aes_gcm_128bit_key_t key;
+};
+
+// Session id N lives in slot N % CHANNEL_MAX_SESSIONS, so opening a new
+// session overwrites the one opened CHANNEL_MAX_SESSIONS sessions earlier
+static ChannelSession sessions[CHANNEL_MAX_SESSIONS];
+static uint32_t nextSessionId = 1;
+static std::mutex sessionLock;
+
+static bool sessionKey(uint32_t id, sgx_aes_gcm_128bit_key_t* key) {
+    std::lock_guard<std::mutex> lock(sessionLock);
+    const ChannelSession& session = sessions[id % CHANNEL_MAX_SESSIONS];
+    if (id == 0 || session.id != id) return false;
+    memcpy(key, session.key, sizeof(*key));
+    return true;
+}
+
+// ============================================================================
+// Session Setup
+// ============================================================================
+
+int ecall_channel_open(const uint8_t* clientPublic, uint8_t* enclavePublic, uint32_t* sessionId) {
+    sgx_ecc_state_handle_t ecc = nullptr;
+    if (sgx_ecc256_open_context(&ecc) != SGX_SUCCESS) return RESULT_ERROR;
+
+    sgx_ec256_public_t peer;
+    memcpy(peer.gx, clientPublic, sizeof(peer.gx));
+    memcpy(peer.gy, clientPublic + sizeof(peer.gx), sizeof(peer.gy));
+
+    // A point off the curve would leak the private key through the shared
+    // secret (invalid-curve attack)
+    int valid = 0;
+    sgx_ec256_private_t privateKey;
+    sgx_ec256_public_t publicKey;
+    sgx_ec256_dh_shared_t shared;
+    bool ok = sgx_ecc256_check_point(&peer, ecc, &valid) == SGX_SUCCESS && valid &&
+              sgx_ecc256_create_key_pair(&privateKey, &publicKey, ecc) == SGX_SUCCESS &&
+              sgx_ecc256_compute_shared_dhkey(&privateKey, &peer, &shared, ecc) == SGX_SUCCESS;
+    sgx_ecc256_close_context(ecc);
+    memset(&privateKey, 0, sizeof(privateKey));
+    if (!ok) {
+        memset(&shared, 0, sizeof(shared));
+        return valid ? RESULT_ERROR : RESULT_UNAUTHENTICATED;
+    }
+
+    uint8_t material[sizeof(CHANNEL_KEY_LABEL) - 1 + sizeof(shared.s)];
+    memcpy(material, CHANNEL_KEY_LABEL, sizeof(CHANNEL_KEY_LABEL) - 1);
+    memcpy(material + sizeof(CHANNEL_KEY_LABEL) - 1, shared.s, sizeof(shared.s));
+    sgx_sha256_hash_t digest;
+    sgx_status_t status = sgx_sha256_msg(material, (uint32_t)sizeof(material), &digest);
+    memset(material, 0, sizeof(material));
+    memset(&shared, 0, sizeof(shared));
+    if (status != SGX_SUCCESS) return RESULT_ERROR;
+
+    {
+        std::lock_guard<std::mutex> lock(sessionLock);
+        uint32_t id = nextSessionId++;
+        if (nextSessionId == 0) nextSessionId = 1;
+        ChannelSession& session = sessions[id % CHANNEL_MAX_SESSIONS];
+        session.id = id;
+        memcpy(session.key, digest, CHANNEL_KEY_LEN);
+        *sessionId = id;
+    }
+    memset(digest, 0, sizeof(digest));
+
+    memcpy(enclavePublic, publicKey.gx, sizeof(publicKey.gx));
+    memcpy(enclavePublic + sizeof(publicKey.gx), publicKey.gy, sizeof(publicKey.gy));
+    return 0;
+}
+
+int ecall_channel_close(uint32_t sessionId) {
+    std::lock_guard<std::mutex> lock(sessionLock);
+    ChannelSession& session = sessions[sessionId % CHANNEL_MAX_SESSIONS];
+    if (sessionId == 0 || session.id != sessionId) return RESULT_ERROR;
+    memset(&session, 0, sizeof(session));
+    return 0;
+}
+
+// ============================================================================
+// Encrypted Batch Evaluation
+// ============================================================================
+
+struct SealedRecord {
+    uint32_t sessionId;
+    const uint8_t* sealed;
+    uint32_t sealedLen;
+    const char* policyJson;
+};
+
+static bool readRecord(const uint8_t** pos, const uint8_t* end, SealedRecord* record) {
+    if ((size_t)(end - *pos) < 2 * sizeof(uint32_t)) return false;
+    memcpy(&record->sessionId, *pos, sizeof(uint32_t));
+    memcpy(&record->sealedLen, *pos + sizeof(uint32_t), sizeof(uint32_t));
+    *pos += 2 * sizeof(uint32_t);
+    if (record->sealedLen < CHANNEL_IV_LEN + CHANNEL_TAG_LEN ||
+        (size_t)(end - *pos) < record->sealedLen) {
+        return false;
+    }
+    record->sealed = *pos;
+    *pos += record->sealedLen;
+
+    record->policyJson = reinterpret_cast<const char*>(*pos);
+    size_t policyLen = strnlen(record->policyJson, (size_t)(end - *pos));
+    if (policyLen == (size_t)(end - *pos)) return false;
+    *pos += policyLen + 1;
+    return true;
+}
+
+// The plaintext must be exactly "app\0user\0"
+static bool splitPlaintext(const char* text, size_t length, const char** user) {
+    if (length < 2 || text[length - 1] != '\0') return false;
+    size_t appLen = strnlen(text, length);
+    if (appLen + 1 >= length) return false;
+    *user = text + appLen + 1;
+    return strlen(*user) + appLen + 2 == length;
+}
+
+// Decrypts every record of the batch into one scratch buffer, then
+// evaluates them. The session key is fetched once per run of records from
+// the same session, which for a gateway's batch means once per ECALL.
+// results[i] is RESULT_UNAUTHENTICATED when record i does not decrypt;
+// digests of such records are left zeroed.
+int ecall_evaluate_encrypted_batch(const uint8_t* input, size_t inputLen, size_t count,
+                                   int* results, uint8_t* digests, size_t digestsLen) {
+    if (!input || !results || count == 0 ||
+        (digests && digestsLen != count * INPUT_DIGEST_LEN)) {
+        return RESULT_ERROR;
+    }
+    if (digests) memset(digests, 0, digestsLen);
+
+    std::vector<SealedRecord> records(count);
+    const uint8_t* pos = input;
+    const uint8_t* end = input + inputLen;
+    size_t plaintextLen = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!readRecord(&pos, end, &records[i])) return RESULT_ERROR;
+        plaintextLen += records[i].sealedLen - CHANNEL_IV_LEN - CHANNEL_TAG_LEN;
+    }
+
+    std::vector<char> plaintext(plaintextLen);
+    std::vector<size_t> offsets(count);
+    sgx_aes_gcm_128bit_key_t key;
+    uint32_t keyId = 0;
+    bool haveKey = false;
+    size_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        const SealedRecord& record = records[i];
+        uint32_t textLen = record.sealedLen - CHANNEL_IV_LEN - CHANNEL_TAG_LEN;
+        offsets[i] = offset;
+        results[i] = RESULT_UNAUTHENTICATED;
+
+        if (!haveKey || keyId != record.sessionId) {
+            haveKey = sessionKey(record.sessionId, &key);
+            keyId = record.sessionId;
+        }
+        if (haveKey &&
+            sgx_rijndael128GCM_decrypt(
+                &key, record.sealed + CHANNEL_IV_LEN + CHANNEL_TAG_LEN, textLen,
+                reinterpret_cast<uint8_t*>(plaintext.data() + offset),
+                record.sealed, CHANNEL_IV_LEN,
+                reinterpret_cast<const uint8_t*>(&record.sessionId), sizeof(uint32_t),
+                reinterpret_cast<const sgx_aes_gcm_128bit_tag_t*>(record.sealed + CHANNEL_IV_LEN)
+            ) == SGX_SUCCESS) {
+            results[i] = RESULT_ERROR;
+        }
+        offset += textLen;
+    }
+    memset(key, 0, sizeof(key));
+
+    for (size_t i = 0; i < count; i++) {
+        if (results[i] == RESULT_UNAUTHENTICATED) continue;
+        const char* appJson = plaintext.data() + offsets[i];
+        size_t textLen = records[i].sealedLen - CHANNEL_IV_LEN - CHANNEL_TAG_LEN;
+        const char* userJson;
+        if (splitPlaintext(appJson, textLen, &userJson)) {
+            results[i] = evaluateCached(appJson, userJson, records[i].policyJson,
+                                        digests ? digests + i * INPUT_DIGEST_LEN : nullptr);
+        }
+    }
+    memset(plaintext.data(), 0, plaintext.size());
+    return (int)count;
+}
@@ -0,0 +1,37 @@
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+// ============================================================================
+// Encrypted Request Channel
+// ============================================================================
+//
+// Lets a client (gateway or device) send the app request and privacy
+// preference AES-128-GCM encrypted, so they are only ever plaintext inside
+// the enclave. The client opens a session with an ECDH exchange on P-256:
+// it sends its public key, the enclave answers with a fresh key pair's
+// public half and a session id, and both sides derive
+//
+//   key = SHA-256(CHANNEL_KEY_LABEL || shared x, little-endian)[0..16)
+//
+// The policy is not secret (the server loads it) and travels in plaintext.
+// Decisions are returned in plaintext as well.
+//
+// The exchange is not attested here: a client that must know it is talking
+// to this enclave should check its report before trusting the public key.
+//
+// Sealed request, as submitted by the client:
+//   iv[CHANNEL_IV_LEN] | tag[CHANNEL_TAG_LEN] | ciphertext of "app\0user\0"
+// with the session id (u32, little-endian) as additional authenticated data.
+//
+// ecall_evaluate_encrypted_batch input, per record:
+//   sessionId u32 | sealedLen u32 | sealed request | policyJson \0
+
+#define CHANNEL_KEY_LABEL "privacy-channel-v1"
+#define CHANNEL_KEY_LEN 16
+#define CHANNEL_IV_LEN 12
+#define CHANNEL_TAG_LEN 16
+#define CHANNEL_POINT_LEN 64        // gx | gy, 32 bytes each, little-endian
+// Open sessions; opening one more closes the oldest
+#define CHANNEL_MAX_SESSIONS 256
+
+#endif // CHANNEL_H
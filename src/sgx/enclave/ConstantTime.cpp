@@ -0,0 +1,212 @@
+#include "ConstantTime.h"
+#include "../core/Hash.h"
+#include <string.h>
+#include <map>
+
+// Padding that takes part in every comparison but never matches: a
+// preference pad contains no node, an app pad is contained by no interval
+#define PREF_PAD_LEFT INT32_MAX
+#define PREF_PAD_RIGHT INT32_MIN
+#define APP_PAD_LEFT INT32_MIN
+#define APP_PAD_RIGHT INT32_MAX
+
+// ============================================================================
+// Keys and Masks
+// ============================================================================
+
+CtKey makeCtKey(const std::string& id) {
+    CtKey key;
+    memset(key.words, 0, sizeof(key.words));
+    key.length = id.size();
+    if (id.size() <= sizeof(key.words)) {
+        memcpy(key.words, id.data(), id.size());
+    } else {
+        memcpy(key.words, id.data(), 2 * sizeof(uint64_t));
+        Hash128 hash = hash128(id.data(), id.size());
+        key.words[2] = hash.lo;
+        key.words[3] = hash.hi;
+    }
+    return key;
+}
+
+// All ones when the keys are equal, zero otherwise
+static inline uint32_t equalMask(const CtKey& a, const CtKey& b) {
+    uint64_t diff = a.length ^ b.length;
+    for (int w = 0; w < CT_KEY_WORDS; w++) diff |= a.words[w] ^ b.words[w];
+    return (uint32_t)(((diff | (0 - diff)) >> 63) - 1);
+}
+
+static inline int32_t select(uint32_t mask, int32_t ifSet, int32_t ifClear) {
+    return (int32_t)(((uint32_t)ifSet & mask) | ((uint32_t)ifClear & ~mask));
+}
+
+// ============================================================================
+// Padded Intervals
+// ============================================================================
+
+// Nested-set intervals padded to a multiple of CT_BLOCK, on the stack up to
+// CT_INLINE_ENTRIES
+class CtIntervals {
+public:
+    CtIntervals(size_t count, int32_t padLeft, int32_t padRight) {
+        padded_ = (count + CT_BLOCK - 1) / CT_BLOCK * CT_BLOCK;
+        left_ = inlineLeft_;
+        right_ = inlineRight_;
+        if (padded_ > CT_INLINE_ENTRIES) {
+            heapLeft_.resize(padded_);
+            heapRight_.resize(padded_);
+            left_ = heapLeft_.data();
+            right_ = heapRight_.data();
+        }
+        for (size_t i = 0; i < padded_; i++) {
+            left_[i] = padLeft;
+            right_[i] = padRight;
+        }
+    }
+
+    size_t padded() const { return padded_; }
+    int32_t* left() { return left_; }
+    int32_t* right() { return right_; }
+    const int32_t* left() const { return left_; }
+    const int32_t* right() const { return right_; }
+
+private:
+    CtIntervals(const CtIntervals&) = delete;
+    CtIntervals& operator=(const CtIntervals&) = delete;
+
+    size_t padded_;
+    int32_t* left_;
+    int32_t* right_;
+    int32_t inlineLeft_[CT_INLINE_ENTRIES];
+    int32_t inlineRight_[CT_INLINE_ENTRIES];
+    std::vector<int32_t> heapLeft_;
+    std::vector<int32_t> heapRight_;
+};
+
+static void fillAppIntervals(const std::vector<PolicyNode>& nodes, CtIntervals* out) {
+    for (size_t i = 0; i < nodes.size(); i++) {
+        out->left()[i] = nodes[i].left;
+        out->right()[i] = nodes[i].right;
+    }
+}
+
+// Each preference ID is compared with every policy entry, and a match
+// lands in the slot of that entry's copy, so every node with the ID counts. The
+// slot depends only on the policy. Unknown IDs and unused copies stay
+// padding, as they match nothing in evaluate().
+static void resolvePreference(const std::vector<std::string>& ids,
+                              const std::vector<CtKey>& keys,
+                              const std::vector<int32_t>& left,
+                              const std::vector<int32_t>& right,
+                              const std::vector<uint32_t>& copy,
+                              uint32_t copies,
+                              CtIntervals* out) {
+    int32_t* outLeft = out->left();
+    int32_t* outRight = out->right();
+    for (size_t j = 0; j < ids.size(); j++) {
+        CtKey key = makeCtKey(ids[j]);
+        size_t base = j * copies;
+        for (size_t n = 0; n < keys.size(); n++) {
+            uint32_t mask = equalMask(key, keys[n]);
+            size_t slot = base + copy[n];
+            outLeft[slot] = select(mask, left[n], outLeft[slot]);
+            outRight[slot] = select(mask, right[n], outRight[slot]);
+        }
+    }
+}
+
+// 1 if any preference interval contains any app node (isDescendant), over
+// every padded pair
+static uint32_t anyContains(const CtIntervals& prefs, const CtIntervals& app) {
+    const int32_t* appLeft = app.left();
+    const int32_t* appRight = app.right();
+    uint32_t hit = 0;
+    for (size_t j = 0; j < prefs.padded(); j++) {
+        int32_t l = prefs.left()[j];
+        int32_t r = prefs.right()[j];
+        for (size_t i = 0; i < app.padded(); i++) {
+            hit |= (uint32_t)(l <= appLeft[i]) & (uint32_t)(r >= appRight[i]);
+        }
+    }
+    return hit;
+}
+
+// ============================================================================
+// Evaluation
+// ============================================================================
+
+// One entry per interval of each node, numbering the entries that share an
+// ID 0, 1, ...; returns the most any ID has
+static uint32_t compileTree(const std::vector<PolicyNode>& nodes, std::vector<CtKey>* keys,
+                            std::vector<int32_t>* left, std::vector<int32_t>* right,
+                            std::vector<uint32_t>* copy) {
+    keys->clear();
+    left->clear();
+    right->clear();
+    copy->clear();
+    std::map<std::string, uint32_t> seen;
+    uint32_t copies = 1;
+    for (const PolicyNode& node : nodes) {
+        CtKey key = makeCtKey(node.id);
+        uint32_t& n = seen[node.id];
+        for (size_t i = 0; i <= node.intervals.size(); i++) {
+            keys->push_back(key);
+            left->push_back(i == 0 ? node.left : node.intervals[i - 1].left);
+            right->push_back(i == 0 ? node.right : node.intervals[i - 1].right);
+            copy->push_back(n++);
+        }
+        if (n > copies) copies = n;
+    }
+    return copies;
+}
+
+void compileConstantTime(const PolicyData& policy, CtPolicy* out) {
+    out->attributeCopies = compileTree(policy.attributes, &out->attributeKeys,
+                                       &out->attributeLeft, &out->attributeRight,
+                                       &out->attributeCopy);
+    out->purposeCopies = compileTree(policy.purposes, &out->purposeKeys, &out->purposeLeft,
+                                     &out->purposeRight, &out->purposeCopy);
+}
+
+EvaluationResult evaluateConstantTime(
+    const AppRequest& app,
+    const UserPreference& userPref,
+    const CtPolicy& policy
+) {
+    CtIntervals appAttributes(app.attributes.size(), APP_PAD_LEFT, APP_PAD_RIGHT);
+    CtIntervals appPurposes(app.purposes.size(), APP_PAD_LEFT, APP_PAD_RIGHT);
+    fillAppIntervals(app.attributes, &appAttributes);
+    fillAppIntervals(app.purposes, &appPurposes);
+
+    uint32_t attributeCopies = policy.attributeCopies;
+    uint32_t purposeCopies = policy.purposeCopies;
+    CtIntervals allowedAttributes(userPref.attributeIds.size() * attributeCopies,
+                                  PREF_PAD_LEFT, PREF_PAD_RIGHT);
+    CtIntervals exceptedAttributes(userPref.exceptionIds.size() * attributeCopies,
+                                   PREF_PAD_LEFT, PREF_PAD_RIGHT);
+    CtIntervals allowedPurposes(userPref.allowedPurposeIds.size() * purposeCopies,
+                                PREF_PAD_LEFT, PREF_PAD_RIGHT);
+    CtIntervals prohibitedPurposes(userPref.prohibitedPurposeIds.size() * purposeCopies,
+                                   PREF_PAD_LEFT, PREF_PAD_RIGHT);
+    resolvePreference(userPref.attributeIds, policy.attributeKeys, policy.attributeLeft,
+                      policy.attributeRight, policy.attributeCopy, attributeCopies,
+                      &allowedAttributes);
+    resolvePreference(userPref.exceptionIds, policy.attributeKeys, policy.attributeLeft,
+                      policy.attributeRight, policy.attributeCopy, attributeCopies,
+                      &exceptedAttributes);
+    resolvePreference(userPref.allowedPurposeIds, policy.purposeKeys, policy.purposeLeft,
+                      policy.purposeRight, policy.purposeCopy, purposeCopies,
+                      &allowedPurposes);
+    resolvePreference(userPref.prohibitedPurposeIds, policy.purposeKeys, policy.purposeLeft,
+                      policy.purposeRight, policy.purposeCopy, purposeCopies,
+                      &prohibitedPurposes);
+
+    // The except and deny checks of evaluate() both read the exception
+    // lists, so one pass covers both
+    uint32_t grant = anyContains(allowedAttributes, appAttributes);
+    grant &= anyContains(exceptedAttributes, appAttributes) ^ 1u;
+    grant &= anyContains(allowedPurposes, appPurposes);
+    grant &= anyContains(prohibitedPurposes, appPurposes) ^ 1u;
+    grant &= (uint32_t)(app.timeofRetention <= userPref.timeofRetention);
+    return (EvaluationResult)grant;
+}
@@ -0,0 +1,79 @@
+#ifndef CONSTANT_TIME_H
+#define CONSTANT_TIME_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "Enclave.h"
+
+// ============================================================================
+// Constant-Time Evaluation
+// ============================================================================
+//
+// Branch-free variant of evaluate(). evaluateAttributeType and
+// evaluatePurposeType return on the first match, so their running time
+// tells an observer of the enclave which preference entry matched. Here
+// every app node is tested against every preference interval with mask
+// arithmetic, over arrays padded to a multiple of CT_BLOCK entries. The
+// running time depends on the list lengths rounded up to CT_BLOCK and on
+// the policy, never on which entries match.
+//
+// Preference IDs are resolved to intervals by comparing them with every
+// policy node as fixed-width CtKeys rather than with std::string ==. An ID
+// that several nodes share (a subtree copied under several parents)
+// resolves to all of them, and a DAG node's further intervals count as
+// more copies of its ID: each preference entry gets one interval slot per
+// copy, as many as the most-copied ID in the policy has, so that count
+// enters the running time as a property of the policy. The decisions are
+// the same as evaluate(), including its use of the exception lists for the
+// deny checks.
+//
+// Enclave builds use this kernel for decision-cache misses when compiled
+// with CONSTANT_TIME_EVALUATION (CONSTANT_TIME=1 ./build.sh), so the mode
+// is part of the enclave measurement. A cache hit is still faster than a
+// miss. That reveals whether the same inputs were evaluated recently, but
+// not what they contained.
+
+#define CT_BLOCK 8
+#define CT_KEY_WORDS 4
+// Entries per list kept on the stack; longer lists use the heap
+#define CT_INLINE_ENTRIES 64
+
+// An ID as fixed-width words: the bytes themselves when they fit in
+// CT_KEY_WORDS words, else the first 16 bytes and a 128-bit hash of the ID
+struct CtKey {
+    uint64_t words[CT_KEY_WORDS];
+    uint64_t length;
+};
+
+CtKey makeCtKey(const std::string& id);
+
+// Policy intervals as keys and bounds, built once per compiled policy: one
+// entry per node, then one per further interval of a DAG node. An entry's
+// copy is how many earlier entries of its tree have the same ID; copies is
+// one more than the largest of them.
+struct CtPolicy {
+    std::vector<CtKey> attributeKeys;
+    std::vector<int32_t> attributeLeft;
+    std::vector<int32_t> attributeRight;
+    std::vector<uint32_t> attributeCopy;
+    uint32_t attributeCopies = 1;
+    std::vector<CtKey> purposeKeys;
+    std::vector<int32_t> purposeLeft;
+    std::vector<int32_t> purposeRight;
+    std::vector<uint32_t> purposeCopy;
+    uint32_t purposeCopies = 1;
+};
+
+void compileConstantTime(const PolicyData& policy, CtPolicy* out);
+
+// Same result as evaluate(app, user, policy) for the policy out was
+// compiled from: RESULT_GRANT or RESULT_DENY
+EvaluationResult evaluateConstantTime(
+    const AppRequest& app,
+    const UserPreference& userPref,
+    const CtPolicy& policy
+);
+
+#endif // CONSTANT_TIME_H
@@ -1,147 +1,70 @@
 #include "Enclave.h"
+#include "EnclaveCache.h"
 #include "PrivacyEvaluation_edl.h"
 #include "sgx_trts.h"
+#include <math.h>
 #include <string.h>
 #include <cstring>
-
-// Simple JSON parsing (without external library for SGX compatibility)
-// For production, consider using a SGX-compatible JSON library
-
-#define MAX_JSON_LEN 65536
-#define MAX_NODES 256
+#include <algorithm>
+#include <atomic>
 
 // ============================================================================
-// JSON Parsing Helpers (Minimal implementation for SGX)
+// Nested Set Model Helper
 // ============================================================================
 
-static char* findJsonStr(char* json, const char* key) {
-    char search[256];
-    snprintf(search, sizeof(search), "\"%s\"", key);
-    char* pos = strstr(json, search);
-    if (!pos) return NULL;
-    pos += strlen(search);
-    while (*pos == ' ' || *pos == ':') pos++;
-    return pos;
-}
-
-static int extractInt(char** pos) {
-    while (**pos == ' ' || **pos == ':' || **pos == ',') (*pos)++;
-    return atoi(*pos);
-}
-
-static void extractStr(char* pos, char* out, int maxLen) {
-    while (*pos == ' ' || *pos == ':' || *pos == ',' || *pos == '"') pos++;
-    if (*pos == '[') {
-        // Array - skip for now (handled separately)
-        out[0] = '\0';
-        return;
-    }
-    if (*pos == '"') {
-        pos++;
-        int i = 0;
-        while (*pos && *pos != '"' && i < maxLen - 1) {
-            out[i++] = *pos++;
-        }
-        out[i] = '\0';
-    }
-}
-
-static int extractStrArray(char* pos, char** arr, int maxCount) {
-    int count = 0;
-    while (*pos == ' ' || *pos == ':') pos++;
-    if (*pos != '[') return 0;
-    pos++; // skip '['
-
-    while (*pos && *pos != ']' && count < maxCount) {
-        while (*pos == ' ' || *pos == ',') pos++;
-        if (*pos == '"') {
-            pos++;
-            int len = 0;
-            char* start = pos;
-            while (*pos && *pos != '"' && *pos != ',') {
-                if (*pos == ']') break;
-                pos++;
-                len++;
-            }
-            if (len > 0) {
-                arr[count] = (char*)malloc(len + 1);
-                memcpy(arr[count], start, len);
-                arr[count][len] = '\0';
-                count++;
-            }
-            if (*pos == '"') pos++;
-        } else {
-            pos++;
-        }
+bool isDescendant(const PolicyNode& ancestor, const PolicyNode& descendant) {
+    // Node A is an ancestor of Node B if:
+    // A.left <= B.left AND A.right >= B.right
+    if ((ancestor.left <= descendant.left) && (ancestor.right >= descendant.right)) return true;
+    // Descendants A reaches through a parent other than its own
+    for (const PrefInterval& interval : ancestor.intervals) {
+        if (interval.left <= descendant.left && interval.right >= descendant.right) return true;
     }
-    return count;
+    return false;
 }
 
 // ============================================================================
-// JSON to Struct Parsers
+// Request Normalization
 // ============================================================================
 
-bool parseAppJson(const char* json, AppRequest& app) {
-    char buffer[MAX_JSON_LEN];
-    strncpy(buffer, json, MAX_JSON_LEN);
-
-    // Clear arrays
-    app.attributes.clear();
-    app.purposes.clear();
-    app.timeofRetention = 0;
-
-    // Parse timeofRetention
-    char* pos = findJsonStr(buffer, "timeofRetention");
-    if (pos) {
-        app.timeofRetention = extractInt(&pos);
+void minimizeAppNodes(std::vector<PolicyNode>* nodes) {
+    if (nodes->size() < 2) return;
+    // Intervals by left, of those sharing a left the widest first; the
+    // nodes themselves (two strings each) are only moved once, at the end
+    struct Bounds {
+        int left;
+        int right;
+        uint32_t index;
+    };
+    std::vector<Bounds> order(nodes->size());
+    for (size_t i = 0; i < nodes->size(); i++) {
+        order[i] = { (*nodes)[i].left, (*nodes)[i].right, (uint32_t)i };
     }
-
-    // For a production implementation, you would parse attributes/purposes arrays
-    // This is a simplified version - the actual implementation would need proper
-    // JSON parsing or use a SGX-compatible JSON library
-
-    return true;
-}
-
-bool parseUserJson(const char* json, UserPreference& user) {
-    char buffer[MAX_JSON_LEN];
-    strncpy(buffer, json, MAX_JSON_LEN);
-
-    // Clear arrays
-    user.attributeIds.clear();
-    user.exceptionIds.clear();
-    user.denyAttributeIds.clear();
-    user.allowedPurposeIds.clear();
-    user.prohibitedPurposeIds.clear();
-    user.denyPurposeIds.clear();
-    user.timeofRetention = 0;
-
-    // Parse timeofRetention
-    char* pos = findJsonStr(buffer, "timeofRetention");
-    if (pos) {
-        user.timeofRetention = extractInt(&pos);
+    std::sort(order.begin(), order.end(), [](const Bounds& a, const Bounds& b) {
+        return a.left != b.left ? a.left < b.left : a.right > b.right;
+    });
+    // From the right, a node goes if the last one kept lies under it. Kept
+    // nodes are disjoint, so no other kept node can be under it without
+    // that one being under it too.
+    size_t kept = order.size();
+    for (size_t i = order.size(); i-- > 0;) {
+        if (kept < order.size() && order[i].left <= order[kept].left &&
+            order[i].right >= order[kept].right) {
+            continue;
+        }
+        order[--kept] = order[i];
     }
-
-    // Parse attribute arrays (simplified - would need proper JSON parser)
-    // ...
-
-    return true;
-}
-
-bool parsePolicyJson(const char* json, PolicyData& policy) {
-    // Parse policy with attributes and purposes arrays
-    // Simplified - would need proper JSON parser for production
-    return true;
+    std::vector<PolicyNode> minimized;
+    minimized.reserve(order.size() - kept);
+    for (size_t i = kept; i < order.size(); i++) {
+        minimized.push_back(std::move((*nodes)[order[i].index]));
+    }
+    nodes->swap(minimized);
 }
 
-// ============================================================================
-// Nested Set Model Helper
-// ============================================================================
-
-bool isDescendant(const PolicyNode& ancestor, const PolicyNode& descendant) {
-    // Node A is an ancestor of Node B if:
-    // A.left <= B.left AND A.right >= B.right
-    return (ancestor.left <= descendant.left) && (ancestor.right >= descendant.right);
+void minimizeAppRequest(AppRequest* app) {
+    minimizeAppNodes(&app->attributes);
+    minimizeAppNodes(&app->purposes);
 }
 
 // ============================================================================
@@ -203,14 +126,17 @@ bool evaluateAttributes(
     const PolicyData& policy
 ) {
     // Port of src/helpers/privacy-preference.helper.js:38-73
-    // Check: allowed AND NOT excepted AND NOT denied
-
-    bool isAllowed = evaluateAttributeType(app, userPref, policy, "allow");
-    bool isExcepted = evaluateAttributeType(app, userPref, policy, "except");
-    bool isDeny = evaluateAttributeType(app, userPref, policy, "deny");
-
-    // Result: allowed AND NOT except AND NOT deny
-    return isAllowed && !isExcepted && !isDeny;
+    // Check: allowed AND NOT excepted AND NOT denied. The deny check reads
+    // the same list as the except check, so it is not repeated, and a
+    // failed allow check settles the result without either
+    if (useIntervalEvaluation(app.attributes.size(),
+                              userPref.attributeIds.size() + userPref.exceptionIds.size(),
+                              policy.attributes.size())) {
+        return evaluateTreeIntervals(app.attributes, userPref.attributeIds, userPref.exceptionIds,
+                                     policy.attributes);
+    }
+    return evaluateAttributeType(app, userPref, policy, "allow") &&
+           !evaluateAttributeType(app, userPref, policy, "except");
 }
 
 // ============================================================================
@@ -262,14 +188,152 @@ bool evaluatePurposes(
     const PolicyData& policy
 ) {
     // Port of src/helpers/privacy-preference.helper.js:138-173
-    // Check: allowed AND NOT excepted AND NOT denied
+    // Check: allowed AND NOT excepted AND NOT denied. The deny check reads
+    // the same list as the except check, so it is not repeated, and a
+    // failed allow check settles the result without either
+    size_t purposeIds = userPref.allowedPurposeIds.size() + userPref.prohibitedPurposeIds.size();
+    if (useIntervalEvaluation(app.purposes.size(), purposeIds, policy.purposes.size())) {
+        return evaluateTreeIntervals(app.purposes, userPref.allowedPurposeIds,
+                                     userPref.prohibitedPurposeIds, policy.purposes);
+    }
+    return evaluatePurposeType(app, userPref, policy, "allow") &&
+           !evaluatePurposeType(app, userPref, policy, "except");
+}
+
+// ============================================================================
+// Interval Evaluation
+// ============================================================================
+
+void sortIntervals(std::vector<PrefInterval>* intervals) {
+    std::sort(intervals->begin(), intervals->end(),
+              [](const PrefInterval& a, const PrefInterval& b) { return a.left < b.left; });
+    for (size_t i = 1; i < intervals->size(); i++) {
+        (*intervals)[i].right = std::max((*intervals)[i].right, (*intervals)[i - 1].right);
+    }
+}
+
+bool anyContainsSorted(const std::vector<PrefInterval>& intervals,
+                       const std::vector<PolicyNode>& appNodes) {
+    if (intervals.empty()) return false;
+    for (const PolicyNode& node : appNodes) {
+        auto it = std::upper_bound(intervals.begin(), intervals.end(), node.left,
+                                   [](int32_t left, const PrefInterval& interval) {
+                                       return left < interval.left;
+                                   });
+        if (it != intervals.begin() && (it - 1)->right >= node.right) return true;
+    }
+    return false;
+}
+
+// Intervals of the policy nodes named in ids, from one scan of the policy
+static void resolveIntervals(const std::vector<std::string>& ids,
+                             const std::vector<PolicyNode>& policyNodes,
+                             std::vector<PrefInterval>* out) {
+    out->clear();
+    if (ids.empty()) return;
+    for (const PolicyNode& node : policyNodes) {
+        for (const std::string& id : ids) {
+            if (node.id == id) {
+                out->push_back({ node.left, node.right });
+                out->insert(out->end(), node.intervals.begin(), node.intervals.end());
+                break;
+            }
+        }
+    }
+    sortIntervals(out);
+}
+
+bool evaluateTreeIntervals(
+    const std::vector<PolicyNode>& appNodes,
+    const std::vector<std::string>& allowIds,
+    const std::vector<std::string>& exceptIds,
+    const std::vector<PolicyNode>& policyNodes
+) {
+    std::vector<PrefInterval> intervals;
+    resolveIntervals(allowIds, policyNodes, &intervals);
+    if (!anyContainsSorted(intervals, appNodes)) return false;
+    resolveIntervals(exceptIds, policyNodes, &intervals);
+    return !anyContainsSorted(intervals, appNodes);
+}
+
+// ============================================================================
+// Stage Counters
+// ============================================================================
+
+// Each thread counts locally and adds its counts to the shared totals every
+// STAGE_FLUSH_INTERVAL evaluations, then refreshes its deny rates from them
+#define STAGE_FLUSH_INTERVAL 64
+
+static std::atomic<uint64_t> stageRuns[STAGE_COUNT];
+static std::atomic<uint64_t> stageDenies[STAGE_COUNT];
+static std::atomic<uint64_t> stageGrants;
+static std::atomic<uint64_t> stagePurposesFirst;
+
+struct StageTally {
+    uint32_t runs[STAGE_COUNT];
+    uint32_t denies[STAGE_COUNT];
+    uint32_t grants;
+    uint32_t purposesFirst;
+    uint32_t evaluations;
+    // Deny rates of the tree stages as of the last flush
+    double attributeDenyRate;
+    double purposeDenyRate;
+};
+
+static thread_local StageTally stageTally = { {0}, {0}, 0, 0, 0, 0.5, 0.5 };
+
+// Share of runs that denied, with one deny and one pass assumed up front
+// so an unseen stage starts at 0.5
+static double stageDenyRate(int stage) {
+    double runs = (double)stageRuns[stage].load(std::memory_order_relaxed);
+    double denies = (double)stageDenies[stage].load(std::memory_order_relaxed);
+    return (denies + 1.0) / (runs + 2.0);
+}
+
+static void flushStageTally(StageTally* tally) {
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        stageRuns[s].fetch_add(tally->runs[s], std::memory_order_relaxed);
+        stageDenies[s].fetch_add(tally->denies[s], std::memory_order_relaxed);
+        tally->runs[s] = 0;
+        tally->denies[s] = 0;
+    }
+    stageGrants.fetch_add(tally->grants, std::memory_order_relaxed);
+    stagePurposesFirst.fetch_add(tally->purposesFirst, std::memory_order_relaxed);
+    tally->grants = 0;
+    tally->purposesFirst = 0;
+    tally->evaluations = 0;
+    tally->attributeDenyRate = stageDenyRate(STAGE_ATTRIBUTES);
+    tally->purposeDenyRate = stageDenyRate(STAGE_PURPOSES);
+}
+
+void evaluationStageCounts(EvaluationStageCounts* out) {
+    flushStageTally(&stageTally);
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        out->runs[s] = stageRuns[s].load(std::memory_order_relaxed);
+        out->denies[s] = stageDenies[s].load(std::memory_order_relaxed);
+    }
+    out->grants = stageGrants.load(std::memory_order_relaxed);
+    out->purposesFirst = stagePurposesFirst.load(std::memory_order_relaxed);
+}
 
-    bool isAllowed = evaluatePurposeType(app, userPref, policy, "allow");
-    bool isExcepted = evaluatePurposeType(app, userPref, policy, "except");
-    bool isDeny = evaluatePurposeType(app, userPref, policy, "deny");
+void resetEvaluationStageCounts() {
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        stageRuns[s].store(0, std::memory_order_relaxed);
+        stageDenies[s].store(0, std::memory_order_relaxed);
+    }
+    stageGrants.store(0, std::memory_order_relaxed);
+    stagePurposesFirst.store(0, std::memory_order_relaxed);
+}
 
-    // Result: allowed AND NOT except AND NOT deny
-    return isAllowed && !isExcepted && !isDeny;
+// Upper bound on the node comparisons of a tree stage: every app node
+// against every policy node of every allowed and excepted ID, or with the
+// interval path, one pass over the policy per ID plus a search per app node
+static double stageCost(size_t appNodes, size_t allowIds, size_t exceptIds, size_t policyNodes) {
+    double ids = (double)(allowIds + exceptIds);
+    if (useIntervalEvaluation(appNodes, allowIds + exceptIds, policyNodes)) {
+        return ids * (double)policyNodes + (double)appNodes * log2(ids + 2.0) + 1.0;
+    }
+    return (double)appNodes * ids * (double)policyNodes + 1.0;
 }
 
 // ============================================================================
@@ -282,52 +346,77 @@ EvaluationResult evaluate(
     const PolicyData& policy
 ) {
     // Port of src/helpers/privacy-preference.helper.js:4-30
-    // All three checks must pass
+    // All three checks must pass, so the first failing one settles a deny.
+    // Retention is a single comparison and goes first. Of the tree checks,
+    // the one with the lower expected cost per deny (comparisons over its
+    // observed deny rate) goes next.
+    StageTally& tally = stageTally;
+    EvaluationResult result = RESULT_GRANT;
+
+    tally.runs[STAGE_RETENTION]++;
+    if (!evaluateTimeofRetention(app, userPref)) {
+        tally.denies[STAGE_RETENTION]++;
+        result = RESULT_DENY;
+    } else {
+        double attributeCost = stageCost(app.attributes.size(), userPref.attributeIds.size(),
+                                         userPref.exceptionIds.size(), policy.attributes.size());
+        double purposeCost = stageCost(app.purposes.size(), userPref.allowedPurposeIds.size(),
+                                       userPref.prohibitedPurposeIds.size(), policy.purposes.size());
+        bool purposesFirst =
+            purposeCost * tally.attributeDenyRate < attributeCost * tally.purposeDenyRate;
+        if (purposesFirst) tally.purposesFirst++;
+
+        EvaluationStage order[2] = { STAGE_ATTRIBUTES, STAGE_PURPOSES };
+        if (purposesFirst) {
+            order[0] = STAGE_PURPOSES;
+            order[1] = STAGE_ATTRIBUTES;
+        }
+        for (EvaluationStage stage : order) {
+            tally.runs[stage]++;
+            bool accepted = stage == STAGE_ATTRIBUTES ? evaluateAttributes(app, userPref, policy)
+                                                      : evaluatePurposes(app, userPref, policy);
+            if (!accepted) {
+                tally.denies[stage]++;
+                result = RESULT_DENY;
+                break;
+            }
+        }
+        if (result == RESULT_GRANT) tally.grants++;
+    }
 
-    bool isAcceptedAttrs = evaluateAttributes(app, userPref, policy);
-    bool isAcceptedPurposes = evaluatePurposes(app, userPref, policy);
-    bool isTimeofRetention = evaluateTimeofRetention(app, userPref);
+    if (++tally.evaluations == STAGE_FLUSH_INTERVAL) flushStageTally(&tally);
+    return result;
+}
 
-    // Return grant only if all checks pass
-    if (isAcceptedAttrs && isAcceptedPurposes && isTimeofRetention) {
-        return RESULT_GRANT;
-    }
-    return RESULT_DENY;
+uint32_t evaluateReasons(
+    const AppRequest& app,
+    const UserPreference& userPref,
+    const PolicyData& policy
+) {
+    // Same checks as evaluate(), kept individually for audit exports
+    uint32_t reasons = 0;
+    if (evaluateAttributeType(app, userPref, policy, "allow")) reasons |= REASON_ATTR_ALLOWED;
+    if (evaluateAttributeType(app, userPref, policy, "except")) reasons |= REASON_ATTR_EXCEPTED;
+    if (evaluatePurposeType(app, userPref, policy, "allow")) reasons |= REASON_PURPOSE_ALLOWED;
+    if (evaluatePurposeType(app, userPref, policy, "except")) reasons |= REASON_PURPOSE_PROHIBITED;
+    if (evaluateTimeofRetention(app, userPref)) reasons |= REASON_RETENTION_OK;
+    return reasons;
 }
 
 // ============================================================================
-// ECALL Entry Point
+// Request Evaluation (shared by the single and batch ECALLs)
 // ============================================================================
 
-int ecall_evaluate_privacy(
+int evaluate_privacy(
     const char* appJson,
     const char* userJson,
     const char* policyJson,
     char* result,
     size_t resultLen
 ) {
-    // Parse JSON inputs
-    AppRequest app;
-    UserPreference user;
-    PolicyData policy;
-
-    if (!parseAppJson(appJson, app)) {
-        strncpy(result, "error", resultLen);
-        return RESULT_ERROR;
-    }
-
-    if (!parseUserJson(userJson, user)) {
-        strncpy(result, "error", resultLen);
-        return RESULT_ERROR;
-    }
-
-    if (!parsePolicyJson(policyJson, policy)) {
-        strncpy(result, "error", resultLen);
-        return RESULT_ERROR;
-    }
-
-    // Perform evaluation
-    EvaluationResult evalResult = evaluate(app, user, policy);
+    // Compiled policies and recent decisions are reused across calls
+    // (EnclaveCache.cpp); misses parse and evaluate as before
+    int evalResult = evaluateCached(appJson, userJson, policyJson);
 
     // Set result string
     if (evalResult == RESULT_GRANT) {
@@ -340,3 +429,69 @@ int ecall_evaluate_privacy(
 
     return evalResult;
 }
+
+// ============================================================================
+// ECALL Entry Points
+// ============================================================================
+
+int ecall_evaluate_privacy(
+    const char* appJson,
+    const char* userJson,
+    const char* policyJson,
+    char* result,
+    size_t resultLen
+) {
+    return evaluate_privacy(appJson, userJson, policyJson, result, resultLen);
+}
+
+// Stage counters of evaluate() as STAGE_COUNTER_WORDS words in the layout of
+// EvaluationStageCounts, reset after reading when reset is non-zero
+int ecall_evaluation_stages(uint64_t* counts, size_t len, int reset) {
+    if (!counts || len != STAGE_COUNTER_WORDS) return RESULT_ERROR;
+    EvaluationStageCounts snapshot;
+    evaluationStageCounts(&snapshot);
+    memcpy(counts, &snapshot, sizeof(snapshot));
+    if (reset) resetEvaluationStageCounts();
+    return 0;
+}
+
+// Batch entry point used by the untrusted dispatcher (app/Dispatcher.cpp).
+// The input buffer holds `count` records of three NUL-terminated strings
+// (app, user preference, policy) back to back. One transition covers the
+// whole batch; results[i] receives the EvaluationResult of record i and,
+// when digests is given, digests[i * INPUT_DIGEST_LEN] its input digest.
+int ecall_evaluate_privacy_batch(
+    const char* input,
+    size_t inputLen,
+    size_t count,
+    int* results,
+    uint8_t* digests,
+    size_t digestsLen
+) {
+    if (!input || !results || inputLen == 0 || input[inputLen - 1] != '\0' ||
+        (digests && digestsLen != count * INPUT_DIGEST_LEN)) {
+        return RESULT_ERROR;
+    }
+
+    const char* pos = input;
+    const char* end = input + inputLen;
+    size_t evaluated = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        const char* fields[3];
+        for (int f = 0; f < 3; f++) {
+            if (pos >= end) {
+                // Truncated batch: fail the remaining records
+                for (size_t j = i; j < count; j++) results[j] = RESULT_ERROR;
+                return (int)evaluated;
+            }
+            fields[f] = pos;
+            pos += strnlen(pos, (size_t)(end - pos)) + 1;
+        }
+        results[i] = evaluateCached(fields[0], fields[1], fields[2],
+                                    digests ? digests + i * INPUT_DIGEST_LEN : nullptr);
+        evaluated++;
+    }
+
+    return (int)evaluated;
+}
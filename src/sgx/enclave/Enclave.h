@@ -7,12 +7,23 @@
 #include <vector>
 #include <map>
 
-// Policy node structure for nested set model
+// One [left, right] range of the numbering
+struct PrefInterval {
+    int32_t left;
+    int32_t right;
+};
+
+// Policy node structure for nested set model. A node with several parents
+// (a DAG-shaped hierarchy, labeled by tools/policy-labeler) keeps in
+// intervals the merged ranges of the descendants it reaches outside
+// [left, right]; its own [left, right] still holds each descendant's, so
+// only the ancestor side of a check reads them. Tree nodes leave it empty.
 struct PolicyNode {
     std::string id;
     std::string name;
     int left;
     int right;
+    std::vector<PrefInterval> intervals;
 };
 
 // App request data
@@ -45,9 +56,55 @@ struct PolicyData {
 enum EvaluationResult {
     RESULT_GRANT = 1,
     RESULT_DENY = 0,
-    RESULT_ERROR = -1
+    RESULT_ERROR = -1,
+    // Set by the untrusted dispatcher, never returned by the enclave
+    RESULT_OVERLOAD = -2,   // refused by admission control
+    RESULT_EXPIRED = -3,    // deadline passed before the ECALL
+    // Encrypted requests only (enclave/Channel.cpp)
+    RESULT_UNAUTHENTICATED = -4   // unknown session or GCM tag mismatch
+};
+
+// Outcome of each check behind a decision (evaluateReasons). The "deny"
+// checks read the except/prohibited lists, so they have no bits of their own.
+enum ReasonBit {
+    REASON_ATTR_ALLOWED = 1 << 0,
+    REASON_ATTR_EXCEPTED = 1 << 1,
+    REASON_PURPOSE_ALLOWED = 1 << 2,
+    REASON_PURPOSE_PROHIBITED = 1 << 3,
+    REASON_RETENTION_OK = 1 << 4
+};
+
+#define REASON_GRANT_MASK (REASON_ATTR_ALLOWED | REASON_PURPOSE_ALLOWED | REASON_RETENTION_OK)
+
+// Grant requires every allow check and no except check
+inline bool reasonsGrant(uint32_t reasons) {
+    return (reasons & 0x1F) == REASON_GRANT_MASK;
+}
+
+// Stages of evaluate(). Retention is checked first; attributes and purposes
+// follow in the order expected to reach a deny soonest (Enclave.cpp)
+enum EvaluationStage {
+    STAGE_RETENTION = 0,
+    STAGE_ATTRIBUTES = 1,
+    STAGE_PURPOSES = 2,
+    STAGE_COUNT = 3
+};
+
+// Process-wide counters of evaluate(), read by ecall_evaluation_stages
+struct EvaluationStageCounts {
+    uint64_t runs[STAGE_COUNT];     // times the stage was checked
+    uint64_t denies[STAGE_COUNT];   // times it settled the decision as deny
+    uint64_t grants;                // decisions that passed every stage
+    uint64_t purposesFirst;         // decisions that checked purposes before attributes
 };
 
+#define STAGE_COUNTER_WORDS (sizeof(EvaluationStageCounts) / sizeof(uint64_t))
+
+// Counts other threads have not flushed yet (at most 64 evaluations each)
+// are missing from the snapshot
+void evaluationStageCounts(EvaluationStageCounts* out);
+void resetEvaluationStageCounts();
+
 // Enclave functions
 int evaluate_privacy(
     const char* appJson,
@@ -58,12 +115,20 @@ int evaluate_privacy(
 );
 
 // Core evaluation functions (ported from privacy-preference.helper.js)
+// evaluate() stops at the first failing stage and updates the stage counters
 EvaluationResult evaluate(
     const AppRequest& app,
     const UserPreference& userPref,
     const PolicyData& policy
 );
 
+// Runs every check of evaluate() and reports each outcome as a ReasonBit
+uint32_t evaluateReasons(
+    const AppRequest& app,
+    const UserPreference& userPref,
+    const PolicyData& policy
+);
+
 bool evaluateAttributes(
     const AppRequest& app,
     const UserPreference& userPref,
@@ -95,12 +160,50 @@ bool evaluateTimeofRetention(
     const UserPreference& userPref
 );
 
-// Nested set model helper
+// Nested set model helper; also true when descendant lies inside one of
+// ancestor's further intervals
 bool isDescendant(const PolicyNode& ancestor, const PolicyNode& descendant);
 
-// JSON parsing helpers
-bool parseAppJson(const char* json, AppRequest& app);
-bool parseUserJson(const char* json, UserPreference& user);
-bool parsePolicyJson(const char* json, PolicyData& policy);
+// Request normalization. Each tree check asks whether any app node lies
+// under a preference node, and a node that does has its descendants there
+// too, so a node listed with one of its own descendants adds nothing.
+// minimizeAppNodes keeps only the deepest nodes of a tree, one of each,
+// ordered by left: { Contact, Email, Phone } becomes { Email, Phone }, and
+// every evaluator returns the same decision for the minimized request.
+// (Keeping Contact instead would deny a user who allows only Email.)
+void minimizeAppNodes(std::vector<PolicyNode>* nodes);
+void minimizeAppRequest(AppRequest* app);
+
+// Interval check for app requests with many nodes in one tree. The checks
+// above resolve the preference IDs against the policy again for every app
+// node. When a tree has at least INTERVAL_MIN_APP_NODES requested nodes and
+// each of them costs at least INTERVAL_MIN_NODE_SCAN comparisons
+// (preference IDs x policy nodes), evaluateAttributes() and
+// evaluatePurposes() instead resolve the allowed and excepted IDs to
+// intervals once, sort them by left, and binary-search each app node.
+#define INTERVAL_MIN_APP_NODES 4
+#define INTERVAL_MIN_NODE_SCAN 256
+
+inline bool useIntervalEvaluation(size_t appNodes, size_t preferenceIds, size_t policyNodes) {
+    return appNodes >= INTERVAL_MIN_APP_NODES &&
+           preferenceIds * policyNodes >= INTERVAL_MIN_NODE_SCAN;
+}
+
+// Sorts by left and raises each right to the running maximum, so a node is
+// inside one of the intervals exactly when the last one starting at or
+// before it reaches its right
+void sortIntervals(std::vector<PrefInterval>* intervals);
+
+// Whether any app node lies inside one of intervals (sortIntervals)
+bool anyContainsSorted(const std::vector<PrefInterval>& intervals,
+                       const std::vector<PolicyNode>& appNodes);
+
+// Allowed and not excepted, for one tree, through sorted intervals
+bool evaluateTreeIntervals(
+    const std::vector<PolicyNode>& appNodes,
+    const std::vector<std::string>& allowIds,
+    const std::vector<std::string>& exceptIds,
+    const std::vector<PolicyNode>& policyNodes
+);
 
 #endif // ENCLAVE_H
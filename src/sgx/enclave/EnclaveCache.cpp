@@ -0,0 +1,717 @@
+#include "EnclaveCache.h"
+#include "ConstantTime.h"
+#include "EvaluationPlanner.h"
+#include "PolicyLayout.h"
+#include "PreferenceTable.h"
+#include "../core/EvaluationInput.h"
+#include "../core/Hash.h"
+#include "../core/Json.h"
+#ifdef SPECIALIZED_POLICY
+#include "../core/GeneratedPolicy.h"
+#endif
+#include <string.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#ifdef ENCLAVE_CODE
+#include "sgx_tcrypto.h"
+#include "sgx_trts.h"
+#else
+#include <random>
+#endif
+
+// Decision sets are locked in stripes
+#define CACHE_LOCKS 64
+#define CACHE_SETS (ENCLAVE_CACHE_ENTRIES / ENCLAVE_CACHE_WAYS)
+// Input digests of requests up to this size are hashed from the stack
+#define DIGEST_STACK_BYTES 2048
+// Preference profiles tracked for compiled tables (direct-mapped)
+#define PROFILE_SLOTS 4096
+// App requests kept parsed and minimized (direct-mapped)
+#define APP_SLOTS 4096
+
+struct CachedDecision {
+    uint64_t keyLo;
+    uint64_t keyHi;
+    int8_t code;
+    bool used;
+};
+
+struct CompiledPolicy {
+    Hash128 key;
+    std::shared_ptr<const PolicyIndex> index;        // resolves app IDs
+    std::shared_ptr<const PolicyData> policy;        // index->policy()
+    std::shared_ptr<const CtPolicy> constantTime;   // CONSTANT_TIME_EVALUATION only
+    std::shared_ptr<const PolicyOrdinals> ordinals;  // PREFERENCE_TABLES only
+    std::shared_ptr<const PolicyLayout> layout;      // POLICY_LAYOUT only: index->layout()
+    bool specialized;                     // is the SPECIALIZED_POLICY snapshot
+    uint64_t lastUse;
+    bool hasDigest;
+    uint8_t digest[INPUT_DIGEST_LEN];     // SHA-256 of the policy text
+};
+
+static CachedDecision decisions[ENCLAVE_CACHE_ENTRIES];
+static uint8_t victims[CACHE_SETS];
+static std::mutex decisionLocks[CACHE_LOCKS];
+
+// A user JSON under one policy; its table is built once the planner
+// expects enough further misses to pay for it
+struct PreferenceProfile {
+    Hash128 key;
+    uint32_t misses;
+    std::shared_ptr<const CompiledPreference> table;
+};
+
+static PreferenceProfile profiles[PROFILE_SLOTS];
+static std::mutex profileLocks[CACHE_LOCKS];
+
+// An app JSON under one policy, minimized (minimizeAppRequest), and the
+// key of what evaluation reads from it
+struct AppProfile {
+    Hash128 key;
+    Hash128 canonical;
+    std::shared_ptr<const AppRequest> app;
+};
+
+static AppProfile apps[APP_SLOTS];
+static std::mutex appLocks[CACHE_LOCKS];
+
+static std::vector<CompiledPolicy> policies;
+static uint64_t policyClock = 0;
+static std::mutex policyLock;
+
+// ============================================================================
+// Cache Key Secret
+// ============================================================================
+//
+// Every cache key below is a keyedHash128 under this secret, so untrusted
+// inputs cannot be crafted to collide with another request's key and be
+// handed its decision. Drawn inside the enclave on first use and carried in
+// the sealed snapshot, so restored entries still resolve.
+
+static std::atomic<uint64_t> secretLo(0);
+static std::atomic<uint64_t> secretHi(0);
+static std::atomic<bool> secretReady(false);
+static std::mutex secretLock;
+
+static bool randomSecret(Hash128* out) {
+#ifdef ENCLAVE_CODE
+    return sgx_read_rand(reinterpret_cast<unsigned char*>(out), sizeof(*out)) == SGX_SUCCESS;
+#else
+    std::random_device device;
+    out->lo = ((uint64_t)device() << 32) | device();
+    out->hi = ((uint64_t)device() << 32) | device();
+    return true;
+#endif
+}
+
+static void installSecretLocked(const Hash128& secret) {
+    secretLo.store(secret.lo, std::memory_order_relaxed);
+    secretHi.store(secret.hi, std::memory_order_relaxed);
+    secretReady.store(true, std::memory_order_release);
+}
+
+// False only if the enclave could not draw random bytes
+static bool cacheSecret(Hash128* out) {
+    if (!secretReady.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(secretLock);
+        if (!secretReady.load(std::memory_order_relaxed)) {
+            Hash128 secret;
+            if (!randomSecret(&secret)) return false;
+            installSecretLocked(secret);
+        }
+    }
+    out->lo = secretLo.load(std::memory_order_relaxed);
+    out->hi = secretHi.load(std::memory_order_relaxed);
+    return true;
+}
+
+// ============================================================================
+// Decision Table
+// ============================================================================
+
+static bool lookupDecision(const Hash128& key, int8_t* code) {
+    size_t set = (size_t)key.lo & (CACHE_SETS - 1);
+    std::lock_guard<std::mutex> lock(decisionLocks[set % CACHE_LOCKS]);
+    CachedDecision* ways = &decisions[set * ENCLAVE_CACHE_WAYS];
+    for (int w = 0; w < ENCLAVE_CACHE_WAYS; w++) {
+        if (ways[w].used && ways[w].keyLo == key.lo && ways[w].keyHi == key.hi) {
+            *code = ways[w].code;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void storeDecision(const Hash128& key, int8_t code) {
+    size_t set = (size_t)key.lo & (CACHE_SETS - 1);
+    std::lock_guard<std::mutex> lock(decisionLocks[set % CACHE_LOCKS]);
+    CachedDecision* ways = &decisions[set * ENCLAVE_CACHE_WAYS];
+    int target = -1;
+    for (int w = 0; w < ENCLAVE_CACHE_WAYS && target < 0; w++) {
+        if (!ways[w].used || (ways[w].keyLo == key.lo && ways[w].keyHi == key.hi)) target = w;
+    }
+    if (target < 0) {
+        target = victims[set];
+        victims[set] = (uint8_t)((target + 1) % ENCLAVE_CACHE_WAYS);
+    }
+    ways[target].keyLo = key.lo;
+    ways[target].keyHi = key.hi;
+    ways[target].code = code;
+    ways[target].used = true;
+}
+
+// ============================================================================
+// Request Parsing
+// ============================================================================
+//
+// The same readers as the native tools (core/EvaluationInput.h). App
+// entries name policy nodes by ID and are resolved through the compiled
+// policy's index.
+
+static bool parseDocument(const char* text, JsonValue* out) {
+    return parseJson(text, text + strlen(text), out);
+}
+
+static bool parsePolicy(const char* policyJson, PolicyIndex* index) {
+    JsonValue json;
+    std::string error;
+    return parseDocument(policyJson, &json) && index->load(json, &error);
+}
+
+static bool parseApp(const char* appJson, const PolicyIndex& index, AppRequest* app) {
+    JsonValue json;
+    std::string error;
+    return parseDocument(appJson, &json) && appRequestFromJson(json, index, app, &error);
+}
+
+static bool parseUser(const char* userJson, UserPreference* user) {
+    JsonValue json;
+    std::string error;
+    return parseDocument(userJson, &json) && userPreferenceFromJson(json, user, &error);
+}
+
+// ============================================================================
+// Compiled Policies
+// ============================================================================
+
+// Least recently used policy goes when the table is full
+static void installPolicyLocked(const Hash128& key, std::shared_ptr<const PolicyIndex> index) {
+    if (policies.size() >= ENCLAVE_MAX_POLICIES) {
+        size_t oldest = 0;
+        for (size_t i = 1; i < policies.size(); i++) {
+            if (policies[i].lastUse < policies[oldest].lastUse) oldest = i;
+        }
+        policies.erase(policies.begin() + oldest);
+    }
+    CompiledPolicy entry;
+    entry.key = key;
+    entry.index = index;
+    entry.policy = std::shared_ptr<const PolicyData>(index, &index->policy());
+#ifdef CONSTANT_TIME_EVALUATION
+    std::shared_ptr<CtPolicy> constantTime(new CtPolicy());
+    compileConstantTime(*entry.policy, constantTime.get());
+    entry.constantTime = constantTime;
+#endif
+#if defined(PREFERENCE_TABLES) && !defined(CONSTANT_TIME_EVALUATION)
+    std::shared_ptr<PolicyOrdinals> ordinals(new PolicyOrdinals());
+    compilePolicyOrdinals(*entry.policy, ordinals.get());
+    entry.ordinals = ordinals;
+#endif
+#if defined(POLICY_LAYOUT) && !defined(CONSTANT_TIME_EVALUATION)
+    entry.layout = std::shared_ptr<const PolicyLayout>(index, &index->layout());
+#endif
+#ifdef SPECIALIZED_POLICY
+    entry.specialized = SpecializedEvaluator<GeneratedPolicy>::matches(*entry.policy);
+#else
+    entry.specialized = false;
+#endif
+    entry.lastUse = ++policyClock;
+    entry.hasDigest = false;
+    policies.push_back(entry);
+}
+
+// Fills *out with the policy's cache entry; false if the JSON does not parse
+static bool compiledPolicy(const Hash128& key, const char* policyJson, CompiledPolicy* out) {
+    {
+        std::lock_guard<std::mutex> lock(policyLock);
+        for (CompiledPolicy& entry : policies) {
+            if (entry.key == key) {
+                entry.lastUse = ++policyClock;
+                *out = entry;
+                return true;
+            }
+        }
+    }
+
+    // Parse outside the lock; a concurrent compile of the same policy only
+    // costs a duplicate parse
+    std::shared_ptr<PolicyIndex> index(new PolicyIndex());
+    if (!parsePolicy(policyJson, index.get())) return false;
+
+    std::lock_guard<std::mutex> lock(policyLock);
+    for (CompiledPolicy& entry : policies) {
+        if (entry.key == key) {
+            *out = entry;
+            return true;
+        }
+    }
+    installPolicyLocked(key, index);
+    *out = policies.back();
+    return true;
+}
+
+// ============================================================================
+// Preference Tables
+// ============================================================================
+
+#if defined(PREFERENCE_TABLES) && !defined(CONSTANT_TIME_EVALUATION)
+// Counts a miss of the profile and returns its table, if one was built;
+// *misses receives the profile's misses so far, this one included
+static std::shared_ptr<const CompiledPreference> profileTable(const Hash128& key,
+                                                              uint32_t* misses) {
+    size_t slot = (size_t)key.lo & (PROFILE_SLOTS - 1);
+    std::lock_guard<std::mutex> lock(profileLocks[slot % CACHE_LOCKS]);
+    PreferenceProfile& profile = profiles[slot];
+    if (profile.key != key) {
+        profile.key = key;
+        profile.misses = 0;
+        profile.table.reset();
+    }
+    *misses = ++profile.misses;
+    return profile.table;
+}
+
+static void storeProfileTable(const Hash128& key, std::shared_ptr<const CompiledPreference> table) {
+    size_t slot = (size_t)key.lo & (PROFILE_SLOTS - 1);
+    std::lock_guard<std::mutex> lock(profileLocks[slot % CACHE_LOCKS]);
+    if (profiles[slot].key == key) profiles[slot].table = table;
+}
+#endif
+
+// ============================================================================
+// Minimized App Requests
+// ============================================================================
+
+// Retention and the node intervals, in order. Apps that minimize to the
+// same nodes get the same key, whatever redundant nodes their JSON lists.
+static Hash128 canonicalAppKey(const AppRequest& app, const Hash128& secret) {
+    std::vector<int32_t> words;
+    words.reserve(3 + 2 * (app.attributes.size() + app.purposes.size()));
+    words.push_back(app.timeofRetention);
+    words.push_back((int32_t)app.attributes.size());
+    for (const PolicyNode& node : app.attributes) {
+        words.push_back(node.left);
+        words.push_back(node.right);
+    }
+    words.push_back((int32_t)app.purposes.size());
+    for (const PolicyNode& node : app.purposes) {
+        words.push_back(node.left);
+        words.push_back(node.right);
+    }
+    return keyedHash128(words.data(), words.size() * sizeof(int32_t), secret);
+}
+
+// The app's minimized request, parsed on first sight; false if the JSON
+// does not parse or names a node the policy does not have. key covers the
+// policy, so a cached app was resolved through the same index.
+static bool minimizedApp(const Hash128& key, const Hash128& secret, const char* appJson,
+                         const PolicyIndex& index, std::shared_ptr<const AppRequest>* app,
+                         Hash128* canonical) {
+    size_t slot = (size_t)key.lo & (APP_SLOTS - 1);
+    {
+        std::lock_guard<std::mutex> lock(appLocks[slot % CACHE_LOCKS]);
+        if (apps[slot].app && apps[slot].key == key) {
+            *app = apps[slot].app;
+            *canonical = apps[slot].canonical;
+            return true;
+        }
+    }
+
+    std::shared_ptr<AppRequest> parsed(new AppRequest());
+    if (!parseApp(appJson, index, parsed.get())) return false;
+    minimizeAppRequest(parsed.get());
+    *app = parsed;
+    *canonical = canonicalAppKey(*parsed, secret);
+
+    std::lock_guard<std::mutex> lock(appLocks[slot % CACHE_LOCKS]);
+    apps[slot].key = key;
+    apps[slot].canonical = *canonical;
+    apps[slot].app = *app;
+    return true;
+}
+
+// ============================================================================
+// Input Digest
+// ============================================================================
+
+// Uses the SDK's SHA-256, which runs on the SHA extensions where the CPU has
+// them; untrusted builds of this file report no digest
+static bool sha256(const uint8_t* data, size_t length, uint8_t* out) {
+#ifdef ENCLAVE_CODE
+    return sgx_sha256_msg(data, (uint32_t)length,
+                          reinterpret_cast<sgx_sha256_hash_t*>(out)) == SGX_SUCCESS;
+#else
+    (void)data;
+    (void)length;
+    (void)out;
+    return false;
+#endif
+}
+
+// SHA-256 of the policy text, kept with the compiled policy
+static bool policyDigest(const Hash128& key, const char* policyJson, uint8_t* out) {
+    {
+        std::lock_guard<std::mutex> lock(policyLock);
+        for (const CompiledPolicy& entry : policies) {
+            if (entry.key == key && entry.hasDigest) {
+                memcpy(out, entry.digest, INPUT_DIGEST_LEN);
+                return true;
+            }
+        }
+    }
+    if (!sha256(reinterpret_cast<const uint8_t*>(policyJson), strlen(policyJson), out)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(policyLock);
+    for (CompiledPolicy& entry : policies) {
+        if (entry.key == key) {
+            memcpy(entry.digest, out, INPUT_DIGEST_LEN);
+            entry.hasDigest = true;
+        }
+    }
+    return true;
+}
+
+static uint8_t* appendText(uint8_t* pos, const char* text, uint32_t length) {
+    memcpy(pos, &length, sizeof(length));
+    memcpy(pos + sizeof(length), text, length);
+    return pos + sizeof(length) + length;
+}
+
+static bool inputDigest(const Hash128& policyKey, const char* policyJson,
+                        const char* appJson, size_t appLen,
+                        const char* userJson, size_t userLen, uint8_t* out) {
+    size_t length = INPUT_DIGEST_LEN + 2 * sizeof(uint32_t) + appLen + userLen;
+    uint8_t stackBuffer[DIGEST_STACK_BYTES];
+    std::vector<uint8_t> heapBuffer;
+    uint8_t* buffer = stackBuffer;
+    if (length > sizeof(stackBuffer)) {
+        heapBuffer.resize(length);
+        buffer = heapBuffer.data();
+    }
+
+    if (!policyDigest(policyKey, policyJson, buffer)) return false;
+    uint8_t* pos = appendText(buffer + INPUT_DIGEST_LEN, appJson, (uint32_t)appLen);
+    appendText(pos, userJson, (uint32_t)userLen);
+    return sha256(buffer, length, out);
+}
+
+// ============================================================================
+// Cached Evaluation
+// ============================================================================
+
+// Decision-cache misses go to the evaluator the build selects:
+// constant-time; else, with PREFERENCE_TABLES, the profile's compiled
+// table or the strategy the planner picks; else the SPECIALIZED_POLICY
+// tables for the pinned snapshot; else evaluate(), over the hot columns of
+// the policy layout with POLICY_LAYOUT
+static EvaluationResult evaluateMiss(const CompiledPolicy& policy, const Hash128& profileKey,
+                                     const AppRequest& app, const UserPreference& user) {
+    (void)profileKey;
+#if defined(CONSTANT_TIME_EVALUATION)
+    return evaluateConstantTime(app, user, *policy.constantTime);
+#else
+#ifdef PREFERENCE_TABLES
+    static const PlannerCosts costs = defaultPlannerCosts();
+    uint32_t misses;
+    std::shared_ptr<const CompiledPreference> table = profileTable(profileKey, &misses);
+    if (table) return evaluateCompiled(app, *table, *policy.policy, *policy.ordinals);
+
+    // A profile that has missed n times is taken to miss about n more
+    PlanShape shape = planShape(app, user, *policy.policy);
+    switch (planEvaluation(shape, (double)misses, costs)) {
+        case STRATEGY_TABLE: {
+            std::shared_ptr<CompiledPreference> built(new CompiledPreference());
+            compilePreference(user, *policy.policy, *policy.ordinals, built.get());
+            storeProfileTable(profileKey, built);
+            return evaluateCompiled(app, *built, *policy.policy, *policy.ordinals);
+        }
+        case STRATEGY_SORTED:
+            return evaluateSorted(app, user, *policy.policy, *policy.ordinals);
+        case STRATEGY_LINEAR:
+            break;
+    }
+#endif
+#ifdef SPECIALIZED_POLICY
+    if (policy.specialized) return SpecializedEvaluator<GeneratedPolicy>::evaluate(app, user);
+#endif
+#ifdef POLICY_LAYOUT
+    return evaluateLayout(app, user, *policy.layout);
+#else
+    return evaluate(app, user, *policy.policy);
+#endif
+#endif
+}
+
+int evaluateCached(const char* appJson, const char* userJson, const char* policyJson,
+                   uint8_t* digest) {
+    size_t appLen = strlen(appJson);
+    size_t userLen = strlen(userJson);
+    Hash128 secret;
+    if (!cacheSecret(&secret)) {
+        if (digest) memset(digest, 0, INPUT_DIGEST_LEN);
+        return RESULT_ERROR;
+    }
+    Hash128 policyKey = keyedHash128(policyJson, strlen(policyJson), secret);
+    Hash128 profileKey = keyedHash128(userJson, userLen, secret, policyKey);
+    Hash128 key = keyedHash128(appJson, appLen, secret, profileKey);
+
+    if (digest && !inputDigest(policyKey, policyJson, appJson, appLen, userJson, userLen, digest)) {
+        memset(digest, 0, INPUT_DIGEST_LEN);
+    }
+
+    int8_t code;
+    if (lookupDecision(key, &code)) return code;
+
+    CompiledPolicy policy;
+    std::shared_ptr<const AppRequest> app;
+    Hash128 canonical;
+    UserPreference user;
+    if (!compiledPolicy(policyKey, policyJson, &policy) ||
+        !minimizedApp(keyedHash128(appJson, appLen, secret, policyKey), secret, appJson,
+                      *policy.index, &app, &canonical) ||
+        !parseUser(userJson, &user)) {
+        return RESULT_ERROR;
+    }
+
+    // Another app JSON with the same minimized form may have been decided
+    Hash128 canonicalKey = keyedHash128(&canonical, sizeof(canonical), secret, profileKey);
+    if (lookupDecision(canonicalKey, &code)) {
+        storeDecision(key, code);
+        return code;
+    }
+
+    EvaluationResult result = evaluateMiss(policy, profileKey, *app, user);
+    if (result == RESULT_GRANT || result == RESULT_DENY) {
+        storeDecision(key, (int8_t)result);
+        storeDecision(canonicalKey, (int8_t)result);
+    }
+    return result;
+}
+
+void clearEnclaveCaches() {
+    for (size_t l = 0; l < CACHE_LOCKS; l++) {
+        std::lock_guard<std::mutex> lock(decisionLocks[l]);
+        for (size_t set = l; set < CACHE_SETS; set += CACHE_LOCKS) {
+            for (int w = 0; w < ENCLAVE_CACHE_WAYS; w++) {
+                decisions[set * ENCLAVE_CACHE_WAYS + w].used = false;
+            }
+        }
+    }
+    for (size_t slot = 0; slot < PROFILE_SLOTS; slot++) {
+        std::lock_guard<std::mutex> lock(profileLocks[slot % CACHE_LOCKS]);
+        profiles[slot].misses = 0;
+        profiles[slot].table.reset();
+        profiles[slot].key = Hash128{ 0, 0 };
+    }
+    for (size_t slot = 0; slot < APP_SLOTS; slot++) {
+        std::lock_guard<std::mutex> lock(appLocks[slot % CACHE_LOCKS]);
+        apps[slot].app.reset();
+        apps[slot].key = Hash128{ 0, 0 };
+    }
+    std::lock_guard<std::mutex> lock(policyLock);
+    policies.clear();
+}
+
+// ============================================================================
+// Snapshot Image
+// ============================================================================
+//
+// Little-endian, no padding:
+//   header    magic u64, format u32, secretLo u64, secretHi u64,
+//             policyCount u32, decisionCount u32
+//   policy    keyLo u64, keyHi u64, attributeCount u32, purposeCount u32,
+//             then per node: idLen u16, id, nameLen u16, name, left i32, right i32,
+//             intervalCount u32, then left i32, right i32 per further interval
+//   decision  keyLo u64, keyHi u64, code i8
+
+template <typename T>
+static void put(std::vector<uint8_t>* out, T value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out->insert(out->end(), bytes, bytes + sizeof(T));
+}
+
+static void putString(std::vector<uint8_t>* out, const std::string& value) {
+    size_t length = value.size() > 0xFFFF ? 0xFFFF : value.size();
+    put<uint16_t>(out, (uint16_t)length);
+    out->insert(out->end(), value.begin(), value.begin() + length);
+}
+
+static void putNodes(std::vector<uint8_t>* out, const std::vector<PolicyNode>& nodes) {
+    for (const PolicyNode& node : nodes) {
+        putString(out, node.id);
+        putString(out, node.name);
+        put<int32_t>(out, node.left);
+        put<int32_t>(out, node.right);
+        put<uint32_t>(out, (uint32_t)node.intervals.size());
+        for (const PrefInterval& interval : node.intervals) {
+            put<int32_t>(out, interval.left);
+            put<int32_t>(out, interval.right);
+        }
+    }
+}
+
+void writeSnapshot(std::vector<uint8_t>* out, size_t* policyCount, size_t* decisionCount) {
+    out->clear();
+    put<uint64_t>(out, SNAPSHOT_MAGIC);
+    put<uint32_t>(out, SNAPSHOT_FORMAT);
+    // Without a secret no entry was ever stored; the zero secret marks the
+    // image invalid
+    Hash128 secret = { 0, 0 };
+    cacheSecret(&secret);
+    put<uint64_t>(out, secret.lo);
+    put<uint64_t>(out, secret.hi);
+    size_t countsAt = out->size();
+    put<uint32_t>(out, 0);
+    put<uint32_t>(out, 0);
+
+    std::vector<CompiledPolicy> policyCopy;
+    {
+        std::lock_guard<std::mutex> lock(policyLock);
+        policyCopy = policies;
+    }
+    for (const CompiledPolicy& entry : policyCopy) {
+        put<uint64_t>(out, entry.key.lo);
+        put<uint64_t>(out, entry.key.hi);
+        put<uint32_t>(out, (uint32_t)entry.policy->attributes.size());
+        put<uint32_t>(out, (uint32_t)entry.policy->purposes.size());
+        putNodes(out, entry.policy->attributes);
+        putNodes(out, entry.policy->purposes);
+    }
+
+    uint32_t stored = 0;
+    for (size_t l = 0; l < CACHE_LOCKS; l++) {
+        std::lock_guard<std::mutex> lock(decisionLocks[l]);
+        for (size_t set = l; set < CACHE_SETS; set += CACHE_LOCKS) {
+            for (int w = 0; w < ENCLAVE_CACHE_WAYS; w++) {
+                const CachedDecision& entry = decisions[set * ENCLAVE_CACHE_WAYS + w];
+                if (!entry.used) continue;
+                put<uint64_t>(out, entry.keyLo);
+                put<uint64_t>(out, entry.keyHi);
+                put<int8_t>(out, entry.code);
+                stored++;
+            }
+        }
+    }
+
+    uint32_t storedPolicies = (uint32_t)policyCopy.size();
+    memcpy(out->data() + countsAt, &storedPolicies, sizeof(uint32_t));
+    memcpy(out->data() + countsAt + sizeof(uint32_t), &stored, sizeof(uint32_t));
+    *policyCount = storedPolicies;
+    *decisionCount = stored;
+}
+
+struct SnapshotReader {
+    const uint8_t* pos;
+    const uint8_t* end;
+
+    template <typename T>
+    bool get(T* value) {
+        if ((size_t)(end - pos) < sizeof(T)) return false;
+        memcpy(value, pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string* value) {
+        uint16_t length;
+        if (!get(&length) || (size_t)(end - pos) < length) return false;
+        value->assign(reinterpret_cast<const char*>(pos), length);
+        pos += length;
+        return true;
+    }
+
+    bool getNodes(uint32_t count, std::vector<PolicyNode>* nodes) {
+        // Each node takes at least 16 bytes: reject counts the image cannot hold
+        if (count > (size_t)(end - pos) / 16) return false;
+        nodes->resize(count);
+        for (PolicyNode& node : *nodes) {
+            uint32_t intervals;
+            if (!getString(&node.id) || !getString(&node.name) ||
+                !get(&node.left) || !get(&node.right) || node.left > node.right ||
+                !get(&intervals) || intervals > (size_t)(end - pos) / 8) {
+                return false;
+            }
+            node.intervals.resize(intervals);
+            for (PrefInterval& interval : node.intervals) {
+                if (!get(&interval.left) || !get(&interval.right)) return false;
+            }
+        }
+        return true;
+    }
+};
+
+bool loadSnapshot(const uint8_t* data, size_t length, size_t* policyCount, size_t* decisionCount) {
+    SnapshotReader reader{data, data + length};
+    uint64_t magic;
+    uint32_t format, storedPolicies, storedDecisions;
+    Hash128 secret;
+    if (!reader.get(&magic) || magic != SNAPSHOT_MAGIC || !reader.get(&format) ||
+        format != SNAPSHOT_FORMAT || !reader.get(&secret.lo) || !reader.get(&secret.hi) ||
+        (secret.lo == 0 && secret.hi == 0) || !reader.get(&storedPolicies) ||
+        !reader.get(&storedDecisions) || storedPolicies > ENCLAVE_MAX_POLICIES ||
+        storedDecisions > ENCLAVE_CACHE_ENTRIES) {
+        return false;
+    }
+
+    std::vector<CompiledPolicy> loadedPolicies;
+    for (uint32_t i = 0; i < storedPolicies; i++) {
+        CompiledPolicy entry;
+        uint32_t attributeCount, purposeCount;
+        PolicyData policy;
+        if (!reader.get(&entry.key.lo) || !reader.get(&entry.key.hi) ||
+            !reader.get(&attributeCount) || !reader.get(&purposeCount) ||
+            !reader.getNodes(attributeCount, &policy.attributes) ||
+            !reader.getNodes(purposeCount, &policy.purposes)) {
+            return false;
+        }
+        std::shared_ptr<PolicyIndex> index(new PolicyIndex());
+        index->load(std::move(policy));
+        entry.index = index;
+        entry.lastUse = 0;
+        entry.hasDigest = false;
+        loadedPolicies.push_back(entry);
+    }
+
+    const size_t DECISION_BYTES = 2 * sizeof(uint64_t) + sizeof(int8_t);
+    if ((size_t)(reader.end - reader.pos) != (size_t)storedDecisions * DECISION_BYTES) return false;
+    const uint8_t* decisionData = reader.pos;
+    for (uint32_t i = 0; i < storedDecisions; i++) {
+        int8_t code = (int8_t)decisionData[i * DECISION_BYTES + 2 * sizeof(uint64_t)];
+        if (code != RESULT_GRANT && code != RESULT_DENY) return false;
+    }
+
+    // Valid: install. Keys computed under the old secret by requests in
+    // flight can no longer match anything.
+    clearEnclaveCaches();
+    {
+        std::lock_guard<std::mutex> lock(secretLock);
+        installSecretLocked(secret);
+    }
+    {
+        std::lock_guard<std::mutex> lock(policyLock);
+        for (CompiledPolicy& entry : loadedPolicies) installPolicyLocked(entry.key, entry.index);
+    }
+    for (uint32_t i = 0; i < storedDecisions; i++) {
+        const uint8_t* record = decisionData + i * DECISION_BYTES;
+        Hash128 key;
+        memcpy(&key.lo, record, sizeof(uint64_t));
+        memcpy(&key.hi, record + sizeof(uint64_t), sizeof(uint64_t));
+        storeDecision(key, (int8_t)record[2 * sizeof(uint64_t)]);
+    }
+
+    *policyCount = storedPolicies;
+    *decisionCount = storedDecisions;
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef ENCLAVE_CACHE_H
+#define ENCLAVE_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "Enclave.h"
+
+// ============================================================================
+// In-Enclave Policy and Decision Caches
+// ============================================================================
+//
+// State kept inside the enclave between ECALLs: compiled policies (a
+// PolicyIndex over the parsed policy, keyed by a hash of the policy JSON;
+// core/EvaluationInput.h parses all three inputs) and a 4-way set-associative
+// table of recent decisions keyed by the hash of all three inputs. Keys are
+// hashed under a secret drawn inside the enclave (sgx_read_rand). Both are
+// lost when the enclave is destroyed; writeSnapshot/loadSnapshot turn them
+// into a compact byte image that Seal.cpp seals to disk and restores on the
+// next start, with the key secret, so a restarted validator does not begin
+// at miss-path latency.
+// Parsed app requests are also kept, minimized (minimizeAppRequest), and
+// not snapshotted; each decision is stored under the minimized app as well,
+// so apps that list redundant nodes share it.
+
+#define ENCLAVE_MAX_POLICIES 16
+#define ENCLAVE_CACHE_ENTRIES (1u << 16)
+#define ENCLAVE_CACHE_WAYS 4
+
+#define SNAPSHOT_MAGIC 0x3153504E5350ULL     // "PSNPS1"
+#define SNAPSHOT_FORMAT 3
+
+// Snapshot ECALL status codes
+#define SNAPSHOT_OK 0
+#define SNAPSHOT_ERR_BUFFER -2               // sealed buffer too small: retry
+#define SNAPSHOT_ERR_SEAL -3                 // sgx_seal_data / unseal failed
+#define SNAPSHOT_ERR_INVALID -4              // unsealed image failed validation
+
+// SHA-256 binding a decision to the exact inputs the enclave evaluated:
+//   SHA-256( SHA-256(policyJson) | appLen u32 | appJson | userLen u32 | userJson )
+// (lengths little-endian, no terminators). The policy digest is computed
+// once per compiled policy, so a request only hashes its own app and user
+// text. Callers recompute it from the JSON they sent to check that nothing
+// in untrusted memory changed the inputs on the way in.
+#define INPUT_DIGEST_LEN 32
+
+// Evaluates one request through both caches (ECALL entry points). When
+// digest is not null it receives the input digest; it is zeroed if the
+// build has no SHA-256 (only enclave builds, ENCLAVE_CODE, do).
+int evaluateCached(const char* appJson, const char* userJson, const char* policyJson,
+                   uint8_t* digest = nullptr);
+
+// Serializes every compiled policy and cached decision
+void writeSnapshot(std::vector<uint8_t>* out, size_t* policies, size_t* decisions);
+// Validates the whole image first, then replaces both caches with it.
+// Nothing is installed if any part is malformed.
+bool loadSnapshot(const uint8_t* data, size_t length, size_t* policies, size_t* decisions);
+
+void clearEnclaveCaches();
+
+#endif // ENCLAVE_CACHE_H
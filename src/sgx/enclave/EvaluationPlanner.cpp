@@ -0,0 +1,119 @@
+#include "EvaluationPlanner.h"
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+// ============================================================================
+// Cost Model
+// ============================================================================
+
+PlannerCosts defaultPlannerCosts() {
+    PlannerCosts costs;
+    costs.linear = { PLANNER_LINEAR_FIXED_NS, PLANNER_LINEAR_OP_NS };
+    costs.sorted = { PLANNER_SORTED_FIXED_NS, PLANNER_SORTED_OP_NS };
+    costs.tableBuild = { PLANNER_BUILD_FIXED_NS, PLANNER_BUILD_OP_NS };
+    costs.tableProbe = { PLANNER_PROBE_FIXED_NS, PLANNER_PROBE_OP_NS };
+    return costs;
+}
+
+static double log2Of(size_t n) {
+    return log2((double)n + 2.0);
+}
+
+// evaluate() on one tree, worst case: every app node against every policy
+// node of every ID, or with the interval path, one policy pass per ID plus
+// a search per app node
+static double linearTreeOps(size_t appNodes, size_t ids, size_t policyNodes) {
+    if (useIntervalEvaluation(appNodes, ids, policyNodes)) {
+        return (double)ids * policyNodes + appNodes * log2Of(ids);
+    }
+    return (double)appNodes * ids * policyNodes;
+}
+
+PlanShape planShape(const AppRequest& app, const UserPreference& userPref,
+                    const PolicyData& policy) {
+    // Worst case of evaluate(): every allow and exception list scanned once
+    size_t attributePrefs = userPref.attributeIds.size() + userPref.exceptionIds.size();
+    size_t purposePrefs = userPref.allowedPurposeIds.size() + userPref.prohibitedPurposeIds.size();
+
+    PlanShape shape;
+    shape.linearOps =
+        linearTreeOps(app.attributes.size(), attributePrefs, policy.attributes.size()) +
+        linearTreeOps(app.purposes.size(), purposePrefs, policy.purposes.size());
+    shape.sortedOps = (attributePrefs + app.attributes.size()) * log2Of(attributePrefs) +
+                      (purposePrefs + app.purposes.size()) * log2Of(purposePrefs);
+    // A build clears one byte per policy node, then resolves each preference
+    // ID and marks the nodes under it (about log2 of the tree size)
+    shape.buildOps = (policy.attributes.size() + policy.purposes.size()) / 16.0 +
+                     attributePrefs * log2Of(policy.attributes.size()) +
+                     purposePrefs * log2Of(policy.purposes.size());
+    shape.probeOps = (double)(app.attributes.size() + app.purposes.size());
+    // Every strategy checks retention first; a request it denies costs no
+    // tree work, but a table would still have to be built
+    if (!evaluateTimeofRetention(app, userPref)) {
+        shape.linearOps = 0;
+        shape.sortedOps = 0;
+        shape.probeOps = 0;
+    }
+    return shape;
+}
+
+EvaluationStrategy planEvaluation(const PlanShape& shape, double expectedUses,
+                                  const PlannerCosts& costs, double* estimateNs) {
+    if (expectedUses < 1) expectedUses = 1;
+    double linear = costs.linear.estimate(shape.linearOps);
+    double sorted = costs.sorted.estimate(shape.sortedOps);
+    double table = costs.tableBuild.estimate(shape.buildOps) / expectedUses +
+                   costs.tableProbe.estimate(shape.probeOps);
+
+    EvaluationStrategy best = STRATEGY_LINEAR;
+    double bestNs = linear;
+    if (sorted < bestNs) {
+        best = STRATEGY_SORTED;
+        bestNs = sorted;
+    }
+    if (table < bestNs) {
+        best = STRATEGY_TABLE;
+        bestNs = table;
+    }
+    if (estimateNs) *estimateNs = bestNs;
+    return best;
+}
+
+// ============================================================================
+// Sorted-Interval Evaluation
+// ============================================================================
+
+// Intervals of every policy node named in ids (a DAG node's further ones
+// too), sorted by left, with right replaced by the running maximum
+static void sortedIntervals(const std::vector<std::string>& ids,
+                            const std::vector<PolicyNode>& nodes, const TreeOrdinals& ordinals,
+                            std::vector<PrefInterval>* out) {
+    out->clear();
+    for (const std::string& id : ids) {
+        auto it = ordinals.first.find(id);
+        if (it == ordinals.first.end()) continue;
+        for (int32_t o = it->second; o >= 0; o = ordinals.next[o]) {
+            PrefInterval interval = { nodes[o].left, nodes[o].right };
+            out->push_back(interval);
+            out->insert(out->end(), nodes[o].intervals.begin(), nodes[o].intervals.end());
+        }
+    }
+    sortIntervals(out);
+}
+
+EvaluationResult evaluateSorted(const AppRequest& app, const UserPreference& userPref,
+                                const PolicyData& policy, const PolicyOrdinals& ordinals) {
+    if (app.timeofRetention > userPref.timeofRetention) return RESULT_DENY;
+
+    std::vector<PrefInterval> allowed, excepted;
+    sortedIntervals(userPref.attributeIds, policy.attributes, ordinals.attributes, &allowed);
+    if (!anyContainsSorted(allowed, app.attributes)) return RESULT_DENY;
+    sortedIntervals(userPref.exceptionIds, policy.attributes, ordinals.attributes, &excepted);
+    if (anyContainsSorted(excepted, app.attributes)) return RESULT_DENY;
+
+    sortedIntervals(userPref.allowedPurposeIds, policy.purposes, ordinals.purposes, &allowed);
+    if (!anyContainsSorted(allowed, app.purposes)) return RESULT_DENY;
+    sortedIntervals(userPref.prohibitedPurposeIds, policy.purposes, ordinals.purposes, &excepted);
+    return anyContainsSorted(excepted, app.purposes) ? RESULT_DENY : RESULT_GRANT;
+}
@@ -0,0 +1,86 @@
+#ifndef EVALUATION_PLANNER_H
+#define EVALUATION_PLANNER_H
+
+#include <stddef.h>
+#include "Enclave.h"
+#include "PreferenceTable.h"
+
+// ============================================================================
+// Evaluation Strategy Planner
+// ============================================================================
+//
+// The fastest way to evaluate a request depends on its shape. evaluate()
+// compares every app node with every policy node of every preference ID,
+// which is cheapest for tiny inputs. Sorting the resolved preference
+// intervals makes each app node a binary search. A compiled table
+// (PreferenceTable.h) makes it one probe, but has to be built first and
+// only pays off when the profile comes back. planEvaluation estimates each
+// strategy's cost from operation counts and per-strategy constants, and
+// returns the cheapest.
+//
+// Each strategy is modelled as fixedNs + perOpNs * ops(shape). The
+// defaults below were fitted on a development host. npm run
+// planner-calibration fits them on the current host and prints replacement
+// values. Enclave builds with PREFERENCE_TABLES consult the planner on
+// every decision-cache miss that has no table yet.
+
+enum EvaluationStrategy {
+    STRATEGY_LINEAR = 0,     // evaluate()
+    STRATEGY_SORTED = 1,     // evaluateSorted()
+    STRATEGY_TABLE = 2       // compilePreference() + evaluateCompiled()
+};
+
+#define PLANNER_LINEAR_FIXED_NS 130.0
+#define PLANNER_LINEAR_OP_NS 0.007
+#define PLANNER_SORTED_FIXED_NS 0.0
+#define PLANNER_SORTED_OP_NS 9.7
+#define PLANNER_BUILD_FIXED_NS 0.0
+#define PLANNER_BUILD_OP_NS 15.4
+#define PLANNER_PROBE_FIXED_NS 30.0
+#define PLANNER_PROBE_OP_NS 0.53
+
+struct StrategyCost {
+    double fixedNs;
+    double perOpNs;
+
+    double estimate(double ops) const { return fixedNs + perOpNs * ops; }
+};
+
+struct PlannerCosts {
+    StrategyCost linear;
+    StrategyCost sorted;
+    StrategyCost tableBuild;
+    StrategyCost tableProbe;
+};
+
+PlannerCosts defaultPlannerCosts();
+
+// Operation counts of one request under each strategy; cheap to compute
+// from the list lengths alone
+struct PlanShape {
+    // On trees that take the interval path (useIntervalEvaluation()),
+    // linearOps counts preference IDs x policy nodes + app nodes x
+    // log2(preference IDs) instead
+    double linearOps;        // app nodes x preference IDs x policy nodes (worst case)
+    double sortedOps;        // (preference IDs + app nodes) x log2(preference IDs)
+    double buildOps;         // policy nodes / 16 + preference IDs x log2(policy nodes)
+    double probeOps;         // app nodes
+};
+
+PlanShape planShape(const AppRequest& app, const UserPreference& userPref,
+                    const PolicyData& policy);
+
+// Cheapest strategy for one request whose profile is expected to be
+// evaluated expectedUses times in all (>= 1), so a table's build is spread
+// over those uses. *estimateNs receives the chosen cost per evaluation.
+EvaluationStrategy planEvaluation(const PlanShape& shape, double expectedUses,
+                                  const PlannerCosts& costs, double* estimateNs = nullptr);
+
+// Containment through the preference intervals sorted by left, with a
+// running maximum of right: an app node is contained when the largest
+// right among intervals starting at or before it reaches its right.
+// Same result as evaluate(app, userPref, policy).
+EvaluationResult evaluateSorted(const AppRequest& app, const UserPreference& userPref,
+                                const PolicyData& policy, const PolicyOrdinals& ordinals);
+
+#endif // EVALUATION_PLANNER_H
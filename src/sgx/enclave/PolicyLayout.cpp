@@ -0,0 +1,343 @@
+#include "PolicyLayout.h"
+#include "../core/Hash.h"
+#include <string.h>
+#include <algorithm>
+
+// ============================================================================
+// Columns and Index
+// ============================================================================
+
+void LayoutColumn::resize(size_t nodes) {
+    lines.assign((nodes + LAYOUT_LINE_NODES - 1) / LAYOUT_LINE_NODES, LayoutLine());
+}
+
+uint64_t layoutIdHash(const std::string& id) {
+    return hash64(id.data(), id.size());
+}
+
+// Pool entries are NUL-terminated. The hash covers the length, so an ID
+// with an embedded NUL that shares a prefix with another cannot also match
+// its hash by more than chance.
+static bool textMatches(const TreeLayout& tree, uint32_t text, const std::string& id) {
+    return memcmp(tree.pool.data() + text, id.data(), id.size()) == 0 &&
+           tree.pool[text + id.size()] == '\0';
+}
+
+// Slot holding id, or the empty slot where it belongs
+static size_t findSlot(const TreeLayout& tree, uint64_t hash, const std::string& id) {
+    size_t mask = tree.slots.size() - 1;
+    for (size_t slot = (size_t)hash & mask;; slot = (slot + 1) & mask) {
+        const LayoutSlot& entry = tree.slots[slot];
+        if (entry.ordinal < 0) return slot;
+        if (entry.hash == hash && textMatches(tree, entry.text, id)) return slot;
+    }
+}
+
+int32_t TreeLayout::firstOrdinal(const std::string& id) const {
+    return firstOrdinal(layoutIdHash(id), id);
+}
+
+int32_t TreeLayout::firstOrdinal(uint64_t hash, const std::string& id) const {
+    if (slots.empty()) return -1;
+    return slots[findSlot(*this, hash, id)].ordinal;
+}
+
+std::string TreeLayout::id(int32_t ordinal) const {
+    return pool.substr(text[2 * ordinal], text[2 * ordinal + 1] - text[2 * ordinal] - 1);
+}
+
+std::string TreeLayout::name(int32_t ordinal) const {
+    return pool.substr(text[2 * ordinal + 1], text[2 * ordinal + 2] - text[2 * ordinal + 1] - 1);
+}
+
+size_t TreeLayout::hotBytes() const {
+    return left.bytes() + right.bytes() + depth.bytes() + parent.bytes() +
+           furtherStart.size() * sizeof(uint32_t) + further.size() * sizeof(PrefInterval);
+}
+
+size_t TreeLayout::indexBytes() const {
+    return slots.size() * sizeof(LayoutSlot) + sameId.size() * sizeof(int32_t);
+}
+
+size_t TreeLayout::coldBytes() const {
+    return pool.size() + text.size() * sizeof(uint32_t);
+}
+
+// ============================================================================
+// Compilation
+// ============================================================================
+
+static void compileTree(const std::vector<PolicyNode>& nodes, TreeLayout* out) {
+    size_t count = nodes.size();
+    out->count = (uint32_t)count;
+    out->left.resize(count);
+    out->right.resize(count);
+    out->depth.resize(count);
+    out->parent.resize(count);
+    int32_t* left = out->left.data();
+    int32_t* right = out->right.data();
+
+    out->pool.clear();
+    out->text.assign(1, 0);
+    out->furtherStart.clear();
+    out->further.clear();
+    for (size_t k = 0; k < count; k++) {
+        left[k] = nodes[k].left;
+        right[k] = nodes[k].right;
+        if (!nodes[k].intervals.empty() && out->furtherStart.empty()) {
+            out->furtherStart.assign(k + 1, 0);
+        }
+        if (!out->furtherStart.empty()) {
+            out->further.insert(out->further.end(), nodes[k].intervals.begin(),
+                                nodes[k].intervals.end());
+            out->furtherStart.push_back((uint32_t)out->further.size());
+        }
+        out->pool += nodes[k].id;
+        out->pool += '\0';
+        out->text.push_back((uint32_t)out->pool.size());
+        out->pool += nodes[k].name;
+        out->pool += '\0';
+        out->text.push_back((uint32_t)out->pool.size());
+    }
+
+    // Power of two at least twice the node count keeps probes short
+    size_t slots = 16;
+    while (slots < 2 * count) slots <<= 1;
+    LayoutSlot empty = { 0, -1, 0 };
+    out->slots.assign(slots, empty);
+    out->sameId.assign(count, -1);
+    // Walk backwards so that a slot ends on the lowest ordinal and the
+    // chains run in ordinal order
+    for (size_t k = count; k-- > 0;) {
+        const std::string& id = nodes[k].id;
+        uint64_t hash = layoutIdHash(id);
+        LayoutSlot& slot = out->slots[findSlot(*out, hash, id)];
+        out->sameId[k] = slot.ordinal;
+        slot.hash = hash;
+        slot.ordinal = (int32_t)k;
+        slot.text = out->text[2 * k];
+    }
+
+    // Depth and parent from the intervals: in order of left, a node's
+    // enclosing nodes are the ones still open on the stack
+    std::vector<int32_t> byLeft(count);
+    for (size_t k = 0; k < count; k++) byLeft[k] = (int32_t)k;
+    std::stable_sort(byLeft.begin(), byLeft.end(), [left](int32_t a, int32_t b) {
+        return left[a] < left[b];
+    });
+    int32_t* depth = out->depth.data();
+    int32_t* parent = out->parent.data();
+    std::vector<int32_t> open;
+    for (int32_t k : byLeft) {
+        while (!open.empty() && right[open.back()] < right[k]) open.pop_back();
+        parent[k] = open.empty() ? -1 : open.back();
+        depth[k] = (int32_t)open.size();
+        open.push_back(k);
+    }
+}
+
+void compilePolicyLayout(const PolicyData& policy, PolicyLayout* out) {
+    compileTree(policy.attributes, &out->attributes);
+    compileTree(policy.purposes, &out->purposes);
+}
+
+// ============================================================================
+// Evaluation
+// ============================================================================
+
+// Whether one of ordinal o's further intervals (a DAG node) contains any
+// app node
+static bool furtherContains(const TreeLayout& tree, int32_t o,
+                            const std::vector<PolicyNode>& appNodes) {
+    if (tree.furtherStart.empty()) return false;
+    for (uint32_t i = tree.furtherStart[o]; i < tree.furtherStart[o + 1]; i++) {
+        const PrefInterval& interval = tree.further[i];
+        for (const PolicyNode& node : appNodes) {
+            if (interval.left <= node.left && interval.right >= node.right) return true;
+        }
+    }
+    return false;
+}
+
+// Whether a node named in ids contains any app node. Reads the index once
+// per ID, then only the left and right columns (and a DAG node's further
+// intervals).
+static bool anyContains(const TreeLayout& tree, const std::vector<std::string>& ids,
+                        const std::vector<PolicyNode>& appNodes) {
+    const int32_t* left = tree.left.data();
+    const int32_t* right = tree.right.data();
+    for (const std::string& id : ids) {
+        for (int32_t o = tree.firstOrdinal(id); o >= 0; o = tree.sameId[o]) {
+            int32_t l = left[o], r = right[o];
+            for (const PolicyNode& node : appNodes) {
+                if (l <= node.left && r >= node.right) return true;
+            }
+            if (furtherContains(tree, o, appNodes)) return true;
+        }
+    }
+    return false;
+}
+
+EvaluationResult evaluateLayout(const AppRequest& app, const UserPreference& userPref,
+                                const PolicyLayout& layout) {
+    // The checks of evaluate(); its deny checks read the except and
+    // prohibited lists again, so they add nothing here
+    if (app.timeofRetention > userPref.timeofRetention) return RESULT_DENY;
+    if (!anyContains(layout.attributes, userPref.attributeIds, app.attributes)) return RESULT_DENY;
+    if (anyContains(layout.attributes, userPref.exceptionIds, app.attributes)) return RESULT_DENY;
+    if (!anyContains(layout.purposes, userPref.allowedPurposeIds, app.purposes)) return RESULT_DENY;
+    if (anyContains(layout.purposes, userPref.prohibitedPurposeIds, app.purposes)) return RESULT_DENY;
+    return RESULT_GRANT;
+}
+
+// ============================================================================
+// Batch Evaluation
+// ============================================================================
+
+#define LAYOUT_STAGES 5
+#define LAYOUT_PIPELINED_IDS 8
+
+// Pipeline state of one request, reused round the ring. Only the allowed
+// attribute IDs are carried: every request past retention reads them, and
+// most stop there. IDs past LAYOUT_PIPELINED_IDS and the other lists are
+// looked up when the request is evaluated.
+struct PipelineEntry {
+    bool active;                             // passed retention
+    size_t ids;
+    uint64_t hashes[LAYOUT_PIPELINED_IDS];
+    int32_t slots[LAYOUT_PIPELINED_IDS];     // candidate slot, -1 when absent
+};
+
+static void prefetchRange(const void* data, size_t bytes) {
+    const char* p = static_cast<const char*>(data);
+    for (size_t offset = 0; offset < bytes; offset += LAYOUT_LINE_BYTES) {
+        __builtin_prefetch(p + offset);
+    }
+}
+
+// Stage 0: prefetch the request's app and preference objects
+static void objectStage(const LayoutRequest& request) {
+    prefetchRange(request.app, sizeof(AppRequest));
+    prefetchRange(request.user, sizeof(UserPreference));
+}
+
+// Stage 1: check retention, prefetch the allowed IDs and the app attributes
+static void listStage(const LayoutRequest& request, PipelineEntry* entry) {
+    const UserPreference& user = *request.user;
+    const AppRequest& app = *request.app;
+    entry->active = app.timeofRetention <= user.timeofRetention;
+    entry->ids = entry->active ? std::min<size_t>(user.attributeIds.size(), LAYOUT_PIPELINED_IDS) : 0;
+    prefetchRange(user.attributeIds.data(), entry->ids * sizeof(std::string));
+    if (entry->active) {
+        prefetchRange(app.attributes.data(), app.attributes.size() * sizeof(PolicyNode));
+    }
+}
+
+// Stage 2: hash the IDs, prefetch their home slots
+static void hashStage(const LayoutRequest& request, const TreeLayout& tree, PipelineEntry* entry) {
+    if (tree.slots.empty()) entry->ids = 0;
+    for (size_t i = 0; i < entry->ids; i++) {
+        entry->hashes[i] = layoutIdHash(request.user->attributeIds[i]);
+        __builtin_prefetch(&tree.slots[tree.homeSlot(entry->hashes[i])]);
+    }
+}
+
+// Stage 3: probe by hash alone to the candidate slot, prefetch the text
+// that confirms it and the ordinal's interval and chain
+static void probeStage(const TreeLayout& tree, PipelineEntry* entry) {
+    size_t mask = tree.slots.size() - 1;
+    for (size_t i = 0; i < entry->ids; i++) {
+        uint64_t hash = entry->hashes[i];
+        int32_t candidate = -1;
+        for (size_t slot = tree.homeSlot(hash); tree.slots[slot].ordinal >= 0;
+             slot = (slot + 1) & mask) {
+            if (tree.slots[slot].hash == hash) {
+                candidate = (int32_t)slot;
+                break;
+            }
+        }
+        entry->slots[i] = candidate;
+        if (candidate < 0) continue;
+        const LayoutSlot& slot = tree.slots[candidate];
+        __builtin_prefetch(tree.pool.data() + slot.text);
+        __builtin_prefetch(tree.left.data() + slot.ordinal);
+        __builtin_prefetch(tree.right.data() + slot.ordinal);
+        __builtin_prefetch(tree.sameId.data() + slot.ordinal);
+    }
+}
+
+// Stage 4: the checks of evaluateLayout(), the allowed attributes through
+// the resolved slots. A candidate whose text differs (a hash collision)
+// falls back to the full lookup.
+static EvaluationResult evaluateStage(const LayoutRequest& request, const PolicyLayout& layout,
+                                      const PipelineEntry& entry) {
+    if (!entry.active) return RESULT_DENY;
+    const UserPreference& user = *request.user;
+    const AppRequest& app = *request.app;
+    const TreeLayout& tree = layout.attributes;
+    const int32_t* left = tree.left.data();
+    const int32_t* right = tree.right.data();
+
+    bool allowed = false;
+    for (size_t i = 0; i < user.attributeIds.size() && !allowed; i++) {
+        const std::string& id = user.attributeIds[i];
+        int32_t o;
+        if (i >= entry.ids) {
+            o = tree.firstOrdinal(id);
+        } else if (entry.slots[i] < 0) {
+            continue;
+        } else {
+            const LayoutSlot& slot = tree.slots[entry.slots[i]];
+            o = textMatches(tree, slot.text, id) ? slot.ordinal : tree.firstOrdinal(entry.hashes[i], id);
+        }
+        for (; o >= 0 && !allowed; o = tree.sameId[o]) {
+            for (const PolicyNode& node : app.attributes) {
+                if (left[o] <= node.left && right[o] >= node.right) {
+                    allowed = true;
+                    break;
+                }
+            }
+            if (!allowed) allowed = furtherContains(tree, o, app.attributes);
+        }
+    }
+    if (!allowed) return RESULT_DENY;
+    if (anyContains(tree, user.exceptionIds, app.attributes)) return RESULT_DENY;
+    if (!anyContains(layout.purposes, user.allowedPurposeIds, app.purposes)) return RESULT_DENY;
+    if (anyContains(layout.purposes, user.prohibitedPurposeIds, app.purposes)) return RESULT_DENY;
+    return RESULT_GRANT;
+}
+
+void evaluateLayoutBatch(const LayoutRequest* requests, size_t count, const PolicyLayout& layout,
+                         size_t distance, int* results) {
+    if (distance == 0) {
+        for (size_t i = 0; i < count; i++) {
+            results[i] = evaluateLayout(*requests[i].app, *requests[i].user, layout);
+        }
+        return;
+    }
+
+    // Step i runs stage s on request i - s * distance
+    size_t lead = (LAYOUT_STAGES - 1) * distance;
+    size_t ring = lead + 1;
+    std::vector<PipelineEntry> entries(ring);
+    const TreeLayout& tree = layout.attributes;
+    for (size_t i = 0; i < count + lead; i++) {
+        if (i < count) objectStage(requests[i]);
+        if (i >= distance && i - distance < count) {
+            size_t r = i - distance;
+            listStage(requests[r], &entries[r % ring]);
+        }
+        if (i >= 2 * distance && i - 2 * distance < count) {
+            size_t r = i - 2 * distance;
+            hashStage(requests[r], tree, &entries[r % ring]);
+        }
+        if (i >= 3 * distance && i - 3 * distance < count) {
+            size_t r = i - 3 * distance;
+            probeStage(tree, &entries[r % ring]);
+        }
+        if (i >= lead) {
+            size_t r = i - lead;
+            results[r] = evaluateStage(requests[r], layout, entries[r % ring]);
+        }
+    }
+}
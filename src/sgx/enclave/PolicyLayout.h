@@ -0,0 +1,137 @@
+#ifndef POLICY_LAYOUT_H
+#define POLICY_LAYOUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "Enclave.h"
+
+// ============================================================================
+// Hot/Cold Policy Layout
+// ============================================================================
+//
+// PolicyNode keeps two std::strings beside the two ints evaluation reads, so
+// evaluate() pulls about 96 bytes per node through the cache and compares
+// IDs by chasing string data. A TreeLayout splits a compiled tree in two.
+// The hot part is one int32 column each for left, right, depth and parent
+// ordinal, 64-byte aligned and padded to whole cache lines. The cold part
+// is a pool with the ID and name text. Preference IDs are resolved to
+// ordinals through an open-addressing index of ID hashes, and a hit is
+// confirmed once against the pool. From then on the work per node reads
+// only the left and right columns.
+//
+// Enclave builds compiled with POLICY_LAYOUT (POLICY_LAYOUT=1 ./build.sh)
+// keep a layout per compiled policy. Decision-cache misses that would
+// otherwise run evaluate() use evaluateLayout() instead.
+
+#define LAYOUT_LINE_BYTES 64
+#define LAYOUT_LINE_NODES (LAYOUT_LINE_BYTES / sizeof(int32_t))
+
+struct alignas(LAYOUT_LINE_BYTES) LayoutLine {
+    int32_t values[LAYOUT_LINE_NODES];
+};
+
+// Index entry: four per cache line, so a lookup usually reads one line
+// for the slot and one for the pool text that confirms it
+struct LayoutSlot {
+    uint64_t hash;
+    int32_t ordinal;
+    uint32_t text;               // pool offset of the ID
+};
+
+// One int32 per node ordinal, cache-line aligned, padding zeroed
+struct LayoutColumn {
+    std::vector<LayoutLine> lines;
+
+    void resize(size_t nodes);
+    int32_t* data() { return reinterpret_cast<int32_t*>(lines.data()); }
+    const int32_t* data() const { return reinterpret_cast<const int32_t*>(lines.data()); }
+    size_t bytes() const { return lines.size() * sizeof(LayoutLine); }
+};
+
+struct TreeLayout {
+    uint32_t count;
+
+    // Hot: read per node
+    LayoutColumn left;
+    LayoutColumn right;
+    LayoutColumn depth;          // enclosing nodes above this one
+    LayoutColumn parent;         // innermost enclosing ordinal, -1 at a root
+    // Further intervals of DAG nodes: ordinal k's are further[furtherStart[k]]
+    // up to further[furtherStart[k + 1]]. Both are empty for a tree.
+    std::vector<uint32_t> furtherStart;
+    std::vector<PrefInterval> further;
+
+    // ID index, read once per preference ID: linear probing over slots
+    // (ordinal -1 when empty), each holding the lowest ordinal with its ID;
+    // sameId chains the others in ordinal order
+    std::vector<LayoutSlot> slots;
+    std::vector<int32_t> sameId;
+
+    // Cold: node k's ID starts at pool[text[2k]] and its name at
+    // pool[text[2k + 1]], each followed by a NUL; text[2 * count] is the
+    // pool size
+    std::string pool;
+    std::vector<uint32_t> text;
+
+    // Lowest ordinal whose ID is id (follow sameId for the others), or -1
+    int32_t firstOrdinal(const std::string& id) const;
+    // The same lookup in two steps, for callers that prefetch in between:
+    // homeSlot is where the probe for hash starts
+    size_t homeSlot(uint64_t hash) const { return (size_t)hash & (slots.size() - 1); }
+    int32_t firstOrdinal(uint64_t hash, const std::string& id) const;
+    std::string id(int32_t ordinal) const;
+    std::string name(int32_t ordinal) const;
+
+    size_t hotBytes() const;
+    size_t indexBytes() const;
+    size_t coldBytes() const;
+};
+
+struct PolicyLayout {
+    TreeLayout attributes;
+    TreeLayout purposes;
+};
+
+void compilePolicyLayout(const PolicyData& policy, PolicyLayout* out);
+
+uint64_t layoutIdHash(const std::string& id);
+
+// Same result as evaluate(app, userPref, policy) for the policy layout was
+// compiled from
+EvaluationResult evaluateLayout(const AppRequest& app, const UserPreference& userPref,
+                                const PolicyLayout& layout);
+
+// ============================================================================
+// Batch Evaluation
+// ============================================================================
+//
+// Against a tree larger than the last-level cache, nearly every index slot,
+// pool string and interval evaluateLayout() touches is a miss, as are the
+// request's own objects, and each step needs the one before. The plain loop
+// waits on them one at a time. evaluateLayoutBatch runs the requests as a
+// software pipeline, each stage distance requests behind the one before:
+//   0. prefetch the app request and the preference
+//   1. check retention, prefetch the allowed attribute IDs and app attributes
+//   2. hash the allowed IDs and prefetch their index slots
+//   3. find the candidate slots, prefetch the pool text that confirms them
+//      and the left, right and sameId lines
+//   4. confirm and evaluate, from lines already in cache
+// so the misses of 4 * distance requests are in flight at once. Only the
+// allowed attributes are pipelined: every request past retention reads them
+// and most are denied on them. The later lists are looked up when reached.
+// Distance 0 is the plain loop.
+
+#define LAYOUT_PREFETCH_DISTANCE 8
+
+struct LayoutRequest {
+    const AppRequest* app;
+    const UserPreference* user;
+};
+
+// results[i] receives the evaluateLayout() result of requests[i]
+void evaluateLayoutBatch(const LayoutRequest* requests, size_t count, const PolicyLayout& layout,
+                         size_t distance, int* results);
+
+#endif // POLICY_LAYOUT_H
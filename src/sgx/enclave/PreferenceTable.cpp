@@ -0,0 +1,149 @@
+#include "PreferenceTable.h"
+#include <algorithm>
+
+// ============================================================================
+// Policy Ordinals
+// ============================================================================
+
+static void compileTree(const std::vector<PolicyNode>& nodes, TreeOrdinals* out) {
+    out->first.clear();
+    out->next.assign(nodes.size(), -1);
+    out->byLeft.resize(nodes.size());
+    out->wellFormed = true;
+    // Walk backwards so that first holds the lowest ordinal and the chains
+    // run in ordinal order
+    for (size_t i = nodes.size(); i-- > 0;) {
+        auto inserted = out->first.emplace(nodes[i].id, (int32_t)i);
+        if (!inserted.second) {
+            out->next[i] = inserted.first->second;
+            inserted.first->second = (int32_t)i;
+        }
+        out->byLeft[i] = (int32_t)i;
+        if (nodes[i].left > nodes[i].right) out->wellFormed = false;
+    }
+    std::stable_sort(out->byLeft.begin(), out->byLeft.end(), [&nodes](int32_t a, int32_t b) {
+        return nodes[a].left < nodes[b].left;
+    });
+    out->lefts.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) out->lefts[i] = nodes[out->byLeft[i]].left;
+}
+
+int32_t TreeOrdinals::find(const PolicyNode& node, const std::vector<PolicyNode>& nodes) const {
+    auto it = first.find(node.id);
+    if (it == first.end()) return -1;
+    for (int32_t o = it->second; o >= 0; o = next[o]) {
+        if (nodes[o].left == node.left && nodes[o].right == node.right) return o;
+    }
+    return -1;
+}
+
+void compilePolicyOrdinals(const PolicyData& policy, PolicyOrdinals* out) {
+    compileTree(policy.attributes, &out->attributes);
+    compileTree(policy.purposes, &out->purposes);
+}
+
+// ============================================================================
+// Preference Compilation
+// ============================================================================
+
+// Sets verdict on each node inside interval. Contained nodes start within
+// [left, right]: scan that run of byLeft (all of it if some node is
+// malformed).
+static void markInterval(const PrefInterval& interval, uint8_t verdict,
+                         const std::vector<PolicyNode>& nodes, const TreeOrdinals& ordinals,
+                         std::vector<uint8_t>* verdicts) {
+    size_t i = std::lower_bound(ordinals.lefts.begin(), ordinals.lefts.end(), interval.left) -
+               ordinals.lefts.begin();
+    for (; i < ordinals.lefts.size(); i++) {
+        if (ordinals.wellFormed && ordinals.lefts[i] > interval.right) break;
+        int32_t k = ordinals.byLeft[i];
+        if (nodes[k].right <= interval.right) (*verdicts)[k] |= verdict;
+    }
+}
+
+// Resolves ids to policy intervals (every node with that ID, as evaluate()
+// compares, and a DAG node's further intervals) and sets verdict on each
+// node they contain
+static void markTree(const std::vector<std::string>& ids, uint8_t verdict,
+                     const std::vector<PolicyNode>& nodes, const TreeOrdinals& ordinals,
+                     std::vector<uint8_t>* verdicts, std::vector<PrefInterval>* intervals) {
+    intervals->clear();
+    for (const std::string& id : ids) {
+        auto it = ordinals.first.find(id);
+        if (it == ordinals.first.end()) continue;
+        for (int32_t o = it->second; o >= 0; o = ordinals.next[o]) {
+            PrefInterval interval = { nodes[o].left, nodes[o].right };
+            intervals->push_back(interval);
+            markInterval(interval, verdict, nodes, ordinals, verdicts);
+            for (const PrefInterval& further : nodes[o].intervals) {
+                intervals->push_back(further);
+                markInterval(further, verdict, nodes, ordinals, verdicts);
+            }
+        }
+    }
+}
+
+void compilePreference(const UserPreference& userPref, const PolicyData& policy,
+                       const PolicyOrdinals& ordinals, CompiledPreference* out) {
+    out->attributeVerdicts.assign(policy.attributes.size(), 0);
+    out->purposeVerdicts.assign(policy.purposes.size(), 0);
+    markTree(userPref.attributeIds, PREF_VERDICT_ALLOW, policy.attributes, ordinals.attributes,
+             &out->attributeVerdicts, &out->allowedAttributes);
+    markTree(userPref.exceptionIds, PREF_VERDICT_EXCEPT, policy.attributes, ordinals.attributes,
+             &out->attributeVerdicts, &out->exceptedAttributes);
+    markTree(userPref.allowedPurposeIds, PREF_VERDICT_ALLOW, policy.purposes, ordinals.purposes,
+             &out->purposeVerdicts, &out->allowedPurposes);
+    markTree(userPref.prohibitedPurposeIds, PREF_VERDICT_EXCEPT, policy.purposes,
+             ordinals.purposes, &out->purposeVerdicts, &out->prohibitedPurposes);
+    out->timeofRetention = userPref.timeofRetention;
+}
+
+// ============================================================================
+// Evaluation
+// ============================================================================
+
+static uint8_t fallbackVerdict(const PolicyNode& node, const std::vector<PrefInterval>& allowed,
+                               const std::vector<PrefInterval>& excepted) {
+    uint8_t verdict = 0;
+    for (const PrefInterval& interval : allowed) {
+        if (interval.left <= node.left && interval.right >= node.right) {
+            verdict |= PREF_VERDICT_ALLOW;
+            break;
+        }
+    }
+    for (const PrefInterval& interval : excepted) {
+        if (interval.left <= node.left && interval.right >= node.right) {
+            verdict |= PREF_VERDICT_EXCEPT;
+            break;
+        }
+    }
+    return verdict;
+}
+
+// OR of the verdicts of every app node; allowed means ALLOW without EXCEPT
+static uint8_t treeVerdict(const std::vector<PolicyNode>& appNodes,
+                           const std::vector<PolicyNode>& nodes, const TreeOrdinals& ordinals,
+                           const std::vector<uint8_t>& verdicts,
+                           const std::vector<PrefInterval>& allowed,
+                           const std::vector<PrefInterval>& excepted) {
+    uint8_t verdict = 0;
+    for (const PolicyNode& node : appNodes) {
+        int32_t o = ordinals.find(node, nodes);
+        verdict |= o >= 0 ? verdicts[o] : fallbackVerdict(node, allowed, excepted);
+        if (verdict & PREF_VERDICT_EXCEPT) break;
+    }
+    return verdict;
+}
+
+EvaluationResult evaluateCompiled(const AppRequest& app, const CompiledPreference& pref,
+                                  const PolicyData& policy, const PolicyOrdinals& ordinals) {
+    if (app.timeofRetention > pref.timeofRetention) return RESULT_DENY;
+    uint8_t attributes = treeVerdict(app.attributes, policy.attributes, ordinals.attributes,
+                                     pref.attributeVerdicts, pref.allowedAttributes,
+                                     pref.exceptedAttributes);
+    if (attributes != PREF_VERDICT_ALLOW) return RESULT_DENY;
+    uint8_t purposes = treeVerdict(app.purposes, policy.purposes, ordinals.purposes,
+                                   pref.purposeVerdicts, pref.allowedPurposes,
+                                   pref.prohibitedPurposes);
+    return purposes == PREF_VERDICT_ALLOW ? RESULT_GRANT : RESULT_DENY;
+}
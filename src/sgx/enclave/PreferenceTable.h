@@ -0,0 +1,74 @@
+#ifndef PREFERENCE_TABLE_H
+#define PREFERENCE_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Enclave.h"
+
+// ============================================================================
+// Compiled Preference Tables
+// ============================================================================
+//
+// evaluate() resolves every preference ID against the policy and compares
+// intervals for each app node, on every request. A preference profile that
+// is evaluated repeatedly can instead be compiled once into a flat verdict
+// table over the policy's node ordinals: entry k holds PREF_VERDICT_ALLOW
+// when an allowed entry contains node k, and PREF_VERDICT_EXCEPT when an
+// exception (which evaluate() also reads for the deny check) contains it.
+// Evaluating an app is then one ordinal lookup and one table read per
+// requested node. App nodes that are not nodes of the policy (unknown ID
+// or different interval) are compared with the resolved preference
+// intervals, as evaluate() would. The decisions are those of evaluate().
+//
+// Enclave builds compiled with PREFERENCE_TABLES (PREFERENCE_TABLES=1
+// ./build.sh) compile a profile, keyed by its user JSON and policy, when
+// the planner (EvaluationPlanner.h) expects it to recur often enough to
+// pay for the build, and keep it in a direct-mapped table of recent
+// profiles.
+
+#define PREF_VERDICT_ALLOW 1
+#define PREF_VERDICT_EXCEPT 2
+
+// Node ID to ordinal for one tree, built once per compiled policy. IDs
+// that occur more than once are chained through next.
+struct TreeOrdinals {
+    std::unordered_map<std::string, int32_t> first;
+    std::vector<int32_t> next;
+    std::vector<int32_t> byLeft;        // ordinals in order of left
+    std::vector<int32_t> lefts;         // left of byLeft[i]
+    bool wellFormed;                    // every node has left <= right
+
+    // Ordinal of the policy node equal to node (ID and interval), or -1
+    int32_t find(const PolicyNode& node, const std::vector<PolicyNode>& nodes) const;
+};
+
+struct PolicyOrdinals {
+    TreeOrdinals attributes;
+    TreeOrdinals purposes;
+};
+
+struct CompiledPreference {
+    std::vector<uint8_t> attributeVerdicts;     // per attribute ordinal
+    std::vector<uint8_t> purposeVerdicts;       // per purpose ordinal
+    // Resolved intervals, for app nodes outside the policy
+    std::vector<PrefInterval> allowedAttributes;
+    std::vector<PrefInterval> exceptedAttributes;
+    std::vector<PrefInterval> allowedPurposes;
+    std::vector<PrefInterval> prohibitedPurposes;
+    int timeofRetention;
+};
+
+void compilePolicyOrdinals(const PolicyData& policy, PolicyOrdinals* out);
+
+void compilePreference(const UserPreference& userPref, const PolicyData& policy,
+                       const PolicyOrdinals& ordinals, CompiledPreference* out);
+
+// Same result as evaluate(app, userPref, policy) for the preference and
+// policy pref was compiled from
+EvaluationResult evaluateCompiled(const AppRequest& app, const CompiledPreference& pref,
+                                  const PolicyData& policy, const PolicyOrdinals& ordinals);
+
+#endif // PREFERENCE_TABLE_H
@@ -0,0 +1,87 @@
+#include "EnclaveCache.h"
+#include "PrivacyEvaluation_edl.h"
+#include "sgx_tseal.h"
+#include <string.h>
+
+// ============================================================================
+// Sealed Snapshot ECALLs
+// ============================================================================
+//
+// Seal the EnclaveCache.h image with a key bound to MRENCLAVE, so only this
+// exact enclave build can restore it: a rebuilt enclave may evaluate
+// differently and must not inherit its predecessor's decisions. The
+// additional authenticated data names the image format. Simulation mode
+// derives the sealing key in software, so the same calls work there.
+
+static const char SNAPSHOT_AAD[] = "privacy-evaluation-snapshot-v3";
+
+static uint32_t sealedSize(size_t plaintextLen) {
+    return sgx_calc_sealed_data_size((uint32_t)sizeof(SNAPSHOT_AAD), (uint32_t)plaintextLen);
+}
+
+// Upper bound on the sealed size of the current caches, for sizing the
+// untrusted buffer. The caches may grow before the seal call; it then
+// returns SNAPSHOT_ERR_BUFFER and the caller retries.
+int ecall_snapshot_size(size_t* size) {
+    std::vector<uint8_t> image;
+    size_t policies, decisions;
+    writeSnapshot(&image, &policies, &decisions);
+    uint32_t sealed = sealedSize(image.size());
+    if (sealed == UINT32_MAX) return SNAPSHOT_ERR_SEAL;
+    *size = sealed;
+    return SNAPSHOT_OK;
+}
+
+int ecall_seal_snapshot(uint8_t* sealed, size_t capacity, size_t* written,
+                        size_t* policies, size_t* decisions) {
+    std::vector<uint8_t> image;
+    writeSnapshot(&image, policies, decisions);
+    uint32_t size = sealedSize(image.size());
+    if (size == UINT32_MAX) return SNAPSHOT_ERR_SEAL;
+    if (size > capacity) {
+        *written = size;
+        return SNAPSHOT_ERR_BUFFER;
+    }
+
+    sgx_attributes_t attributeMask;
+    attributeMask.flags = TSEAL_DEFAULT_FLAGSMASK;
+    attributeMask.xfrm = 0;
+    sgx_status_t status = sgx_seal_data_ex(
+        SGX_KEYPOLICY_MRENCLAVE, attributeMask, TSEAL_DEFAULT_MISCMASK,
+        (uint32_t)sizeof(SNAPSHOT_AAD), reinterpret_cast<const uint8_t*>(SNAPSHOT_AAD),
+        (uint32_t)image.size(), image.data(), size, reinterpret_cast<sgx_sealed_data_t*>(sealed));
+    // The image holds decision keys: do not leave it in freed heap
+    memset(image.data(), 0, image.size());
+    if (status != SGX_SUCCESS) return SNAPSHOT_ERR_SEAL;
+
+    *written = size;
+    return SNAPSHOT_OK;
+}
+
+int ecall_unseal_snapshot(const uint8_t* sealed, size_t length, size_t* policies, size_t* decisions) {
+    *policies = 0;
+    *decisions = 0;
+    const sgx_sealed_data_t* blob = reinterpret_cast<const sgx_sealed_data_t*>(sealed);
+    if (length < sizeof(sgx_sealed_data_t)) return SNAPSHOT_ERR_INVALID;
+
+    uint32_t aadLen = sgx_get_add_mac_txt_len(blob);
+    uint32_t textLen = sgx_get_encrypt_txt_len(blob);
+    if (aadLen != sizeof(SNAPSHOT_AAD) || textLen == UINT32_MAX ||
+        sealedSize(textLen) != length) {
+        return SNAPSHOT_ERR_INVALID;
+    }
+
+    std::vector<uint8_t> image(textLen);
+    uint8_t aad[sizeof(SNAPSHOT_AAD)];
+    uint32_t outAadLen = aadLen;
+    uint32_t outTextLen = textLen;
+    // Checks the MAC over the image and the AAD
+    if (sgx_unseal_data(blob, aad, &outAadLen, image.data(), &outTextLen) != SGX_SUCCESS) {
+        return SNAPSHOT_ERR_SEAL;
+    }
+    if (memcmp(aad, SNAPSHOT_AAD, sizeof(SNAPSHOT_AAD)) != 0) return SNAPSHOT_ERR_INVALID;
+
+    bool loaded = loadSnapshot(image.data(), outTextLen, policies, decisions);
+    memset(image.data(), 0, image.size());
+    return loaded ? SNAPSHOT_OK : SNAPSHOT_ERR_INVALID;
+}
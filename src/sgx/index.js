@@ -5,6 +5,7 @@
  * privacy compliance evaluation.
  */
 
+import crypto from "crypto";
 import path from "path";
 import { fileURLToPath } from "url";
 
@@ -13,6 +14,98 @@ const __dirname = path.dirname(__filename);
 
 let addon = null;
 let enclaveInitialized = false;
+let daemonConnected = false;
+
+// Dispatcher result codes (EvaluationResult in enclave/Enclave.h)
+const RESULT_OVERLOAD = -2;
+const RESULT_EXPIRED = -3;
+const RESULT_UNAUTHENTICATED = -4;
+
+// Sealed snapshot of the enclave caches, restored on start and saved on a
+// timer and at shutdown
+const SNAPSHOT_PATH = process.env.SGX_SNAPSHOT_PATH;
+const SNAPSHOT_INTERVAL_MS = Number(process.env.SGX_SNAPSHOT_INTERVAL_MS) || 0;
+
+/**
+ * Load the native addon once; also used by APIs that do not need the enclave
+ */
+function loadAddon() {
+  if (!addon) {
+    const addonPath = path.join(__dirname, "build", "Release", "sgx-addon.node");
+    addon = require(addonPath);
+  }
+  return addon;
+}
+
+function inputMismatch(message) {
+  const error = new Error(message);
+  error.code = "SGX_INPUT_MISMATCH";
+  return error;
+}
+
+/**
+ * Shape an addon result for evaluate() / evaluateEncrypted(). A requested
+ * digest that is missing or all zeros (the enclave could not hash, or it was
+ * blanked in untrusted memory) fails closed: nothing binds the decision to
+ * its inputs.
+ */
+function withDigest(result, options) {
+  const granted = result.result === "grant";
+  if (!options.digest) return granted;
+  if (!result.digest || /^0+$/.test(result.digest)) {
+    throw inputMismatch("Enclave returned no input digest");
+  }
+  return { granted, inputDigest: result.digest };
+}
+
+// SHA-256 of recent policies' JSON by policy version, so verifying a digest
+// only hashes the request's own app and preference text
+const POLICY_DIGESTS = 16;
+const policyDigests = new Map();
+
+function policyDigest(policyJson, policyVersion) {
+  if (policyVersion === undefined) {
+    return crypto.createHash("sha256").update(policyJson).digest();
+  }
+  // The length guards against a policy edited without a version bump
+  const key = `${policyVersion}:${policyJson.length}`;
+  let digest = policyDigests.get(key);
+  if (!digest) {
+    digest = crypto.createHash("sha256").update(policyJson).digest();
+    if (policyDigests.size >= POLICY_DIGESTS) {
+      policyDigests.delete(policyDigests.keys().next().value);
+    }
+    policyDigests.set(key, digest);
+  }
+  return digest;
+}
+
+/**
+ * SHA-256 of an evaluation's inputs, computed the way the enclave does
+ * (INPUT_DIGEST_LEN in enclave/EnclaveCache.h), for checking the digest
+ * evaluate() returns against the JSON that was sent
+ * @param {string} appJson
+ * @param {string} userJson - The privacyPreference JSON
+ * @param {string} policyJson
+ * @param {string} [policyVersion] - When given, the policy's own hash is
+ *   kept per version instead of recomputed
+ * @returns {string} - hex digest
+ */
+export function inputDigest(appJson, userJson, policyJson, policyVersion) {
+  const length = (text) => {
+    const buffer = Buffer.alloc(4);
+    buffer.writeUInt32LE(Buffer.byteLength(text));
+    return buffer;
+  };
+  return crypto
+    .createHash("sha256")
+    .update(policyDigest(policyJson, policyVersion))
+    .update(length(appJson))
+    .update(appJson)
+    .update(length(userJson))
+    .update(userJson)
+    .digest("hex");
+}
 
 /**
  * SGX Privacy Evaluator Class
@@ -20,6 +113,7 @@ let enclaveInitialized = false;
 class SGXPrivacyEvaluator {
   constructor() {
     this.initialized = false;
+    this.snapshotTimer = null;
   }
 
   /**
@@ -33,8 +127,7 @@ class SGXPrivacyEvaluator {
 
     try {
       // Try to load the native addon
-      const addonPath = path.join(__dirname, "build", "Release", "sgx-addon.node");
-      addon = require(addonPath);
+      loadAddon();
 
       // Initialize enclave
       const success = addon.initializeEnclave();
@@ -42,6 +135,9 @@ class SGXPrivacyEvaluator {
         this.initialized = true;
         enclaveInitialized = true;
         console.log("[SGX] Enclave initialized successfully");
+        if (SNAPSHOT_PATH) {
+          this.restoreSnapshot();
+        }
         return true;
       } else {
         console.error("[SGX] Failed to initialize enclave");
@@ -59,9 +155,24 @@ class SGXPrivacyEvaluator {
    * @param {Object} app - Application data (attributes, purposes, timeofRetention)
    * @param {Object} user - User object with privacyPreference
    * @param {Object} policy - Privacy policy with hierarchical attributes and purposes
-   * @returns {Promise<boolean>} - true if granted, false if denied
+   * @param {Object} options - { deadlineMs, priority, digest }: give up if no
+   *   answer by deadlineMs; priority "realtime" (device checks, default) or
+   *   "bulk" (audits) selects the dispatcher lane; digest true also returns
+   *   the enclave's SHA-256 of the inputs it evaluated (see inputDigest()),
+   *   after checking it against the JSON sent
+   * @returns {Promise<boolean|Object>} - true if granted, false if denied;
+   *   with options.digest, { granted, inputDigest } where inputDigest is hex,
+   *   or null through the evaluation daemon, which returns no digest
+   * @throws {Error} with code SGX_OVERLOAD or SGX_DEADLINE_EXPIRED when the
+   *   native queue cannot answer before the deadline, or SGX_INPUT_MISMATCH
+   *   when the enclave's digest is missing or not that of the JSON sent
    */
-  async evaluate(app, user, policy) {
+  async evaluate(app, user, policy, options = {}) {
+    if (daemonConnected) {
+      const granted = await this.evaluateViaDaemon(app, user, policy);
+      return options.digest ? { granted, inputDigest: null } : granted;
+    }
+
     if (!this.initialized) {
       const initialized = await this.initialize();
       if (!initialized) {
@@ -79,26 +190,493 @@ class SGXPrivacyEvaluator {
       const userJson = JSON.stringify(user.privacyPreference);
       const policyJson = JSON.stringify(policy);
 
-      // 2. Call into enclave via native addon
-      const result = addon.evaluatePrivacy(appJson, userJson, policyJson);
+      // 2. Call into enclave via native addon. Concurrent calls are
+      //    micro-batched into one ECALL by the native dispatcher.
+      const dispatchOptions = {};
+      if (options.deadlineMs > 0) {
+        dispatchOptions.deadlineUs = options.deadlineMs * 1000;
+      }
+      if (options.priority) {
+        dispatchOptions.priority = options.priority;
+      }
+      if (options.digest) {
+        dispatchOptions.digest = true;
+      }
+      const result = addon.evaluatePrivacyAsync
+        ? await addon.evaluatePrivacyAsync(appJson, userJson, policyJson, dispatchOptions)
+        : addon.evaluatePrivacy(appJson, userJson, policyJson);
+
+      if (result.code === RESULT_OVERLOAD || result.code === RESULT_EXPIRED) {
+        const error = new Error(`Enclave queue cannot meet deadline: ${result.result}`);
+        error.code = result.code === RESULT_OVERLOAD ? "SGX_OVERLOAD" : "SGX_DEADLINE_EXPIRED";
+        throw error;
+      }
 
       if (!result.success) {
         throw new Error(`Enclave evaluation failed with code: ${result.code}`);
       }
 
-      // 3. Return result as boolean
-      return result.result === "grant";
+      // 3. Return result as boolean, with the digest only if the enclave
+      //    evaluated exactly what was sent
+      const evaluation = withDigest(result, options);
+      if (
+        options.digest &&
+        evaluation.inputDigest !== inputDigest(appJson, userJson, policyJson, policy.version)
+      ) {
+        throw inputMismatch("Enclave evaluated different inputs than were sent");
+      }
+      return evaluation;
     } catch (error) {
-      console.error("[SGX] Evaluation error:", error.message);
+      if (!error.code) {
+        console.error("[SGX] Evaluation error:", error.message);
+      }
+      throw error;
+    }
+  }
+
+  /**
+   * Open an encrypted request channel (see channel.js for the client side)
+   * @param {Buffer} clientPublicKey - Uncompressed P-256 point
+   * @returns {Object} - { sessionId, enclavePublicKey }
+   */
+  openSecureChannel(clientPublicKey) {
+    if (!this.initialized) {
+      throw new Error("SGX enclave not initialized");
+    }
+    return addon.openSecureChannel(clientPublicKey);
+  }
+
+  /**
+   * Forget a channel's session key
+   * @returns {boolean} - false if the session was unknown
+   */
+  closeSecureChannel(sessionId) {
+    return addon ? addon.closeSecureChannel(sessionId) : false;
+  }
+
+  /**
+   * Evaluate a request whose app and preference JSON are AES-GCM sealed
+   * under a channel session; they are decrypted only inside the enclave
+   * @param {number} sessionId - From openSecureChannel
+   * @param {Buffer} sealed - SecureChannelClient.seal() output
+   * @param {Object} policy - Privacy policy (not encrypted)
+   * @param {Object} options - { deadlineMs, priority, digest } as for evaluate()
+   * @returns {Promise<boolean|Object>} - as for evaluate(); the digest covers
+   *   the decrypted app and preference JSON
+   * @throws {Error} with code SGX_UNAUTHENTICATED when the request does not
+   *   decrypt (tampered, or unknown session), or as for evaluate()
+   */
+  async evaluateEncrypted(sessionId, sealed, policy, options = {}) {
+    if (!this.initialized) {
+      throw new Error("SGX enclave not initialized");
+    }
+
+    const dispatchOptions = {};
+    if (options.deadlineMs > 0) {
+      dispatchOptions.deadlineUs = options.deadlineMs * 1000;
+    }
+    if (options.priority) {
+      dispatchOptions.priority = options.priority;
+    }
+    if (options.digest) {
+      dispatchOptions.digest = true;
+    }
+    const result = await addon.evaluateEncryptedAsync(
+      sessionId,
+      sealed,
+      JSON.stringify(policy),
+      dispatchOptions
+    );
+
+    if (result.code === RESULT_UNAUTHENTICATED) {
+      const error = new Error("Enclave rejected the sealed request");
+      error.code = "SGX_UNAUTHENTICATED";
       throw error;
     }
+    if (result.code === RESULT_OVERLOAD || result.code === RESULT_EXPIRED) {
+      const error = new Error(`Enclave queue cannot meet deadline: ${result.result}`);
+      error.code = result.code === RESULT_OVERLOAD ? "SGX_OVERLOAD" : "SGX_DEADLINE_EXPIRED";
+      throw error;
+    }
+    if (!result.success) {
+      throw new Error(`Enclave evaluation failed with code: ${result.code}`);
+    }
+    return withDigest(result, options);
+  }
+
+  /**
+   * Share the host's evaluation daemon (npm run eval-daemon) instead of an
+   * in-process enclave; evaluate() goes through it from then on
+   * @param {string} socketPath - Daemon socket (default /tmp/privacy-evald.sock)
+   * @returns {boolean} - true once connected
+   */
+  connectDaemon(socketPath) {
+    try {
+      loadAddon().connectDaemon(socketPath);
+      daemonConnected = true;
+      console.log(`[SGX] Connected to evaluation daemon ${socketPath || ""}`.trim());
+      return true;
+    } catch (error) {
+      console.error("[SGX] Failed to connect to evaluation daemon:", error.message);
+      return false;
+    }
+  }
+
+  /**
+   * Evaluate through the daemon. Concurrent calls are coalesced into one
+   * request frame and pipelined on a single connection.
+   * @returns {Promise<boolean>} - true if granted, false if denied
+   * @throws {Error} with code EVAL_DAEMON_UNAVAILABLE if the daemon is gone
+   */
+  async evaluateViaDaemon(app, user, policy) {
+    const code = await addon.daemonEvaluate(
+      JSON.stringify(app),
+      JSON.stringify(user.privacyPreference),
+      JSON.stringify(policy)
+    );
+    if (code < 0) {
+      throw new Error(`Daemon evaluation failed with code: ${code}`);
+    }
+    return code === 1;
+  }
+
+  /**
+   * Daemon counters: connections, frames, records per engine batch, cache hits
+   * @returns {Promise<Object|null>}
+   */
+  async getDaemonStats() {
+    if (!daemonConnected) {
+      return null;
+    }
+    return JSON.parse(await addon.getDaemonStats());
+  }
+
+  /**
+   * Close the daemon connection; pending evaluations reject
+   */
+  disconnectDaemon() {
+    if (daemonConnected) {
+      addon.disconnectDaemon();
+      daemonConnected = false;
+    }
+  }
+
+  /**
+   * Attach to the host-wide shared-memory decision cache, creating it if
+   * this is the first validator on the host
+   * @param {Object} options - { name, capacity }: segment name
+   *   (default /privacy-decisions) and entries for a new segment
+   * @returns {Object|null} - { created, capacity, segmentBytes }, or null if
+   *   the addon is unavailable
+   */
+  openSharedCache(options = {}) {
+    try {
+      return loadAddon().openSharedCache(options);
+    } catch (error) {
+      console.error("[SGX] Shared decision cache unavailable:", error.message);
+      return null;
+    }
+  }
+
+  /**
+   * Look up a cached decision
+   * @param {string} key - Request key (user + app + preference hash)
+   * @param {string|number} policyVersion - Entries of other versions miss
+   * @returns {string|null} - "grant", "deny", or null on a miss
+   */
+  sharedCacheGet(key, policyVersion) {
+    const code = addon.sharedCacheGet(key, policyVersion);
+    if (code === null) {
+      return null;
+    }
+    return code === 1 ? "grant" : "deny";
+  }
+
+  /**
+   * Cache a decision until ttlSeconds (the user's timeofRetention) pass
+   * @returns {boolean} - false if it could not be stored
+   */
+  sharedCacheSet(key, policyVersion, result, ttlSeconds) {
+    return addon.sharedCacheSet(key, policyVersion, result === "grant" ? 1 : 0, ttlSeconds);
+  }
+
+  /**
+   * Invalidate every shared cache entry on the host
+   */
+  clearSharedCache() {
+    if (addon && addon.clearSharedCache) {
+      addon.clearSharedCache();
+    }
+  }
+
+  /**
+   * Hits, misses, evictions and crash recoveries across all validators
+   * @returns {Object|null}
+   */
+  getSharedCacheStats() {
+    if (!addon || !addon.getSharedCacheStats) {
+      return null;
+    }
+    return addon.getSharedCacheStats();
+  }
+
+  /**
+   * Detach from the shared cache
+   * @param {Object} options - { remove: true } also deletes the segment
+   */
+  closeSharedCache(options = {}) {
+    if (addon && addon.closeSharedCache) {
+      addon.closeSharedCache(options);
+    }
+  }
+
+  /**
+   * Enable the per-process decision cache, whose entries are evicted by a
+   * timing wheel when their retention window ends
+   * @param {Object} options - { capacity, bloomFilter }: maximum live entries
+   *   (default 1M); bloomFilter: false always probes the table
+   * @returns {boolean} - false if the addon is unavailable
+   */
+  enableDecisionCache(options = {}) {
+    try {
+      loadAddon().configureDecisionCache(options);
+      return true;
+    } catch (error) {
+      console.error("[SGX] Decision cache unavailable:", error.message);
+      return false;
+    }
+  }
+
+  /**
+   * Look up a decision in the per-process cache
+   * @param {string} key - Request key (user + app + preference hash)
+   * @param {string|number} policyVersion - Entries of other versions miss
+   * @param {Object} options - { digest }: also return the stored input digest
+   * @returns {string|Object|null} - "grant", "deny", or null on a miss; with
+   *   options.digest, { result, inputDigest } (inputDigest hex or null)
+   */
+  decisionCacheGet(key, policyVersion, options = {}) {
+    if (options.digest) {
+      const hit = addon.decisionCacheGet(key, policyVersion, true);
+      if (hit === null) {
+        return null;
+      }
+      return { result: hit.code === 1 ? "grant" : "deny", inputDigest: hit.digest };
+    }
+    const code = addon.decisionCacheGet(key, policyVersion);
+    if (code === null) {
+      return null;
+    }
+    return code === 1 ? "grant" : "deny";
+  }
+
+  /**
+   * Cache a decision for ttlSeconds (the user's timeofRetention), with the
+   * enclave's input digest when there is one
+   * @returns {boolean} - false if it was not stored (cache full)
+   */
+  decisionCacheSet(key, policyVersion, result, ttlSeconds, inputDigest = null) {
+    const code = result === "grant" ? 1 : 0;
+    return inputDigest
+      ? addon.decisionCacheSet(key, policyVersion, code, ttlSeconds, inputDigest)
+      : addon.decisionCacheSet(key, policyVersion, code, ttlSeconds);
+  }
+
+  /**
+   * Drop every entry of the per-process cache
+   */
+  clearDecisionCache() {
+    if (addon && addon.clearDecisionCache) {
+      addon.clearDecisionCache();
+    }
+  }
+
+  /**
+   * Live entries, estimated bytes, hits, expirations and Bloom filter
+   * skips / false positives of the per-process cache
+   * @returns {Object|null}
+   */
+  getDecisionCacheStats() {
+    if (!addon || !addon.getDecisionCacheStats) {
+      return null;
+    }
+    return addon.getDecisionCacheStats();
+  }
+
+  /**
+   * Tune the micro-batching dispatcher
+   * @param {Object} options - { workers, strictPriority, adaptive,
+   *   defaultDeadlineUs, admissionControl, lanes: { realtime, bulk } }; each
+   *   lane takes { maxBatchSize, maxWaitUs, sloP99Us, maxConcurrency, weight }
+   */
+  configureBatching(options) {
+    if (addon && addon.configureDispatcher) {
+      addon.configureDispatcher(options);
+    }
+  }
+
+  /**
+   * Dispatcher metrics: per-lane batch-size, queueing-delay and latency histograms
+   * @param {boolean} reset - Clear the counters after reading them
+   * @returns {Object|null}
+   */
+  getBatchingStats(reset = false) {
+    if (!addon || !addon.getDispatcherStats) {
+      return null;
+    }
+    return addon.getDispatcherStats(reset);
+  }
+
+  /**
+   * How often each stage of the enclave's evaluation (retention, attributes,
+   * purposes) ran and settled a decision as deny, plus grants and how many
+   * decisions checked purposes before attributes
+   * @param {boolean} reset - Clear the counters after reading them
+   * @returns {Object|null}
+   */
+  getEvaluationStages(reset = false) {
+    if (!this.initialized || !addon || !addon.getEvaluationStages) {
+      return null;
+    }
+    return addon.getEvaluationStages(reset);
+  }
+
+  /**
+   * Evaluate one app request against many users on the native work-stealing
+   * pool (policy re-evaluation, audits). Bypasses the batching dispatcher.
+   * @param {Object|Object[]} app - One app for every user, or one per user
+   * @param {Object[]} users - User objects with privacyPreference
+   * @param {Object} policy - Privacy policy
+   * @param {Object} options - { chunk }: records packed into one ECALL
+   * @returns {Promise<Int32Array>} - EvaluationResult code per user
+   *   (1 grant, 0 deny, -1 error)
+   */
+  async evaluateBulk(app, users, policy, options = {}) {
+    if (!this.initialized) {
+      const initialized = await this.initialize();
+      if (!initialized) {
+        throw new Error("SGX enclave not initialized");
+      }
+    }
+
+    if (!addon || !addon.evaluateBulk) {
+      throw new Error("Native addon not loaded");
+    }
+
+    const appJson = Array.isArray(app) ? app.map((a) => JSON.stringify(a)) : JSON.stringify(app);
+    const userJsons = users.map((user) => JSON.stringify(user.privacyPreference));
+    const result = await addon.evaluateBulk(appJson, userJsons, JSON.stringify(policy), options);
+    if (result.ecallFailures > 0) {
+      console.error(`[SGX] ${result.ecallFailures} bulk ECALLs failed`);
+    }
+    return result.codes;
+  }
+
+  /**
+   * Resize the native bulk thread pool
+   * @param {Object} options - { threads, pinCores }; threads includes the
+   *   calling thread
+   * @returns {Object|null} - Effective { threads, pinCores }
+   */
+  configureBulkPool(options) {
+    if (!addon || !addon.configureBulkPool) {
+      return null;
+    }
+    return addon.configureBulkPool(options);
+  }
+
+  /**
+   * Offline compliance audit: stream an NDJSON file of { id, app, user }
+   * records through the native pipeline and write one decision per line.
+   * Evaluates outside the enclave against a policy snapshot file.
+   * @param {Object} options - { policy, input, output } file paths,
+   *   optional { columnar, batchMb, chunkKb }; columnar also writes a
+   *   compact column file with per-check reason bits
+   * @returns {Promise<Object>} - { records, grants, denies, errors,
+   *   recordsPerSec, peakRssKb, ... }
+   */
+  async auditNdjson(options) {
+    return loadAddon().auditNdjson(options);
+  }
+
+  /**
+   * Count rows of a decision export where a boolean column is set
+   * @param {Object} options - { path, format: "columnar" | "jsonl", column }
+   *   e.g. column "decision", "retention", "attr_excepted"
+   * @returns {Object} - { rows, matches, openMs, scanMs }
+   */
+  scanDecisions(options) {
+    return loadAddon().scanDecisions(options);
+  }
+
+  /**
+   * Seal the enclave's compiled policies and decision cache to a file that
+   * only this enclave build can restore
+   * @param {string} snapshotPath - Defaults to SGX_SNAPSHOT_PATH
+   * @returns {Object} - { bytes, policies, decisions, sealMs }
+   */
+  saveSnapshot(snapshotPath = SNAPSHOT_PATH) {
+    return addon.saveEnclaveSnapshot(snapshotPath);
+  }
+
+  /**
+   * Replace the enclave caches with a sealed snapshot
+   * @param {string} snapshotPath - Defaults to SGX_SNAPSHOT_PATH
+   * @returns {Object|null} - { bytes, policies, decisions, unsealMs }, or
+   *   null if there is no snapshot yet
+   * @throws {Error} if the snapshot is corrupt or from another enclave build
+   */
+  loadSnapshot(snapshotPath = SNAPSHOT_PATH) {
+    return addon.loadEnclaveSnapshot(snapshotPath);
+  }
+
+  /**
+   * Restore SGX_SNAPSHOT_PATH after initialization and schedule saves every
+   * SGX_SNAPSHOT_INTERVAL_MS. A snapshot that does not unseal (e.g. after an
+   * enclave upgrade) is skipped: the caches start cold.
+   */
+  restoreSnapshot() {
+    try {
+      const restored = this.loadSnapshot();
+      if (restored) {
+        console.log(
+          `[SGX] Restored ${restored.policies} policies and ${restored.decisions} decisions ` +
+            `in ${restored.unsealMs.toFixed(1)} ms`
+        );
+      }
+    } catch (error) {
+      console.warn("[SGX] Ignoring enclave snapshot:", error.message);
+    }
+
+    if (SNAPSHOT_INTERVAL_MS > 0 && !this.snapshotTimer) {
+      this.snapshotTimer = setInterval(() => {
+        try {
+          this.saveSnapshot();
+        } catch (error) {
+          console.warn("[SGX] Enclave snapshot failed:", error.message);
+        }
+      }, SNAPSHOT_INTERVAL_MS);
+      this.snapshotTimer.unref();
+    }
   }
 
   /**
    * Destroy the SGX enclave and free resources
+   * Saves SGX_SNAPSHOT_PATH first when configured
    */
   destroy() {
+    if (this.snapshotTimer) {
+      clearInterval(this.snapshotTimer);
+      this.snapshotTimer = null;
+    }
     if (addon && this.initialized) {
+      if (SNAPSHOT_PATH) {
+        try {
+          this.saveSnapshot();
+        } catch (error) {
+          console.warn("[SGX] Enclave snapshot failed:", error.message);
+        }
+      }
       addon.destroyEnclave();
       this.initialized = false;
       enclaveInitialized = false;
@@ -117,6 +695,12 @@ const sgxEvaluator = new SGXPrivacyEvaluator();
  */
 async function autoInit() {
   const sgxEnabled = process.env.SGX_ENABLED === "true";
+  if (sgxEnabled && process.env.SGX_DAEMON_SOCKET) {
+    // One daemon per host owns the enclave; fall back to a private one
+    if (sgxEvaluator.connectDaemon(process.env.SGX_DAEMON_SOCKET)) {
+      return;
+    }
+  }
   if (sgxEnabled && !enclaveInitialized) {
     await sgxEvaluator.initialize();
   }
@@ -131,7 +715,7 @@ autoInit().catch((err) => {
  * Check if SGX is available and initialized
  */
 export function isSGXAvailable() {
-  return enclaveInitialized && sgxEvaluator.initialized;
+  return daemonConnected || (enclaveInitialized && sgxEvaluator.initialized);
 }
 
 /**
@@ -0,0 +1,186 @@
+// eval-daemon: host-local privacy evaluation service on a Unix socket
+//
+// Usage:
+//   eval-daemon [--socket /tmp/privacy-evald.sock] [--engine enclave|native]
+//               [--enclave enclave.signed.so] [--ecall-threads N]
+//               [--cache-entries N] [--max-connections N]
+//               [--prefetch-distance N]
+//
+// Validators on the host connect through the addon client (connectDaemon in
+// src/sgx/index.js) instead of each loading its own enclave, policy and
+// cache. SIGINT / SIGTERM close the connections, remove the socket and print
+// the counters to stderr.
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "sgx_urts.h"
+#include "PrivacyEvaluation_u.h"
+#include "../core/EvalDaemon.h"
+
+// Records packed into one ECALL
+#define ENCLAVE_CHUNK 512
+// Enclave.config.xml TCSNum; the daemon owns the whole enclave
+#define DEFAULT_ECALL_THREADS 24
+
+// ============================================================================
+// Enclave Engine
+// ============================================================================
+
+class EnclaveEvalEngine : public EvalEngine {
+public:
+    EnclaveEvalEngine(sgx_enclave_id_t eid, int maxEcalls) : eid_(eid), maxEcalls_(maxEcalls) {}
+
+    const char* name() const override { return "enclave"; }
+
+    bool evaluate(const EvalRecordView* const* records, size_t count, int8_t* codes) override {
+        std::string packed;
+        std::vector<int> results;
+        for (size_t begin = 0; begin < count; begin += ENCLAVE_CHUNK) {
+            size_t end = begin + ENCLAVE_CHUNK < count ? begin + ENCLAVE_CHUNK : count;
+            packed.clear();
+            for (size_t i = begin; i < end; i++) {
+                const EvalRecordView& record = *records[i];
+                packed.append(record.app, record.appLen).push_back('\0');
+                packed.append(record.user, record.userLen).push_back('\0');
+                packed.append(record.policy, record.policyLen).push_back('\0');
+            }
+            results.assign(end - begin, RESULT_ERROR);
+
+            int evaluated = RESULT_ERROR;
+            acquire();
+            sgx_status_t status = ecall_evaluate_privacy_batch(eid_, &evaluated,
+                                                               packed.data(), packed.size(),
+                                                               end - begin, results.data(),
+                                                               nullptr, 0);
+            release();
+            if (status != SGX_SUCCESS || evaluated < 0) return false;
+            for (size_t i = begin; i < end; i++) codes[i] = (int8_t)results[i - begin];
+        }
+        return true;
+    }
+
+private:
+    // Connection threads beyond the TCS count wait here instead of failing
+    void acquire() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return inUse_ < maxEcalls_; });
+        inUse_++;
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            inUse_--;
+        }
+        cv_.notify_one();
+    }
+
+    sgx_enclave_id_t eid_;
+    int maxEcalls_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    int inUse_ = 0;
+};
+
+// ============================================================================
+// Main
+// ============================================================================
+
+static EvalDaemon* runningDaemon = nullptr;
+
+static void onSignal(int) {
+    if (runningDaemon) runningDaemon->stop();
+}
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [--socket path] [--engine enclave|native] [--enclave enclave.signed.so]\n"
+            "       [--ecall-threads N] [--cache-entries N] [--max-connections N]\n"
+            "       [--prefetch-distance N]\n",
+            program);
+}
+
+int main(int argc, char** argv) {
+    EvalDaemonConfig config;
+    std::string engineName = "enclave";
+    std::string enclavePath = "enclave.signed.so";
+    int ecallThreads = DEFAULT_ECALL_THREADS;
+    size_t prefetchDistance = LAYOUT_PREFETCH_DISTANCE;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--help") == 0) {
+            usage(argv[0]);
+            return 0;
+        }
+        if (!value) {
+            usage(argv[0]);
+            return 2;
+        }
+
+        if (strcmp(arg, "--socket") == 0) config.socketPath = value;
+        else if (strcmp(arg, "--engine") == 0) engineName = value;
+        else if (strcmp(arg, "--enclave") == 0) enclavePath = value;
+        else if (strcmp(arg, "--ecall-threads") == 0) ecallThreads = atoi(value);
+        else if (strcmp(arg, "--cache-entries") == 0) config.cacheEntries = (size_t)atoll(value);
+        else if (strcmp(arg, "--max-connections") == 0) config.maxConnections = (size_t)atoi(value);
+        else if (strcmp(arg, "--prefetch-distance") == 0) prefetchDistance = (size_t)atoi(value);
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    if ((engineName != "enclave" && engineName != "native") || ecallThreads < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    sgx_enclave_id_t eid = 0;
+    EvalEngine* engine = nullptr;
+    if (engineName == "enclave") {
+        sgx_launch_token_t token = {0};
+        int updated = 0;
+        sgx_status_t status = sgx_create_enclave(enclavePath.c_str(), SGX_DEBUG_FLAG,
+                                                 &token, &updated, &eid, NULL);
+        if (status != SGX_SUCCESS) {
+            fprintf(stderr, "eval-daemon: cannot create enclave %s (status 0x%x)\n",
+                    enclavePath.c_str(), (unsigned)status);
+            return 1;
+        }
+        engine = new EnclaveEvalEngine(eid, ecallThreads);
+    } else {
+        engine = new NativeEvalEngine(prefetchDistance);
+    }
+
+    EvalDaemon daemon(engine, config);
+    std::string error;
+    if (!daemon.listen(&error)) {
+        fprintf(stderr, "eval-daemon: %s\n", error.c_str());
+        return 1;
+    }
+
+    runningDaemon = &daemon;
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    fprintf(stderr, "eval-daemon: %s engine on %s\n", engine->name(), config.socketPath.c_str());
+    daemon.serve();
+    runningDaemon = nullptr;
+
+    fprintf(stderr, "eval-daemon: %s\n", daemon.statsJson().c_str());
+    delete engine;
+    if (eid) sgx_destroy_enclave(eid);
+    return 0;
+}
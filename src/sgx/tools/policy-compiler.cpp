@@ -0,0 +1,209 @@
+// policy-compiler: generate a specialized evaluator header from a policy
+//
+// Usage:
+//   policy-compiler --policy policy.json [--output core/GeneratedPolicy.h]
+//                   [--name GeneratedPolicy]
+//
+// The policy is the document (or a mongoexport array whose first element
+// is it) with nested-set attributes and purposes. Trees only: a DAG policy
+// (nodes with intervals) is left to evaluate(). The header defines the
+// Policy type for SpecializedEvaluator (core/SpecializedPolicy.h); build
+// with SPECIALIZED_POLICY=1 to evaluate that policy through it.
+
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "../core/EvaluationInput.h"
+#include "../core/SpecializedPolicy.h"
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s --policy policy.json [--output core/GeneratedPolicy.h]\n"
+            "       [--name GeneratedPolicy]\n",
+            program);
+}
+
+static bool readFile(const std::string& path, std::string* out) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) out->append(buffer, n);
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+static bool validIdentifier(const std::string& name) {
+    if (name.empty() || !(isalpha((unsigned char)name[0]) || name[0] == '_')) return false;
+    for (char c : name) {
+        if (!(isalnum((unsigned char)c) || c == '_')) return false;
+    }
+    return true;
+}
+
+// C++ string literal; IDs are ObjectIds in practice, but escape anyway
+static std::string literal(const std::string& s) {
+    std::string out = "\"";
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += (char)c;
+        } else if (c < 0x20 || c >= 0x7F) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\%03o", c);
+            out += escaped;
+        } else {
+            out += (char)c;
+        }
+    }
+    return out + "\"";
+}
+
+static bool checkTree(const std::vector<PolicyNode>& nodes, const char* kind, std::string* error) {
+    if (nodes.empty() || nodes.size() > SPEC_MAX_NODES) {
+        *error = std::string("policy ") + kind + " must hold 1 to " +
+                 std::to_string(SPEC_MAX_NODES) + " nodes";
+        return false;
+    }
+    std::set<std::string> seen;
+    for (const PolicyNode& node : nodes) {
+        if (!seen.insert(node.id).second) {
+            *error = std::string("duplicate ") + kind + " id " + node.id;
+            return false;
+        }
+        if (!node.intervals.empty()) {
+            *error = std::string(kind) + " " + node.id + " has intervals: DAG policies are not specialized";
+            return false;
+        }
+        if (node.left > node.right) {
+            *error = std::string(kind) + " " + node.id + " has left > right";
+            return false;
+        }
+    }
+    return true;
+}
+
+// One Tree type: the constexpr node table and an ordinal() switch whose
+// case labels are computed by the compiler. IDs whose hashes collide share
+// a case and are told apart by comparison.
+static void writeTree(FILE* out, const char* type, const std::vector<PolicyNode>& nodes) {
+    fprintf(out, "    struct %s {\n", type);
+    fprintf(out, "        static constexpr size_t kCount = %zu;\n", nodes.size());
+    fprintf(out, "        static constexpr SpecNode kNodes[kCount] = {\n");
+    for (const PolicyNode& node : nodes) {
+        fprintf(out, "            { %s, %d, %d },\n", literal(node.id).c_str(), node.left, node.right);
+    }
+    fprintf(out, "        };\n\n");
+
+    std::map<uint64_t, std::vector<size_t>> byHash;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        byHash[specIdHash(nodes[i].id.data(), nodes[i].id.size())].push_back(i);
+    }
+    fprintf(out, "        static int ordinal(const std::string& id) {\n");
+    fprintf(out, "            switch (specIdHash(id.data(), id.size())) {\n");
+    for (const auto& entry : byHash) {
+        const std::vector<size_t>& ordinals = entry.second;
+        fprintf(out, "            case specIdHash(%s):\n", literal(nodes[ordinals[0]].id).c_str());
+        for (size_t i : ordinals) {
+            fprintf(out, "                if (id == %s) return %zu;\n", literal(nodes[i].id).c_str(), i);
+        }
+        fprintf(out, "                return -1;\n");
+    }
+    fprintf(out, "            default:\n");
+    fprintf(out, "                return -1;\n");
+    fprintf(out, "            }\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "    };\n");
+}
+
+int main(int argc, char** argv) {
+    std::string policyPath;
+    std::string outputPath = "core/GeneratedPolicy.h";
+    std::string name = "GeneratedPolicy";
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--help") == 0) {
+            usage(argv[0]);
+            return 0;
+        }
+        if (!value) {
+            usage(argv[0]);
+            return 2;
+        }
+
+        if (strcmp(arg, "--policy") == 0) policyPath = value;
+        else if (strcmp(arg, "--output") == 0) outputPath = value;
+        else if (strcmp(arg, "--name") == 0) name = value;
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+
+    if (policyPath.empty() || !validIdentifier(name)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::string text;
+    if (!readFile(policyPath, &text)) {
+        fprintf(stderr, "policy-compiler: cannot read %s\n", policyPath.c_str());
+        return 1;
+    }
+    JsonValue json;
+    const char* parseError = nullptr;
+    if (!parseJson(text.data(), text.data() + text.size(), &json, &parseError)) {
+        fprintf(stderr, "policy-compiler: %s: %s\n", policyPath.c_str(), parseError);
+        return 1;
+    }
+    PolicyIndex index;
+    std::string error;
+    if (!index.load(json, &error) ||
+        !checkTree(index.policy().attributes, "attributes", &error) ||
+        !checkTree(index.policy().purposes, "purposes", &error)) {
+        fprintf(stderr, "policy-compiler: %s\n", error.c_str());
+        return 1;
+    }
+
+    const JsonValue* doc = json.isArray() ? &json.items[0] : &json;
+    const JsonValue* version = doc->get("version");
+    std::string versionText = version && version->isString() ? version->string : "";
+
+    FILE* out = fopen(outputPath.c_str(), "w");
+    if (!out) {
+        fprintf(stderr, "policy-compiler: cannot write %s\n", outputPath.c_str());
+        return 1;
+    }
+    std::string guard = "GENERATED_POLICY_" + name + "_H";
+    fprintf(out, "// Generated by policy-compiler from %s; do not edit.\n", policyPath.c_str());
+    fprintf(out, "// Regenerate when the policy changes: SpecializedEvaluator only serves\n");
+    fprintf(out, "// the exact snapshot below and everything else goes to evaluate().\n\n");
+    fprintf(out, "#ifndef %s\n#define %s\n\n", guard.c_str(), guard.c_str());
+    fprintf(out, "#include \"SpecializedPolicy.h\"\n\n");
+    fprintf(out, "struct %s {\n", name.c_str());
+    fprintf(out, "    static constexpr const char* kVersion = %s;\n\n", literal(versionText).c_str());
+    writeTree(out, "Attributes", index.policy().attributes);
+    fprintf(out, "\n");
+    writeTree(out, "Purposes", index.policy().purposes);
+    fprintf(out, "};\n\n");
+    if (name != "GeneratedPolicy") {
+        fprintf(out, "typedef %s GeneratedPolicy;\n\n", name.c_str());
+    }
+    fprintf(out, "#endif // %s\n", guard.c_str());
+
+    bool ok = fclose(out) == 0;
+    if (!ok) {
+        fprintf(stderr, "policy-compiler: cannot write %s\n", outputPath.c_str());
+        return 1;
+    }
+    fprintf(stderr, "%s: %zu attributes, %zu purposes -> %s\n", name.c_str(),
+            index.policy().attributes.size(), index.policy().purposes.size(), outputPath.c_str());
+    return 0;
+}
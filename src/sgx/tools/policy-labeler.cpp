@@ -0,0 +1,257 @@
+// policy-labeler: number a policy whose nodes may have several parents
+//
+// Usage:
+//   policy-labeler --policy policy.json [--output labeled.json]
+//
+// The policy is the document (or a mongoexport array whose first element
+// is it). Each attribute and purpose entry lists the IDs of the nodes it
+// sits directly under in "parents", the first being its parent in the
+// spanning tree; roots have none. The policy is written back, to stdout
+// without --output, with left and right from a PolicyDag labeling
+// (core/PolicyDag.h) and, for nodes that reach descendants through another
+// parent, an "intervals" array that evaluate() and the Mongo lookups read.
+// Everything else in the document is kept as it was.
+
+#include <stdio.h>
+#include <string.h>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../core/EvaluationInput.h"
+#include "../core/PolicyDag.h"
+
+static void usage(const char* program) {
+    fprintf(stderr, "Usage: %s --policy policy.json [--output labeled.json]\n", program);
+}
+
+static bool readFile(const std::string& path, std::string* out) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) out->append(buffer, n);
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+// ============================================================================
+// Labeling
+// ============================================================================
+
+static JsonValue numberValue(int32_t number) {
+    JsonValue value;
+    value.type = JSON_NUMBER;
+    value.number = number;
+    return value;
+}
+
+// Sets key on an object, in place if present; a null value removes it
+static void setMember(JsonValue* object, const char* key, JsonValue value) {
+    for (size_t i = 0; i < object->keys.size(); i++) {
+        if (object->keys[i] != key) continue;
+        if (value.type == JSON_NULL) {
+            object->keys.erase(object->keys.begin() + i);
+            object->items.erase(object->items.begin() + i);
+        } else {
+            object->items[i] = std::move(value);
+        }
+        return;
+    }
+    if (value.type == JSON_NULL) return;
+    object->keys.push_back(key);
+    object->items.push_back(std::move(value));
+}
+
+static bool labelTree(JsonValue* array, const char* kind, std::string* error) {
+    if (!array) return true;
+    if (!array->isArray()) {
+        *error = std::string("policy ") + kind + " must be an array";
+        return false;
+    }
+
+    std::unordered_map<std::string, uint32_t> ordinals;
+    for (const JsonValue& item : array->items) {
+        std::string id;
+        if (!item.isObject() || !readObjectId(item, &id)) {
+            *error = std::string("policy ") + kind + " entry without _id";
+            return false;
+        }
+        if (!ordinals.emplace(id, (uint32_t)ordinals.size()).second) {
+            *error = std::string("duplicate ") + kind + " id " + id +
+                     ": list each node once, with all its parents";
+            return false;
+        }
+    }
+
+    std::vector<std::vector<uint32_t>> parents(array->items.size());
+    for (size_t i = 0; i < array->items.size(); i++) {
+        const JsonValue* list = array->items[i].get("parents");
+        if (!list || list->type == JSON_NULL) continue;
+        if (!list->isArray()) {
+            *error = std::string(kind) + " parents must be an array";
+            return false;
+        }
+        for (const JsonValue& parent : list->items) {
+            std::string id;
+            auto it = readObjectId(parent, &id) ? ordinals.find(id) : ordinals.end();
+            if (it == ordinals.end()) {
+                *error = std::string(kind) + " parent " + id + " not found";
+                return false;
+            }
+            parents[i].push_back(it->second);
+        }
+    }
+
+    PolicyDag dag;
+    std::vector<uint32_t> postorder;
+    if (!dag.build(parents, &postorder)) {
+        *error = std::string(kind) + " parents form a cycle or name the node itself";
+        return false;
+    }
+    for (size_t i = 0; i < array->items.size(); i++) {
+        JsonValue& item = array->items[i];
+        uint32_t node = postorder[i];
+        setMember(&item, "left", numberValue(dag.low(node, 0)));
+        setMember(&item, "right", numberValue(dag.high(node, 0)));
+        JsonValue intervals;
+        if (dag.intervalCount(node) > 1) {
+            intervals.type = JSON_ARRAY;
+            for (uint32_t j = 1; j < dag.intervalCount(node); j++) {
+                JsonValue interval;
+                interval.type = JSON_OBJECT;
+                setMember(&interval, "left", numberValue(dag.low(node, j)));
+                setMember(&interval, "right", numberValue(dag.high(node, j)));
+                intervals.items.push_back(std::move(interval));
+            }
+        }
+        setMember(&item, "intervals", std::move(intervals));
+    }
+    return true;
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+static void writeJson(const JsonValue& value, std::string* out) {
+    switch (value.type) {
+        case JSON_NULL:
+            *out += "null";
+            break;
+        case JSON_BOOL:
+            *out += value.boolean ? "true" : "false";
+            break;
+        case JSON_NUMBER: {
+            char number[32];
+            // Integers as integers; anything else with enough digits to
+            // read back the same double
+            if (std::fabs(value.number) < 9007199254740992.0 &&
+                value.number == std::floor(value.number)) {
+                snprintf(number, sizeof(number), "%lld", (long long)value.number);
+            } else {
+                snprintf(number, sizeof(number), "%.17g", value.number);
+            }
+            *out += number;
+            break;
+        }
+        case JSON_STRING:
+            appendJsonString(out, value.string);
+            break;
+        case JSON_ARRAY:
+            *out += '[';
+            for (size_t i = 0; i < value.items.size(); i++) {
+                if (i > 0) *out += ',';
+                writeJson(value.items[i], out);
+            }
+            *out += ']';
+            break;
+        case JSON_OBJECT:
+            *out += '{';
+            for (size_t i = 0; i < value.items.size(); i++) {
+                if (i > 0) *out += ',';
+                appendJsonString(out, value.keys[i]);
+                *out += ':';
+                writeJson(value.items[i], out);
+            }
+            *out += '}';
+            break;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string policyPath;
+    std::string outputPath;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--help") == 0) {
+            usage(argv[0]);
+            return 0;
+        }
+        if (!value) {
+            usage(argv[0]);
+            return 2;
+        }
+
+        if (strcmp(arg, "--policy") == 0) policyPath = value;
+        else if (strcmp(arg, "--output") == 0) outputPath = value;
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+
+    if (policyPath.empty()) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::string text;
+    if (!readFile(policyPath, &text)) {
+        fprintf(stderr, "policy-labeler: cannot read %s\n", policyPath.c_str());
+        return 1;
+    }
+    JsonValue json;
+    const char* parseError = nullptr;
+    if (!parseJson(text.data(), text.data() + text.size(), &json, &parseError)) {
+        fprintf(stderr, "policy-labeler: %s: %s\n", policyPath.c_str(), parseError);
+        return 1;
+    }
+    JsonValue* doc = json.isArray() && !json.items.empty() ? &json.items[0] : &json;
+    if (!doc->isObject()) {
+        fprintf(stderr, "policy-labeler: policy must be a JSON object\n");
+        return 1;
+    }
+
+    // Members are looked up by index so they can be edited in place
+    std::string error;
+    for (size_t i = 0; i < doc->keys.size(); i++) {
+        const std::string& key = doc->keys[i];
+        if ((key == "attributes" && !labelTree(&doc->items[i], "attributes", &error)) ||
+            (key == "purposes" && !labelTree(&doc->items[i], "purposes", &error))) {
+            fprintf(stderr, "policy-labeler: %s\n", error.c_str());
+            return 1;
+        }
+    }
+
+    std::string labeled;
+    writeJson(json, &labeled);
+    labeled += '\n';
+    FILE* out = outputPath.empty() ? stdout : fopen(outputPath.c_str(), "w");
+    if (!out) {
+        fprintf(stderr, "policy-labeler: cannot write %s\n", outputPath.c_str());
+        return 1;
+    }
+    bool ok = fwrite(labeled.data(), 1, labeled.size(), out) == labeled.size();
+    ok = (out == stdout ? fflush(out) == 0 : fclose(out) == 0) && ok;
+    if (!ok) {
+        fprintf(stderr, "policy-labeler: cannot write %s\n",
+                outputPath.empty() ? "stdout" : outputPath.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -292,7 +292,9 @@ class FogNode {
       throw new Error("SGX not available");
     }
 
-    const isAccepted = await sgxEvaluator.evaluate(app, user, policy);
+    // Device checks go through the realtime lane so bulk audits sharing the
+    // enclave cannot starve them
+    const isAccepted = await sgxEvaluator.evaluate(app, user, policy, { priority: "realtime" });
     return {
       result: isAccepted ? "grant" : "deny",
       usingSGX: true,
@@ -367,6 +369,7 @@ class FogNode {
     const cloudResponse = await axios.post(`${this.cloudUrl}/api/evaluate`, {
       appId,
       userId,
+      priority: "realtime",
     });
 
     const endTime = process.hrtime.bigint();